@@ -31,7 +31,6 @@
 
 @interface MIKMIDIToAudioExporter ()
 
-@property (nonatomic, strong) MIKMIDISequencer *sequencer;
 @property (nonatomic, strong) MIKOfflineMIDISynthesizer *synthesizer;
 
 @property (nonatomic, copy) MIKStudioMIDIToAudioExporterCompletionBlock completionBlock;
@@ -69,9 +68,9 @@
 	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithFileAtURL:self.midiFileURL error:&error];
 	if (!sequence) return [self finishWithError:error];
 	
-	self.synthesizer = [[MIKOfflineMIDISynthesizer alloc] init];
-	self.synthesizer.tracks = sequence.tracks;
-	self.synthesizer.tempo = [sequence tempoAtTimeStamp:0];
+	self.synthesizer = [[MIKOfflineMIDISynthesizer alloc] initWithError:&error];
+	if (!self.synthesizer) return [self finishWithError:error];
+	self.synthesizer.sequence = sequence;
 	
 	[self.synthesizer export];
 	
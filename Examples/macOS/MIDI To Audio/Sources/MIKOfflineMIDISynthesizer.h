@@ -31,8 +31,7 @@
 
 - (void)export;
 
-@property (nonatomic, strong) NSArray *tracks; // Array of MIKMIDITracks.
-@property (nonatomic) Float64 tempo;
+@property (nonatomic, strong) MIKMIDISequence *sequence;
 @property (nonatomic, strong, readonly) NSURL *outputFileURL;
 
 @end
@@ -31,6 +31,9 @@
 //	the # of frames to process on each render operation
 #define RENDER_FRAMES	(512)
 
+//	how long to keep rendering after the sequence ends, so the last notes can ring out
+#define RELEASE_SECONDS	(1.0)
+
 //	[thread] save audio stream through a subclass of MIKRecorder
 OSStatus recordCallback(void							*extFileRef,
 						AudioUnitRenderActionFlags	*ioActionFlags,
@@ -80,36 +83,18 @@ AudioStreamBasicDescription LPCMASBD(void)
 
 @property (nonatomic) ExtAudioFileRef cafFile;
 @property (nonatomic) AudioUnit outputUnit;
-@property (nonatomic, strong) MIKMIDIClock *midiClock;
-
-@property (nonatomic, copy) NSArray *allNoteMessages;
-@property (nonatomic) MusicTimeStamp maxTrackLength;
 
 @end
 
 @implementation MIKOfflineMIDISynthesizer
-{
-	BOOL _doneRendering;
-	
-	MIKMIDITrack *__unsafe_unretained *_rawTracks;
-	NSUInteger _numTracks;
-}
 
-- (instancetype)initWithAudioUnitDescription:(AudioComponentDescription)componentDescription
-{
-	self = [super initWithAudioUnitDescription:componentDescription];
-	if (self) {
-		_midiClock = [MIKMIDIClock clock];
-	}
-	return self;
-}
-
-- (BOOL)setupAUGraph
+- (BOOL)setupAUGraphWithError:(NSError **)error
 {
 	AUGraph graph;
 	OSStatus err = 0;
 	if ((err = NewAUGraph(&graph))) {
 		NSLog(@"Unable to create AU graph: %i", err);
+		if (error) *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 		return NO;
 	}
 	
@@ -121,6 +106,7 @@ AudioStreamBasicDescription LPCMASBD(void)
 	AUNode outputNode;
 	if ((err = AUGraphAddNode(graph, &outputcd, &outputNode))) {
 		NSLog(@"Unable to add ouptput node to graph: %i", err);
+		if (error) *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 		return NO;
 	}
 	
@@ -129,28 +115,33 @@ AudioStreamBasicDescription LPCMASBD(void)
 	AUNode instrumentNode;
 	if ((err = AUGraphAddNode(graph, &instrumentcd, &instrumentNode))) {
 		NSLog(@"Unable to add instrument node to AU graph: %i", err);
+		if (error) *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 		return NO;
 	}
 	
 	if ((err = AUGraphOpen(graph))) {
 		NSLog(@"Unable to open AU graph: %i", err);
+		if (error) *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 		return NO;
 	}
 	
 	AudioUnit outputUnit;
 	if ((err = AUGraphNodeInfo(graph, outputNode, NULL, &outputUnit))) {
 		NSLog(@"Unable to get output unit: %i", err);
+		if (error) *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 		return NO;
 	}
 	
 	AudioUnit instrumentUnit;
 	if ((err = AUGraphNodeInfo(graph, instrumentNode, NULL, &instrumentUnit))) {
 		NSLog(@"Unable to get instrument AU unit: %i", err);
+		if (error) *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 		return NO;
 	}
 	
 	if ((err = AUGraphConnectNodeInput(graph, instrumentNode, 0, outputNode, 0))) {
 		NSLog(@"Unable to connect instrument to output: %i", err);
+		if (error) *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 		return NO;
 	}
 	
@@ -174,23 +165,20 @@ AudioStreamBasicDescription LPCMASBD(void)
 											   &cafFile);
 	if (err) {
 		NSLog(@"Unable to create CAF file: %i", err);
+		if (error) *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 		return NO;
 	}
 	self.cafFile = cafFile;
 	
 	if ((err = AudioUnitAddRenderNotify(outputUnit, recordCallback, (void *)self.cafFile))) {
 		NSLog(@"Unable to add record callback: %i", err);
+		if (error) *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 		return NO;
 	}
 	
 	if ((err = AUGraphInitialize(graph))) {
 		NSLog(@"Unable to initialize AU graph: %i", err);
-		return NO;
-	}
-	
-	err = AudioUnitAddRenderNotify(instrumentUnit, instrumentRenderCallback, (__bridge void *)self);
-	if (err) {
-		NSLog(@"Unable to set set render callback on instrument unit: %i", err);
+		if (error) *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 		return NO;
 	}
 	
@@ -206,6 +194,7 @@ AudioStreamBasicDescription LPCMASBD(void)
 	AudioStreamBasicDescription absd = LPCMASBD();
 	if ((err = AudioUnitSetProperty(outputUnit, kAudioUnitProperty_StreamFormat, kAudioUnitScope_Output, 0, &absd, sizeof(absd)))) {
 		NSLog(@"Unable to set output unit's format: %i", err);
+		if (error) *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 		return NO;
 	}
 	
@@ -221,46 +210,21 @@ AudioStreamBasicDescription LPCMASBD(void)
 	return YES;
 }
 
-- (void)storeAllEvents
-{
-	NSPredicate *notePredicate = [NSPredicate predicateWithBlock:^BOOL(id obj, NSDictionary *b) {
-		return [obj isKindOfClass:[MIKMIDINoteEvent class]];
-	}];
-	self.maxTrackLength = 0;
-	NSMutableArray *noteEvents = [NSMutableArray array];
-	for (NSUInteger i=0; i<[self.tracks count]; i++) {
-		MIKMIDITrack *track = self.tracks[i];
-		self.maxTrackLength = MAX(self.maxTrackLength, track.length);
-		NSArray *events = [[track events] filteredArrayUsingPredicate:notePredicate];
-		for (MIKMIDINoteEvent *event in events) {
-			MIKMutableMIDINoteEvent *eventScratch = [event mutableCopy];
-			eventScratch.channel = i;
-			[noteEvents addObject:[eventScratch copy]];
-		}
-		if (events) [noteEvents addObjectsFromArray:events];
-	}
-	
-	[noteEvents filterUsingPredicate:notePredicate];
-	NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"timeStamp" ascending:YES];
-	[noteEvents sortUsingDescriptors:@[sortDescriptor]];
-	
-	NSMutableArray *noteCommands = [NSMutableArray array];
-	for (MIKMIDINoteEvent *event in noteEvents) {
-		[noteCommands addObjectsFromArray:[MIKMIDICommand commandsFromNoteEvent:event clock:self.midiClock]];
-	}
-	
-	self.allNoteMessages = noteCommands;
-}
-
 - (void)export
 {
-	[self storeAllEvents];
-	//	dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
-	//	render settings
+	MIKMIDISequence *sequence = self.sequence;
+	MIKMIDISequencer *sequencer = [MIKMIDISequencer sequencerWithSequence:sequence];
+	sequencer.createSynthsIfNeeded = NO;
+	for (MIKMIDITrack *track in sequence.tracks) {
+		[sequencer setCommandScheduler:self forTrack:track];
+	}
 	
 	CFAbsoluteTime startTime = CFAbsoluteTimeGetCurrent();
 	
-	AudioTimeStamp timestamp = (AudioTimeStamp) { 0, kAudioTimeStampSampleTimeValid };
+	//	render settings
+	Float64 sampleRate = LPCMASBD().mSampleRate;
+	AudioTimeStamp timestamp = {0};
+	timestamp.mFlags = kAudioTimeStampSampleTimeValid | kAudioTimeStampHostTimeValid;
 	
 	UInt32 channels = LPCMASBD().mChannelsPerFrame;
 	AudioBufferList bufferList;
@@ -271,7 +235,18 @@ AudioStreamBasicDescription LPCMASBD(void)
 	AudioUnitRenderActionFlags flags = 0;
 	OSStatus err = 0;
 	
+	//	the sequencer runs on a clock where MIDI time stamp 0 is the first sample of the file
+	[sequencer startOfflineRenderingAtTimeStamp:0 MIDITimeStamp:0];
+	Float64 endSampleTime = DBL_MAX;
+	
 	do {
+		//	schedule everything in this buffer before rendering it
+		timestamp.mHostTime = MIKMIDIClockMIDITimeStampsPerTimeInterval(timestamp.mSampleTime / sampleRate);
+		[sequencer renderOfflineToMIDITimeStamp:MIKMIDIClockMIDITimeStampsPerTimeInterval((timestamp.mSampleTime + RENDER_FRAMES) / sampleRate)];
+		if (!sequencer.isPlaying && endSampleTime == DBL_MAX) {
+			endSampleTime = timestamp.mSampleTime + RENDER_FRAMES + RELEASE_SECONDS * sampleRate;
+		}
+		
 		//	output unit provides its own buffer
 		bufferList.mBuffers[0].mData = NULL;
 		
@@ -284,80 +259,13 @@ AudioStreamBasicDescription LPCMASBD(void)
 		//	update state
 		timestamp.mSampleTime += RENDER_FRAMES;
 		
-	} while (!_doneRendering);
+	} while (timestamp.mSampleTime < endSampleTime);
 	
-	AUGraphStop(self.graph);
+	[sequencer stop];
 	ExtAudioFileDispose(self.cafFile);
 	self.cafFile = NULL;
 	
-	NSLog(@"rendering took %f (%fs file)", CFAbsoluteTimeGetCurrent() - startTime, [self.midiClock midiTimeStampForMusicTimeStamp:self.maxTrackLength] * MIKMIDIClockSecondsPerMIDITimeStamp());
-	
-	//	});
-}
-
-#pragma mark - Callbacks
-
-OSStatus instrumentRenderCallback(void							*info,
-								  AudioUnitRenderActionFlags	*ioActionFlags,
-								  const AudioTimeStamp			*inTimeStamp,
-								  UInt32						inBusNumber,
-								  UInt32						inNumberFrames,
-								  AudioBufferList				*ioData)
-{
-	@autoreleasepool {
-		MIKOfflineMIDISynthesizer *self = (__bridge MIKOfflineMIDISynthesizer *)info;
-		OSStatus error = noErr;
-		
-		if ( (*ioActionFlags & kAudioUnitRenderAction_PreRender) == 0 ) return noErr;
-		
-		NSTimeInterval startTimeInterval = inTimeStamp->mSampleTime / 44100.0;
-		NSTimeInterval duration = inNumberFrames / 44100.0;
-		
-		static mach_timebase_info_data_t timebaseInfo = {0,0};
-		if (timebaseInfo.denom == 0) mach_timebase_info(&timebaseInfo);
-		uint64_t midiStartTime = startTimeInterval * NSEC_PER_SEC * timebaseInfo.denom / timebaseInfo.numer;
-		uint64_t midiEndTime = midiStartTime + duration * NSEC_PER_SEC;
-		
-		NSMutableArray *commands = [NSMutableArray array];
-		for (MIKMIDICommand *command in self.allNoteMessages) {
-			if (midiStartTime > command.midiTimestamp) continue;
-			if (midiEndTime <= command.midiTimestamp) break;
-			
-			[commands addObject:command];
-		}
-		
-		if ([self.midiClock musicTimeStampForMIDITimeStamp:midiEndTime] >= self.maxTrackLength)
-			self->_doneRendering = YES;
-		
-		for (MIKMIDINoteOnCommand *command in commands) {
-			NSLog(@"channel: %i status: %x (%@)", command.channel, (unsigned int)command.statusByte, command.data);
-			error = MusicDeviceMIDIEvent(self.instrumentUnit, command.statusByte, command.dataByte1, command.dataByte2, 0);
-			if (error) return error;
-		}
-	}
-	return noErr;
-}
-
-#pragma mark - Properties
-
-- (void)setTracks:(NSArray *)tracks
-{
-	if (tracks != _tracks) {
-		free(_rawTracks);
-		_tracks = tracks;
-		
-		_numTracks = [_tracks count];
-		_rawTracks = (MIKMIDITrack *__unsafe_unretained *)malloc(sizeof(MIKMIDITrack *) * _numTracks);
-		[_tracks getObjects:_rawTracks];
-	}
-}
-
-- (void)setTempo:(Float64)tempo
-{
-	if (tempo != _tempo) {
-		_tempo = tempo;
-		[self.midiClock syncMusicTimeStamp:0 withMIDITimeStamp:0 tempo:_tempo];
-	}
+	NSLog(@"rendering took %f (%fs file)", CFAbsoluteTimeGetCurrent() - startTime, timestamp.mSampleTime / sampleRate);
 }
 
 @end
@@ -0,0 +1,205 @@
+//
+//  MIKMIDIClockTests.m
+//  MIKMIDI Tests
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright © 2026 Mixed In Key. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <MIKMIDI/MIKMIDI.h>
+
+@interface MIKMIDIClockTests : XCTestCase
+
+@property (nonatomic, strong) MIKMIDIClock *clock;
+
+@end
+
+@implementation MIKMIDIClockTests
+
+- (void)setUp
+{
+	[super setUp];
+	self.clock = [MIKMIDIClock clock];
+}
+
+- (void)testConversions
+{
+	MIKMIDIClock *clock = self.clock;
+	XCTAssertFalse(clock.isReady);
+	XCTAssertEqual([clock musicTimeStampForMIDITimeStamp:MIKMIDIGetCurrentTimeStamp()], 0);
+
+	MIDITimeStamp start = MIKMIDIGetCurrentTimeStamp();
+	MIDITimeStamp oneSecond = MIKMIDIClockMIDITimeStampsPerTimeInterval(1);
+	[clock syncMusicTimeStamp:0 withMIDITimeStamp:start tempo:120];
+	[clock syncMusicTimeStamp:4 withMIDITimeStamp:start + 2 * oneSecond tempo:60];
+	XCTAssertTrue(clock.isReady);
+	XCTAssertEqual(clock.currentTempo, 60);
+
+	// Before the tempo change, the earlier tempo applies
+	XCTAssertEqualWithAccuracy([clock musicTimeStampForMIDITimeStamp:start + oneSecond], 2, 1e-6);
+	XCTAssertEqualWithAccuracy([clock musicTimeStampForMIDITimeStamp:start + 3 * oneSecond], 5, 1e-6);
+	XCTAssertEqualWithAccuracy((double)[clock midiTimeStampForMusicTimeStamp:2], (double)(start + oneSecond), 2);
+	XCTAssertEqualWithAccuracy((double)[clock midiTimeStampForMusicTimeStamp:5], (double)(start + 3 * oneSecond), 2);
+	XCTAssertEqual([clock tempoAtMIDITimeStamp:start + oneSecond], 120);
+	XCTAssertEqual([clock tempoAtMusicTimeStamp:4.5], 60);
+	XCTAssertEqual([clock.syncedClock tempoAtMusicTimeStamp:1], 120);
+
+	[clock unsyncMusicTimeStampsAndTemposFromMIDITimeStamps];
+	XCTAssertFalse(clock.isReady);
+	XCTAssertEqual(clock.currentTempo, 0);
+}
+
+- (void)testConversionsWhenSyncedAtMIDITimeStampZero
+{
+	MIKMIDIClock *clock = self.clock;
+	MIDITimeStamp oneSecond = MIKMIDIClockMIDITimeStampsPerTimeInterval(1);
+
+	// Beat 0 is before MIDI time stamp 0, and further before it once the tempo slows
+	[clock syncMusicTimeStamp:8 withMIDITimeStamp:0 tempo:120];
+	XCTAssertTrue(clock.isReady);
+	XCTAssertEqual([clock musicTimeStampForMIDITimeStamp:0], 8);
+	XCTAssertEqualWithAccuracy([clock musicTimeStampForMIDITimeStamp:oneSecond], 10, 1e-6);
+	XCTAssertEqual([clock midiTimeStampForMusicTimeStamp:8], 0);
+	XCTAssertEqual([clock midiTimeStampForMusicTimeStamp:4], 0, @"Music time stamps before MIDI time stamp 0 should give 0.");
+
+	[clock syncMusicTimeStamp:10 withMIDITimeStamp:oneSecond tempo:60];
+	XCTAssertEqual(clock.currentTempo, 60);
+
+	// The clock synced at MIDI time stamp 0 is still used before the tempo change
+	XCTAssertEqual([clock tempoAtMIDITimeStamp:oneSecond / 2], 120);
+	XCTAssertEqualWithAccuracy([clock musicTimeStampForMIDITimeStamp:oneSecond / 2], 9, 1e-6);
+	XCTAssertEqualWithAccuracy((double)[clock midiTimeStampForMusicTimeStamp:9], (double)(oneSecond / 2), 2);
+	XCTAssertEqualWithAccuracy([clock musicTimeStampForMIDITimeStamp:3 * oneSecond], 12, 1e-6);
+	XCTAssertEqualWithAccuracy((double)[clock midiTimeStampForMusicTimeStamp:12], (double)(3 * oneSecond), 2);
+}
+
+- (void)testReadsAreConsistentWhileSyncing
+{
+	MIKMIDIClock *clock = self.clock;
+	MIDITimeStamp start = MIKMIDIGetCurrentTimeStamp();
+	MIDITimeStamp oneSecond = MIKMIDIClockMIDITimeStampsPerTimeInterval(1);
+	[clock syncMusicTimeStamp:0 withMIDITimeStamp:start tempo:120];
+
+	// The clock alternates between two syncs that put beat 3 at 1.5 and 2 seconds. Mixing up their
+	// start times and tempos would put it somewhere else.
+	__block BOOL done = NO;
+	__block NSUInteger numberOfInconsistentReads = 0;
+	dispatch_group_t group = dispatch_group_create();
+	dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+		while (!done) {
+			double seconds = (double)([clock midiTimeStampForMusicTimeStamp:3] - start) / oneSecond;
+			if (fabs(seconds - 1.5) > 1e-6 && fabs(seconds - 2.0) > 1e-6) numberOfInconsistentReads++;
+		}
+	});
+
+	for (NSUInteger i = 0; i < 100000; i++) {
+		[clock syncMusicTimeStamp:2 withMIDITimeStamp:start + oneSecond tempo:60];
+		[clock syncMusicTimeStamp:0 withMIDITimeStamp:start tempo:120];
+	}
+	done = YES;
+	dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+
+	XCTAssertEqual(numberOfInconsistentReads, 0);
+}
+
+#pragma mark - Time Sources
+
+- (void)testSimulatedTimeSourceRunsBlocksInOrder
+{
+	MIKMIDISimulatedTimeSource *timeSource = [[MIKMIDISimulatedTimeSource alloc] initWithMIDITimeStamp:1000];
+	dispatch_queue_t queue = dispatch_queue_create("MIKMIDIClockTests", DISPATCH_QUEUE_SERIAL);
+	NSMutableArray *order = [NSMutableArray array];
+	NSMutableArray *times = [NSMutableArray array];
+	void (^record)(NSUInteger) = ^(NSUInteger i) {
+		[order addObject:@(i)];
+		[times addObject:@(timeSource.currentMIDITimeStamp)];
+	};
+	[timeSource dispatchAtMIDITimeStamp:3000 queue:queue block:^{ record(3); }];
+	[timeSource dispatchAtMIDITimeStamp:2000 queue:queue block:^{
+		record(1);
+		// Blocks scheduled while advancing run in the same advance if they're due
+		[timeSource dispatchAtMIDITimeStamp:2500 queue:queue block:^{ record(2); }];
+	}];
+	[timeSource dispatchAtMIDITimeStamp:3000 queue:queue block:^{ record(4); }];
+	[timeSource dispatchAtMIDITimeStamp:5000 queue:queue block:^{ record(5); }];
+	XCTAssertEqual(order.count, 0);
+	XCTAssertEqual(timeSource.numberOfPendingBlocks, 4);
+
+	[timeSource advanceToMIDITimeStamp:4000];
+	XCTAssertEqualObjects(order, (@[@1, @2, @3, @4]));
+	XCTAssertEqualObjects(times, (@[@2000, @2500, @3000, @3000]));
+	XCTAssertEqual(timeSource.currentMIDITimeStamp, 4000);
+	XCTAssertEqual(timeSource.numberOfPendingBlocks, 1);
+
+	[timeSource advanceToMIDITimeStamp:3500];
+	XCTAssertEqual(timeSource.currentMIDITimeStamp, 4000, @"Time shouldn't go backwards.");
+	[timeSource advanceToMIDITimeStamp:5000];
+	XCTAssertEqualObjects(order, (@[@1, @2, @3, @4, @5]));
+	XCTAssertEqual(timeSource.numberOfPendingBlocks, 0);
+}
+
+- (void)testClockPrunesHistoryUsingTimeSource
+{
+	MIKMIDIClock *clock = self.clock;
+	MIDITimeStamp oneSecond = MIKMIDIClockMIDITimeStampsPerTimeInterval(1);
+	MIKMIDISimulatedTimeSource *timeSource = [[MIKMIDISimulatedTimeSource alloc] initWithMIDITimeStamp:oneSecond];
+	clock.timeSource = timeSource;
+	[clock syncMusicTimeStamp:0 withMIDITimeStamp:oneSecond tempo:120];
+	[clock syncMusicTimeStamp:4 withMIDITimeStamp:3 * oneSecond tempo:60];
+
+	// Far in the host clock's past, but not the time source's, so the first tempo must still be known
+	XCTAssertEqual([clock tempoAtMIDITimeStamp:2 * oneSecond], 120);
+}
+
+#pragma mark - Performance
+
+- (void)measureReadsWithNumberOfReaders:(NSUInteger)numberOfReaders
+{
+	MIKMIDIClock *clock = self.clock;
+	MIDITimeStamp start = MIKMIDIGetCurrentTimeStamp();
+	[clock syncMusicTimeStamp:0 withMIDITimeStamp:start tempo:120];
+
+	NSUInteger readsPerReader = 200000;
+	[self measureBlock:^{
+		// Sync every millisecond or so, like the sequencer during a tempo ramp, while reading as fast as possible
+		__block BOOL done = NO;
+		dispatch_group_t writerGroup = dispatch_group_create();
+		dispatch_group_async(writerGroup, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+			MusicTimeStamp musicTimeStamp = 0;
+			while (!done) {
+				musicTimeStamp += 0.002;
+				[clock syncMusicTimeStamp:musicTimeStamp withMIDITimeStamp:start + MIKMIDIClockMIDITimeStampsPerTimeInterval(musicTimeStamp / 2.0) tempo:120];
+				usleep(1000);
+			}
+		});
+
+		dispatch_apply(numberOfReaders, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^(size_t reader) {
+			MusicTimeStamp total = 0;
+			for (NSUInteger i = 0; i < readsPerReader; i++) {
+				total += [clock musicTimeStampForMIDITimeStamp:start + i];
+			}
+			XCTAssertGreaterThanOrEqual(total, 0);
+		});
+
+		done = YES;
+		dispatch_group_wait(writerGroup, DISPATCH_TIME_FOREVER);
+	}];
+}
+
+- (void)testReadPerformanceWith1Reader
+{
+	[self measureReadsWithNumberOfReaders:1];
+}
+
+- (void)testReadPerformanceWith4Readers
+{
+	[self measureReadsWithNumberOfReaders:4];
+}
+
+- (void)testReadPerformanceWith16Readers
+{
+	[self measureReadsWithNumberOfReaders:16];
+}
+
+@end
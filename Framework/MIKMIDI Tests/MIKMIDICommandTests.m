@@ -8,6 +8,8 @@
 
 #import <XCTest/XCTest.h>
 #import <MIKMIDI/MIKMIDI.h>
+#import <MIKMIDI/MIKMIDIPacketListArena.h>
+#import "MIKMIDITestAllocationCounting.h"
 
 @interface MIKMIDICommandTests : XCTestCase
 
@@ -102,4 +104,106 @@
 	MIKMIDIPacketFree(packet);
 }
 
+- (void)testPacketListFromCommands
+{
+	MIDITimeStamp timeStamp = MIKMIDIGetCurrentTimeStamp();
+	MIKMutableMIDINoteOnCommand *noteOn = [MIKMutableMIDINoteOnCommand noteOnCommandWithNote:60 velocity:64 channel:0 timestamp:nil];
+	noteOn.midiTimestamp = timeStamp;
+	MIKMutableMIDIControlChangeCommand *cc = [MIKMutableMIDIControlChangeCommand controlChangeCommandWithControllerNumber:27 value:63];
+	cc.midiTimestamp = timeStamp;
+	MIKMutableMIDISystemExclusiveCommand *sysex = [[MIKMutableMIDISystemExclusiveCommand alloc] init];
+	sysex.data = [NSData dataWithBytes:(UInt8[]){0xF0, 0x7E, 0x7F, 0x06, 0x01, 0xF7} length:6];
+	sysex.midiTimestamp = timeStamp;
+	MIKMutableMIDINoteOffCommand *noteOff = [MIKMutableMIDINoteOffCommand noteOffCommandWithNote:60 velocity:0 channel:0 timestamp:nil];
+	noteOff.midiTimestamp = timeStamp + 1000;
+	NSArray *commands = @[noteOn, cc, sysex, noteOff];
+
+	ByteCount listSize = MIKMIDIPacketListSizeForCommands(commands);
+	XCTAssertGreaterThan(listSize, 0);
+	MIDIPacketList *packetList = malloc(listSize);
+	XCTAssertTrue(MIKMIDIPacketListInitWithCommands(packetList, listSize, commands));
+
+	// Messages with the same timestamp share a packet, except for system exclusive messages
+	XCTAssertEqual(packetList->numPackets, 3);
+	const MIDIPacket *packet = &packetList->packet[0];
+	XCTAssertEqual(packet->timeStamp, timeStamp);
+	XCTAssertEqual(packet->length, 6);
+	XCTAssertEqualObjects([MIKMIDICommand commandsWithMIDIPacket:(MIDIPacket *)packet], (@[noteOn, cc]));
+
+	packet = MIDIPacketNext(packet);
+	XCTAssertEqual(packet->timeStamp, timeStamp);
+	XCTAssertEqualObjects([NSData dataWithBytes:packet->data length:packet->length], sysex.data);
+
+	packet = MIDIPacketNext(packet);
+	XCTAssertEqual(packet->timeStamp, timeStamp + 1000);
+	XCTAssertEqualObjects([MIKMIDICommand commandsWithMIDIPacket:(MIDIPacket *)packet], @[noteOff]);
+
+	XCTAssertFalse(MIKMIDIPacketListInitWithCommands(packetList, sizeof(MIDIPacketList), commands), @"Commands shouldn't fit in a buffer that's too small.");
+	free(packetList);
+}
+
+// Each command has its own time stamp, so gets its own packet
+- (void)assertPacketListArena:(MIKMIDIPacketListArena *)arena encodesNumberOfCommands:(NSUInteger)numberOfCommands
+{
+	NSMutableArray *commands = [NSMutableArray array];
+	for (NSUInteger i = 0; i < numberOfCommands; i++) {
+		MIKMutableMIDINoteOnCommand *noteOn = [MIKMutableMIDINoteOnCommand noteOnCommandWithNote:i % 128 velocity:100 channel:0 timestamp:nil];
+		noteOn.midiTimestamp = 1000 + i;
+		[commands addObject:noteOn];
+	}
+
+	__block BOOL calledBlock = NO;
+	XCTAssertTrue([arena encodeCommands:commands usingBlock:^(const MIDIPacketList *packetList) {
+		calledBlock = YES;
+		XCTAssertEqual(packetList->numPackets, numberOfCommands);
+		const MIDIPacket *packet = &packetList->packet[0];
+		for (NSUInteger i = 0; i < packetList->numPackets; i++) {
+			XCTAssertEqualObjects([MIKMIDICommand commandsWithMIDIPacket:(MIDIPacket *)packet], @[commands[i]]);
+			packet = MIDIPacketNext(packet);
+		}
+	}]);
+	XCTAssertTrue(calledBlock);
+}
+
+- (void)testPacketListArenaGrowsWhileEncoding
+{
+	MIKMIDIPacketListArena *arena = [[MIKMIDIPacketListArena alloc] init];
+	XCTAssertFalse([arena encodeCommands:@[] usingBlock:^(const MIDIPacketList *packetList) {}]);
+
+	[self assertPacketListArena:arena encodesNumberOfCommands:4]; // Fits on the stack
+	[self assertPacketListArena:arena encodesNumberOfCommands:1000]; // Outgrows the stack into the arena's buffer
+	[self assertPacketListArena:arena encodesNumberOfCommands:2000]; // Outgrows the arena's buffer, which grows with it
+	XCTAssertEqual(arena.numberOfTemporaryAllocations, 0);
+
+	[self assertPacketListArena:arena encodesNumberOfCommands:10000]; // Too big to keep a buffer for
+	XCTAssertEqual(arena.numberOfTemporaryAllocations, 1);
+}
+
+#pragma mark - Performance
+
+- (void)testPacketListEncodingPerformance
+{
+	NSMutableArray *commands = [NSMutableArray array];
+	MIDITimeStamp timeStamp = MIKMIDIGetCurrentTimeStamp();
+	for (UInt8 note = 60; note < 64; note++) {
+		MIKMutableMIDINoteOnCommand *noteOn = [MIKMutableMIDINoteOnCommand noteOnCommandWithNote:note velocity:100 channel:0 timestamp:nil];
+		noteOn.midiTimestamp = timeStamp;
+		[commands addObject:noteOn];
+	}
+	MIKMIDIPacketListArena *arena = [[MIKMIDIPacketListArena alloc] init];
+	void (^block)(const MIDIPacketList *) = ^(const MIDIPacketList *packetList) {};
+
+	NSUInteger numberOfEncodes = 1000000;
+	[self measureBlock:^{
+		MIKMIDIStartCountingAllocations();
+		NSDate *start = [NSDate date];
+		for (NSUInteger i = 0; i < numberOfEncodes; i++) {
+			[arena encodeCommands:commands usingBlock:block];
+		}
+		NSTimeInterval duration = -[start timeIntervalSinceNow];
+		NSUInteger numberOfAllocations = MIKMIDIStopCountingAllocations();
+		NSLog(@"%.0f packet lists per second, %.3f allocations per packet list", numberOfEncodes / duration, (double)numberOfAllocations / numberOfEncodes);
+	}];
+}
+
 @end
@@ -0,0 +1,608 @@
+//
+//  MIKMIDIFileParserTests.m
+//  MIKMIDI Tests
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright © 2026 Mixed In Key. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <MIKMIDI/MIKMIDI.h>
+#import <MIKMIDI/MIKMIDIFileParser.h>
+#import <MIKMIDI/MIKMIDIFileDecoder.h>
+#import <MIKMIDI/MIKMIDIFileWriter.h>
+
+@interface MIKMIDIFileParserTests : XCTestCase
+
+@end
+
+@implementation MIKMIDIFileParserTests
+
+#pragma mark - Helpers
+
+- (NSURL *)URLForResource:(NSString *)name
+{
+	NSBundle *bundle = [NSBundle bundleForClass:[self class]];
+	return [bundle URLForResource:name withExtension:@"mid"];
+}
+
+- (NSData *)dataForResource:(NSString *)name
+{
+	return [NSData dataWithContentsOfURL:[self URLForResource:name]];
+}
+
+// Loads data the way MIKMIDISequence used to, by way of MusicSequenceFileLoadData()
+- (MIKMIDISequence *)audioToolboxSequenceWithData:(NSData *)data
+{
+	MusicSequence musicSequence;
+	if (NewMusicSequence(&musicSequence)) return nil;
+	if (MusicSequenceFileLoadData(musicSequence, (__bridge CFDataRef)data, kMusicSequenceFile_MIDIType, 0)) return nil;
+	return [MIKMIDISequence sequenceWithMusicSequence:musicSequence error:NULL];
+}
+
+static NSData *MIKSMFWithTrackBytes(const UInt8 *trackBytes, UInt32 length)
+{
+	NSMutableData *result = [NSMutableData data];
+	UInt8 header[] = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0x01, 0xE0}; // Format 0, 1 track, 480 PPQ
+	[result appendBytes:header length:sizeof(header)];
+	UInt8 chunkHeader[] = {'M', 'T', 'r', 'k', (length >> 24) & 0xFF, (length >> 16) & 0xFF, (length >> 8) & 0xFF, length & 0xFF};
+	[result appendBytes:chunkHeader length:sizeof(chunkHeader)];
+	[result appendBytes:trackBytes length:length];
+	return result;
+}
+
+// A format 1 file with numberOfTracks tracks, made by repeating the tracks in Parallax-Loader.mid,
+// standing in for large orchestral files.
+- (NSData *)dataForFileWithNumberOfTracks:(UInt16)numberOfTracks
+{
+	NSData *source = [self dataForResource:@"Parallax-Loader"];
+	MIKMIDIFileHeader header;
+	MIKMIDIFileParseHeader(source.bytes, source.length, &header, NULL);
+	MIKMIDIFileTrackChunk chunks[16];
+	size_t count = 0;
+	MIKMIDIFileIndexTrackChunks(source.bytes, source.length, &header, chunks, 16, &count);
+
+	NSMutableData *result = [NSMutableData data];
+	UInt8 headerBytes[] = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 1, numberOfTracks >> 8, numberOfTracks & 0xFF, header.division >> 8, header.division & 0xFF};
+	[result appendBytes:headerBytes length:sizeof(headerBytes)];
+	for (UInt16 i = 0; i < numberOfTracks; i++) {
+		MIKMIDIFileTrackChunk chunk = chunks[i % count];
+		UInt32 length = chunk.length;
+		UInt8 chunkHeader[] = {'M', 'T', 'r', 'k', (length >> 24) & 0xFF, (length >> 16) & 0xFF, (length >> 8) & 0xFF, length & 0xFF};
+		[result appendBytes:chunkHeader length:sizeof(chunkHeader)];
+		[result appendBytes:chunk.bytes length:length];
+	}
+	return result;
+}
+
+#pragma mark - Low Level Parsing
+
+- (void)testVariableLengthQuantities
+{
+	struct { UInt8 bytes[4]; NSUInteger length; uint32_t value; } cases[] = {
+		{{0x00}, 1, 0},
+		{{0x7F}, 1, 0x7F},
+		{{0x81, 0x00}, 2, 0x80},
+		{{0xC0, 0x00}, 2, 0x2000},
+		{{0xFF, 0x7F}, 2, 0x3FFF},
+		{{0x81, 0x80, 0x00}, 3, 0x4000},
+		{{0xFF, 0xFF, 0xFF, 0x7F}, 4, 0x0FFFFFFF},
+	};
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		const uint8_t *cursor = cases[i].bytes;
+		uint32_t value = 0;
+		XCTAssertEqual(MIKMIDIFileReadVariableLengthQuantity(&cursor, cases[i].bytes + cases[i].length, &value), MIKMIDIFileResultOK);
+		XCTAssertEqual(value, cases[i].value);
+		XCTAssertEqual(cursor, cases[i].bytes + cases[i].length);
+	}
+
+	const uint8_t truncated[] = {0x81, 0x80};
+	const uint8_t *cursor = truncated;
+	uint32_t value = 0;
+	XCTAssertEqual(MIKMIDIFileReadVariableLengthQuantity(&cursor, truncated + sizeof(truncated), &value), MIKMIDIFileResultTruncated);
+}
+
+- (void)testRunningStatusMetaAndSysex
+{
+	const UInt8 track[] = {
+		0x00, 0xFF, 0x03, 0x04, 'L', 'e', 'a', 'd',		// Track name
+		0x00, 0x90, 0x3C, 0x64,							// Note on C4
+		0x00, 0x40, 0x50,								// Note on E4 (running status)
+		0x83, 0x60, 0x3C, 0x00,							// Note off C4 (running status, velocity 0) at 480
+		0x00, 0xF0, 0x03, 0x7E, 0x01, 0xF7,				// Sysex
+		0x00, 0x80, 0x40, 0x20,							// Note off E4 at 480
+		0x00, 0xFF, 0x2F, 0x00,							// End of track
+	};
+	NSData *data = MIKSMFWithTrackBytes(track, sizeof(track));
+
+	MIKMIDIFileHeader header;
+	XCTAssertEqual(MIKMIDIFileParseHeader(data.bytes, data.length, &header, NULL), MIKMIDIFileResultOK);
+	XCTAssertEqual(header.format, 0);
+	XCTAssertEqual(header.division, 480);
+
+	MIKMIDIFileTrackChunk chunk;
+	size_t count = 0;
+	XCTAssertEqual(MIKMIDIFileIndexTrackChunks(data.bytes, data.length, &header, &chunk, 1, &count), MIKMIDIFileResultOK);
+	XCTAssertEqual(count, 1);
+
+	MIKMIDIFileTrackReader reader;
+	MIKMIDIFileTrackReaderInit(&reader, chunk);
+	MIKMIDIFileEvent event;
+
+	XCTAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	XCTAssertEqual(event.kind, MIKMIDIFileEventKindMeta);
+	XCTAssertEqual(event.metaType, 0x03);
+	XCTAssertEqual(event.payloadLength, 4);
+	XCTAssertEqual(memcmp(event.payload, "Lead", 4), 0);
+
+	XCTAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	XCTAssertEqual(event.status, 0x90);
+	XCTAssertEqual(event.data1, 0x3C);
+
+	XCTAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	XCTAssertEqual(event.status, 0x90);
+	XCTAssertEqual(event.data1, 0x40);
+	XCTAssertEqual(event.data2, 0x50);
+
+	XCTAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	XCTAssertEqual(event.tick, 480);
+	XCTAssertEqual(event.status, 0x90);
+	XCTAssertEqual(event.data2, 0);
+
+	XCTAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	XCTAssertEqual(event.kind, MIKMIDIFileEventKindSystemExclusive);
+	XCTAssertEqual(event.payloadLength, 3);
+	XCTAssertEqual(event.payload[2], 0xF7);
+
+	XCTAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	XCTAssertEqual(event.status, 0x80);
+
+	XCTAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultEndOfTrack);
+	XCTAssertEqual(event.tick, 480);
+}
+
+- (void)testMalformedFiles
+{
+	MIKMIDIFileHeader header;
+	const UInt8 notAMIDIFile[] = {'R', 'I', 'F', 'F', 0, 0, 0, 6, 0, 0, 0, 1, 0, 96};
+	XCTAssertEqual(MIKMIDIFileParseHeader(notAMIDIFile, sizeof(notAMIDIFile), &header, NULL), MIKMIDIFileResultNotAMIDIFile);
+	XCTAssertEqual(MIKMIDIFileParseHeader(notAMIDIFile, 8, &header, NULL), MIKMIDIFileResultTruncated);
+
+	const UInt8 missingStatus[] = {0x00, 0x3C, 0x64};
+	NSData *data = MIKSMFWithTrackBytes(missingStatus, sizeof(missingStatus));
+	XCTAssertEqual(MIKMIDIFileParseHeader(data.bytes, data.length, &header, NULL), MIKMIDIFileResultOK);
+	MIKMIDIFileTrackChunk chunk;
+	size_t count = 0;
+	MIKMIDIFileIndexTrackChunks(data.bytes, data.length, &header, &chunk, 1, &count);
+	MIKMIDIFileTrackReader reader;
+	MIKMIDIFileTrackReaderInit(&reader, chunk);
+	MIKMIDIFileEvent event;
+	XCTAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultMissingRunningStatus);
+
+	const UInt8 statusByteAsData[] = {0x00, 0x90, 0x3C, 0xE4};
+	data = MIKSMFWithTrackBytes(statusByteAsData, sizeof(statusByteAsData));
+	MIKMIDIFileIndexTrackChunks(data.bytes, data.length, &header, &chunk, 1, &count);
+	MIKMIDIFileTrackReaderInit(&reader, chunk);
+	XCTAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultMalformedEvent);
+}
+
+#pragma mark - Sequence Loading
+
+- (void)testNotePairing
+{
+	const UInt8 track[] = {
+		0x00, 0x90, 0x3C, 0x64,		// Note on C4
+		0x83, 0x60, 0x90, 0x3C, 0x64,	// Note on C4 again at 480, before the first is released
+		0x83, 0x60, 0x80, 0x3C, 0x10,	// First note off at 960
+		0x83, 0x60, 0x80, 0x3C, 0x20,	// Second note off at 1440
+		0x00, 0xFF, 0x2F, 0x00,
+	};
+	NSData *data = MIKSMFWithTrackBytes(track, sizeof(track));
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithData:data error:NULL];
+	XCTAssertNotNil(sequence);
+	XCTAssertEqual(sequence.tracks.count, 1);
+
+	NSArray *notes = [sequence.tracks[0] notes];
+	XCTAssertEqual(notes.count, 2);
+	MIKMIDINoteEvent *first = notes[0], *second = notes[1];
+	XCTAssertEqual(first.timeStamp, 0);
+	XCTAssertEqual(first.duration, 2);
+	XCTAssertEqual(first.releaseVelocity, 0x10);
+	XCTAssertEqual(second.timeStamp, 1);
+	XCTAssertEqual(second.duration, 2);
+	XCTAssertEqual(second.releaseVelocity, 0x20);
+}
+
+- (void)testRejectedFilesFallBackToAudioToolboxWhenConvertingChannels
+{
+	const UInt8 track[] = {
+		0x00, 0x90, 0x3C, 0x64,
+		0x83, 0x60, 0x80, 0x3C, 0x40,
+		0x00, 0xF4,			// Undefined status byte, which our decoder rejects
+		0x00, 0xFF, 0x2F, 0x00,
+	};
+	NSData *data = MIKSMFWithTrackBytes(track, sizeof(track));
+	MIKMIDIFileDecoder *decoder = [[MIKMIDIFileDecoder alloc] initWithData:data error:NULL];
+	XCTAssertNil([decoder eventsForAllTracksWithTempoTrackEvents:nil maximumConcurrentTracks:1 error:NULL]);
+
+	// Whatever MusicSequenceFileLoadData() makes of the file, it must not quietly load as an empty sequence
+	NSError *error = nil;
+	MIKMIDISequence *sequence = [[MIKMIDISequence alloc] initWithData:data options:MIKMIDISequenceLoadingOptionConvertMIDIChannelsToTracks error:&error];
+	if (sequence) {
+		NSUInteger numberOfNotes = 0;
+		for (MIKMIDITrack *sequenceTrack in sequence.tracks) numberOfNotes += [sequenceTrack.notes count];
+		XCTAssertEqual(numberOfNotes, 1);
+	} else {
+		XCTAssertNotNil(error);
+	}
+}
+
+- (void)testNativeLoadingMatchesAudioToolbox
+{
+	for (NSString *name in @[@"bach", @"Parallax-Loader"]) {
+		NSData *data = [self dataForResource:name];
+		MIKMIDISequence *native = [MIKMIDISequence sequenceWithData:data error:NULL];
+		MIKMIDISequence *audioToolbox = [self audioToolboxSequenceWithData:data];
+		XCTAssertNotNil(native);
+		XCTAssertNotNil(audioToolbox);
+
+		XCTAssertEqual(native.tracks.count, audioToolbox.tracks.count, @"Track count mismatch for %@", name);
+		XCTAssertEqual(native.tempoTrack.timeResolution, audioToolbox.tempoTrack.timeResolution);
+		XCTAssertEqualWithAccuracy(native.durationInSeconds, audioToolbox.durationInSeconds, 1e-6);
+		XCTAssertEqualWithAccuracy([native tempoAtTimeStamp:0], [audioToolbox tempoAtTimeStamp:0], 1e-6);
+
+		for (NSUInteger i = 0; i < MIN(native.tracks.count, audioToolbox.tracks.count); i++) {
+			NSArray *nativeNotes = [native.tracks[i] notes];
+			NSArray *audioToolboxNotes = [audioToolbox.tracks[i] notes];
+			XCTAssertEqual(nativeNotes.count, audioToolboxNotes.count, @"Note count mismatch in track %lu of %@", (unsigned long)i, name);
+			XCTAssertEqualObjects([NSSet setWithArray:nativeNotes], [NSSet setWithArray:audioToolboxNotes]);
+		}
+	}
+}
+
+- (void)testLazyLoadingMatchesEagerLoading
+{
+	for (NSString *name in @[@"bach", @"Parallax-Loader"]) {
+		NSURL *url = [self URLForResource:name];
+		MIKMIDISequence *eager = [MIKMIDISequence sequenceWithFileAtURL:url error:NULL];
+		MIKMIDISequence *lazy = [MIKMIDISequence sequenceWithFileAtURL:url options:MIKMIDISequenceLoadingOptionLazy error:NULL];
+		XCTAssertNotNil(eager);
+		XCTAssertNotNil(lazy);
+		XCTAssertEqual(lazy.tracks.count, eager.tracks.count, @"Track count mismatch for %@", name);
+
+		// None of this should require decoding the tracks' events
+		XCTAssertEqual(lazy.length, eager.length);
+		XCTAssertEqualWithAccuracy(lazy.durationInSeconds, eager.durationInSeconds, 1e-9);
+		XCTAssertEqualObjects(lazy.tempoTrack.events, eager.tempoTrack.events);
+		for (NSUInteger i = 0; i < MIN(lazy.tracks.count, eager.tracks.count); i++) {
+			MIKMIDITrack *lazyTrack = lazy.tracks[i];
+			XCTAssertEqualObjects(lazyTrack.name, [eager.tracks[i] name]);
+			XCTAssertEqual(lazyTrack.length, [eager.tracks[i] length]);
+			XCTAssertNotNil([lazyTrack valueForKey:@"pendingFileDecoder"], @"Track %lu of %@ was loaded early", (unsigned long)i, name);
+		}
+
+		for (NSUInteger i = 0; i < MIN(lazy.tracks.count, eager.tracks.count); i++) {
+			MIKMIDITrack *lazyTrack = lazy.tracks[i];
+			XCTAssertEqualObjects(lazyTrack.events, [eager.tracks[i] events]);
+			XCTAssertNil([lazyTrack valueForKey:@"pendingFileDecoder"]);
+			XCTAssertEqual(lazyTrack.length, [eager.tracks[i] length]);
+		}
+	}
+}
+
+- (void)testLazyTracksLoadBeforeModification
+{
+	NSURL *url = [self URLForResource:@"bach"];
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithFileAtURL:url options:MIKMIDISequenceLoadingOptionLazy error:NULL];
+	MIKMIDITrack *track = sequence.tracks[1];
+	NSUInteger originalCount = [[MIKMIDISequence sequenceWithFileAtURL:url error:NULL].tracks[1] events].count;
+
+	[track addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:0 note:60 velocity:100 duration:1 channel:0]];
+	XCTAssertEqual(track.events.count, originalCount + 1);
+}
+
+- (void)testConcurrentDecodingIsDeterministic
+{
+	NSData *data = [self dataForFileWithNumberOfTracks:64];
+	MIKMIDIFileDecoder *decoder = [[MIKMIDIFileDecoder alloc] initWithData:data error:NULL];
+	XCTAssertEqual(decoder.numberOfTracks, 64);
+
+	NSMutableArray *serialTempoTrackEvents = [NSMutableArray array];
+	NSArray *serialTracks = [decoder eventsForAllTracksWithTempoTrackEvents:serialTempoTrackEvents maximumConcurrentTracks:1 error:NULL];
+	XCTAssertEqual(serialTracks.count, 64);
+
+	for (NSNumber *workers in @[@2, @4, @8, @100]) {
+		NSMutableArray *tempoTrackEvents = [NSMutableArray array];
+		NSArray *tracks = [decoder eventsForAllTracksWithTempoTrackEvents:tempoTrackEvents maximumConcurrentTracks:workers.unsignedIntegerValue error:NULL];
+		XCTAssertEqualObjects(tracks, serialTracks, @"Tracks differ with %@ workers", workers);
+		XCTAssertEqualObjects(tempoTrackEvents, serialTempoTrackEvents, @"Tempo track differs with %@ workers", workers);
+	}
+
+	MIKMIDISequence *serial = [[MIKMIDISequence alloc] initWithData:data options:MIKMIDISequenceLoadingOptionNone error:NULL];
+	MIKMIDISequence *concurrent = [[MIKMIDISequence alloc] initWithData:data options:MIKMIDISequenceLoadingOptionConcurrentDecoding error:NULL];
+	XCTAssertEqual(concurrent.tracks.count, serial.tracks.count);
+	XCTAssertEqualObjects(concurrent.tempoTrack.events, serial.tempoTrack.events);
+	for (NSUInteger i = 0; i < MIN(concurrent.tracks.count, serial.tracks.count); i++) {
+		XCTAssertEqualObjects([concurrent.tracks[i] events], [serial.tracks[i] events]);
+	}
+}
+
+- (void)testConcurrentDecodingReportsFirstError
+{
+	// Add an unreadable track after 7 good ones
+	NSMutableData *data = [[self dataForFileWithNumberOfTracks:7] mutableCopy];
+	((UInt8 *)data.mutableBytes)[11] = 8;
+	const UInt8 badTrack[] = {'M', 'T', 'r', 'k', 0, 0, 0, 3, 0x00, 0x3C, 0x64};
+	[data appendBytes:badTrack length:sizeof(badTrack)];
+
+	MIKMIDIFileDecoder *decoder = [[MIKMIDIFileDecoder alloc] initWithData:data error:NULL];
+	NSError *error = nil;
+	XCTAssertNil([decoder eventsForAllTracksWithTempoTrackEvents:nil maximumConcurrentTracks:4 error:&error]);
+	XCTAssertEqual(error.code, MIKMIDIInvalidMIDIFileErrorCode);
+}
+
+#pragma mark - Writing
+
+static MIKMIDIFileResult MIKTestWriteToData(void *context, const uint8_t *bytes, size_t length)
+{
+	[(__bridge NSMutableData *)context appendBytes:bytes length:length];
+	return MIKMIDIFileResultOK;
+}
+
+static MIKMIDIFileResult MIKTestPatchData(void *context, uint64_t offset, const uint8_t *bytes, size_t length)
+{
+	[(__bridge NSMutableData *)context replaceBytesInRange:NSMakeRange((NSUInteger)offset, length) withBytes:bytes];
+	return MIKMIDIFileResultOK;
+}
+
+- (void)testWritingVariableLengthQuantities
+{
+	UInt8 bytes[4];
+	XCTAssertEqual(MIKMIDIFileWriteVariableLengthQuantity(0, bytes), 1);
+	XCTAssertEqual(bytes[0], 0x00);
+	XCTAssertEqual(MIKMIDIFileWriteVariableLengthQuantity(0x7F, bytes), 1);
+	XCTAssertEqual(bytes[0], 0x7F);
+	XCTAssertEqual(MIKMIDIFileWriteVariableLengthQuantity(0x80, bytes), 2);
+	XCTAssertEqual(bytes[0], 0x81);
+	XCTAssertEqual(bytes[1], 0x00);
+	XCTAssertEqual(MIKMIDIFileWriteVariableLengthQuantity(0x0FFFFFFF, bytes), 4);
+	XCTAssertEqual(memcmp(bytes, (UInt8[]){0xFF, 0xFF, 0xFF, 0x7F}, 4), 0);
+	XCTAssertEqual(MIKMIDIFileWriteVariableLengthQuantity(0x10000000, bytes), 0);
+}
+
+- (void)testWriterOutput
+{
+	NSMutableData *data = [NSMutableData data];
+	MIKMIDIFileWriter writer;
+	MIKMIDIFileWriterInit(&writer, MIKTestWriteToData, MIKTestPatchData, (__bridge void *)data);
+	MIKMIDIFileHeader header = {.format = 0, .numberOfTracks = 1, .division = 480};
+	XCTAssertEqual(MIKMIDIFileWriterWriteHeader(&writer, &header), MIKMIDIFileResultOK);
+	XCTAssertEqual(MIKMIDIFileWriterBeginTrack(&writer, MIKMIDIFileWriterUnknownTrackLength), MIKMIDIFileResultOK);
+	XCTAssertEqual(MIKMIDIFileWriterWriteMetaEvent(&writer, 0, MIKMIDIFileMetaTypeTrackName, (const UInt8 *)"Lead", 4), MIKMIDIFileResultOK);
+	XCTAssertEqual(MIKMIDIFileWriterWriteNote(&writer, 0, 480, 0, 60, 100, 0), MIKMIDIFileResultOK);
+	XCTAssertEqual(MIKMIDIFileWriterWriteNote(&writer, 0, 480, 0, 64, 80, 32), MIKMIDIFileResultOK);
+	const UInt8 sysex[] = {0x7E, 0x01, 0xF7};
+	XCTAssertEqual(MIKMIDIFileWriterWriteSystemExclusiveEvent(&writer, 480, 0xF0, sysex, sizeof(sysex)), MIKMIDIFileResultOK);
+	UInt32 length = 0;
+	XCTAssertEqual(MIKMIDIFileWriterEndTrack(&writer, &length), MIKMIDIFileResultOK);
+	XCTAssertEqual(MIKMIDIFileWriterFlush(&writer), MIKMIDIFileResultOK);
+	MIKMIDIFileWriterDestroy(&writer);
+
+	const UInt8 expected[] = {
+		'M', 'T', 'h', 'd', 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x01, 0x01, 0xE0,
+		'M', 'T', 'r', 'k', 0x00, 0x00, 0x00, 0x21,	// Length filled in after the fact
+		0x00, 0xFF, 0x03, 0x04, 'L', 'e', 'a', 'd',
+		0x00, 0x90, 0x3C, 0x64,
+		0x00, 0x40, 0x50,				// Running status
+		0x83, 0x60, 0x3C, 0x00,			// Note off as a note on with velocity 0, at 480
+		0x00, 0x80, 0x40, 0x20,			// Real note off, to keep the release velocity
+		0x00, 0xF0, 0x03, 0x7E, 0x01, 0xF7,
+		0x00, 0xFF, 0x2F, 0x00,
+	};
+	XCTAssertEqual(length, 0x21);
+	XCTAssertEqualObjects(data, [NSData dataWithBytes:expected length:sizeof(expected)]);
+}
+
+- (void)testWriterRequiresLengthOfLongTracksWithoutPatching
+{
+	NSMutableData *data = [NSMutableData data];
+	MIKMIDIFileWriter writer;
+	MIKMIDIFileWriterInit(&writer, MIKTestWriteToData, NULL, (__bridge void *)data);
+	MIKMIDIFileHeader header = {.format = 0, .numberOfTracks = 1, .division = 480};
+	MIKMIDIFileWriterWriteHeader(&writer, &header);
+	MIKMIDIFileWriterBeginTrack(&writer, MIKMIDIFileWriterUnknownTrackLength);
+	for (UInt64 i = 0; i < MIKMIDIFileWriterBufferSize; i++) {
+		MIKMIDIFileWriterWriteNote(&writer, i * 10, i * 10 + 5, 0, i % 128, 100, 0);
+	}
+	XCTAssertEqual(MIKMIDIFileWriterEndTrack(&writer, NULL), MIKMIDIFileResultInvalidArgument);
+	MIKMIDIFileWriterDestroy(&writer);
+}
+
+- (void)testTempoTrackIsWrittenAsConductorTrack
+{
+	MIKMIDISequence *sequence = [MIKMIDISequence sequence];
+	[sequence setOverallTempo:150];
+	MIKMIDITrack *track = [sequence addTrackWithError:NULL];
+	[track addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:0 note:60 velocity:100 duration:1 channel:0]];
+	NSData *data = sequence.dataValue;
+
+	MIKMIDIFileHeader header;
+	XCTAssertEqual(MIKMIDIFileParseHeader(data.bytes, data.length, &header, NULL), MIKMIDIFileResultOK);
+	XCTAssertEqual(header.format, 1);
+	XCTAssertEqual(header.numberOfTracks, 2);
+	MIKMIDIFileTrackChunk chunks[2];
+	size_t count = 0;
+	XCTAssertEqual(MIKMIDIFileIndexTrackChunks(data.bytes, data.length, &header, chunks, 2, &count), MIKMIDIFileResultOK);
+	XCTAssertEqual(count, 2);
+
+	MIKMIDIFileTrackReader reader;
+	MIKMIDIFileEvent event;
+	MIKMIDIFileTrackReaderInit(&reader, chunks[0]);
+	XCTAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	XCTAssertEqual(event.kind, MIKMIDIFileEventKindMeta);
+	XCTAssertEqual(event.metaType, MIKMIDIFileMetaTypeTempo);
+	while (MIKMIDIFileTrackReaderNextEvent(&reader, &event) == MIKMIDIFileResultOK) {
+		XCTAssertNotEqual(event.kind, MIKMIDIFileEventKindChannel, @"The conductor track should only hold the tempo track's events");
+	}
+
+	MIKMIDIFileTrackReaderInit(&reader, chunks[1]);
+	XCTAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	XCTAssertEqual(event.status, 0x90);
+	XCTAssertEqual(event.data1, 60);
+}
+
+- (void)testWritingRoundTrips
+{
+	for (NSString *name in @[@"bach", @"Parallax-Loader"]) {
+		MIKMIDISequence *original = [MIKMIDISequence sequenceWithData:[self dataForResource:name] error:NULL];
+		NSData *written = original.dataValue;
+		XCTAssertNotNil(written);
+
+		MIKMIDISequence *reread = [MIKMIDISequence sequenceWithData:written error:NULL];
+		XCTAssertNotNil(reread);
+		XCTAssertEqual(reread.tempoTrack.timeResolution, original.tempoTrack.timeResolution);
+		XCTAssertEqualObjects(reread.tempoTrack.events, original.tempoTrack.events);
+
+		// The tempo track was written as a conductor track, which reads back into the tempo track
+		XCTAssertEqual(reread.tracks.count, original.tracks.count, @"Track count mismatch for %@", name);
+		for (NSUInteger i = 0; i < MIN(reread.tracks.count, original.tracks.count); i++) {
+			XCTAssertEqualObjects([reread.tracks[i] events], [original.tracks[i] events], @"Events differ in track %lu of %@", (unsigned long)i, name);
+		}
+
+		XCTAssertEqualObjects(reread.dataValue, written, @"Rewriting %@ changed its bytes", name);
+
+		MIKMIDISequence *lazilyReread = [[MIKMIDISequence alloc] initWithData:written options:MIKMIDISequenceLoadingOptionLazy error:NULL];
+		XCTAssertEqual(lazilyReread.tracks.count, original.tracks.count, @"Lazy track count mismatch for %@", name);
+		XCTAssertEqualObjects(lazilyReread.tempoTrack.events, original.tempoTrack.events);
+	}
+}
+
+- (void)testWritingNotesWithoutVelocity
+{
+	MIKMIDISequence *sequence = [MIKMIDISequence sequence];
+	MIKMIDITrack *track = [sequence addTrackWithError:NULL];
+	MIKMIDINoteEvent *loudNote = [MIKMIDINoteEvent noteEventWithTimeStamp:0 note:60 velocity:100 duration:1 channel:0];
+	MIKMIDINoteEvent *quietNote = [MIKMIDINoteEvent noteEventWithTimeStamp:2 note:64 velocity:1 duration:1 channel:0];
+	[track addEvents:@[loudNote, [MIKMIDINoteEvent noteEventWithTimeStamp:1 note:62 velocity:0 duration:1 channel:0], quietNote]];
+	NSData *data = sequence.dataValue;
+
+	// The note without velocity is written as a note off, never as a note on with a velocity of 0
+	MIKMIDIFileHeader header;
+	XCTAssertEqual(MIKMIDIFileParseHeader(data.bytes, data.length, &header, NULL), MIKMIDIFileResultOK);
+	MIKMIDIFileTrackChunk chunks[2];
+	size_t count = 0;
+	XCTAssertEqual(MIKMIDIFileIndexTrackChunks(data.bytes, data.length, &header, chunks, 2, &count), MIKMIDIFileResultOK);
+	XCTAssertEqual(count, 2);
+	MIKMIDIFileTrackReader reader;
+	MIKMIDIFileEvent event;
+	MIKMIDIFileTrackReaderInit(&reader, chunks[1]);
+	NSUInteger numberOfNoteOffsForSilentNote = 0;
+	while (MIKMIDIFileTrackReaderNextEvent(&reader, &event) == MIKMIDIFileResultOK) {
+		if (event.kind != MIKMIDIFileEventKindChannel || event.data1 != 62) continue;
+		XCTAssertEqual(event.status, 0x80);
+		numberOfNoteOffsForSilentNote++;
+	}
+	XCTAssertEqual(numberOfNoteOffsForSilentNote, 1);
+
+	// So reading the file back gives only the notes that can be heard, with their velocities
+	MIKMIDISequence *reread = [MIKMIDISequence sequenceWithData:data error:NULL];
+	XCTAssertEqual(reread.tracks.count, 1);
+	NSArray *expectedNotes = @[loudNote, quietNote];
+	XCTAssertEqualObjects([reread.tracks.firstObject notes], expectedNotes);
+}
+
+- (void)testWritingToStreamsAndFiles
+{
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithData:[self dataForResource:@"Parallax-Loader"] error:NULL];
+	NSData *expected = sequence.dataValue;
+
+	NSOutputStream *stream = [NSOutputStream outputStreamToMemory];
+	NSError *error = nil;
+	XCTAssertTrue([sequence writeToOutputStream:stream error:&error], @"%@", error);
+	XCTAssertEqualObjects([stream propertyForKey:NSStreamDataWrittenToMemoryStreamKey], expected);
+	[stream close];
+
+	NSString *fileName = [NSString stringWithFormat:@"%@.mid", [[NSProcessInfo processInfo] globallyUniqueString]];
+	NSURL *fileURL = [NSURL fileURLWithPath:[NSTemporaryDirectory() stringByAppendingPathComponent:fileName]];
+	XCTAssertTrue([sequence writeToURL:fileURL error:&error], @"%@", error);
+	XCTAssertEqualObjects([NSData dataWithContentsOfURL:fileURL], expected);
+	[[NSFileManager defaultManager] removeItemAtURL:fileURL error:NULL];
+}
+
+#pragma mark - Performance
+
+- (void)measureDecodingWithMaximumConcurrentTracks:(NSUInteger)maximumConcurrentTracks
+{
+	NSData *data = [self dataForFileWithNumberOfTracks:64];
+	MIKMIDIFileDecoder *decoder = [[MIKMIDIFileDecoder alloc] initWithData:data error:NULL];
+	[self measureBlock:^{
+		for (NSInteger i=0; i<5; i++) {
+			[decoder eventsForAllTracksWithTempoTrackEvents:[NSMutableArray array] maximumConcurrentTracks:maximumConcurrentTracks error:NULL];
+		}
+	}];
+}
+
+- (void)testDecodingPerformanceWith1Worker { [self measureDecodingWithMaximumConcurrentTracks:1]; }
+- (void)testDecodingPerformanceWith2Workers { [self measureDecodingWithMaximumConcurrentTracks:2]; }
+- (void)testDecodingPerformanceWith4Workers { [self measureDecodingWithMaximumConcurrentTracks:4]; }
+- (void)testDecodingPerformanceWith8Workers { [self measureDecodingWithMaximumConcurrentTracks:8]; }
+
+- (void)testNativeLoadingPerformance
+{
+	NSData *bach = [self dataForResource:@"bach"];
+	NSData *parallax = [self dataForResource:@"Parallax-Loader"];
+	[self measureBlock:^{
+		for (NSInteger i=0; i<10; i++) {
+			[MIKMIDISequence sequenceWithData:bach error:NULL];
+			[MIKMIDISequence sequenceWithData:parallax error:NULL];
+		}
+	}];
+}
+
+- (void)testLazyOpeningPerformance
+{
+	NSURL *bach = [self URLForResource:@"bach"];
+	NSURL *parallax = [self URLForResource:@"Parallax-Loader"];
+	[self measureBlock:^{
+		for (NSInteger i=0; i<10; i++) {
+			[[MIKMIDISequence sequenceWithFileAtURL:bach options:MIKMIDISequenceLoadingOptionLazy error:NULL] durationInSeconds];
+			[[MIKMIDISequence sequenceWithFileAtURL:parallax options:MIKMIDISequenceLoadingOptionLazy error:NULL] durationInSeconds];
+		}
+	}];
+}
+
+- (void)testEagerOpeningPerformance
+{
+	NSURL *bach = [self URLForResource:@"bach"];
+	NSURL *parallax = [self URLForResource:@"Parallax-Loader"];
+	[self measureBlock:^{
+		for (NSInteger i=0; i<10; i++) {
+			[[MIKMIDISequence sequenceWithFileAtURL:bach error:NULL] durationInSeconds];
+			[[MIKMIDISequence sequenceWithFileAtURL:parallax error:NULL] durationInSeconds];
+		}
+	}];
+}
+
+- (void)testWritingPerformance
+{
+	MIKMIDISequence *sequence = [MIKMIDISequence sequenceWithData:[self dataForFileWithNumberOfTracks:64] error:NULL];
+	[self measureBlock:^{
+		for (NSInteger i=0; i<5; i++) {
+			[sequence writeToOutputStream:[NSOutputStream outputStreamToMemory] error:NULL];
+		}
+	}];
+}
+
+- (void)testAudioToolboxLoadingPerformance
+{
+	NSData *bach = [self dataForResource:@"bach"];
+	NSData *parallax = [self dataForResource:@"Parallax-Loader"];
+	[self measureBlock:^{
+		for (NSInteger i=0; i<10; i++) {
+			[self audioToolboxSequenceWithData:bach];
+			[self audioToolboxSequenceWithData:parallax];
+		}
+	}];
+}
+
+@end
@@ -10,6 +10,7 @@
 #import <MIKMIDI/MIKMIDI.h>
 
 @interface MIKMIDIDeviceManager (Private)
+@property (nonatomic) MIDIClientRef client;
 @property (nonatomic, strong) MIKMIDIInputPort *inputPort;
 @end
 
@@ -17,6 +18,11 @@
 - (void)interpretPacketList:(const MIDIPacketList *)pktList handleResultingCommands:(void (^_Nonnull)(NSArray <MIKMIDICommand*> *receivedCommands))completionBlock;
 - (NSString *)createNewConnectionToken;
 - (void)addConnectionToken:(NSString *)connectionToken andEventHandler:(MIKMIDIEventHandlerBlock)eventHandler forSource:(MIKMIDISourceEndpoint *)source;
+- (void)addConnectionToken:(NSString *)connectionToken deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode andEventHandler:(MIKMIDIEventHandlerBlock)eventHandler forSource:(MIKMIDISourceEndpoint *)source;
+- (void)addConnectionToken:(NSString *)connectionToken deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode filter:(MIKMIDIInputFilter *)filter andEventHandler:(MIKMIDIEventHandlerBlock)eventHandler forSource:(MIKMIDISourceEndpoint *)source;
+- (void)sendCommands:(NSArray *)commands toEventHandlersFromSource:(MIKMIDISourceEndpoint *)source;
+- (id)sourceStateForSource:(MIKMIDISourceEndpoint *)source;
+- (void)interpretPacketList:(const MIDIPacketList *)pktList sourceState:(id)state;
 - (MIKMIDISourceEndpoint *)sourceEndpointForConnectionToken:(NSString *)token;
 @end
 
@@ -67,4 +73,488 @@
     XCTAssertNil([port sourceEndpointForConnectionToken:connectionToken]);
 }
 
+- (void)testBatchedMainQueueDelivery
+{
+	MIKMIDIInputPort *port = [[MIKMIDIDeviceManager sharedDeviceManager] inputPort];
+	MIKMIDISourceEndpoint *source = [[MIKMockSourceEndpoint alloc] init];
+	NSString *connectionToken = [port createNewConnectionToken];
+	XCTestExpectation *expectation = [self expectationWithDescription:@"Commands delivered"];
+	__block NSUInteger numberOfCalls = 0;
+	__block NSArray *receivedCommands = nil;
+	[port addConnectionToken:connectionToken deliveryMode:MIKMIDIEventDeliveryModeBatchedMainQueue andEventHandler:^(MIKMIDISourceEndpoint *s, NSArray *commands) {
+		XCTAssertTrue([NSThread isMainThread]);
+		numberOfCalls++;
+		receivedCommands = commands;
+		[expectation fulfill];
+	} forSource:source];
+	XCTAssertEqual([port sourceEndpointForConnectionToken:connectionToken], source); // Waits for the handler to be added
+	
+	// The main queue can't run until this test returns to the run loop, so all three arrays should be delivered at once
+	NSMutableArray *sentCommands = [NSMutableArray array];
+	for (UInt8 note = 60; note < 63; note++) {
+		MIKMIDICommand *command = [MIKMIDINoteOnCommand noteOnCommandWithNote:note velocity:100 channel:0 timestamp:nil];
+		[port sendCommands:@[command] toEventHandlersFromSource:source];
+		[sentCommands addObject:command];
+	}
+	[self waitForExpectationsWithTimeout:1 handler:nil];
+	XCTAssertEqual(numberOfCalls, 1);
+	XCTAssertEqualObjects(receivedCommands, sentCommands);
+	[port disconnectConnectionForToken:connectionToken];
+}
+
+- (void)testHighPriorityQueueDeliveryDoesNotUseMainThread
+{
+	MIKMIDIInputPort *port = [[MIKMIDIDeviceManager sharedDeviceManager] inputPort];
+	MIKMIDISourceEndpoint *source = [[MIKMockSourceEndpoint alloc] init];
+	NSString *connectionToken = [port createNewConnectionToken];
+	XCTestExpectation *expectation = [self expectationWithDescription:@"Commands delivered"];
+	[port addConnectionToken:connectionToken deliveryMode:MIKMIDIEventDeliveryModeHighPriorityQueue andEventHandler:^(MIKMIDISourceEndpoint *s, NSArray *commands) {
+		XCTAssertFalse([NSThread isMainThread]);
+		XCTAssertEqual(commands.count, 1);
+		[expectation fulfill];
+	} forSource:source];
+	XCTAssertEqual([port sourceEndpointForConnectionToken:connectionToken], source);
+	
+	[port sendCommands:@[[MIKMIDINoteOnCommand noteOnCommandWithNote:60 velocity:100 channel:0 timestamp:nil]] toEventHandlersFromSource:source];
+	[self waitForExpectationsWithTimeout:1 handler:nil];
+	[port disconnectConnectionForToken:connectionToken];
+}
+
+- (void)testCoalescing14BitControlChangesFromInterleavedSources
+{
+	MIKMIDIInputPort *port = [[MIKMIDIInputPort alloc] initWithClient:[MIKMIDIDeviceManager sharedDeviceManager].client name:@"MIKMIDIInputPortTests"];
+	MIKMIDISimulatedTimeSource *timeSource = [[MIKMIDISimulatedTimeSource alloc] init];
+	port.timeSource = timeSource;
+	port.fourteenBitControlChangeCoalescingWindow = 0.01;
+	
+	NSArray *sources = @[[[MIKMockSourceEndpoint alloc] initWithObjectRef:1], [[MIKMockSourceEndpoint alloc] initWithObjectRef:2]];
+	NSArray *receivedCommands = @[[NSMutableArray array], [NSMutableArray array]];
+	for (NSUInteger i = 0; i < 2; i++) {
+		NSString *connectionToken = [port createNewConnectionToken];
+		[port addConnectionToken:connectionToken deliveryMode:MIKMIDIEventDeliveryModeReadThread andEventHandler:^(MIKMIDISourceEndpoint *s, NSArray *commands) {
+			[receivedCommands[i] addObjectsFromArray:commands];
+		} forSource:sources[i]];
+		XCTAssertEqual([port sourceEndpointForConnectionToken:connectionToken], sources[i]); // Waits for the handler to be added
+	}
+	void (^receive)(NSUInteger, NSArray *) = ^(NSUInteger sourceIndex, NSArray *bytes) {
+		MIDIPacketList list = {0};
+		list.numPackets = 1;
+		list.packet[0].length = bytes.count;
+		for (NSUInteger i = 0; i < bytes.count; i++) list.packet[0].data[i] = [bytes[i] unsignedCharValue];
+		[port interpretPacketList:&list sourceState:[port sourceStateForSource:sources[sourceIndex]]];
+	};
+	
+	receive(0, @[@0xB0, @0x01, @0x40]); // MSB for controller 1 from the first source
+	receive(1, @[@0xB0, @0x21, @0x10]); // An LSB for controller 1 from the second source, which mustn't pair with it
+	receive(1, @[@0xB0, @0x01, @0x22]); // An MSB from the second source that never gets an LSB
+	receive(0, @[@0xB1, @0x21, @0x07, @0x91, @0x3C, @0x40, @0xB0, @0x21, @0x05]); // An LSB and a note on another channel come between the first source's MSB and LSB
+	
+	NSArray *firstSourceCommands = receivedCommands[0];
+	XCTAssertEqual(firstSourceCommands.count, 3);
+	MIKMIDIControlChangeCommand *otherChannelLSB = firstSourceCommands[0];
+	XCTAssertFalse(otherChannelLSB.isFourteenBitCommand);
+	XCTAssertEqual(otherChannelLSB.channel, 1);
+	XCTAssertEqualObjects([firstSourceCommands[1] class], [MIKMIDINoteOnCommand class]);
+	MIKMIDIControlChangeCommand *fourteenBitCommand = firstSourceCommands[2];
+	XCTAssertTrue(fourteenBitCommand.isFourteenBitCommand);
+	XCTAssertEqual(fourteenBitCommand.controllerNumber, 1);
+	XCTAssertEqual(fourteenBitCommand.fourteenBitValue, (0x40 << 7) | 0x05);
+	
+	// A note on the MSB's own channel sends the MSB on its own, ahead of the note, instead of pairing it with the later LSB
+	receive(0, @[@0xB0, @0x01, @0x41]);
+	receive(0, @[@0x90, @0x3C, @0x40, @0xB0, @0x21, @0x06]);
+	XCTAssertEqual(firstSourceCommands.count, 6);
+	MIKMIDIControlChangeCommand *sevenBitMSB = firstSourceCommands[3];
+	XCTAssertFalse(sevenBitMSB.isFourteenBitCommand);
+	XCTAssertEqual(sevenBitMSB.controllerNumber, 1);
+	XCTAssertEqual(sevenBitMSB.controllerValue, 0x41);
+	XCTAssertEqualObjects([firstSourceCommands[4] class], [MIKMIDINoteOnCommand class]);
+	MIKMIDIControlChangeCommand *unpairedLSB = firstSourceCommands[5];
+	XCTAssertFalse(unpairedLSB.isFourteenBitCommand);
+	XCTAssertEqual(unpairedLSB.controllerNumber, 0x21);
+	
+	NSArray *secondSourceCommands = receivedCommands[1];
+	XCTAssertEqual(secondSourceCommands.count, 1);
+	XCTAssertFalse([secondSourceCommands[0] isFourteenBitCommand]);
+	XCTAssertEqual([secondSourceCommands[0] controllerNumber], 0x21);
+	
+	// The second source's MSB is delivered on its own once the window has passed
+	[timeSource advanceByTimeInterval:0.005];
+	XCTAssertEqual(secondSourceCommands.count, 1);
+	[timeSource advanceByTimeInterval:0.01];
+	XCTAssertEqual(secondSourceCommands.count, 2);
+	XCTAssertEqual([secondSourceCommands[1] controllerNumber], 1);
+	XCTAssertEqual([secondSourceCommands[1] controllerValue], 0x22);
+	XCTAssertEqual(firstSourceCommands.count, 6);
+	XCTAssertEqual(timeSource.numberOfPendingBlocks, 0, @"Only one expiry block should have been scheduled.");
+}
+
+- (void)testShorteningTheCoalescingWindowDoesNotDelayMSBs
+{
+	MIKMIDIInputPort *port = [[MIKMIDIInputPort alloc] initWithClient:[MIKMIDIDeviceManager sharedDeviceManager].client name:@"MIKMIDIInputPortTests"];
+	MIKMIDISimulatedTimeSource *timeSource = [[MIKMIDISimulatedTimeSource alloc] init];
+	port.timeSource = timeSource;
+	port.fourteenBitControlChangeCoalescingWindow = 1.0;
+
+	MIKMIDISourceEndpoint *source = [[MIKMockSourceEndpoint alloc] init];
+	NSMutableArray *receivedCommands = [NSMutableArray array];
+	NSString *connectionToken = [port createNewConnectionToken];
+	[port addConnectionToken:connectionToken deliveryMode:MIKMIDIEventDeliveryModeReadThread andEventHandler:^(MIKMIDISourceEndpoint *s, NSArray *commands) {
+		[receivedCommands addObjectsFromArray:commands];
+	} forSource:source];
+	XCTAssertEqual([port sourceEndpointForConnectionToken:connectionToken], source); // Waits for the handler to be added
+	void (^receive)(UInt8, UInt8, UInt8) = ^(UInt8 status, UInt8 controller, UInt8 value) {
+		MIDIPacketList list = {0};
+		list.numPackets = 1;
+		list.packet[0].length = 3;
+		memcpy(list.packet[0].data, (UInt8[]){status, controller, value}, 3);
+		[port interpretPacketList:&list sourceState:[port sourceStateForSource:source]];
+	};
+
+	// On separate channels, so the second MSB doesn't send the first
+	receive(0xB0, 1, 0x10);
+	port.fourteenBitControlChangeCoalescingWindow = 0.01;
+	receive(0xB1, 2, 0x20);
+	[timeSource advanceByTimeInterval:0.02];
+	XCTAssertEqual(receivedCommands.count, 1, @"The second MSB should be sent once its shorter window has passed.");
+	XCTAssertEqual([receivedCommands.firstObject controllerNumber], 2);
+	[timeSource advanceByTimeInterval:1.0];
+	XCTAssertEqual(receivedCommands.count, 2);
+	XCTAssertEqual(timeSource.numberOfPendingBlocks, 0);
+}
+
+- (void)testCoalescingSysexFromInterleavedSources
+{
+	MIKMIDIInputPort *port = [[MIKMIDIInputPort alloc] initWithClient:[MIKMIDIDeviceManager sharedDeviceManager].client name:@"MIKMIDIInputPortTests"];
+	port.timeSource = [[MIKMIDISimulatedTimeSource alloc] init];
+	NSArray *sources = @[[[MIKMockSourceEndpoint alloc] initWithObjectRef:1], [[MIKMockSourceEndpoint alloc] initWithObjectRef:2]];
+	NSArray *receivedCommands = @[[NSMutableArray array], [NSMutableArray array]];
+	for (NSUInteger i = 0; i < 2; i++) {
+		NSString *connectionToken = [port createNewConnectionToken];
+		[port addConnectionToken:connectionToken deliveryMode:MIKMIDIEventDeliveryModeReadThread andEventHandler:^(MIKMIDISourceEndpoint *s, NSArray *commands) {
+			[receivedCommands[i] addObjectsFromArray:commands];
+		} forSource:sources[i]];
+		XCTAssertEqual([port sourceEndpointForConnectionToken:connectionToken], sources[i]); // Waits for the handler to be added
+	}
+	void (^receive)(NSUInteger, NSArray *) = ^(NSUInteger sourceIndex, NSArray *bytes) {
+		MIDIPacketList list = {0};
+		list.numPackets = 1;
+		list.packet[0].length = bytes.count;
+		for (NSUInteger i = 0; i < bytes.count; i++) list.packet[0].data[i] = [bytes[i] unsignedCharValue];
+		[port interpretPacketList:&list sourceState:[port sourceStateForSource:sources[sourceIndex]]];
+	};
+	
+	receive(0, @[@0xF0, @0x7D, @0x01]);
+	receive(1, @[@0xF0, @0x7D, @0x02, @0x03, @0xF7]);
+	receive(0, @[@0x04, @0xF7]);
+	
+	UInt8 firstSourceSysex[] = {0xF0, 0x7D, 0x01, 0x04, 0xF7};
+	UInt8 secondSourceSysex[] = {0xF0, 0x7D, 0x02, 0x03, 0xF7};
+	NSArray <MIKMIDICommand *> *firstSourceCommands = receivedCommands[0];
+	NSArray <MIKMIDICommand *> *secondSourceCommands = receivedCommands[1];
+	XCTAssertEqual(firstSourceCommands.count, 1);
+	XCTAssertEqualObjects(firstSourceCommands.firstObject.data, [NSData dataWithBytes:firstSourceSysex length:sizeof(firstSourceSysex)]);
+	XCTAssertEqual(secondSourceCommands.count, 1);
+	XCTAssertEqualObjects(secondSourceCommands.firstObject.data, [NSData dataWithBytes:secondSourceSysex length:sizeof(secondSourceSysex)]);
+}
+
+- (void)testAssemblingParameterNumberCommands
+{
+	MIKMIDIInputPort *port = [[MIKMIDIInputPort alloc] initWithClient:[MIKMIDIDeviceManager sharedDeviceManager].client name:@"MIKMIDIInputPortTests"];
+	port.timeSource = [[MIKMIDISimulatedTimeSource alloc] init];
+	port.coalescesParameterNumberCommands = YES;
+	
+	NSMutableArray *receivedCommands = [NSMutableArray array];
+	void (^receive)(NSData *) = ^(NSData *bytes) {
+		MIDIPacketList list = {0};
+		list.numPackets = 1;
+		list.packet[0].length = bytes.length;
+		memcpy(list.packet[0].data, bytes.bytes, bytes.length);
+		[port interpretPacketList:&list handleResultingCommands:^(NSArray *commands) {
+			[receivedCommands addObjectsFromArray:commands];
+		}];
+	};
+	
+	// NRPN 130 on channel 0, with a 14-bit value
+	NSData *nrpnBytes = [NSData dataWithBytes:(UInt8[]){0xB0, 0x63, 0x01, 0xB0, 0x62, 0x02, 0xB0, 0x06, 0x40, 0xB0, 0x26, 0x10} length:12];
+	receive(nrpnBytes);
+	XCTAssertEqual(receivedCommands.count, 1);
+	MIKMIDIParameterChangeCommand *nrpn = receivedCommands.lastObject;
+	XCTAssertTrue([nrpn isKindOfClass:[MIKMIDIParameterChangeCommand class]]);
+	XCTAssertEqual(nrpn.parameterType, MIKMIDIParameterTypeNonRegistered);
+	XCTAssertEqual(nrpn.parameterNumber, 130);
+	XCTAssertEqual(nrpn.value, (0x40 << 7) | 0x10);
+	XCTAssertTrue(nrpn.hasFineValue);
+	XCTAssertEqualObjects(nrpn.data, nrpnBytes, @"A parameter change's data should be the control changes it was made from.");
+	
+	// An RPN increment on channel 1 doesn't change channel 0's selection
+	receive([NSData dataWithBytes:(UInt8[]){0xB1, 0x65, 0x00, 0xB1, 0x64, 0x00, 0xB1, 0x60, 0x00} length:9]);
+	XCTAssertEqual(receivedCommands.count, 2);
+	MIKMIDIParameterChangeCommand *increment = receivedCommands.lastObject;
+	XCTAssertEqual(increment.channel, 1);
+	XCTAssertEqual(increment.parameterType, MIKMIDIParameterTypeRegistered);
+	XCTAssertEqual(increment.parameterNumber, 0);
+	XCTAssertEqual(increment.dataIncrement, 1);
+	
+	receive([NSData dataWithBytes:(UInt8[]){0xB0, 0x26, 0x20} length:3]); // A data entry LSB on its own keeps the last MSB
+	XCTAssertEqual(receivedCommands.count, 3);
+	MIKMIDIParameterChangeCommand *fineOnly = receivedCommands.lastObject;
+	XCTAssertEqual(fineOnly.parameterNumber, 130);
+	XCTAssertEqual(fineOnly.value, (0x40 << 7) | 0x20);
+	
+	// A 7-bit data entry is complete once the next parameter is selected
+	receive([NSData dataWithBytes:(UInt8[]){0xB0, 0x63, 0x00, 0xB0, 0x62, 0x05, 0xB0, 0x06, 0x11, 0xB0, 0x63, 0x00, 0xB0, 0x62, 0x06, 0xB0, 0x06, 0x22, 0xB0, 0x26, 0x01} length:21]);
+	XCTAssertEqual(receivedCommands.count, 5);
+	MIKMIDIParameterChangeCommand *coarse = receivedCommands[3];
+	XCTAssertEqual(coarse.parameterNumber, 5);
+	XCTAssertEqual(coarse.value, 0x11 << 7);
+	XCTAssertFalse(coarse.hasFineValue);
+	MIKMIDIParameterChangeCommand *fine = receivedCommands[4];
+	XCTAssertEqual(fine.parameterNumber, 6);
+	XCTAssertEqual(fine.value, (0x22 << 7) | 0x01);
+	
+	// After the RPN null function, a decrement is just a control change
+	receive([NSData dataWithBytes:(UInt8[]){0xB1, 0x65, 0x7F, 0xB1, 0x64, 0x7F, 0xB1, 0x61, 0x00} length:9]);
+	XCTAssertEqual(receivedCommands.count, 6);
+	XCTAssertFalse([receivedCommands.lastObject isKindOfClass:[MIKMIDIParameterChangeCommand class]]);
+	XCTAssertEqual([receivedCommands.lastObject controllerNumber], 0x61);
+}
+
+- (void)testParameterNumberCommandsAreNotAssembledByDefault
+{
+	MIKMIDIInputPort *port = [[MIKMIDIInputPort alloc] initWithClient:[MIKMIDIDeviceManager sharedDeviceManager].client name:@"MIKMIDIInputPortTests"];
+	XCTAssertFalse(port.coalescesParameterNumberCommands);
+	
+	MIDIPacketList list = {0};
+	list.numPackets = 1;
+	list.packet[0].length = 12;
+	memcpy(list.packet[0].data, (UInt8[]){0xB0, 0x63, 0x01, 0xB0, 0x62, 0x02, 0xB0, 0x06, 0x40, 0xB0, 0x26, 0x10}, 12);
+	__block NSArray *receivedCommands = nil;
+	[port interpretPacketList:&list handleResultingCommands:^(NSArray *commands) { receivedCommands = commands; }];
+	
+	XCTAssertEqual(receivedCommands.count, 3); // Parameter number MSB and LSB, and a 14-bit data entry
+	for (MIKMIDICommand *command in receivedCommands) {
+		XCTAssertEqualObjects([command class], [MIKMIDIControlChangeCommand class]);
+	}
+}
+
+- (void)testCreatingParameterChangeCommands
+{
+	MIKMutableMIDIParameterChangeCommand *command = [[MIKMutableMIDIParameterChangeCommand alloc] init];
+	command.parameterType = MIKMIDIParameterTypeRegistered;
+	command.parameterNumber = 2;
+	command.value = 0x2000;
+	command.channel = 3;
+	UInt8 expectedBytes[] = {0xB3, 0x65, 0x00, 0xB3, 0x64, 0x02, 0xB3, 0x06, 0x40, 0xB3, 0x26, 0x00};
+	XCTAssertEqualObjects(command.data, [NSData dataWithBytes:expectedBytes length:sizeof(expectedBytes)]);
+	
+	command.dataIncrement = -3;
+	XCTAssertEqual(command.dataIncrement, -3);
+	XCTAssertEqual(command.value, 0);
+	XCTAssertEqual(command.channel, 3);
+	XCTAssertEqual(command.data.length, 9);
+	
+	MIKMIDIParameterChangeCommand *copy = [command copy];
+	XCTAssertEqualObjects([copy class], [MIKMIDIParameterChangeCommand class]);
+	XCTAssertEqual(copy.parameterNumber, 2);
+	XCTAssertEqual(copy.dataIncrement, -3);
+}
+
+- (void)testFilteringConnections
+{
+	MIKMIDIInputPort *port = [[MIKMIDIInputPort alloc] initWithClient:[MIKMIDIDeviceManager sharedDeviceManager].client name:@"MIKMIDIInputPortTests"];
+	MIKMockSourceEndpoint *source = [[MIKMockSourceEndpoint alloc] initWithObjectRef:1];
+	
+	MIKMIDIInputFilter *filter = [MIKMIDIInputFilter filterWithMessageTypes:MIKMIDIMessageTypeMaskNoteOn | MIKMIDIMessageTypeMaskPitchWheelChange];
+	filter.channelMask = 1 << 0;
+	filter.noteRange = NSMakeRange(60, 13);
+	[filter setDecimationFactor:4 forMessageTypes:MIKMIDIMessageTypeMaskPitchWheelChange];
+	
+	__block NSUInteger numberOfFilteredHandlerCalls = 0;
+	NSMutableArray *filteredCommands = [NSMutableArray array];
+	NSMutableArray *allCommands = [NSMutableArray array];
+	NSString *filteredToken = [port createNewConnectionToken];
+	[port addConnectionToken:filteredToken deliveryMode:MIKMIDIEventDeliveryModeReadThread filter:filter andEventHandler:^(MIKMIDISourceEndpoint *s, NSArray *commands) {
+		numberOfFilteredHandlerCalls++;
+		[filteredCommands addObjectsFromArray:commands];
+	} forSource:source];
+	NSString *unfilteredToken = [port createNewConnectionToken];
+	[port addConnectionToken:unfilteredToken deliveryMode:MIKMIDIEventDeliveryModeReadThread andEventHandler:^(MIKMIDISourceEndpoint *s, NSArray *commands) {
+		[allCommands addObjectsFromArray:commands];
+	} forSource:source];
+	XCTAssertEqual([port sourceEndpointForConnectionToken:unfilteredToken], source); // Waits for the handlers to be added
+	
+	void (^receive)(NSArray *) = ^(NSArray *bytes) {
+		MIDIPacketList list = {0};
+		list.numPackets = 1;
+		list.packet[0].length = bytes.count;
+		for (NSUInteger i = 0; i < bytes.count; i++) list.packet[0].data[i] = [bytes[i] unsignedCharValue];
+		[port interpretPacketList:&list sourceState:[port sourceStateForSource:source]];
+	};
+	
+	receive(@[@0xF8, @0xFE]); // Clock and active sensing only. The filtered handler shouldn't be called.
+	XCTAssertEqual(numberOfFilteredHandlerCalls, 0);
+	XCTAssertEqual(allCommands.count, 2);
+	
+	receive(@[@0x90, @0x3C, @0x40, // Passes
+			  @0x91, @0x3C, @0x40, // Wrong channel
+			  @0x90, @0x30, @0x40, // Note out of range
+			  @0x80, @0x3C, @0x00, // Note off
+			  @0xF0, @0x7D, @0x01, @0xF7,
+			  @0xE0, @0x00, @0x40, @0xE0, @0x01, @0x40, @0xE0, @0x02, @0x40, @0xE0, @0x03, @0x40, @0xE0, @0x04, @0x40]);
+	XCTAssertEqual(numberOfFilteredHandlerCalls, 1);
+	XCTAssertEqual(filteredCommands.count, 3, @"Only the note on and every fourth pitch bend should have gotten through.");
+	XCTAssertEqualObjects([filteredCommands[0] class], [MIKMIDINoteOnCommand class]);
+	XCTAssertEqual([filteredCommands[1] pitchChange], 0x2000);
+	XCTAssertEqual([filteredCommands[2] pitchChange], 0x2004);
+	XCTAssertEqual(allCommands.count, 2 + 10, @"Filters should only affect their own connection.");
+	XCTAssertEqualObjects([allCommands.lastObject class], [MIKMIDIPitchBendChangeCommand class]);
+	
+	filter.messageTypes = MIKMIDIMessageTypeMaskAll;
+	receive(@[@0x91, @0x3C, @0x40]);
+	XCTAssertEqual(filteredCommands.count, 3, @"Changing a filter shouldn't affect connections that were already made with it.");
+	
+	[port disconnectConnectionForToken:filteredToken];
+	[port disconnectConnectionForToken:unfilteredToken];
+}
+
+- (void)testFilteringUndefinedMessages
+{
+	NSMutableArray *commands = [NSMutableArray array];
+	for (NSNumber *status in @[@0xF4, @0xF5, @0xF9, @0xFD, @0xF8]) {
+		MIDIPacket packet = {0};
+		packet.length = 1;
+		packet.data[0] = [status unsignedCharValue];
+		[commands addObject:[MIKMIDICommand commandWithMIDIPacket:&packet]];
+	}
+
+	MIKMIDIInputFilter *filter = [MIKMIDIInputFilter filterWithMessageTypes:MIKMIDIMessageTypeMaskSystemCommon | MIKMIDIMessageTypeMaskSystemRealTime];
+	NSArray *filteredCommands = [filter filteredCommands:commands];
+	XCTAssertEqual(filteredCommands.count, 1, @"Undefined messages aren't system common or real time messages.");
+	XCTAssertEqual([filteredCommands.firstObject statusByte], 0xF8);
+
+	filter.messageTypes = MIKMIDIMessageTypeMaskUndefined;
+	XCTAssertEqual([filter filteredCommands:commands].count, 4);
+	XCTAssertEqual([[MIKMIDIInputFilter new] filteredCommands:commands].count, 5, @"The default filter should let everything through.");
+}
+
+// Simulates a device sending MIDI clock, with a note every beat, to a main queue handler that only
+// wants notes, with and without a filter. Logs how many packet lists per second are handled.
+- (void)measureReceivingClockWithFilter:(MIKMIDIInputFilter *)filter description:(NSString *)description
+{
+	MIKMIDIInputPort *port = [[MIKMIDIInputPort alloc] initWithClient:[MIKMIDIDeviceManager sharedDeviceManager].client name:@"MIKMIDIInputPortTests"];
+	MIKMockSourceEndpoint *source = [[MIKMockSourceEndpoint alloc] initWithObjectRef:1];
+	NSUInteger numberOfPacketLists = 50000;
+	__block NSUInteger numberOfNotes = 0;
+	NSString *connectionToken = [port createNewConnectionToken];
+	[port addConnectionToken:connectionToken deliveryMode:MIKMIDIEventDeliveryModeMainQueue filter:filter andEventHandler:^(MIKMIDISourceEndpoint *s, NSArray *commands) {
+		for (MIKMIDICommand *command in commands) {
+			if (command.commandType == MIKMIDICommandTypeNoteOn) numberOfNotes++;
+		}
+	} forSource:source];
+	XCTAssertEqual([port sourceEndpointForConnectionToken:connectionToken], source); // Waits for the handler to be added
+	id state = [port sourceStateForSource:source];
+	
+	MIDIPacketList clockList = {0};
+	clockList.numPackets = 1;
+	clockList.packet[0].length = 1;
+	clockList.packet[0].data[0] = 0xF8;
+	MIDIPacketList noteList = clockList;
+	noteList.packet[0].length = 3;
+	memcpy(noteList.packet[0].data, (UInt8[]){0x90, 0x3C, 0x40}, 3);
+	
+	[self measureBlock:^{
+		numberOfNotes = 0;
+		NSDate *start = [NSDate date];
+		for (NSUInteger i = 0; i < numberOfPacketLists; i++) {
+			[port interpretPacketList:(i % 24) ? &clockList : &noteList sourceState:state];
+		}
+		// Handlers are called in order, so once this block runs, they've all been called
+		XCTestExpectation *expectation = [self expectationWithDescription:@"Main queue drained"];
+		dispatch_async(dispatch_get_main_queue(), ^{ [expectation fulfill]; });
+		[self waitForExpectationsWithTimeout:30 handler:nil];
+		NSTimeInterval duration = -[start timeIntervalSinceNow];
+		XCTAssertEqual(numberOfNotes, (numberOfPacketLists + 23) / 24);
+		NSLog(@"%@: %.0f packet lists per second", description, numberOfPacketLists / duration);
+	}];
+	[port disconnectConnectionForToken:connectionToken];
+}
+
+- (void)testReceivingClockWithoutFilterPerformance
+{
+	[self measureReceivingClockWithFilter:nil description:@"Clock and notes, unfiltered"];
+}
+
+- (void)testReceivingClockWithFilterPerformance
+{
+	MIKMIDIInputFilter *filter = [MIKMIDIInputFilter filterWithMessageTypes:MIKMIDIMessageTypeMaskAll & ~MIKMIDIMessageTypeMaskSystemRealTime];
+	[self measureReceivingClockWithFilter:filter description:@"Clock and notes, real time messages filtered out"];
+}
+
+// Sends notes through a virtual source connected back to the input port, and logs a histogram of the
+// time from sending each one until its event handler is called, for each delivery mode.
+- (void)testRoundTripLatencyForDeliveryModes
+{
+	NSError *error = nil;
+	MIKMIDIClientSourceEndpoint *loopback = [[MIKMIDIClientSourceEndpoint alloc] initWithName:@"MIKMIDIInputPortTests Loopback" error:&error];
+	XCTAssertNotNil(loopback, @"Creating virtual source failed with error %@", error);
+	if (!loopback) return;
+	
+	MIKMIDIInputPort *port = [[MIKMIDIDeviceManager sharedDeviceManager] inputPort];
+	NSDictionary *modeNames = @{@(MIKMIDIEventDeliveryModeMainQueue) : @"Main queue",
+								@(MIKMIDIEventDeliveryModeBatchedMainQueue) : @"Batched main queue",
+								@(MIKMIDIEventDeliveryModeHighPriorityQueue) : @"High priority queue",
+								@(MIKMIDIEventDeliveryModeReadThread) : @"Read thread"};
+	double bucketLimits[] = {50, 100, 250, 500, 1000, 2000, 5000, INFINITY}; // microseconds
+	NSUInteger numberOfBuckets = sizeof(bucketLimits) / sizeof(bucketLimits[0]);
+	NSUInteger numberOfNotes = 500;
+	
+	for (NSNumber *mode in @[@(MIKMIDIEventDeliveryModeMainQueue), @(MIKMIDIEventDeliveryModeBatchedMainQueue),
+							 @(MIKMIDIEventDeliveryModeHighPriorityQueue), @(MIKMIDIEventDeliveryModeReadThread)]) {
+		__block MIDITimeStamp sentTimeStamp = 0;
+		__block XCTestExpectation *expectation = nil;
+		NSMutableArray *latencies = [NSMutableArray array];
+		id connectionToken = [port connectToSource:loopback deliveryMode:[mode integerValue] error:&error eventHandler:^(MIKMIDISourceEndpoint *source, NSArray *commands) {
+			MIDITimeStamp receivedTimeStamp = MIKMIDIGetCurrentTimeStamp();
+			@synchronized(latencies) {
+				[latencies addObject:@((receivedTimeStamp - sentTimeStamp) * MIKMIDIClockSecondsPerMIDITimeStamp() * 1000000.0)];
+			}
+			[expectation fulfill];
+		}];
+		XCTAssertNotNil(connectionToken, @"Connecting to virtual source failed with error %@", error);
+		XCTAssertEqual([port sourceEndpointForConnectionToken:connectionToken], loopback); // Waits for the handler to be added
+		
+		for (NSUInteger i = 0; i < numberOfNotes; i++) {
+			expectation = [self expectationWithDescription:@"Note received"];
+			MIKMIDICommand *note = [MIKMIDINoteOnCommand noteOnCommandWithNote:i % 128 velocity:100 channel:0 timestamp:nil];
+			sentTimeStamp = MIKMIDIGetCurrentTimeStamp();
+			XCTAssertTrue([loopback sendCommands:@[note] error:NULL]);
+			[self waitForExpectationsWithTimeout:1 handler:nil];
+		}
+		[port disconnectConnectionForToken:connectionToken];
+		
+		XCTAssertEqual(latencies.count, numberOfNotes);
+		if (latencies.count < numberOfNotes) continue;
+		
+		NSMutableArray *bucketCounts = [NSMutableArray array];
+		for (NSUInteger i = 0; i < numberOfBuckets; i++) [bucketCounts addObject:@0];
+		for (NSNumber *latency in latencies) {
+			NSUInteger bucket = 0;
+			while ([latency doubleValue] >= bucketLimits[bucket]) bucket++;
+			bucketCounts[bucket] = @([bucketCounts[bucket] unsignedIntegerValue] + 1);
+		}
+		NSArray *sortedLatencies = [latencies sortedArrayUsingSelector:@selector(compare:)];
+		NSMutableString *histogram = [NSMutableString string];
+		for (NSUInteger i = 0; i < numberOfBuckets; i++) {
+			if (isinf(bucketLimits[i])) {
+				[histogram appendFormat:@" >=%.0fus: %@", bucketLimits[i - 1], bucketCounts[i]];
+			} else {
+				[histogram appendFormat:@" <%.0fus: %@", bucketLimits[i], bucketCounts[i]];
+			}
+		}
+		NSLog(@"%@ round trip latency: median %.0fus, 99th percentile %.0fus;%@", modeNames[mode],
+			  [sortedLatencies[numberOfNotes / 2] doubleValue], [sortedLatencies[numberOfNotes * 99 / 100] doubleValue], histogram);
+	}
+}
+
 @end
@@ -0,0 +1,233 @@
+//
+//  MIKMIDIMessageParserTests.m
+//  MIKMIDI Tests
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright © 2026 Mixed In Key. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <MIKMIDI/MIKMIDI.h>
+#import <MIKMIDI/MIKMIDIMessageParser.h>
+
+@interface MIKMIDIDeviceManager (Private)
+@property (nonatomic) MIDIClientRef client;
+@end
+
+@interface MIKMIDIInputPort (Private)
+- (void)interpretPacketList:(const MIDIPacketList *)pktList handleResultingCommands:(void (^_Nonnull)(NSArray <MIKMIDICommand*> *receivedCommands))completionBlock;
+@end
+
+@interface MIKMIDIMessageParserTests : XCTestCase
+
+@property (nonatomic, strong) MIKMIDIInputPort *port;
+
+@end
+
+@implementation MIKMIDIMessageParserTests
+
+- (void)setUp
+{
+	[super setUp];
+	self.port = [[MIKMIDIInputPort alloc] initWithClient:[MIKMIDIDeviceManager sharedDeviceManager].client name:@"MIKMIDIMessageParserTests"];
+}
+
+#pragma mark - Helpers
+
+// Parses bytes in chunks of chunkLength, and returns the parsed messages, with fragment bytes copied into fragments
+- (NSArray *)messagesByParsingBytes:(const UInt8 *)bytes length:(size_t)length chunkLength:(size_t)chunkLength fragments:(NSMutableArray *)fragments
+{
+	MIKMIDIMessageParser parser;
+	MIKMIDIMessageParserInit(&parser);
+	NSMutableArray *result = [NSMutableArray array];
+	for (size_t offset = 0; offset < length; offset += chunkLength) {
+		const UInt8 *chunk = bytes + offset;
+		size_t chunkRemaining = MIN(chunkLength, length - offset);
+		while (chunkRemaining) {
+			MIKMIDIParsedMessage messages[MIKMIDIMessageParserMinimumCapacity];
+			size_t bytesConsumed = 0;
+			size_t count = MIKMIDIMessageParserParse(&parser, chunk, chunkRemaining, offset, messages, MIKMIDIMessageParserMinimumCapacity, &bytesConsumed);
+			for (size_t i = 0; i < count; i++) {
+				MIKMIDIParsedMessage message = messages[i];
+				if (message.kind == MIKMIDIParsedMessageKindSystemExclusiveFragment) {
+					[fragments addObject:[NSData dataWithBytes:message.bytes length:message.length]];
+					message.bytes = NULL;
+				}
+				[result addObject:[NSValue valueWithBytes:&message objCType:@encode(MIKMIDIParsedMessage)]];
+			}
+			chunk += bytesConsumed;
+			chunkRemaining -= bytesConsumed;
+		}
+	}
+	return result;
+}
+
+- (MIKMIDIParsedMessage)messageAtIndex:(NSUInteger)index inMessages:(NSArray *)messages
+{
+	MIKMIDIParsedMessage result;
+	[messages[index] getValue:&result];
+	return result;
+}
+
+// Splits stream into packet lists of one packet each, with packet lengths cycling through packetLengths
+- (NSArray <NSData *> *)packetListsWithStream:(NSData *)stream packetLengths:(NSArray <NSNumber *> *)packetLengths bytesPerSecond:(NSUInteger)bytesPerSecond
+{
+	NSMutableArray *result = [NSMutableArray array];
+	const UInt8 *bytes = stream.bytes;
+	MIDITimeStamp timeStamp = MIKMIDIGetCurrentTimeStamp();
+	NSUInteger offset = 0;
+	for (NSUInteger i = 0; offset < stream.length; i++) {
+		NSUInteger length = MIN([packetLengths[i % packetLengths.count] unsignedIntegerValue], stream.length - offset);
+		NSMutableData *listData = [NSMutableData dataWithLength:sizeof(MIDIPacketList) + length];
+		MIDIPacketList *list = listData.mutableBytes;
+		MIDIPacket *packet = MIDIPacketListInit(list);
+		MIDIPacketListAdd(list, listData.length, packet, timeStamp, length, bytes + offset);
+		[result addObject:listData];
+		offset += length;
+		timeStamp += MIKMIDIClockMIDITimeStampsPerTimeInterval((NSTimeInterval)length / bytesPerSecond);
+	}
+	return result;
+}
+
+// Feeds packetLists to the input port repeatedly, logging the number of messages parsed per second
+- (void)measureParsingPacketLists:(NSArray <NSData *> *)packetLists expectedNumberOfMessages:(NSUInteger)expectedNumberOfMessages description:(NSString *)description
+{
+	NSUInteger numberOfPasses = 200;
+	MIKMIDIInputPort *port = self.port;
+	[self measureBlock:^{
+		__block NSUInteger numberOfMessages = 0;
+		void (^handler)(NSArray *) = ^(NSArray *commands) { numberOfMessages += commands.count; };
+		NSDate *start = [NSDate date];
+		for (NSUInteger pass = 0; pass < numberOfPasses; pass++) {
+			for (NSData *packetList in packetLists) {
+				[port interpretPacketList:packetList.bytes handleResultingCommands:handler];
+			}
+		}
+		NSTimeInterval duration = -[start timeIntervalSinceNow];
+		XCTAssertEqual(numberOfMessages, expectedNumberOfMessages * numberOfPasses);
+		NSLog(@"%@: %.0f messages per second", description, numberOfMessages / duration);
+	}];
+}
+
+#pragma mark - Tests
+
+- (void)testRunningStatusAndRealTimeBytes
+{
+	// Note on, then running status note on with a clock byte in the middle, then a program change with running status
+	UInt8 bytes[] = {0x90, 0x3C, 0x40, 0x3E, 0xF8, 0x41, 0xC1, 0x05, 0x06};
+	NSArray *messages = [self messagesByParsingBytes:bytes length:sizeof(bytes) chunkLength:sizeof(bytes) fragments:nil];
+	XCTAssertEqual(messages.count, 5);
+
+	MIKMIDIParsedMessage message = [self messageAtIndex:0 inMessages:messages];
+	XCTAssertEqual(message.status, 0x90);
+	XCTAssertEqual(message.data1, 0x3C);
+	XCTAssertEqual(message.data2, 0x40);
+	XCTAssertEqual(message.length, 3);
+	XCTAssertEqual([self messageAtIndex:1 inMessages:messages].status, 0xF8, @"A real time byte should be reported as soon as it arrives.");
+	message = [self messageAtIndex:2 inMessages:messages];
+	XCTAssertEqual(message.status, 0x90);
+	XCTAssertEqual(message.data1, 0x3E);
+	XCTAssertEqual(message.data2, 0x41);
+	message = [self messageAtIndex:4 inMessages:messages];
+	XCTAssertEqual(message.status, 0xC1);
+	XCTAssertEqual(message.data1, 0x06);
+	XCTAssertEqual(message.length, 2);
+}
+
+- (void)testMessagesSplitAcrossBuffers
+{
+	UInt8 bytes[] = {0xB2, 0x4A, 0x10, 0x4A, 0x11, 0xF2, 0x01, 0x02};
+	for (size_t chunkLength = 1; chunkLength <= sizeof(bytes); chunkLength++) {
+		NSArray *messages = [self messagesByParsingBytes:bytes length:sizeof(bytes) chunkLength:chunkLength fragments:nil];
+		XCTAssertEqual(messages.count, 3);
+		MIKMIDIParsedMessage message = [self messageAtIndex:1 inMessages:messages];
+		XCTAssertEqual(message.status, 0xB2);
+		XCTAssertEqual(message.data2, 0x11);
+		XCTAssertEqual(message.timeStamp, 3 / chunkLength * chunkLength, @"Messages should have the time stamp of the buffer they started in.");
+		message = [self messageAtIndex:2 inMessages:messages];
+		XCTAssertEqual(message.status, 0xF2);
+		XCTAssertEqual(message.data1, 0x01);
+		XCTAssertEqual(message.data2, 0x02);
+	}
+}
+
+- (void)testSystemExclusiveFragments
+{
+	// A clock byte in the middle of a system exclusive message, which is then cut off by a note on
+	UInt8 bytes[] = {0xF0, 0x7E, 0x01, 0xF8, 0x02, 0x03, 0x90, 0x3C, 0x40};
+	NSMutableArray *fragments = [NSMutableArray array];
+	NSArray *messages = [self messagesByParsingBytes:bytes length:sizeof(bytes) chunkLength:sizeof(bytes) fragments:fragments];
+	XCTAssertEqual(messages.count, 4);
+
+	MIKMIDIParsedMessage message = [self messageAtIndex:0 inMessages:messages];
+	XCTAssertEqual(message.kind, MIKMIDIParsedMessageKindSystemExclusiveFragment);
+	XCTAssertEqual(message.flags, MIKMIDIParsedMessageFlagSystemExclusiveStart);
+	XCTAssertEqualObjects(fragments[0], [NSData dataWithBytes:(UInt8[]){0xF0, 0x7E, 0x01} length:3]);
+	XCTAssertEqual([self messageAtIndex:1 inMessages:messages].status, 0xF8);
+	message = [self messageAtIndex:2 inMessages:messages];
+	XCTAssertEqual(message.flags, MIKMIDIParsedMessageFlagSystemExclusiveEnd);
+	XCTAssertEqualObjects(fragments[1], [NSData dataWithBytes:(UInt8[]){0x02, 0x03} length:2]);
+	XCTAssertEqual([self messageAtIndex:3 inMessages:messages].status, 0x90);
+}
+
+- (void)testInputPortHandlesRunningStatusAndSplitPackets
+{
+	NSData *stream = [NSData dataWithBytes:(UInt8[]){0x90, 0x3C, 0x40, 0x3E, 0xF8, 0x40, 0xF0, 0x7E, 0x01, 0xF7, 0x80, 0x3C, 0x00} length:13];
+	NSMutableArray <MIKMIDICommand *> *commands = [NSMutableArray array];
+	for (NSData *packetList in [self packetListsWithStream:stream packetLengths:@[@1, @2] bytesPerSecond:3125]) {
+		[self.port interpretPacketList:packetList.bytes handleResultingCommands:^(NSArray<MIKMIDICommand *> *receivedCommands) {
+			[commands addObjectsFromArray:receivedCommands];
+		}];
+	}
+
+	XCTAssertEqual(commands.count, 5);
+	XCTAssertEqualObjects([commands[0] class], [MIKMIDINoteOnCommand class]);
+	XCTAssertEqual(commands[1].commandType, MIKMIDICommandTypeSystemTimingClock);
+	XCTAssertEqual([(MIKMIDINoteOnCommand *)commands[2] note], 0x3E);
+	XCTAssertEqualObjects(commands[3].data, [NSData dataWithBytes:(UInt8[]){0xF0, 0x7E, 0x01, 0xF7} length:4]);
+	XCTAssertEqualObjects([commands[4] class], [MIKMIDINoteOffCommand class]);
+}
+
+#pragma mark - Benchmarks
+
+// A MIDI 1.0 DIN connection running flat out (31250 baud, 3125 bytes per second), as delivered by a
+// serial interface: packets of one to three bytes, running status, and clock bytes mixed in,
+// splitting messages.
+- (void)testParsingSaturatedSerialStreamPerformance
+{
+	NSMutableData *stream = [NSMutableData data];
+	NSUInteger numberOfMessages = 0;
+	for (NSUInteger i = 0; i < 3125; i++) {
+		UInt8 note = 36 + i % 48;
+		if (i % 64 == 0) {
+			[stream appendBytes:(UInt8[]){0x90} length:1];
+		}
+		[stream appendBytes:(UInt8[]){note, (i % 2) ? 0x00 : 0x64} length:2];
+		numberOfMessages++;
+		if (i % 4 == 0) {
+			[stream appendBytes:(UInt8[]){0xF8} length:1];
+			numberOfMessages++;
+		}
+	}
+	NSArray *packetLists = [self packetListsWithStream:stream packetLengths:@[@1, @3, @2, @1, @2] bytesPerSecond:3125];
+	[self measureParsingPacketLists:packetLists expectedNumberOfMessages:numberOfMessages description:@"Saturated 31.25 kbaud stream"];
+}
+
+// A USB device sending complete messages, many to a packet, at a rate a DIN connection couldn't carry.
+- (void)testParsingUSBStreamPerformance
+{
+	NSMutableData *stream = [NSMutableData data];
+	NSUInteger numberOfMessages = 10000;
+	for (NSUInteger i = 0; i < numberOfMessages; i++) {
+		UInt8 channel = i % 16;
+		switch (i % 3) {
+			case 0: [stream appendBytes:(UInt8[]){0x90 | channel, 36 + i % 48, 0x64} length:3]; break;
+			case 1: [stream appendBytes:(UInt8[]){0xB0 | channel, 74, i % 128} length:3]; break;
+			case 2: [stream appendBytes:(UInt8[]){0x80 | channel, 36 + i % 48, 0x00} length:3]; break;
+		}
+	}
+	NSArray *packetLists = [self packetListsWithStream:stream packetLengths:@[@48] bytesPerSecond:1000000];
+	[self measureParsingPacketLists:packetLists expectedNumberOfMessages:numberOfMessages description:@"USB stream"];
+}
+
+@end
@@ -0,0 +1,217 @@
+//
+//  MIKMIDIOutputPortTests.m
+//  MIKMIDI Tests
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright © 2026 Mixed In Key. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <MIKMIDI/MIKMIDI.h>
+
+@interface MIKMIDIDeviceManager (Private)
+@property (nonatomic) MIDIClientRef client;
+@end
+
+@interface MIKMIDIOutputPort (Private)
+- (BOOL)sendTransformedCommands:(NSArray *)commands toDestination:(MIKMIDIDestinationEndpoint *)destination error:(NSError **)error;
+@end
+
+@interface MIKMockDestinationEndpoint : MIKMIDIDestinationEndpoint
+@end
+
+@implementation MIKMockDestinationEndpoint
+
++ (BOOL)canInitWithObjectRef:(MIDIObjectRef)objectRef { return YES; }
+
+@end
+
+// Records what would be sent instead of sending it
+@interface MIKMockOutputPort : MIKMIDIOutputPort
+@property (nonatomic, strong) NSMutableArray *sentCommands;
+@property (nonatomic, strong) NSMutableArray *sentDestinations;
+@end
+
+@implementation MIKMockOutputPort
+
+- (BOOL)sendTransformedCommands:(NSArray *)commands toDestination:(MIKMIDIDestinationEndpoint *)destination error:(NSError **)error
+{
+	[self.sentCommands addObject:commands];
+	[self.sentDestinations addObject:destination];
+	return YES;
+}
+
+@end
+
+@interface MIKMIDIOutputPortTests : XCTestCase
+
+@property (nonatomic, strong) MIKMockOutputPort *port;
+@property (nonatomic, strong) MIKMIDISimulatedTimeSource *timeSource;
+@property (nonatomic, strong) MIKMIDIDestinationEndpoint *destination;
+
+@end
+
+@implementation MIKMIDIOutputPortTests
+
+- (void)setUp
+{
+	[super setUp];
+	self.port = [[MIKMockOutputPort alloc] initWithClient:[MIKMIDIDeviceManager sharedDeviceManager].client name:@"MIKMIDIOutputPortTests"];
+	self.port.sentCommands = [NSMutableArray array];
+	self.port.sentDestinations = [NSMutableArray array];
+	self.timeSource = [[MIKMIDISimulatedTimeSource alloc] init];
+	self.port.timeSource = self.timeSource;
+	self.port.batchingInterval = 0.001;
+	self.destination = [[MIKMockDestinationEndpoint alloc] initWithObjectRef:1];
+}
+
+- (void)sendControllerNumber:(NSUInteger)controllerNumber value:(NSUInteger)value toDestination:(MIKMIDIDestinationEndpoint *)destination
+{
+	MIKMIDIControlChangeCommand *command = [MIKMIDIControlChangeCommand controlChangeCommandWithControllerNumber:controllerNumber value:value];
+	XCTAssertTrue([self.port sendCommands:@[command] toDestination:destination error:NULL]);
+}
+
+- (void)testBatchingSendsCommandsTogether
+{
+	MIKMIDIDestinationEndpoint *otherDestination = [[MIKMockDestinationEndpoint alloc] initWithObjectRef:2];
+	for (NSUInteger i = 0; i < 64; i++) {
+		[self sendControllerNumber:i value:0 toDestination:self.destination];
+	}
+	[self sendControllerNumber:0 value:1 toDestination:otherDestination];
+	XCTAssertEqual(self.port.sentCommands.count, 0, @"Commands shouldn't be sent before the batching interval ends.");
+
+	[self.timeSource advanceByTimeInterval:0.001];
+	XCTAssertEqual(self.port.sentCommands.count, 2, @"There should be one send per destination.");
+	NSUInteger index = [self.port.sentDestinations indexOfObjectIdenticalTo:self.destination];
+	XCTAssertNotEqual(index, NSNotFound);
+	XCTAssertEqual([self.port.sentCommands[index] count], 64);
+	XCTAssertEqual([self.port.sentCommands[1 - index] count], 1);
+
+	// A new batch starts with the next command
+	[self sendControllerNumber:0 value:2 toDestination:self.destination];
+	[self.timeSource advanceByTimeInterval:0.0005];
+	XCTAssertEqual(self.port.sentCommands.count, 2);
+	[self.timeSource advanceByTimeInterval:0.0005];
+	XCTAssertEqual(self.port.sentCommands.count, 3);
+}
+
+- (void)testRepeatedControlChangesAreCoalesced
+{
+	for (NSUInteger value = 0; value < 10; value++) {
+		[self sendControllerNumber:7 value:value toDestination:self.destination];
+		[self sendControllerNumber:8 value:value toDestination:self.destination];
+	}
+	[self.port flushBatchedCommands];
+	XCTAssertEqual(self.port.sentCommands.count, 1);
+	NSArray *sentCommands = self.port.sentCommands.firstObject;
+	XCTAssertEqual(sentCommands.count, 2);
+	XCTAssertEqual([sentCommands[0] controllerNumber], 7);
+	XCTAssertEqual([sentCommands[0] controllerValue], 9);
+	XCTAssertEqual([sentCommands[1] controllerNumber], 8);
+	XCTAssertEqual([sentCommands[1] controllerValue], 9);
+
+	self.port.coalescesControlChangeCommands = NO;
+	for (NSUInteger value = 0; value < 10; value++) {
+		[self sendControllerNumber:7 value:value toDestination:self.destination];
+	}
+	[self.port flushBatchedCommands];
+	XCTAssertEqual([self.port.sentCommands.lastObject count], 10);
+}
+
+- (void)testControlChangesForDifferentTimesAreNotCoalesced
+{
+	// A fade scheduled ahead of time, plus a value to send right away
+	MIDITimeStamp future = MIKMIDIGetCurrentTimeStamp() + MIKMIDIClockMIDITimeStampsPerTimeInterval(1);
+	NSMutableArray *commands = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 2; i++) {
+		MIKMutableMIDIControlChangeCommand *command = [MIKMutableMIDIControlChangeCommand controlChangeCommandWithControllerNumber:7 value:100 - i];
+		command.midiTimestamp = future + i;
+		[commands addObject:command];
+	}
+	[commands addObject:[MIKMIDIControlChangeCommand controlChangeCommandWithControllerNumber:7 value:127]];
+	XCTAssertTrue([self.port sendCommands:commands toDestination:self.destination error:NULL]);
+	[self.port flushBatchedCommands];
+
+	NSArray *sentCommands = self.port.sentCommands.firstObject;
+	XCTAssertEqual(sentCommands.count, 3, @"Both scheduled values should be sent.");
+	XCTAssertEqualObjects(sentCommands[0], commands[2], @"Commands should be sent in time order.");
+	XCTAssertEqualObjects(sentCommands[1], commands[0]);
+	XCTAssertEqualObjects(sentCommands[2], commands[1]);
+}
+
+- (void)testParameterNumberAndDataEntryControlChangesAreNotCoalesced
+{
+	// Two RPNs set one after the other, with volume changes that are kept, as the second RPN comes between them
+	NSArray *controllers = @[@101, @100, @6, @38, @7, @101, @100, @6, @96, @7, @7];
+	NSArray *values = @[@0, @0, @2, @0, @100, @0, @1, @64, @0, @110, @120];
+	for (NSUInteger i = 0; i < controllers.count; i++) {
+		[self sendControllerNumber:[controllers[i] unsignedIntegerValue] value:[values[i] unsignedIntegerValue] toDestination:self.destination];
+	}
+	[self.port flushBatchedCommands];
+
+	NSArray *sentCommands = self.port.sentCommands.firstObject;
+	XCTAssertEqual(sentCommands.count, controllers.count - 1);
+	NSMutableArray *sentControllers = [NSMutableArray array];
+	for (MIKMIDIControlChangeCommand *command in sentCommands) {
+		[sentControllers addObject:@(command.controllerNumber)];
+	}
+	NSArray *expectedControllers = @[@101, @100, @6, @38, @7, @101, @100, @6, @96, @7];
+	XCTAssertEqualObjects(sentControllers, expectedControllers);
+	XCTAssertEqual([sentCommands[2] controllerValue], 2);
+	XCTAssertEqual([sentCommands[4] controllerValue], 100);
+	XCTAssertEqual([sentCommands[7] controllerValue], 64);
+	XCTAssertEqual([sentCommands.lastObject controllerValue], 120);
+}
+
+- (void)testControlChangesAreNotCoalescedAcrossOtherMessagesOnTheirChannel
+{
+	NSArray *commands = @[[MIKMIDIControlChangeCommand controlChangeCommandWithControllerNumber:64 value:127],
+						  [MIKMIDINoteOnCommand noteOnCommandWithNote:60 velocity:100 channel:0 midiTimeStamp:0],
+						  [MIKMIDINoteOffCommand noteOffCommandWithNote:60 velocity:0 channel:0 midiTimeStamp:0],
+						  [MIKMIDIControlChangeCommand controlChangeCommandWithControllerNumber:64 value:0],
+						  [MIKMIDINoteOnCommand noteOnCommandWithNote:62 velocity:100 channel:1 midiTimeStamp:0],
+						  [MIKMIDIControlChangeCommand controlChangeCommandWithControllerNumber:64 value:127]];
+	XCTAssertTrue([self.port sendCommands:commands toDestination:self.destination error:NULL]);
+	[self.port flushBatchedCommands];
+
+	// The note on another channel doesn't stop the last two sustain changes being coalesced,
+	// but the notes between the first two do, so the first note is still played with the pedal down.
+	NSArray *sentCommands = self.port.sentCommands.firstObject;
+	XCTAssertEqual(sentCommands.count, 5);
+	XCTAssertEqual([sentCommands[0] controllerValue], 127);
+	XCTAssertEqualObjects(sentCommands[1], commands[1]);
+	XCTAssertEqualObjects(sentCommands[2], commands[2]);
+	XCTAssertEqualObjects(sentCommands[3], commands[4]);
+	XCTAssertEqual([sentCommands[4] controllerNumber], 64);
+	XCTAssertEqual([sentCommands[4] controllerValue], 127);
+}
+
+- (void)testFullBatchIsSentImmediately
+{
+	self.port.maximumBatchLength = 30; // Ten control changes
+	for (NSUInteger i = 0; i < 25; i++) {
+		[self sendControllerNumber:i value:0 toDestination:self.destination];
+	}
+	XCTAssertEqual(self.port.sentCommands.count, 2);
+	XCTAssertEqual([self.port.sentCommands[0] count], 10);
+
+	[self.timeSource advanceByTimeInterval:0.001];
+	XCTAssertEqual(self.port.sentCommands.count, 3);
+	XCTAssertEqual([self.port.sentCommands[2] count], 5);
+}
+
+- (void)testDisablingBatchingSendsBatchedCommands
+{
+	MIKMutableMIDIControlChangeCommand *command = [MIKMutableMIDIControlChangeCommand controlChangeCommandWithControllerNumber:1 value:1];
+	[self.port sendCommands:@[command] toDestination:self.destination error:NULL];
+	command.controllerValue = 2; // Changing a command after sending it mustn't change what's sent
+
+	self.port.batchingInterval = 0;
+	XCTAssertEqual(self.port.sentCommands.count, 1);
+	XCTAssertEqual([[self.port.sentCommands.firstObject firstObject] controllerValue], 1);
+
+	[self.port sendCommands:@[command] toDestination:self.destination error:NULL];
+	XCTAssertEqual(self.port.sentCommands.count, 2, @"Commands should be sent immediately when batching is off.");
+}
+
+@end
@@ -9,6 +9,53 @@
 #import <Cocoa/Cocoa.h>
 #import <XCTest/XCTest.h>
 #import <MIKMIDI/MIKMIDI.h>
+#import <MIKMIDI/MIKMIDISequencer+MIKMIDIPrivate.h>
+
+@interface MIKMIDISequencerTestsCountingScheduler : NSObject <MIKMIDICommandScheduler>
+
+@property (nonatomic) NSUInteger numberOfScheduledCommands;
+
+@end
+
+@implementation MIKMIDISequencerTestsCountingScheduler
+
+- (void)scheduleMIDICommands:(NSArray *)commands
+{
+	self.numberOfScheduledCommands += [commands count];
+}
+
+@end
+
+@interface MIKMIDISequencerTestsRecordingScheduler : NSObject <MIKMIDICommandScheduler>
+
+@property (nonatomic, strong, readonly) NSMutableArray *scheduledCommands;
+
+@end
+
+@implementation MIKMIDISequencerTestsRecordingScheduler
+
+- (instancetype)init
+{
+	self = [super init];
+	if (self) {
+		_scheduledCommands = [NSMutableArray array];
+	}
+	return self;
+}
+
+- (void)scheduleMIDICommands:(NSArray *)commands
+{
+	[self.scheduledCommands addObjectsFromArray:commands];
+}
+
+- (NSArray *)noteOnCommands
+{
+	return [self.scheduledCommands filteredArrayUsingPredicate:[NSPredicate predicateWithBlock:^BOOL(MIKMIDICommand *command, NSDictionary *bindings) {
+		return [command isKindOfClass:[MIKMIDINoteOnCommand class]];
+	}]];
+}
+
+@end
 
 @interface MIKMIDISequencerTests : XCTestCase
 
@@ -45,4 +92,333 @@
 	}
 }
 
+#pragma mark - Helpers
+
+// A sequence at 120 BPM, with empty tracks
+- (MIKMIDISequence *)sequenceWithNumberOfTracks:(NSUInteger)numberOfTracks
+{
+	MIKMIDISequence *sequence = [MIKMIDISequence sequence];
+	[sequence setOverallTempo:120];
+	for (NSUInteger i = 0; i < numberOfTracks; i++) {
+		NSError *error = nil;
+		MIKMIDITrack *track = [sequence addTrackWithError:&error];
+		XCTAssertNotNil(track, @"Adding a track failed: %@", error);
+	}
+	return sequence;
+}
+
+- (MIKMIDISequence *)sequenceWithSingleTrack
+{
+	return [self sequenceWithNumberOfTracks:1];
+}
+
+#pragma mark - Offline Rendering
+
+- (MIKMIDISequencerTestsRecordingScheduler *)recordingSchedulerForSequence:(MIKMIDISequence *)sequence
+{
+	MIKMIDISequencerTestsRecordingScheduler *scheduler = [[MIKMIDISequencerTestsRecordingScheduler alloc] init];
+	self.sequencer.sequence = sequence;
+	for (MIKMIDITrack *track in sequence.tracks) {
+		[self.sequencer setCommandScheduler:scheduler forTrack:track];
+	}
+	return scheduler;
+}
+
+// Renders in 10 ms steps, as if rendering audio a buffer at a time, until the sequencer stops or duration has been rendered
+- (void)renderOfflineFromMIDITimeStamp:(MIDITimeStamp)start duration:(NSTimeInterval)duration
+{
+	[self renderOfflineFromMIDITimeStamp:start duration:duration stepDuration:0.01];
+}
+
+- (void)renderOfflineFromMIDITimeStamp:(MIDITimeStamp)start duration:(NSTimeInterval)duration stepDuration:(NSTimeInterval)stepDuration
+{
+	MIDITimeStamp step = MIKMIDIClockMIDITimeStampsPerTimeInterval(stepDuration);
+	MIDITimeStamp end = start + MIKMIDIClockMIDITimeStampsPerTimeInterval(duration);
+	for (MIDITimeStamp midiTimeStamp = start + step; self.sequencer.isPlaying && midiTimeStamp <= end; midiTimeStamp += step) {
+		[self.sequencer renderOfflineToMIDITimeStamp:midiTimeStamp];
+	}
+}
+
+- (void)testOfflineRendering
+{
+	MIKMIDISequence *sequence = [self sequenceWithSingleTrack];
+	[sequence setTempo:60 atTimeStamp:4];
+	MIKMIDITrack *track = sequence.tracks.firstObject;
+	for (NSUInteger i = 0; i < 8; i++) {
+		[track addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:i note:60 + i velocity:100 duration:0.5 channel:0]];
+	}
+	MIKMIDISequencerTestsRecordingScheduler *scheduler = [self recordingSchedulerForSequence:sequence];
+
+	// Far from the current time, which offline rendering doesn't care about
+	MIDITimeStamp start = 1000;
+	[self.sequencer startOfflineRenderingAtTimeStamp:0 MIDITimeStamp:start];
+	XCTAssertTrue(self.sequencer.isPlaying);
+	XCTAssertTrue(self.sequencer.isRenderingOffline);
+	NSDate *startDate = [NSDate date];
+	[self renderOfflineFromMIDITimeStamp:start duration:60];
+	XCTAssertLessThan(-[startDate timeIntervalSinceNow], 2.0 /* sequence takes 6 s to play */, @"Offline rendering should be faster than real time.");
+
+	XCTAssertFalse(self.sequencer.isPlaying, @"The sequencer should stop at the end of the sequence.");
+	XCTAssertFalse(self.sequencer.isRenderingOffline);
+	XCTAssertEqual(scheduler.scheduledCommands.count, 16);
+	MIDITimeStamp previousTimeStamp = 0;
+	for (MIKMIDICommand *command in scheduler.scheduledCommands) {
+		XCTAssertGreaterThanOrEqual(command.midiTimestamp, previousTimeStamp, @"Commands should be scheduled in order.");
+		previousTimeStamp = command.midiTimestamp;
+	}
+
+	NSArray *noteOns = [scheduler noteOnCommands];
+	XCTAssertEqual(noteOns.count, 8);
+	MIKMIDITempoMap *tempoMap = sequence.tempoMap;
+	for (NSUInteger i = 0; i < noteOns.count; i++) {
+		MIKMIDINoteOnCommand *noteOn = noteOns[i];
+		XCTAssertEqual(noteOn.note, 60 + i);
+		MIDITimeStamp expected = start + MIKMIDIClockMIDITimeStampsPerTimeInterval([tempoMap secondsForTimeStamp:i]);
+		XCTAssertEqualWithAccuracy((double)noteOn.midiTimestamp, (double)expected, MIKMIDIClockMIDITimeStampsPerTimeInterval(0.0001));
+	}
+}
+
+// One note a beat from beat 0 to beat 7, slowing from 120 to 60 BPM at beat 4
+- (MIKMIDISequence *)sequenceWithTempoChange
+{
+	MIKMIDISequence *sequence = [self sequenceWithSingleTrack];
+	[sequence setTempo:60 atTimeStamp:4];
+	MIKMIDITrack *track = sequence.tracks.firstObject;
+	for (NSUInteger i = 0; i < 8; i++) {
+		[track addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:i note:60 + i velocity:100 duration:0.5 channel:0]];
+	}
+	return sequence;
+}
+
+- (void)assertNoteOns:(NSArray *)noteOns fromTimeStamp:(MusicTimeStamp)startTimeStamp MIDITimeStamp:(MIDITimeStamp)start inSequence:(MIKMIDISequence *)sequence
+{
+	NSUInteger firstNote = (NSUInteger)ceil(startTimeStamp);
+	XCTAssertEqual(noteOns.count, 8 - firstNote, @"Every note should be played exactly once.");
+	MIKMIDITempoMap *tempoMap = sequence.tempoMap;
+	Float64 startSeconds = [tempoMap secondsForTimeStamp:startTimeStamp];
+	for (NSUInteger i = 0; i < noteOns.count; i++) {
+		MIKMIDINoteOnCommand *noteOn = noteOns[i];
+		XCTAssertEqual(noteOn.note, 60 + firstNote + i);
+		MIDITimeStamp expected = start + MIKMIDIClockMIDITimeStampsPerTimeInterval([tempoMap secondsForTimeStamp:firstNote + i] - startSeconds);
+		XCTAssertEqualWithAccuracy((double)noteOn.midiTimestamp, (double)expected, MIKMIDIClockMIDITimeStampsPerTimeInterval(0.0001));
+	}
+}
+
+- (void)testOfflineRenderingFromMIDITimeStampZero
+{
+	MIKMIDISequence *sequence = [self sequenceWithTempoChange];
+	MIKMIDISequencerTestsRecordingScheduler *scheduler = [self recordingSchedulerForSequence:sequence];
+
+	// After the tempo change, beat 0 falls before MIDI time stamp 0
+	[self.sequencer startOfflineRenderingAtTimeStamp:2 MIDITimeStamp:0];
+	[self renderOfflineFromMIDITimeStamp:0 duration:60];
+	XCTAssertFalse(self.sequencer.isPlaying, @"The sequencer should stop at the end of the sequence.");
+
+	[self assertNoteOns:[scheduler noteOnCommands] fromTimeStamp:2 MIDITimeStamp:0 inSequence:sequence];
+}
+
+- (void)testOfflineRenderingInLargeSteps
+{
+	MIKMIDISequence *sequence = [self sequenceWithTempoChange];
+	MIKMIDISequencerTestsRecordingScheduler *scheduler = [self recordingSchedulerForSequence:sequence];
+
+	// Each step spans two beats before the tempo change, so the tempo change lands in the middle of one
+	MIDITimeStamp start = 1000;
+	[self.sequencer startOfflineRenderingAtTimeStamp:0 MIDITimeStamp:start];
+	[self renderOfflineFromMIDITimeStamp:start duration:60 stepDuration:1.0];
+	XCTAssertFalse(self.sequencer.isPlaying, @"The sequencer should stop at the end of the sequence.");
+
+	[self assertNoteOns:[scheduler noteOnCommands] fromTimeStamp:0 MIDITimeStamp:start inSequence:sequence];
+}
+
+- (void)testOfflineRenderingLoops
+{
+	MIKMIDISequence *sequence = [self sequenceWithSingleTrack];
+	MIKMIDITrack *track = sequence.tracks.firstObject;
+	for (NSUInteger i = 0; i < 4; i++) {
+		[track addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:i note:60 + i velocity:100 duration:0.5 channel:0]];
+	}
+	MIKMIDISequencerTestsRecordingScheduler *scheduler = [self recordingSchedulerForSequence:sequence];
+	[self.sequencer setLoopStartTimeStamp:0 endTimeStamp:4];
+	self.sequencer.loop = YES;
+
+	__block NSUInteger numberOfLoops = 0;
+	id observer = [[NSNotificationCenter defaultCenter] addObserverForName:MIKMIDISequencerWillLoopNotification object:self.sequencer queue:nil usingBlock:^(NSNotification *note) {
+		numberOfLoops++;
+	}];
+
+	// Each loop is 2 seconds long. Stop just short of the 10th note.
+	MIDITimeStamp start = MIKMIDIGetCurrentTimeStamp();
+	[self.sequencer startOfflineRenderingAtTimeStamp:0 MIDITimeStamp:start];
+	[self renderOfflineFromMIDITimeStamp:start duration:4.9];
+	XCTAssertTrue(self.sequencer.isPlaying, @"A looping sequencer shouldn't stop by itself.");
+	[self.sequencer stop];
+	[[NSNotificationCenter defaultCenter] removeObserver:observer];
+
+	XCTAssertEqual(numberOfLoops, 2);
+	NSArray *noteOns = [scheduler noteOnCommands];
+	XCTAssertEqual(noteOns.count, 10);
+	for (NSUInteger i = 0; i < noteOns.count; i++) {
+		MIKMIDINoteOnCommand *noteOn = noteOns[i];
+		XCTAssertEqual(noteOn.note, 60 + i % 4);
+		MIDITimeStamp expected = start + MIKMIDIClockMIDITimeStampsPerTimeInterval(i * 0.5);
+		XCTAssertEqualWithAccuracy((double)noteOn.midiTimestamp, (double)expected, MIKMIDIClockMIDITimeStampsPerTimeInterval(0.0001));
+	}
+}
+
+#pragma mark - Simulated Time
+
+- (void)testPlaybackWithSimulatedTimeSource
+{
+	MIKMIDISequence *sequence = [self sequenceWithSingleTrack];
+	[sequence setTempo:240 atTimeStamp:120];
+	MIKMIDITrack *track = sequence.tracks.firstObject;
+	NSUInteger numberOfNotes = 240;
+	NSMutableArray *notes = [NSMutableArray array];
+	for (NSUInteger i = 0; i < numberOfNotes; i++) {
+		[notes addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:i note:i % 128 velocity:100 duration:0.5 channel:0]];
+	}
+	[track addEvents:notes];
+	MIKMIDISequencerTestsRecordingScheduler *scheduler = [self recordingSchedulerForSequence:sequence];
+
+	MIKMIDISimulatedTimeSource *timeSource = [[MIKMIDISimulatedTimeSource alloc] init];
+	self.sequencer.timeSource = timeSource;
+	XCTAssertEqual(self.sequencer.clock.timeSource, timeSource);
+	MIDITimeStamp start = timeSource.currentMIDITimeStamp;
+	[self.sequencer startPlaybackAtTimeStamp:0 MIDITimeStamp:start];
+
+	// The sequence takes 90 seconds to play
+	NSDate *startDate = [NSDate date];
+	[timeSource advanceByTimeInterval:95];
+	XCTAssertLessThan(-[startDate timeIntervalSinceNow], 5.0, @"Playback with a simulated time source should be much faster than real time.");
+	XCTAssertFalse(self.sequencer.isPlaying, @"The sequencer should stop at the end of the sequence.");
+	XCTAssertEqual(timeSource.numberOfPendingBlocks, 0, @"The sequencer shouldn't wake up after it stops.");
+
+	NSArray *noteOns = [scheduler noteOnCommands];
+	XCTAssertEqual(noteOns.count, numberOfNotes);
+	MIKMIDITempoMap *tempoMap = sequence.tempoMap;
+	for (NSUInteger i = 0; i < noteOns.count; i++) {
+		MIKMIDINoteOnCommand *noteOn = noteOns[i];
+		XCTAssertEqual(noteOn.note, i % 128);
+		MIDITimeStamp expected = start + MIKMIDIClockMIDITimeStampsPerTimeInterval([tempoMap secondsForTimeStamp:i]);
+		XCTAssertEqualWithAccuracy((double)noteOn.midiTimestamp, (double)expected, MIKMIDIClockMIDITimeStampsPerTimeInterval(0.0001));
+	}
+
+	self.sequencer.timeSource = nil;
+	XCTAssertEqual(self.sequencer.timeSource, [MIKMIDIHostTimeSource hostTimeSource]);
+}
+
+#pragma mark - Adaptive Look-Ahead
+
+// Plays sequence to the end against a simulated time source, returning the commands that were scheduled
+- (NSArray *)commandsPlayingSequence:(MIKMIDISequence *)sequence adaptive:(BOOL)adaptive statistics:(MIKMIDISequencerSchedulingStatistics *)outStatistics
+{
+	MIKMIDISequencerTestsRecordingScheduler *scheduler = [self recordingSchedulerForSequence:sequence];
+	MIKMIDISimulatedTimeSource *timeSource = [[MIKMIDISimulatedTimeSource alloc] initWithMIDITimeStamp:MIKMIDIClockMIDITimeStampsPerTimeInterval(60)];
+	self.sequencer.timeSource = timeSource;
+	self.sequencer.adaptiveLookAheadEnabled = adaptive;
+	[self.sequencer startPlaybackAtTimeStamp:0 MIDITimeStamp:timeSource.currentMIDITimeStamp];
+	[timeSource advanceByTimeInterval:sequence.durationInSeconds + 1];
+	XCTAssertFalse(self.sequencer.isPlaying, @"The sequencer should stop at the end of the sequence.");
+	*outStatistics = self.sequencer.schedulingStatistics;
+	return scheduler.scheduledCommands;
+}
+
+- (void)testAdaptiveLookAheadSleepsThroughSparsePassages
+{
+	MIKMIDISequence *sequence = [self sequenceWithSingleTrack];
+	MIKMIDITrack *track = sequence.tracks.firstObject;
+	for (NSUInteger i = 0; i < 8; i++) {
+		[track addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:i * 8 note:60 velocity:100 duration:1 channel:0]];
+	}
+
+	MIKMIDISequencerSchedulingStatistics fixed, adaptive;
+	NSArray *fixedCommands = [self commandsPlayingSequence:sequence adaptive:NO statistics:&fixed];
+	NSArray *adaptiveCommands = [self commandsPlayingSequence:sequence adaptive:YES statistics:&adaptive];
+	XCTAssertEqualObjects(adaptiveCommands, fixedCommands, @"Adaptive look-ahead should schedule the same commands at the same times.");
+	XCTAssertEqual(adaptiveCommands.count, 16);
+
+	// The sequence is 28.5 seconds long, with one note every 4 seconds
+	XCTAssertGreaterThan(fixed.numberOfWakeUps, 500);
+	XCTAssertLessThan(adaptive.numberOfWakeUps, 120, @"The sequencer should sleep between notes.");
+	XCTAssertEqual(adaptive.maximumWakeUpLateness, 0);
+	XCTAssertLessThanOrEqual(adaptive.lookAheadInterval, self.sequencer.maximumLookAheadInterval);
+}
+
+- (void)testAdaptiveLookAheadLimitsBurstSize
+{
+	MIKMIDISequence *sequence = [self sequenceWithSingleTrack];
+	MIKMIDITrack *track = sequence.tracks.firstObject;
+	NSMutableArray *notes = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 2048; i++) {
+		// 512 notes per second
+		[notes addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:i / 256.0 note:i % 128 velocity:100 duration:1 / 512.0 channel:0]];
+	}
+	[track addEvents:notes];
+
+	MIKMIDISequencerSchedulingStatistics fixed, adaptive;
+	NSArray *fixedCommands = [self commandsPlayingSequence:sequence adaptive:NO statistics:&fixed];
+	NSArray *adaptiveCommands = [self commandsPlayingSequence:sequence adaptive:YES statistics:&adaptive];
+	XCTAssertEqualObjects(adaptiveCommands, fixedCommands, @"Adaptive look-ahead should schedule the same commands at the same times.");
+	XCTAssertEqual(adaptiveCommands.count, 4096);
+
+	XCTAssertGreaterThanOrEqual(fixed.maximumNumberOfEventsScheduledAtOneWakeUp, 90);
+	XCTAssertLessThanOrEqual(adaptive.maximumNumberOfEventsScheduledAtOneWakeUp, 64, @"Dense passages should be scheduled in smaller batches.");
+	XCTAssertLessThan(adaptive.lookAheadInterval, fixed.lookAheadInterval);
+}
+
+#pragma mark - Performance
+
+- (void)measureProcessingWithNumberOfTracks:(NSUInteger)numberOfTracks
+{
+	MIKMIDISequence *sequence = [self sequenceWithNumberOfTracks:numberOfTracks];
+	MIKMIDISequencer *sequencer = [MIKMIDISequencer sequencerWithSequence:sequence];
+	MIKMIDISequencerTestsCountingScheduler *scheduler = [[MIKMIDISequencerTestsCountingScheduler alloc] init];
+	for (NSUInteger i = 0; i < numberOfTracks; i++) {
+		MIKMIDITrack *track = sequence.tracks[i];
+		NSMutableArray *notes = [NSMutableArray array];
+		for (NSUInteger j = 0; j < 512; j++) {
+			[notes addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:j / 4.0 note:(i + j) % 128 velocity:100 duration:0.2 channel:i % 16]];
+		}
+		[track addEvents:notes];
+		[sequencer setCommandScheduler:scheduler forTrack:track];
+	}
+
+	// Start far in the future so the sequencer's own timer doesn't schedule anything, then drive it by hand.
+	Float64 midiTimeStampsPerTick = MIKMIDIClockMIDITimeStampsPerTimeInterval(0.05);
+	MIDITimeStamp start = MIKMIDIGetCurrentTimeStamp() + MIKMIDIClockMIDITimeStampsPerTimeInterval(3600);
+	[sequencer startPlaybackAtTimeStamp:0 MIDITimeStamp:start];
+
+	NSUInteger numberOfTicks = 320; // 16 seconds, or 64 beats at 120 BPM
+	[self measureBlock:^{
+		NSDate *startDate = [NSDate date];
+		[sequencer dispatchSyncToProcessingQueueAsNeeded:^{
+			for (NSUInteger tick = 0; tick < numberOfTicks; tick++) {
+				MIDITimeStamp from = start + (MIDITimeStamp)(tick * midiTimeStampsPerTick);
+				MIDITimeStamp to = start + (MIDITimeStamp)((tick + 1) * midiTimeStampsPerTick);
+				[sequencer processSequenceFromMIDITimeStamp:from toMIDITimeStamp:to];
+			}
+		}];
+		NSLog(@"%lu tracks: %.0f ticks per second", (unsigned long)numberOfTracks, numberOfTicks / -[startDate timeIntervalSinceNow]);
+	}];
+	[sequencer stop];
+
+	XCTAssertGreaterThan(scheduler.numberOfScheduledCommands, 0);
+}
+
+- (void)testProcessingPerformanceWith10Tracks
+{
+	[self measureProcessingWithNumberOfTracks:10];
+}
+
+- (void)testProcessingPerformanceWith100Tracks
+{
+	[self measureProcessingWithNumberOfTracks:100];
+}
+
+- (void)testProcessingPerformanceWith400Tracks
+{
+	[self measureProcessingWithNumberOfTracks:400];
+}
+
 @end
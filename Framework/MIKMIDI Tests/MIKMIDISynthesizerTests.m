@@ -0,0 +1,195 @@
+//
+//  MIKMIDISynthesizerTests.m
+//  MIKMIDI Tests
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright © 2026 Mixed In Key. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <MIKMIDI/MIKMIDI.h>
+#import <MIKMIDI/MIKMIDISynthesizer_SubclassMethods.h>
+#import "MIKMIDITestAllocationCounting.h"
+
+@interface MIKMIDISynthesizerTests : XCTestCase
+
+@property (nonatomic, strong) MIKMIDISynthesizer *synthesizer;
+
+@end
+
+@implementation MIKMIDISynthesizerTests
+
+- (void)setUp
+{
+	[super setUp];
+
+	NSError *error = nil;
+	self.synthesizer = [[MIKMIDISynthesizer alloc] initWithError:&error];
+	XCTAssertNotNil(self.synthesizer, @"Creating synthesizer failed: %@", error);
+	// Don't let the real render callback interfere
+	self.synthesizer.instrumentUnit = NULL;
+}
+
+- (NSArray *)noteCommandsFromTimeStamp:(MIDITimeStamp)start count:(NSUInteger)count spacing:(MIDITimeStamp)spacing
+{
+	NSMutableArray *commands = [NSMutableArray arrayWithCapacity:count];
+	for (NSUInteger i = 0; i < count; i++) {
+		[commands addObject:[MIKMIDINoteOnCommand noteOnCommandWithNote:60 + i % 12 velocity:100 channel:0 midiTimeStamp:start + i * spacing]];
+	}
+	return commands;
+}
+
+- (AudioTimeStamp)renderTimeStampWithHostTime:(MIDITimeStamp)hostTime
+{
+	AudioTimeStamp timeStamp = {0};
+	timeStamp.mHostTime = hostTime;
+	timeStamp.mFlags = kAudioTimeStampHostTimeValid | kAudioTimeStampSampleTimeValid;
+	return timeStamp;
+}
+
+- (void)testCommandsAreSentInTimeOrder
+{
+	NSMutableArray *sentNotes = [NSMutableArray array];
+	self.synthesizer.sendMIDICommand = ^OSStatus(MIKMIDISynthesizer *synth, MusicDeviceComponent inUnit, UInt32 inStatus, UInt32 inData1, UInt32 inData2, UInt32 inOffsetSampleFrame) {
+		[sentNotes addObject:@(inData1)];
+		return noErr;
+	};
+
+	MIDITimeStamp start = MIKMIDIGetCurrentTimeStamp();
+	MIDITimeStamp spacing = MIKMIDIClockMIDITimeStampsPerTimeInterval(0.001);
+	// Scheduled out of order, as separate schedulers might
+	[self.synthesizer scheduleMIDICommands:@[[MIKMIDINoteOnCommand noteOnCommandWithNote:62 velocity:100 channel:0 midiTimeStamp:start + 2 * spacing]]];
+	[self.synthesizer scheduleMIDICommands:@[[MIKMIDINoteOnCommand noteOnCommandWithNote:60 velocity:100 channel:0 midiTimeStamp:start],
+											 [MIKMIDINoteOnCommand noteOnCommandWithNote:61 velocity:100 channel:0 midiTimeStamp:start + spacing],
+											 [MIKMIDINoteOnCommand noteOnCommandWithNote:63 velocity:100 channel:0 midiTimeStamp:start + spacing]]];
+
+	AudioTimeStamp timeStamp = [self renderTimeStampWithHostTime:start];
+	MIKMIDISynthesizerScheduleUpcomingMIDICommands(self.synthesizer, NULL, 44, 44100, &timeStamp); // 1 ms
+	XCTAssertEqualObjects(sentNotes, @[@60]);
+	timeStamp = [self renderTimeStampWithHostTime:start + 2 * spacing];
+	MIKMIDISynthesizerScheduleUpcomingMIDICommands(self.synthesizer, NULL, 44, 44100, &timeStamp);
+	XCTAssertEqualObjects(sentNotes, (@[@60, @61, @63, @62]));
+}
+
+- (void)testRenderingDoesNotAllocate
+{
+	__block NSUInteger numberOfSentCommands = 0;
+	self.synthesizer.sendMIDICommand = ^OSStatus(MIKMIDISynthesizer *synth, MusicDeviceComponent inUnit, UInt32 inStatus, UInt32 inData1, UInt32 inData2, UInt32 inOffsetSampleFrame) {
+		numberOfSentCommands++;
+		return noErr;
+	};
+
+	// Schedule from another thread while rendering on this one, like the sequencer and the audio thread.
+	MIDITimeStamp start = MIKMIDIGetCurrentTimeStamp();
+	UInt32 framesPerRender = 256;
+	Float64 sampleRate = 44100;
+	MIDITimeStamp midiTimeStampsPerRender = MIKMIDIClockMIDITimeStampsPerTimeInterval(framesPerRender / sampleRate);
+	NSUInteger numberOfRenders = 4000;
+	NSUInteger commandsPerBatch = 64;
+	NSUInteger numberOfBatches = 500;
+	NSUInteger rendersPerBatch = numberOfRenders / numberOfBatches;
+	MIKMIDISynthesizer *synthesizer = self.synthesizer;
+	__block volatile NSUInteger numberOfRendersDone = 0;
+	__block volatile NSUInteger numberOfBatchesScheduled = 0;
+
+	dispatch_group_t group = dispatch_group_create();
+	dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+		for (NSUInteger batch = 0; batch < numberOfBatches; batch++) {
+			// Stay a few batches ahead of rendering, like the sequencer's look-ahead
+			while (batch * rendersPerBatch > numberOfRendersDone + 4 * rendersPerBatch) usleep(50);
+			@autoreleasepool {
+				MIDITimeStamp batchStart = start + batch * rendersPerBatch * midiTimeStampsPerRender;
+				[synthesizer scheduleMIDICommands:[self noteCommandsFromTimeStamp:batchStart count:commandsPerBatch spacing:midiTimeStampsPerRender / 8]];
+			}
+			numberOfBatchesScheduled = batch + 1;
+		}
+	});
+
+	MIKMIDIStartCountingAllocations();
+	for (NSUInteger i = 0; i < numberOfRenders; i++) {
+		while (numberOfBatchesScheduled < numberOfBatches && numberOfBatchesScheduled * rendersPerBatch <= i) usleep(50);
+		AudioTimeStamp timeStamp = [self renderTimeStampWithHostTime:start + i * midiTimeStampsPerRender];
+		MIKMIDISynthesizerScheduleUpcomingMIDICommands(synthesizer, NULL, framesPerRender, sampleRate, &timeStamp);
+		numberOfRendersDone = i + 1;
+	}
+	NSUInteger numberOfAllocations = MIKMIDIStopCountingAllocations();
+	dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+
+	XCTAssertEqual(numberOfAllocations, 0, @"Rendering allocated memory.");
+	XCTAssertEqual(numberOfSentCommands, numberOfBatches * commandsPerBatch);
+}
+
+- (void)testSampleOffsetJitter
+{
+	NSMutableArray *sentOffsets = [NSMutableArray array];
+	self.synthesizer.sendMIDICommand = ^OSStatus(MIKMIDISynthesizer *synth, MusicDeviceComponent inUnit, UInt32 inStatus, UInt32 inData1, UInt32 inData2, UInt32 inOffsetSampleFrame) {
+		[sentOffsets addObject:@(inOffsetSampleFrame)];
+		return noErr;
+	};
+
+	UInt32 framesPerRender = 512;
+	for (NSNumber *sampleRateNumber in @[@44100, @48000, @96000]) {
+		Float64 sampleRate = [sampleRateNumber doubleValue];
+		Float64 midiTimeStampsPerFrame = MIKMIDIClockMIDITimeStampsPerTimeInterval(1.0 / sampleRate);
+		MIDITimeStamp hostTime = MIKMIDIGetCurrentTimeStamp();
+
+		// One command at a random point in each of many buffers
+		NSUInteger numberOfRenders = 1000;
+		NSMutableArray *idealOffsets = [NSMutableArray array];
+		[sentOffsets removeAllObjects];
+		for (NSUInteger i = 0; i < numberOfRenders; i++) {
+			MIDITimeStamp renderHostTime = hostTime + (MIDITimeStamp)(i * framesPerRender * midiTimeStampsPerFrame);
+			MIDITimeStamp commandHostTime = renderHostTime + arc4random_uniform((UInt32)((framesPerRender - 1) * midiTimeStampsPerFrame));
+			[self.synthesizer scheduleMIDICommands:@[[MIKMIDINoteOnCommand noteOnCommandWithNote:60 velocity:100 channel:0 midiTimeStamp:commandHostTime]]];
+			[idealOffsets addObject:@((commandHostTime - renderHostTime) / midiTimeStampsPerFrame)];
+
+			AudioTimeStamp timeStamp = [self renderTimeStampWithHostTime:renderHostTime];
+			MIKMIDISynthesizerScheduleUpcomingMIDICommands(self.synthesizer, NULL, framesPerRender, sampleRate, &timeStamp);
+		}
+
+		XCTAssertEqual(sentOffsets.count, numberOfRenders);
+		Float64 maximumJitter = 0, totalJitter = 0;
+		for (NSUInteger i = 0; i < MIN(sentOffsets.count, numberOfRenders); i++) {
+			Float64 jitter = fabs([sentOffsets[i] doubleValue] - [idealOffsets[i] doubleValue]);
+			maximumJitter = MAX(maximumJitter, jitter);
+			totalJitter += jitter;
+		}
+		NSLog(@"Sample offset jitter at %.0f Hz: mean %.3f frames, maximum %.3f frames", sampleRate, totalJitter / numberOfRenders, maximumJitter);
+		XCTAssertLessThanOrEqual(maximumJitter, 0.5 + 1e-6, @"Commands should be scheduled at the nearest frame.");
+	}
+}
+
+- (void)testSynthesizersWithDifferentBufferSizesDoNotInterfere
+{
+	NSError *error = nil;
+	MIKMIDISynthesizer *otherSynthesizer = [[MIKMIDISynthesizer alloc] initWithError:&error];
+	XCTAssertNotNil(otherSynthesizer, @"Creating synthesizer failed: %@", error);
+	otherSynthesizer.instrumentUnit = NULL;
+
+	NSMutableArray *sentOffsets = [NSMutableArray array];
+	NSMutableArray *otherSentOffsets = [NSMutableArray array];
+	self.synthesizer.sendMIDICommand = ^OSStatus(MIKMIDISynthesizer *synth, MusicDeviceComponent inUnit, UInt32 inStatus, UInt32 inData1, UInt32 inData2, UInt32 inOffsetSampleFrame) {
+		[sentOffsets addObject:@(inOffsetSampleFrame)];
+		return noErr;
+	};
+	otherSynthesizer.sendMIDICommand = ^OSStatus(MIKMIDISynthesizer *synth, MusicDeviceComponent inUnit, UInt32 inStatus, UInt32 inData1, UInt32 inData2, UInt32 inOffsetSampleFrame) {
+		[otherSentOffsets addObject:@(inOffsetSampleFrame)];
+		return noErr;
+	};
+
+	// 10 ms into the buffer is frame 441 at 44.1 kHz and frame 960 at 96 kHz
+	MIDITimeStamp hostTime = MIKMIDIGetCurrentTimeStamp();
+	MIDITimeStamp commandHostTime = hostTime + MIKMIDIClockMIDITimeStampsPerTimeInterval(0.01);
+	AudioTimeStamp timeStamp = [self renderTimeStampWithHostTime:hostTime];
+	for (NSUInteger i = 0; i < 3; i++) {
+		[self.synthesizer scheduleMIDICommands:@[[MIKMIDINoteOnCommand noteOnCommandWithNote:60 velocity:100 channel:0 midiTimeStamp:commandHostTime]]];
+		[otherSynthesizer scheduleMIDICommands:@[[MIKMIDINoteOnCommand noteOnCommandWithNote:60 velocity:100 channel:0 midiTimeStamp:commandHostTime]]];
+		MIKMIDISynthesizerScheduleUpcomingMIDICommands(self.synthesizer, NULL, 512, 44100, &timeStamp);
+		MIKMIDISynthesizerScheduleUpcomingMIDICommands(otherSynthesizer, NULL, 1024, 96000, &timeStamp);
+	}
+
+	XCTAssertEqualObjects(sentOffsets, (@[@441, @441, @441]));
+	XCTAssertEqualObjects(otherSentOffsets, (@[@960, @960, @960]));
+}
+
+@end
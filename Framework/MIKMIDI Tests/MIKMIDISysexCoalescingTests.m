@@ -10,12 +10,12 @@
 #import <MIKMIDI/MIKMIDI.h>
 
 @interface MIKMIDIDeviceManager ()
+@property (nonatomic) MIDIClientRef client;
 @property (nonatomic, strong) MIKMIDIInputPort *inputPort;
 @end
 
 @interface MIKMIDIInputPort ()
 - (void)interpretPacketList:(const MIDIPacketList *)pktList handleResultingCommands:(void (^_Nonnull)(NSArray <MIKMIDICommand*> *receivedCommands))completionBlock;
-- (BOOL)coalesceSysexFromMIDIPacket:(const MIDIPacket *)packet toCommandInArray:(NSMutableArray **)commandsArray;
 @end
 
 @interface MIKMIDISysexCoalescingTests : XCTestCase
@@ -57,47 +57,60 @@
 	return packet;
 }
 
+// Feeds each of packetsData to the input port in its own packet list, and returns all the resulting commands
+- (NSArray <MIKMIDICommand*> *)commandsFromPacketsWithData:(NSArray <NSData*> *)packetsData
+{
+	return [self commandsFromPacketsWithData:packetsData inputPort:_debugInputPort];
+}
+
+- (NSArray <MIKMIDICommand*> *)commandsFromPacketsWithData:(NSArray <NSData*> *)packetsData inputPort:(MIKMIDIInputPort *)inputPort
+{
+	NSMutableArray <MIKMIDICommand*> *result = [NSMutableArray array];
+	for (NSData *packetData in packetsData) {
+		MIDIPacketList pktList = {0};
+		pktList.numPackets = 1;
+		pktList.packet[0] = [self packetWithData:packetData];
+		[inputPort interpretPacketList:&pktList handleResultingCommands:^(NSArray<MIKMIDICommand *> *receivedCommands) {
+			[result addObjectsFromArray:receivedCommands];
+		}];
+	}
+	return result;
+}
+
 #pragma mark - Tests
 
 - (void)testReadingSinglePacketSysex
 {
-	NSMutableArray <MIKMIDICommand*> *cmdArray = [NSMutableArray new];
-	
-	MIDIPacket testPacket = [self packetWithData:_validSysexData];
-	
-	[_debugInputPort coalesceSysexFromMIDIPacket:&testPacket toCommandInArray:&cmdArray];
+	NSArray <MIKMIDICommand*> *cmdArray = [self commandsFromPacketsWithData:@[_validSysexData]];
 	
+	XCTAssertEqual(cmdArray.count, 1);
+	XCTAssert([cmdArray.firstObject isKindOfClass:[MIKMIDISystemExclusiveCommand class]]);
 	XCTAssert([_validSysexData isEqualToData:cmdArray.firstObject.data], @"Single-packet sysex message failed coalescing properly");
 }
 		
 - (void)testReadingChunkedSysex
 {
-	NSMutableArray <MIKMIDICommand*> *cmdArray = [NSMutableArray new];
-	
 	// Split into 6 chunks
+	NSMutableArray <NSData*> *chunks = [NSMutableArray array];
 	for (NSUInteger i=0; i<6; i++) {
-		MIDIPacket chunk = [self packetWithData:[_validSysexData subdataWithRange:NSMakeRange(i*4, 4)]];
-		[_debugInputPort coalesceSysexFromMIDIPacket:&chunk toCommandInArray:&cmdArray];
+		[chunks addObject:[_validSysexData subdataWithRange:NSMakeRange(i*4, 4)]];
 	}
+	NSArray <MIKMIDICommand*> *cmdArray = [self commandsFromPacketsWithData:chunks];
 	
+	XCTAssertEqual(cmdArray.count, 1);
 	XCTAssert([_validSysexData isEqualToData:cmdArray.firstObject.data], @"Chunked sysex message failed coalescing properly");
 }
 
 - (void)testReadingNonTerminatedSysexFollowedByCommand
 {
-	NSMutableArray <MIKMIDICommand*> *cmdArray = [NSMutableArray new];
-	
-	// Simulate non terminated sysex packet
+	// Simulate non terminated sysex packet, followed by a note-on command
 	NSRange rangeBeforeEOT = NSMakeRange(0, _validSysexData.length - 1);
-	MIDIPacket testPacket = [self packetWithData:[_validSysexData subdataWithRange:rangeBeforeEOT]];
-	
-	[_debugInputPort coalesceSysexFromMIDIPacket:&testPacket toCommandInArray:&cmdArray];
-	
-	// Simulate following note-on command
-	MIDIPacket noteOnPacket = [self packetWithData:[MIKMIDINoteOnCommand noteOnCommandWithNote:0 velocity:0 channel:0 timestamp:nil].data];
+	MIKMIDINoteOnCommand *noteOn = [MIKMIDINoteOnCommand noteOnCommandWithNote:60 velocity:100 channel:0 timestamp:nil];
+	NSArray <MIKMIDICommand*> *cmdArray = [self commandsFromPacketsWithData:@[[_validSysexData subdataWithRange:rangeBeforeEOT], noteOn.data]];
 	
-	XCTAssertFalse([_debugInputPort coalesceSysexFromMIDIPacket:&noteOnPacket toCommandInArray:&cmdArray], @"Sysex coalescing should have failed because of an invalid start byte in noteOnPacket");
-	XCTAssert([_validSysexData isEqualToData:cmdArray.firstObject.data], @"Sysex coalescing should have ended because of an invalid start byte in noteOnPacket");
+	XCTAssertEqual(cmdArray.count, 2);
+	XCTAssert([_validSysexData isEqualToData:cmdArray.firstObject.data], @"Sysex coalescing should have ended because of the status byte in noteOnPacket");
+	XCTAssertEqualObjects(cmdArray.lastObject.data, noteOn.data, @"The note-on command that ended the sysex message should have been received too");
 }
 
 - (void)testReadingNonTerminatedSysexUntilTimeout
@@ -124,4 +137,117 @@
 	}];
 }
 
+- (void)testReadingNonTerminatedSysexUntilSimulatedTimeout
+{
+	MIKMIDISimulatedTimeSource *timeSource = [[MIKMIDISimulatedTimeSource alloc] init];
+	id<MIKMIDITimeSource> originalTimeSource = _debugInputPort.timeSource;
+	_debugInputPort.timeSource = timeSource;
+	
+	// Simulate non terminated sysex packet, followed by another chunk half a second later
+	NSData *firstChunk = [_validSysexData subdataWithRange:NSMakeRange(0, 12)];
+	NSData *secondChunk = [_validSysexData subdataWithRange:NSMakeRange(12, _validSysexData.length - 13)];
+	__block NSArray <MIKMIDICommand*> *resultingCommands = nil;
+	void (^handler)(NSArray<MIKMIDICommand *> *) = ^(NSArray<MIKMIDICommand *> *receivedCommands) {
+		resultingCommands = receivedCommands;
+	};
+	
+	MIDIPacketList pktList = {0};
+	pktList.numPackets = 1;
+	pktList.packet[0] = [self packetWithData:firstChunk];
+	[_debugInputPort interpretPacketList:&pktList handleResultingCommands:handler];
+	[timeSource advanceByTimeInterval:0.5];
+	
+	// The second chunk extends the time-out
+	MIDITimeStamp timeOut = timeSource.currentMIDITimeStamp + MIKMIDIClockMIDITimeStampsPerTimeInterval(_debugInputPort.sysexTimeOut);
+	pktList.packet[0] = [self packetWithData:secondChunk];
+	[_debugInputPort interpretPacketList:&pktList handleResultingCommands:handler];
+	
+	[timeSource advanceToMIDITimeStamp:timeOut - 1];
+	XCTAssertNil(resultingCommands, @"Sysex coalescing shouldn't time out while chunks are still arriving");
+	[timeSource advanceToMIDITimeStamp:timeOut];
+	XCTAssert([_validSysexData isEqualToData:resultingCommands.firstObject.data], @"Coalescing of non-terminated sysex message should have ended after time-out");
+	XCTAssertEqual(timeSource.numberOfPendingBlocks, 0);
+	
+	_debugInputPort.timeSource = originalTimeSource;
+}
+
+- (void)testSysexTimeOutWhileTimeAdvancesConcurrently
+{
+	MIKMIDIInputPort *port = [[MIKMIDIInputPort alloc] initWithClient:[MIKMIDIDeviceManager sharedDeviceManager].client name:@"MIKMIDISysexCoalescingTests"];
+	MIKMIDISimulatedTimeSource *timeSource = [[MIKMIDISimulatedTimeSource alloc] init];
+	port.timeSource = timeSource;
+
+	// Every packet starts a message that never ends, cutting off the one before it, so each becomes exactly one command,
+	// whether it's cut off or times out. Time-outs are scheduled and extended on this thread, while they fire on another.
+	NSUInteger numberOfPackets = 2000;
+	NSMutableArray *receivedCommands = [NSMutableArray array];
+	void (^handler)(NSArray<MIKMIDICommand *> *) = ^(NSArray<MIKMIDICommand *> *commands) {
+		@synchronized(receivedCommands) { [receivedCommands addObjectsFromArray:commands]; }
+	};
+
+	dispatch_group_t group = dispatch_group_create();
+	dispatch_group_async(group, dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+		for (NSUInteger i = 0; i < numberOfPackets; i++) [timeSource advanceByTimeInterval:port.sysexTimeOut / 3.0];
+	});
+	MIDIPacketList pktList = {0};
+	pktList.numPackets = 1;
+	pktList.packet[0] = [self packetWithData:[NSData dataWithBytes:(UInt8[]){0xF0, 0x7D, 0x01, 0x02} length:4]];
+	for (NSUInteger i = 0; i < numberOfPackets; i++) {
+		[port interpretPacketList:&pktList handleResultingCommands:handler];
+	}
+	dispatch_group_wait(group, DISPATCH_TIME_FOREVER);
+
+	[timeSource advanceByTimeInterval:port.sysexTimeOut];
+	XCTAssertEqual(receivedCommands.count, numberOfPackets, @"The last message should have timed out.");
+	XCTAssertEqual(timeSource.numberOfPendingBlocks, 0);
+}
+
+- (void)testStreamingSysexFragments
+{
+	MIKMIDIInputPort *port = [[MIKMIDIInputPort alloc] initWithClient:[MIKMIDIDeviceManager sharedDeviceManager].client name:@"MIKMIDISysexCoalescingTests"];
+	MIKMIDISimulatedTimeSource *timeSource = [[MIKMIDISimulatedTimeSource alloc] init];
+	port.timeSource = timeSource;
+	NSMutableData *streamedData = [NSMutableData data];
+	NSMutableArray *fragmentFlags = [NSMutableArray array];
+	port.systemExclusiveFragmentHandler = ^(MIKMIDISourceEndpoint *source, NSData *fragment, MIDITimeStamp timeStamp, MIKMIDISystemExclusiveFragmentFlags flags) {
+		[streamedData appendData:fragment];
+		[fragmentFlags addObject:@(flags)];
+	};
+	
+	// A clock message in the middle of the second chunk splits it in two
+	NSMutableData *secondChunk = [[_validSysexData subdataWithRange:NSMakeRange(8, 8)] mutableCopy];
+	[secondChunk replaceBytesInRange:NSMakeRange(4, 0) withBytes:(UInt8[]){0xF8} length:1];
+	NSArray *chunks = @[[_validSysexData subdataWithRange:NSMakeRange(0, 8)], secondChunk, [_validSysexData subdataWithRange:NSMakeRange(16, 8)]];
+	NSArray *commands = [self commandsFromPacketsWithData:chunks inputPort:port];
+	
+	XCTAssertEqualObjects(streamedData, _validSysexData);
+	NSArray *expectedFlags = @[@(MIKMIDISystemExclusiveFragmentFlagStart), @0, @0, @(MIKMIDISystemExclusiveFragmentFlagEnd)];
+	XCTAssertEqualObjects(fragmentFlags, expectedFlags);
+	XCTAssertEqual(commands.count, 1, @"Only the clock message should have been sent to event handlers.");
+	XCTAssertEqual(commands.firstObject.commandType, MIKMIDICommandTypeSystemTimingClock);
+	
+	// A message that stops partway through ends with an empty, timed out fragment
+	[self commandsFromPacketsWithData:@[[_validSysexData subdataWithRange:NSMakeRange(0, 8)]] inputPort:port];
+	[timeSource advanceByTimeInterval:port.sysexTimeOut];
+	XCTAssertEqualObjects(fragmentFlags.lastObject, @(MIKMIDISystemExclusiveFragmentFlagEnd | MIKMIDISystemExclusiveFragmentFlagTimedOut));
+	XCTAssertEqual(streamedData.length, _validSysexData.length + 8);
+	XCTAssertEqual(timeSource.numberOfPendingBlocks, 0);
+}
+
+- (void)testDiscardingSysexLongerThanMaximumLength
+{
+	MIKMIDIInputPort *port = [[MIKMIDIInputPort alloc] initWithClient:[MIKMIDIDeviceManager sharedDeviceManager].client name:@"MIKMIDISysexCoalescingTests"];
+	port.maximumSystemExclusiveLength = _validSysexData.length - 1;
+	
+	MIKMIDINoteOnCommand *noteOn = [MIKMIDINoteOnCommand noteOnCommandWithNote:60 velocity:100 channel:0 timestamp:nil];
+	NSArray *chunks = @[[_validSysexData subdataWithRange:NSMakeRange(0, 12)], [_validSysexData subdataWithRange:NSMakeRange(12, 12)], noteOn.data];
+	NSArray <MIKMIDICommand*> *cmdArray = [self commandsFromPacketsWithData:chunks inputPort:port];
+	XCTAssertEqual(cmdArray.count, 1);
+	XCTAssertEqualObjects(cmdArray.firstObject.data, noteOn.data);
+	
+	port.maximumSystemExclusiveLength = _validSysexData.length;
+	cmdArray = [self commandsFromPacketsWithData:@[_validSysexData] inputPort:port];
+	XCTAssertEqualObjects(cmdArray.firstObject.data, _validSysexData);
+}
+
 @end
@@ -0,0 +1,166 @@
+//
+//  MIKMIDISystemExclusiveSenderTests.m
+//  MIKMIDI Tests
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright © 2026 Mixed In Key. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <MIKMIDI/MIKMIDI.h>
+
+@interface MIKMIDIDeviceManager (Private)
+@property (nonatomic) MIDIClientRef client;
+@end
+
+@interface MIKSysexMockDestinationEndpoint : MIKMIDIDestinationEndpoint
+@end
+
+@implementation MIKSysexMockDestinationEndpoint
+
++ (BOOL)canInitWithObjectRef:(MIDIObjectRef)objectRef { return YES; }
+
+@end
+
+// Records the packets that would be sent, and when
+@interface MIKRecordingOutputPort : MIKMIDIOutputPort
+@property (nonatomic, strong) id<MIKMIDITimeSource> recordingTimeSource;
+@property (nonatomic, strong) NSMutableArray *sentPackets;
+@property (nonatomic, strong) NSMutableArray *sendTimes;
+@end
+
+@implementation MIKRecordingOutputPort
+
+- (BOOL)sendPacketList:(const MIDIPacketList *)packetList toDestination:(MIKMIDIDestinationEndpoint *)destination error:(NSError **)error
+{
+	const MIDIPacket *packet = &packetList->packet[0];
+	for (UInt32 i = 0; i < packetList->numPackets; i++) {
+		[self.sentPackets addObject:[NSData dataWithBytes:packet->data length:packet->length]];
+		[self.sendTimes addObject:@(self.recordingTimeSource.currentMIDITimeStamp)];
+		packet = MIDIPacketNext(packet);
+	}
+	return YES;
+}
+
+@end
+
+@interface MIKMIDISystemExclusiveSenderTests : XCTestCase
+
+@property (nonatomic, strong) MIKRecordingOutputPort *port;
+@property (nonatomic, strong) MIKMIDISimulatedTimeSource *timeSource;
+@property (nonatomic, strong) MIKMIDIDestinationEndpoint *destination;
+@property (nonatomic, strong) NSData *data;
+
+@end
+
+@implementation MIKMIDISystemExclusiveSenderTests
+
+- (void)setUp
+{
+	[super setUp];
+	self.timeSource = [[MIKMIDISimulatedTimeSource alloc] init];
+	self.port = [[MIKRecordingOutputPort alloc] initWithClient:[MIKMIDIDeviceManager sharedDeviceManager].client name:@"MIKMIDISystemExclusiveSenderTests"];
+	self.port.recordingTimeSource = self.timeSource;
+	self.port.sentPackets = [NSMutableArray array];
+	self.port.sendTimes = [NSMutableArray array];
+	self.destination = [[MIKSysexMockDestinationEndpoint alloc] initWithObjectRef:1];
+
+	NSMutableData *data = [NSMutableData dataWithLength:1000];
+	UInt8 *bytes = data.mutableBytes;
+	for (NSUInteger i = 0; i < data.length; i++) bytes[i] = i % 128;
+	bytes[0] = 0xF0;
+	bytes[data.length - 1] = 0xF7;
+	self.data = data;
+}
+
+- (MIKMIDISystemExclusiveSender *)senderWithSender:(MIKMIDISystemExclusiveSender *)sender
+{
+	sender.outputPort = self.port;
+	sender.timeSource = self.timeSource;
+	sender.bytesPerSecond = 1000;
+	sender.chunkLength = 100;
+	return sender;
+}
+
+- (void)testSendingIsChunkedAndPaced
+{
+	MIKMIDISystemExclusiveSender *sender = [self senderWithSender:[[MIKMIDISystemExclusiveSender alloc] initWithData:self.data]];
+	XCTestExpectation *expectation = [self expectationWithDescription:@"Sending finished"];
+	__block NSUInteger lastProgress = 0;
+	BOOL started = [sender sendToDestination:self.destination progressHandler:^(NSUInteger numberOfBytesSent, NSUInteger length) {
+		XCTAssertGreaterThan(numberOfBytesSent, lastProgress);
+		XCTAssertEqual(length, 1000);
+		lastProgress = numberOfBytesSent;
+	} completionHandler:^(NSError *error) {
+		XCTAssertNil(error);
+		[expectation fulfill];
+	} error:NULL];
+	XCTAssertTrue(started);
+	XCTAssertFalse([sender sendToDestination:self.destination progressHandler:nil completionHandler:nil error:NULL], @"Only one send should be allowed at a time.");
+
+	MIDITimeStamp start = self.timeSource.currentMIDITimeStamp;
+	while (sender.isSending) [self.timeSource advanceByTimeInterval:0.01];
+	[self waitForExpectationsWithTimeout:1 handler:nil];
+
+	XCTAssertEqual(self.port.sentPackets.count, 10);
+	NSMutableData *sentData = [NSMutableData data];
+	for (NSData *packet in self.port.sentPackets) [sentData appendData:packet];
+	XCTAssertEqualObjects(sentData, self.data);
+	XCTAssertEqual(lastProgress, 1000);
+
+	// 100 bytes at 1000 bytes per second is 100 ms per chunk
+	for (NSUInteger i = 0; i < 10; i++) {
+		NSTimeInterval sendTime = ([self.port.sendTimes[i] unsignedLongLongValue] - start) * MIKMIDIClockSecondsPerMIDITimeStamp();
+		XCTAssertEqualWithAccuracy(sendTime, i * 0.1, 0.011);
+	}
+}
+
+- (void)testSendingFromStream
+{
+	NSInputStream *stream = [NSInputStream inputStreamWithData:self.data];
+	MIKMIDISystemExclusiveSender *sender = [self senderWithSender:[[MIKMIDISystemExclusiveSender alloc] initWithInputStream:stream length:0]];
+	XCTestExpectation *expectation = [self expectationWithDescription:@"Sending finished"];
+	XCTAssertTrue([sender sendToDestination:self.destination progressHandler:nil completionHandler:^(NSError *error) {
+		XCTAssertNil(error);
+		[expectation fulfill];
+	} error:NULL]);
+	while (sender.isSending) [self.timeSource advanceByTimeInterval:0.1];
+	[self waitForExpectationsWithTimeout:1 handler:nil];
+
+	NSMutableData *sentData = [NSMutableData data];
+	for (NSData *packet in self.port.sentPackets) [sentData appendData:packet];
+	XCTAssertEqualObjects(sentData, self.data);
+	XCTAssertFalse([sender sendToDestination:self.destination progressHandler:nil completionHandler:nil error:NULL], @"A stream can only be sent once.");
+}
+
+- (void)testCancellingEndsMessage
+{
+	MIKMIDISystemExclusiveSender *sender = [self senderWithSender:[[MIKMIDISystemExclusiveSender alloc] initWithData:self.data]];
+	XCTestExpectation *expectation = [self expectationWithDescription:@"Sending cancelled"];
+	[sender sendToDestination:self.destination progressHandler:nil completionHandler:^(NSError *error) {
+		XCTAssertEqualObjects(error.domain, NSCocoaErrorDomain);
+		XCTAssertEqual(error.code, NSUserCancelledError);
+		[expectation fulfill];
+	} error:NULL];
+	[self.timeSource advanceByTimeInterval:0.1];
+	XCTAssertEqual(sender.numberOfBytesSent, 200);
+
+	[sender cancel];
+	[self.timeSource advanceByTimeInterval:0.1];
+	[self waitForExpectationsWithTimeout:1 handler:nil];
+	XCTAssertFalse(sender.isSending);
+	XCTAssertEqual(self.port.sentPackets.count, 3);
+	XCTAssertEqualObjects(self.port.sentPackets.lastObject, [NSData dataWithBytes:(UInt8[]){0xF7} length:1]);
+}
+
+- (void)testInvalidDataIsRejected
+{
+	NSData *data = [NSData dataWithBytes:(UInt8[]){0x90, 0x3C, 0x40} length:3];
+	MIKMIDISystemExclusiveSender *sender = [self senderWithSender:[[MIKMIDISystemExclusiveSender alloc] initWithData:data]];
+	NSError *error = nil;
+	XCTAssertFalse([sender sendToDestination:self.destination progressHandler:nil completionHandler:nil error:&error]);
+	XCTAssertEqual(error.code, MIKMIDIInvalidSystemExclusiveDataErrorCode);
+	XCTAssertEqual(self.port.sentPackets.count, 0);
+}
+
+@end
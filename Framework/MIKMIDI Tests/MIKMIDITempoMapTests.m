@@ -0,0 +1,121 @@
+//
+//  MIKMIDITempoMapTests.m
+//  MIKMIDI Tests
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright © 2026 Mixed In Key. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <MIKMIDI/MIKMIDI.h>
+
+@interface MIKMIDITempoMapTests : XCTestCase
+
+@property (nonatomic, strong) MIKMIDISequence *sequence;
+
+@end
+
+@implementation MIKMIDITempoMapTests
+
+- (void)setUp
+{
+	[super setUp];
+
+	self.sequence = [MIKMIDISequence sequence];
+	[self.sequence setOverallTempo:90];
+	[self.sequence setTempo:140 atTimeStamp:8];
+	[self.sequence setTempo:60 atTimeStamp:12.5];
+	[self.sequence setTempo:200 atTimeStamp:31];
+}
+
+- (void)testConversionsMatchMusicSequence
+{
+	MIKMIDITempoMap *tempoMap = self.sequence.tempoMap;
+	MusicSequence musicSequence = self.sequence.musicSequence;
+	for (MusicTimeStamp timeStamp = 0; timeStamp < 40; timeStamp += 0.25) {
+		Float64 expectedSeconds = 0;
+		XCTAssertEqual(MusicSequenceGetSecondsForBeats(musicSequence, timeStamp, &expectedSeconds), noErr);
+		XCTAssertEqualWithAccuracy([tempoMap secondsForTimeStamp:timeStamp], expectedSeconds, 1e-9, @"Wrong time for beat %f", timeStamp);
+		XCTAssertEqualWithAccuracy([tempoMap timeStampForSeconds:expectedSeconds], timeStamp, 1e-9);
+	}
+
+	XCTAssertEqualWithAccuracy([tempoMap tempoAtTimeStamp:10], 140, 1e-9);
+	XCTAssertEqualWithAccuracy([tempoMap tempoAtTimeStamp:12.5], 60, 1e-9);
+	XCTAssertEqualWithAccuracy([self.sequence tempoAtTimeStamp:31], 200, 1e-9);
+}
+
+- (void)testDefaultTempo
+{
+	MIKMIDITempoMap *tempoMap = [[MIKMIDITempoMap alloc] initWithTempoEvents:@[]];
+	XCTAssertEqualWithAccuracy([tempoMap secondsForTimeStamp:4], 2, 1e-9, @"Tempo should be 120 BPM without tempo events.");
+	XCTAssertNil([tempoMap tempoEventAtTimeStamp:4]);
+
+	tempoMap = [[MIKMIDITempoMap alloc] initWithTempoEvents:@[[MIKMIDITempoEvent tempoEventWithTimeStamp:2 tempo:60]]];
+	XCTAssertEqualWithAccuracy([tempoMap secondsForTimeStamp:3], 2, 1e-9, @"Tempo should be 120 BPM before the first tempo event.");
+	XCTAssertNil([tempoMap tempoEventAtTimeStamp:1]);
+	XCTAssertEqualObjects([tempoMap tempoEventAtTimeStamp:2], [MIKMIDITempoEvent tempoEventWithTimeStamp:2 tempo:60]);
+}
+
+- (void)testTempoMapFollowsTempoTrack
+{
+	MIKMIDITempoMap *before = self.sequence.tempoMap;
+	XCTAssertEqual(self.sequence.tempoMap, before, @"Tempo map should be reused while the tempo track is unchanged.");
+	Float64 durationBefore = [before secondsForTimeStamp:40];
+
+	[self.sequence setTempo:30 atTimeStamp:35];
+	MIKMIDITempoMap *after = self.sequence.tempoMap;
+	XCTAssertNotEqual(after, before);
+	XCTAssertEqualWithAccuracy([after secondsForTimeStamp:20], [before secondsForTimeStamp:20], 1e-9);
+	XCTAssertGreaterThan([after secondsForTimeStamp:40], durationBefore);
+
+	// A map updated incrementally must match one built from scratch
+	MIKMIDITempoMap *fresh = [[MIKMIDITempoMap alloc] initWithTempoEvents:after.tempoEvents];
+	for (MusicTimeStamp timeStamp = 0; timeStamp < 40; timeStamp += 0.5) {
+		XCTAssertEqual([after secondsForTimeStamp:timeStamp], [fresh secondsForTimeStamp:timeStamp]);
+	}
+}
+
+- (void)testBatchConversion
+{
+	MIKMIDITempoMap *tempoMap = self.sequence.tempoMap;
+	NSUInteger count = 1000;
+	MusicTimeStamp *timeStamps = malloc(count * sizeof(MusicTimeStamp));
+	Float64 *seconds = malloc(count * sizeof(Float64));
+	MusicTimeStamp *roundTrip = malloc(count * sizeof(MusicTimeStamp));
+	for (NSUInteger i = 0; i < count; i++) {
+		// Mostly ascending, with some jumps backward
+		timeStamps[i] = (i % 100 == 99) ? 1.0 : i * 0.04;
+	}
+
+	[tempoMap getSeconds:seconds forTimeStamps:timeStamps count:count];
+	[tempoMap getTimeStamps:roundTrip forSeconds:seconds count:count];
+	for (NSUInteger i = 0; i < count; i++) {
+		XCTAssertEqual(seconds[i], [tempoMap secondsForTimeStamp:timeStamps[i]]);
+		XCTAssertEqualWithAccuracy(roundTrip[i], timeStamps[i], 1e-9);
+	}
+
+	free(timeStamps);
+	free(seconds);
+	free(roundTrip);
+}
+
+- (void)testBatchConversionPerformance
+{
+	for (NSUInteger i = 0; i < 1000; i++) {
+		[self.sequence setTempo:60 + i % 120 atTimeStamp:32 + i];
+	}
+	MIKMIDITempoMap *tempoMap = self.sequence.tempoMap;
+	NSUInteger count = 1000000;
+	NSMutableData *timeStamps = [NSMutableData dataWithLength:count * sizeof(MusicTimeStamp)];
+	NSMutableData *seconds = [NSMutableData dataWithLength:count * sizeof(Float64)];
+	MusicTimeStamp *timeStampBytes = timeStamps.mutableBytes;
+	for (NSUInteger i = 0; i < count; i++) {
+		timeStampBytes[i] = i * 0.001;
+	}
+
+	[self measureBlock:^{
+		[tempoMap getSeconds:seconds.mutableBytes forTimeStamps:timeStamps.bytes count:count];
+	}];
+}
+
+@end
@@ -0,0 +1,25 @@
+//
+//  MIKMIDITestAllocationCounting.h
+//  MIKMIDI Tests
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright © 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Starts counting the memory allocations made on the calling thread, by installing a malloc logger,
+ *  the hook libmalloc uses for malloc stack logging. Only one thread can be counted at a time.
+ */
+void MIKMIDIStartCountingAllocations(void);
+
+/**
+ *  Stops counting allocations, and returns the number made on the counted thread since
+ *  MIKMIDIStartCountingAllocations() was called. Must be called on the same thread.
+ */
+NSUInteger MIKMIDIStopCountingAllocations(void);
+
+NS_ASSUME_NONNULL_END
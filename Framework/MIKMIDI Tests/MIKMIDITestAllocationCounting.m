@@ -0,0 +1,43 @@
+//
+//  MIKMIDITestAllocationCounting.m
+//  MIKMIDI Tests
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright © 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDITestAllocationCounting.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+// libmalloc calls this, if set, for every allocation and free. It's how malloc stack logging works.
+typedef void (MIKMallocLogger)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numberOfHotFramesToSkip);
+extern MIKMallocLogger *malloc_logger;
+
+#define MIK_MALLOC_LOG_TYPE_ALLOCATE	2
+
+static pthread_t MIKCountedAllocationsThread;
+static atomic_ulong MIKNumberOfCountedAllocations;
+static MIKMallocLogger *MIKPreviousMallocLogger;
+
+static void MIKCountAllocations(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3, uintptr_t result, uint32_t numberOfHotFramesToSkip)
+{
+	if ((type & MIK_MALLOC_LOG_TYPE_ALLOCATE) && pthread_equal(pthread_self(), MIKCountedAllocationsThread)) {
+		atomic_fetch_add_explicit(&MIKNumberOfCountedAllocations, 1, memory_order_relaxed);
+	}
+}
+
+void MIKMIDIStartCountingAllocations(void)
+{
+	MIKCountedAllocationsThread = pthread_self();
+	atomic_store(&MIKNumberOfCountedAllocations, 0);
+	MIKPreviousMallocLogger = malloc_logger;
+	malloc_logger = MIKCountAllocations;
+}
+
+NSUInteger MIKMIDIStopCountingAllocations(void)
+{
+	malloc_logger = MIKPreviousMallocLogger;
+	MIKPreviousMallocLogger = NULL;
+	return atomic_load(&MIKNumberOfCountedAllocations);
+}
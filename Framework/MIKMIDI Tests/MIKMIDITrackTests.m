@@ -124,6 +124,188 @@
 	XCTAssertEqual(onlyNotes.count, firstNotesTrack.events.count-2);
 }
 
+#pragma mark - Event Storage
+
+- (void)testEventsStaySortedAsTheyChange
+{
+	MIKMIDITrack *track = self.defaultTrack;
+	NSMutableArray *expected = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 2000; i++) {
+		// Plenty of events share a timestamp
+		MusicTimeStamp timeStamp = arc4random_uniform(200) / 4.0;
+		MIKMIDIEvent *event = [MIKMIDINoteEvent noteEventWithTimeStamp:timeStamp note:i % 128 velocity:1 + i / 128 duration:0.5 channel:0];
+		[track addEvent:event];
+		[expected addObject:event];
+
+		if (i % 3 == 0) {
+			MIKMIDIEvent *eventToRemove = expected[arc4random_uniform((UInt32)expected.count)];
+			[track removeEvent:eventToRemove];
+			[expected removeObject:eventToRemove];
+		}
+	}
+
+	NSArray *events = track.events;
+	XCTAssertEqual(events.count, expected.count);
+	XCTAssertEqualObjects([NSSet setWithArray:events], [NSSet setWithArray:expected]);
+	for (NSUInteger i = 1; i < events.count; i++) {
+		XCTAssertLessThanOrEqual([events[i-1] timeStamp], [events[i] timeStamp], @"Events out of order at index %lu", (unsigned long)i);
+	}
+
+	for (MusicTimeStamp start = -1; start < 51; start += 2.75) {
+		NSPredicate *inRange = [NSPredicate predicateWithBlock:^BOOL(MIKMIDIEvent *event, NSDictionary *bindings) {
+			return event.timeStamp >= start && event.timeStamp <= start + 3;
+		}];
+		NSArray *expectedInRange = [events filteredArrayUsingPredicate:inRange];
+		XCTAssertEqualObjects([track eventsFromTimeStamp:start toTimeStamp:start + 3], expectedInRange);
+	}
+}
+
+- (void)testEventsWithTheSameTimestampKeepTheirOrder
+{
+	NSMutableArray *expected = [NSMutableArray array];
+	for (UInt8 note = 0; note < 100; note++) {
+		MIKMIDIEvent *event = [MIKMIDINoteEvent noteEventWithTimeStamp:1 note:note velocity:127 duration:1 channel:0];
+		[self.defaultTrack addEvent:event];
+		[expected addObject:event];
+	}
+	[self.defaultTrack addEvent:expected[50]]; // Duplicates are ignored
+	XCTAssertEqualObjects(self.defaultTrack.events, expected);
+	XCTAssertEqualObjects([self.defaultTrack eventsFromTimeStamp:1 toTimeStamp:1], expected);
+	XCTAssertEqualObjects([self.defaultTrack eventsFromTimeStamp:0 toTimeStamp:0.5], @[]);
+}
+
+- (void)testEventsComeBackUnchanged
+{
+	MIKMutableMIDINoteEvent *mutableNote = [[MIKMIDINoteEvent noteEventWithTimeStamp:2 note:64 velocity:90 duration:0.25 channel:3] mutableCopy];
+	mutableNote.releaseVelocity = 12;
+	NSArray *events = @[[MIKMIDINoteEvent noteEventWithTimeStamp:0 note:60 velocity:100 duration:1.5 channel:1],
+						[MIKMIDIChannelEvent channelEventWithTimeStamp:0.5 message:(MIDIChannelMessage){0xB2, 7, 100, 0}],
+						[MIKMIDIChannelEvent channelEventWithTimeStamp:1 message:(MIDIChannelMessage){0xE0, 0, 64, 0}],
+						[MIKMIDIChannelEvent channelEventWithTimeStamp:1.25 message:(MIDIChannelMessage){0xC5, 42, 0, 0}],
+						[MIKMIDITempoEvent tempoEventWithTimeStamp:1.5 tempo:97],
+						mutableNote];
+	[self.defaultTrack addEvents:events];
+
+	NSArray *trackEvents = self.defaultTrack.events;
+	XCTAssertEqualObjects(trackEvents, events);
+	for (NSUInteger i = 0; i < events.count; i++) {
+		XCTAssertEqualObjects([trackEvents[i] class], [[events[i] copy] class]);
+	}
+	XCTAssertEqualObjects([self.defaultTrack eventsOfClass:[MIKMIDIControlChangeEvent class] fromTimeStamp:0 toTimeStamp:2], @[events[1]]);
+	XCTAssertEqual([self.defaultTrack.notes[1] releaseVelocity], 12);
+	XCTAssertEqual(self.defaultTrack.length, 2.25);
+
+	for (MIKMIDIEvent *event in events) {
+		[self.defaultTrack removeEvent:event];
+	}
+	XCTAssertEqualObjects(self.defaultTrack.events, @[]);
+}
+
+- (void)testRepeatedQueriesReturnTheSameEvents
+{
+	NSMutableArray *events = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 1000; i++) {
+		[events addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:i * 0.25 note:60 + i % 12 velocity:100 duration:0.25 channel:0]];
+	}
+	[self.defaultTrack addEvents:events];
+
+	NSArray *firstEvents = [self.defaultTrack eventsFromTimeStamp:10 toTimeStamp:20];
+	[self.defaultTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:15.1 note:30 velocity:100 duration:1 channel:0]];
+	NSArray *secondEvents = [self.defaultTrack eventsOfClass:[MIKMIDINoteEvent class] fromTimeStamp:10 toTimeStamp:20];
+	XCTAssertEqual(secondEvents.count, firstEvents.count + 1);
+	NSUInteger index = 0;
+	for (MIKMIDIEvent *event in secondEvents) {
+		if (event.timeStamp == 15.1) continue;
+		XCTAssertEqual(event, firstEvents[index], @"Event objects shouldn't be created again for every query");
+		index++;
+	}
+}
+
+- (void)testEventObjectsAreNotKeptByTheTrack
+{
+	__weak MIKMIDIEvent *weakEvent = nil;
+	__weak MIKMIDIEvent *weakSoundingNote = nil;
+	@autoreleasepool {
+		[self.defaultTrack addEvent:[MIKMIDINoteEvent noteEventWithTimeStamp:1 note:60 velocity:100 duration:1 channel:0]];
+		weakEvent = [self.defaultTrack.events firstObject];
+		weakSoundingNote = [[self.defaultTrack notesSoundingAtTimeStamp:1.5] firstObject];
+		XCTAssertNotNil(weakEvent);
+		XCTAssertEqual(weakSoundingNote, weakEvent, @"An event that's still in use should be returned again");
+		XCTAssertEqual([self.defaultTrack.events firstObject], weakEvent);
+	}
+	XCTAssertNil(weakEvent, @"The track shouldn't keep an object for a packed event once it's no longer used");
+	
+	__weak NSArray *weakEvents = nil;
+	@autoreleasepool {
+		weakEvents = self.defaultTrack.events;
+		XCTAssertEqual(weakEvents.count, 1);
+	}
+	XCTAssertNil(weakEvents, @"The track shouldn't keep the array of its events either");
+	XCTAssertEqualObjects(self.defaultTrack.events, @[[MIKMIDINoteEvent noteEventWithTimeStamp:1 note:60 velocity:100 duration:1 channel:0]]);
+}
+
+#pragma mark - Sounding Notes
+
+- (void)testNotesSoundingAtTimeStamp
+{
+	MIKMIDINoteEvent *longNote = [MIKMIDINoteEvent noteEventWithTimeStamp:0 note:60 velocity:100 duration:8 channel:0];
+	MIKMIDINoteEvent *shortNote = [MIKMIDINoteEvent noteEventWithTimeStamp:2 note:62 velocity:100 duration:1 channel:0];
+	MIKMIDINoteEvent *emptyNote = [MIKMIDINoteEvent noteEventWithTimeStamp:4 note:64 velocity:100 duration:0 channel:0];
+	[self.defaultTrack addEvents:@[longNote, shortNote, emptyNote]];
+
+	XCTAssertEqualObjects([self.defaultTrack notesSoundingAtTimeStamp:0], (@[longNote]));
+	XCTAssertEqualObjects([self.defaultTrack notesSoundingAtTimeStamp:2], (@[longNote, shortNote]));
+	XCTAssertEqualObjects([self.defaultTrack notesSoundingAtTimeStamp:2.5], (@[longNote, shortNote]));
+	XCTAssertEqualObjects([self.defaultTrack notesSoundingAtTimeStamp:3], (@[longNote]), @"Notes shouldn't sound at their end time stamp");
+	XCTAssertEqualObjects([self.defaultTrack notesSoundingAtTimeStamp:4], (@[longNote]), @"Notes with no duration never sound");
+	XCTAssertEqualObjects([self.defaultTrack notesSoundingAtTimeStamp:8], @[]);
+	XCTAssertEqualObjects([self.defaultTrack notesSoundingAtTimeStamp:-1], @[]);
+
+	[self.defaultTrack removeEvent:longNote];
+	XCTAssertEqualObjects([self.defaultTrack notesSoundingAtTimeStamp:2.5], (@[shortNote]), @"Removed notes should no longer be found");
+}
+
+- (void)testNotesOverlappingRange
+{
+	MIKMIDINoteEvent *longNote = [MIKMIDINoteEvent noteEventWithTimeStamp:0 note:60 velocity:100 duration:8 channel:0];
+	MIKMIDINoteEvent *shortNote = [MIKMIDINoteEvent noteEventWithTimeStamp:2 note:62 velocity:100 duration:1 channel:0];
+	MIKMIDINoteEvent *emptyNote = [MIKMIDINoteEvent noteEventWithTimeStamp:4 note:64 velocity:100 duration:0 channel:0];
+	[self.defaultTrack addEvents:@[longNote, shortNote, emptyNote]];
+
+	XCTAssertEqualObjects([self.defaultTrack notesOverlappingRangeFromTimeStamp:1 toTimeStamp:2], (@[longNote]), @"The end of the range should be excluded");
+	XCTAssertEqualObjects([self.defaultTrack notesOverlappingRangeFromTimeStamp:2.5 toTimeStamp:4], (@[longNote, shortNote]));
+	XCTAssertEqualObjects([self.defaultTrack notesOverlappingRangeFromTimeStamp:3 toTimeStamp:5], (@[longNote, emptyNote]), @"Notes with no duration should be found if they start in the range");
+	XCTAssertEqualObjects([self.defaultTrack notesOverlappingRangeFromTimeStamp:8 toTimeStamp:10], @[]);
+	XCTAssertEqualObjects([self.defaultTrack notesOverlappingRangeFromTimeStamp:4 toTimeStamp:4], @[]);
+}
+
+- (void)testSoundingNotesMatchAllNotes
+{
+	srandom(42);
+	NSMutableArray *notes = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 1000; i++) {
+		MusicTimeStamp timeStamp = (random() % 400) / 4.0;
+		Float32 duration = (random() % 40) / 4.0;
+		[notes addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:timeStamp note:i % 128 velocity:i / 128 + 1 duration:duration channel:0]];
+	}
+	[self.defaultTrack addEvents:notes];
+	NSArray *allNotes = self.defaultTrack.notes;
+
+	for (MusicTimeStamp timeStamp = -1; timeStamp < 110; timeStamp += 0.375) {
+		NSPredicate *sounding = [NSPredicate predicateWithBlock:^BOOL(MIKMIDINoteEvent *note, NSDictionary *bindings) {
+			return note.timeStamp <= timeStamp && note.endTimeStamp > timeStamp;
+		}];
+		XCTAssertEqualObjects([self.defaultTrack notesSoundingAtTimeStamp:timeStamp], [allNotes filteredArrayUsingPredicate:sounding]);
+
+		MusicTimeStamp endTimeStamp = timeStamp + 2.5;
+		NSPredicate *overlapping = [NSPredicate predicateWithBlock:^BOOL(MIKMIDINoteEvent *note, NSDictionary *bindings) {
+			if (note.timeStamp >= endTimeStamp) return NO;
+			return note.timeStamp >= timeStamp || note.endTimeStamp > timeStamp;
+		}];
+		XCTAssertEqualObjects([self.defaultTrack notesOverlappingRangeFromTimeStamp:timeStamp toTimeStamp:endTimeStamp], [allNotes filteredArrayUsingPredicate:overlapping]);
+	}
+}
+
 #pragma mark - Moving Events
 
 - (void)testMovingSingleEvent
@@ -888,6 +1070,71 @@
 	[self.defaultTrack removeObserver:self forKeyPath:@"doesLoop"];
 }
 
+#pragma mark - Performance
+
+- (MIKMIDITrack *)trackWithNumberOfEvents:(NSUInteger)numberOfEvents
+{
+	MIKMIDITrack *track = [self.defaultSequence addTrack];
+	NSMutableArray *events = [NSMutableArray arrayWithCapacity:numberOfEvents];
+	for (NSUInteger i = 0; i < numberOfEvents; i++) {
+		[events addObject:[MIKMIDINoteEvent noteEventWithTimeStamp:i / 8.0 note:i % 128 velocity:100 duration:0.125 channel:0]];
+	}
+	[track addEvents:events];
+	return track;
+}
+
+- (void)testRangeQueryPerformance
+{
+	MIKMIDITrack *track = [self trackWithNumberOfEvents:100000];
+	MusicTimeStamp length = track.length;
+	[self measureBlock:^{
+		// The sequencer asks each track for the next slice of events every 50 ms or so.
+		for (MusicTimeStamp start = 0; start < length; start += 2) {
+			[track eventsFromTimeStamp:start toTimeStamp:start + 1];
+		}
+	}];
+}
+
+- (void)testSoundingNotesQueryPerformance
+{
+	MIKMIDITrack *track = [self trackWithNumberOfEvents:100000];
+	MusicTimeStamp length = track.length;
+	[track notesSoundingAtTimeStamp:0]; // Build the index outside of the measurement
+	[self measureBlock:^{
+		// Like seeking repeatedly while scrubbing
+		for (MusicTimeStamp timeStamp = 0; timeStamp < length; timeStamp += 2) {
+			[track notesSoundingAtTimeStamp:timeStamp];
+		}
+	}];
+}
+
+- (void)testMemoryFootprintOfLargeTrack
+{
+	if (@available(macOS 10.15, *)) {
+		[self measureWithMetrics:@[[[XCTMemoryMetric alloc] init]] block:^{
+			MIKMIDITrack *track = [self trackWithNumberOfEvents:200000];
+			XCTAssertGreaterThan(track.length, 0);
+			[self.defaultSequence removeTrack:track];
+		}];
+	}
+}
+
+- (void)testAddingEventsPerformance
+{
+	MIKMIDITrack *track = [self trackWithNumberOfEvents:100000];
+	MusicTimeStamp length = track.length;
+	[self measureBlock:^{
+		// Like recording, interleaved with playback asking for events
+		for (NSUInteger i = 0; i < 100; i++) {
+			MusicTimeStamp timeStamp = length * i / 100;
+			MIKMIDINoteEvent *event = [MIKMIDINoteEvent noteEventWithTimeStamp:timeStamp + 0.01 note:60 velocity:1 duration:1 channel:1];
+			[track addEvent:event];
+			[track eventsFromTimeStamp:timeStamp toTimeStamp:timeStamp + 0.5];
+			[track removeEvent:event];
+		}
+	}];
+}
+
 #pragma mark - (KVO Test Helper)
 
 - (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
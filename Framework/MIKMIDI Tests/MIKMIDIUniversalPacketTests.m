@@ -0,0 +1,261 @@
+//
+//  MIKMIDIUniversalPacketTests.m
+//  MIKMIDI Tests
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright © 2026 Mixed In Key. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <MIKMIDI/MIKMIDI.h>
+#import <MIKMIDI/MIKMIDIUniversalPacket.h>
+
+@interface MIKMIDIUniversalPacketTests : XCTestCase
+
+@end
+
+@implementation MIKMIDIUniversalPacketTests
+
+#pragma mark - Helpers
+
+- (NSArray *)wordsWithData:(NSData *)data
+{
+	NSMutableArray *result = [NSMutableArray array];
+	const UInt32 *words = data.bytes;
+	for (NSUInteger i = 0; i < data.length / sizeof(UInt32); i++) {
+		[result addObject:@(words[i])];
+	}
+	return result;
+}
+
+- (NSArray *)commandsWithWords:(NSArray *)wordNumbers
+{
+	UInt32 words[wordNumbers.count];
+	for (NSUInteger i = 0; i < wordNumbers.count; i++) {
+		words[i] = [wordNumbers[i] unsignedIntValue];
+	}
+	return [MIKMIDICommand commandsWithUniversalMIDIPacketWords:words count:wordNumbers.count timeStamp:1234];
+}
+
+#pragma mark - Portable Core
+
+- (void)testScalingValues
+{
+	XCTAssertEqual(MIKMIDIUniversalScaleUp(0, 7, 32), 0);
+	XCTAssertEqual(MIKMIDIUniversalScaleUp(64, 7, 32), 0x80000000);
+	XCTAssertEqual(MIKMIDIUniversalScaleUp(127, 7, 32), 0xFFFFFFFF);
+	XCTAssertEqual(MIKMIDIUniversalScaleUp(127, 7, 16), 0xFFFF);
+	XCTAssertEqual(MIKMIDIUniversalScaleUp(0x2000, 14, 32), 0x80000000);
+	XCTAssertEqual(MIKMIDIUniversalScaleUp(0x3FFF, 14, 32), 0xFFFFFFFF);
+
+	for (UInt32 value = 0; value < 0x4000; value++) {
+		if (value < 0x80) {
+			XCTAssertEqual(MIKMIDIUniversalScaleDown(MIKMIDIUniversalScaleUp(value, 7, 16), 16, 7), value);
+			XCTAssertEqual(MIKMIDIUniversalScaleDown(MIKMIDIUniversalScaleUp(value, 7, 32), 32, 7), value);
+		}
+		XCTAssertEqual(MIKMIDIUniversalScaleDown(MIKMIDIUniversalScaleUp(value, 14, 32), 32, 14), value);
+	}
+}
+
+- (void)testParsingAndWritingPackets
+{
+	// A MIDI 1.0 note on, a MIDI 2.0 note on, a clock, a 128-bit data message, and the first half of a MIDI 2.0 control change
+	UInt32 words[] = {0x20903C64, 0x40903C00, 0xFFFF0000, 0x10F80000, 0x50000000, 1, 2, 3, 0x40B00700};
+	MIKMIDIUniversalMessage messages[8];
+	size_t wordsConsumed = 0;
+	size_t count = MIKMIDIUniversalPacketParse(words, 9, messages, 8, &wordsConsumed);
+	XCTAssertEqual(count, 4);
+	XCTAssertEqual(wordsConsumed, 8, @"The cut off control change should be left for the next call.");
+	XCTAssertEqual(MIKMIDIUniversalMessageGetType(&messages[1]), MIKMIDIUniversalMessageTypeMIDI2ChannelVoice);
+	XCTAssertEqual(MIKMIDIUniversalMessageGetStatus(&messages[1]), 0x90);
+	XCTAssertEqual(MIKMIDIUniversalMessageGetData1(&messages[1]), 0x3C);
+	XCTAssertEqual(MIKMIDIUniversalMessageGetValue(&messages[1]), 0xFFFF0000);
+	XCTAssertEqual(messages[3].words[3], 3);
+
+	UInt32 written[16];
+	XCTAssertEqual(MIKMIDIUniversalPacketWrite(messages, count, written, 16), 8);
+	XCTAssertEqual(memcmp(written, words, 8 * sizeof(UInt32)), 0);
+	XCTAssertEqual(MIKMIDIUniversalPacketWrite(messages, count, written, 7), 4, @"Writing should stop at the first message that doesn't fit.");
+
+	UInt8 bytes[9 * 4];
+	UInt32 wordsFromBytes[9];
+	MIKMIDIUniversalPacketWordsToBytes(words, 9, bytes);
+	XCTAssertEqual(bytes[0], 0x20);
+	XCTAssertEqual(bytes[3], 0x64);
+	MIKMIDIUniversalPacketBytesToWords(bytes, 9, wordsFromBytes);
+	XCTAssertEqual(memcmp(wordsFromBytes, words, sizeof(words)), 0);
+}
+
+- (void)testTranslatingChannelVoiceMessages
+{
+	MIKMIDIUniversalMessage midi1, midi2;
+	MIKMIDIUniversalMessage results[MIKMIDIUniversalMessageMaximumMIDI1TranslationCount];
+
+	MIKMIDIUniversalMessageMakeMIDI1(0, 0x90, 60, 100, &midi1);
+	XCTAssertTrue(MIKMIDIUniversalMessageTranslateToMIDI2(&midi1, &midi2));
+	XCTAssertEqual(midi2.words[0], 0x40903C00);
+	XCTAssertEqual(midi2.words[1], 0xC9240000);
+	XCTAssertEqual(MIKMIDIUniversalMessageTranslateToMIDI1(&midi2, results, 1), 1);
+	XCTAssertEqual(results[0].words[0], midi1.words[0]);
+
+	MIKMIDIUniversalMessageMakeMIDI1(0, 0x91, 60, 0, &midi1);
+	MIKMIDIUniversalMessageTranslateToMIDI2(&midi1, &midi2);
+	XCTAssertEqual(MIKMIDIUniversalMessageGetStatus(&midi2), 0x81, @"A note on with a velocity of 0 should become a note off.");
+	XCTAssertEqual(midi2.words[1], 0x80000000);
+
+	MIKMIDIUniversalMessageMakeMIDI1(0, 0xE0, 0x7F, 0x7F, &midi1);
+	MIKMIDIUniversalMessageTranslateToMIDI2(&midi1, &midi2);
+	XCTAssertEqual(midi2.words[1], 0xFFFFFFFF);
+
+	midi2 = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(0, 0x90, 60, 0, 0x01000000);
+	XCTAssertEqual(MIKMIDIUniversalMessageTranslateToMIDI1(&midi2, results, 1), 1);
+	XCTAssertEqual(MIKMIDIUniversalMessageGetData2(&results[0]), 1, @"A quiet note on shouldn't become a note off.");
+
+	midi2 = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(2, MIKMIDIUniversalOpcodeRegisteredController | 3, 0, 1, 0x80000000);
+	XCTAssertEqual(MIKMIDIUniversalMessageTranslateToMIDI1(&midi2, results, 3), 0);
+	XCTAssertEqual(MIKMIDIUniversalMessageTranslateToMIDI1(&midi2, results, 4), 4);
+	UInt32 expectedRPN[] = {0x22B36500, 0x22B36401, 0x22B30640, 0x22B32600};
+	for (NSUInteger i = 0; i < 4; i++) XCTAssertEqual(results[i].words[0], expectedRPN[i]);
+
+	midi2 = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(0, 0xC5, 0, MIKMIDIUniversalProgramChangeFlagBankValid, (5 << 24) | (1 << 8) | 2);
+	XCTAssertEqual(MIKMIDIUniversalMessageTranslateToMIDI1(&midi2, results, 4), 3);
+	UInt32 expectedProgramChange[] = {0x20B50001, 0x20B52002, 0x20C50500};
+	for (NSUInteger i = 0; i < 3; i++) XCTAssertEqual(results[i].words[0], expectedProgramChange[i]);
+
+	midi2 = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(0, MIKMIDIUniversalOpcodePerNotePitchBend, 60, 0, 0);
+	XCTAssertEqual(MIKMIDIUniversalMessageTranslateToMIDI1(&midi2, results, 4), 0);
+	XCTAssertFalse(MIKMIDIUniversalMessageMakeMIDI1(0, 0xF0, 0, 0, &midi1));
+}
+
+- (void)testSplittingSystemExclusiveMessages
+{
+	UInt8 sysex[] = {0xF0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 0xF7};
+	MIKMIDIUniversalMessage messages[4];
+	XCTAssertEqual(MIKMIDIUniversalSystemExclusiveMessageCount(13), 3);
+	XCTAssertEqual(MIKMIDIUniversalMessagesMakeSystemExclusive(0, sysex, sizeof(sysex), messages, 2), 0);
+	XCTAssertEqual(MIKMIDIUniversalMessagesMakeSystemExclusive(0, sysex, sizeof(sysex), messages, 4), 3);
+
+	UInt8 bytes[18];
+	UInt8 statuses[3];
+	size_t length = 0;
+	for (NSUInteger i = 0; i < 3; i++) {
+		length += MIKMIDIUniversalMessageGetSystemExclusiveBytes(&messages[i], bytes + length, &statuses[i]);
+	}
+	XCTAssertEqual(length, 13);
+	XCTAssertEqual(memcmp(bytes, sysex + 1, 13), 0);
+	XCTAssertEqual(statuses[0], MIKMIDIUniversalSystemExclusiveStatusStart);
+	XCTAssertEqual(statuses[1], MIKMIDIUniversalSystemExclusiveStatusContinue);
+	XCTAssertEqual(statuses[2], MIKMIDIUniversalSystemExclusiveStatusEnd);
+}
+
+#pragma mark - Commands
+
+- (void)testHighResolutionValues
+{
+	MIKMutableMIDIControlChangeCommand *controlChange = [MIKMutableMIDIControlChangeCommand controlChangeCommandWithControllerNumber:7 value:127];
+	XCTAssertEqual(controlChange.highResolutionValue, 0xFFFFFFFF);
+	controlChange.highResolutionValue = 0x80000001;
+	XCTAssertEqual(controlChange.controllerValue, 64);
+	XCTAssertEqual(controlChange.highResolutionValue, 0x80000001);
+	XCTAssertEqual([[controlChange copy] highResolutionValue], 0x80000001);
+	controlChange.controllerValue = 1;
+	XCTAssertEqual(controlChange.highResolutionValue, MIKMIDIUniversalScaleUp(1, 7, 32), @"Changing the MIDI 1.0 value should replace the high resolution value.");
+
+	MIKMIDIControlChangeCommand *fourteenBit = [MIKMIDIControlChangeCommand fourteenBitControlChangeCommandWithControllerNumber:1 value:0x3FFF];
+	XCTAssertEqual(fourteenBit.highResolutionValue, 0xFFFFFFFF);
+
+	MIKMutableMIDINoteOnCommand *noteOn = [MIKMutableMIDINoteOnCommand noteOnCommandWithNote:60 velocity:100 channel:0 timestamp:nil];
+	XCTAssertEqual(noteOn.highResolutionValue, 0xC924);
+	noteOn.highResolutionValue = 0x0100;
+	XCTAssertEqual(noteOn.velocity, 1, @"A quiet note on shouldn't become a note off.");
+	XCTAssertEqual(noteOn.highResolutionValue, 0x0100);
+
+	MIKMIDIPitchBendChangeCommand *pitchBend = [MIKMIDIPitchBendChangeCommand commandForCommandType:MIKMIDICommandTypePitchWheelChange];
+	XCTAssertEqual(pitchBend.highResolutionValue, 0);
+
+	MIKMutableMIDIProgramChangeCommand *programChange = [MIKMutableMIDIProgramChangeCommand commandForCommandType:MIKMIDICommandTypeProgramChange];
+	programChange.programNumber = 42;
+	XCTAssertEqual(programChange.highResolutionValue, 42);
+}
+
+- (void)testCreatingCommandsFromMIDI2Messages
+{
+	NSArray *commands = [self commandsWithWords:@[@0x40913C00, @0x01000000, // Very quiet note on
+												  @0x40B20700, @0x12345678, // Control change
+												  @0x40E00000, @0xFFFFFFFF, // Pitch bend
+												  @0x42230102, @0xC0000000, // RPN on group 2
+												  @0x40600000, @0, // Per-note pitch bend, skipped
+												  @0x10F80000, // Clock
+												  @0x30160102, @0x03040506, @0x30320708, @0, // System exclusive
+												  @0x40B00700]]; // Cut off
+	XCTAssertEqual(commands.count, 6);
+
+	MIKMIDINoteOnCommand *noteOn = commands[0];
+	XCTAssertEqualObjects([noteOn class], [MIKMIDINoteOnCommand class]);
+	XCTAssertEqual(noteOn.channel, 1);
+	XCTAssertEqual(noteOn.note, 60);
+	XCTAssertEqual(noteOn.velocity, 1);
+	XCTAssertEqual(noteOn.highResolutionValue, 0x0100);
+	XCTAssertEqual(noteOn.midiTimestamp, 1234);
+
+	MIKMIDIControlChangeCommand *controlChange = commands[1];
+	XCTAssertEqual(controlChange.controllerNumber, 7);
+	XCTAssertEqual(controlChange.controllerValue, 0x12 >> 1);
+	XCTAssertEqual(controlChange.highResolutionValue, 0x12345678);
+
+	MIKMIDIPitchBendChangeCommand *pitchBend = commands[2];
+	XCTAssertEqual(pitchBend.pitchChange, 0x3FFF);
+	XCTAssertEqual(pitchBend.highResolutionValue, 0xFFFFFFFF);
+
+	MIKMIDIParameterChangeCommand *parameterChange = commands[3];
+	XCTAssertEqualObjects([parameterChange class], [MIKMIDIParameterChangeCommand class]);
+	XCTAssertEqual(parameterChange.parameterType, MIKMIDIParameterTypeRegistered);
+	XCTAssertEqual(parameterChange.channel, 3);
+	XCTAssertEqual(parameterChange.parameterNumber, (1 << 7) | 2);
+	XCTAssertEqual(parameterChange.value, 0x3000);
+	XCTAssertEqual(parameterChange.highResolutionValue, 0xC0000000);
+
+	MIKMIDICommand *clock = commands[4];
+	XCTAssertEqual(clock.commandType, MIKMIDICommandTypeSystemTimingClock);
+	MIKMIDISystemExclusiveCommand *sysexCommand = commands[5];
+	UInt8 sysex[] = {0xF0, 1, 2, 3, 4, 5, 6, 7, 8, 0xF7};
+	XCTAssertEqualObjects(sysexCommand.data, [NSData dataWithBytes:sysex length:sizeof(sysex)]);
+}
+
+- (void)testWritingCommandsAsUniversalMIDIPackets
+{
+	MIKMutableMIDIControlChangeCommand *controlChange = [MIKMutableMIDIControlChangeCommand controlChangeCommandWithControllerNumber:7 value:0];
+	controlChange.channel = 2;
+	controlChange.highResolutionValue = 0x12345678;
+	XCTAssertEqualObjects([self wordsWithData:[controlChange universalMIDIPacketDataWithProtocol:MIKMIDIProtocol2_0 group:1]], (@[@0x41B20700, @0x12345678]));
+	XCTAssertEqualObjects([self wordsWithData:[controlChange universalMIDIPacketDataWithProtocol:MIKMIDIProtocol1_0 group:1]], (@[@0x21B20709]));
+
+	// MIDI 2.0 doesn't need MSB and LSB control changes, or parameter number and data entry control changes
+	MIKMIDIControlChangeCommand *fourteenBit = [MIKMIDIControlChangeCommand fourteenBitControlChangeCommandWithControllerNumber:1 value:0x2000];
+	XCTAssertEqualObjects([self wordsWithData:[fourteenBit universalMIDIPacketDataWithProtocol:MIKMIDIProtocol2_0 group:0]], (@[@0x40B00100, @0x80000000]));
+	XCTAssertEqualObjects([self wordsWithData:[fourteenBit universalMIDIPacketDataWithProtocol:MIKMIDIProtocol1_0 group:0]], (@[@0x20B00140, @0x20B02100]));
+
+	MIKMIDIParameterChangeCommand *parameterChange = [MIKMIDIParameterChangeCommand parameterChangeCommandWithParameterType:MIKMIDIParameterTypeNonRegistered parameterNumber:(3 << 7) | 4 value:0x3FFF];
+	XCTAssertEqualObjects([self wordsWithData:[parameterChange universalMIDIPacketDataWithProtocol:MIKMIDIProtocol2_0 group:0]], (@[@0x40300304, @0xFFFFFFFF]));
+	XCTAssertEqual([parameterChange universalMIDIPacketDataWithProtocol:MIKMIDIProtocol1_0 group:0].length, 4 * sizeof(UInt32));
+
+	MIKMIDINoteOnCommand *noteOff = [MIKMIDINoteOnCommand noteOnCommandWithNote:60 velocity:0 channel:0 timestamp:nil];
+	XCTAssertEqualObjects([self wordsWithData:[noteOff universalMIDIPacketDataWithProtocol:MIKMIDIProtocol2_0 group:0]], (@[@0x40803C00, @0x80000000]));
+
+	MIDIPacket packet = {0};
+	packet.length = 1;
+	packet.data[0] = MIKMIDICommandTypeSystemTimingClock;
+	MIKMIDICommand *clock = [MIKMIDICommand commandWithMIDIPacket:&packet];
+	XCTAssertEqualObjects([self wordsWithData:[clock universalMIDIPacketDataWithProtocol:MIKMIDIProtocol2_0 group:0]], (@[@0x10F80000]));
+
+	// Commands should survive a round trip through MIDI 2.0 with their full resolution
+	NSArray *commands = @[controlChange, fourteenBit, parameterChange];
+	for (MIKMIDIChannelVoiceCommand *command in commands) {
+		NSData *data = [command universalMIDIPacketDataWithProtocol:MIKMIDIProtocol2_0 group:0];
+		MIKMIDIChannelVoiceCommand *result = [[MIKMIDICommand commandsWithUniversalMIDIPacketWords:data.bytes count:data.length / sizeof(UInt32) timeStamp:0] firstObject];
+		XCTAssertEqual(result.highResolutionValue, command.highResolutionValue);
+		XCTAssertEqual(result.channel, command.channel);
+	}
+}
+
+@end
@@ -14,6 +14,7 @@
 // MIDI port
 #import "MIKMIDIPort.h"
 #import "MIKMIDIInputPort.h"
+#import "MIKMIDIInputFilter.h"
 #import "MIKMIDIOutputPort.h"
 
 // MIDI Device support
@@ -38,16 +39,19 @@
 #import "MIKMIDIControlChangeCommand.h"
 #import "MIKMIDIProgramChangeCommand.h"
 #import "MIKMIDIPitchBendChangeCommand.h"
+#import "MIKMIDIParameterChangeCommand.h"
 #import "MIKMIDINoteOnCommand.h"
 #import "MIKMIDINoteOffCommand.h"
 #import "MIKMIDIPolyphonicKeyPressureCommand.h"
 #import "MIKMIDISystemExclusiveCommand.h"
+#import "MIKMIDISystemExclusiveSender.h"
 #import "MIKMIDISystemMessageCommand.h"
 #import "MIKMIDISystemKeepAliveCommand.h"
 
 // MIDI Sequence/File support
 #import "MIKMIDISequence.h"
 #import "MIKMIDITrack.h"
+#import "MIKMIDITempoMap.h"
 
 // MIDI Events
 #import "MIKMIDIEvent.h"
@@ -79,6 +83,9 @@
 #import "MIKMIDISequencer.h"
 #import "MIKMIDIMetronome.h"
 #import "MIKMIDIClock.h"
+#import "MIKMIDITimeSource.h"
+#import "MIKMIDIHostTimeSource.h"
+#import "MIKMIDISimulatedTimeSource.h"
 #import "MIKMIDIPlayer.h"
 #import "MIKMIDIEndpointSynthesizer.h"
 
@@ -43,6 +43,7 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, readwrite) MIDITimeStamp midiTimestamp;
 @property (nonatomic, readwrite) UInt8 channel;
 @property (nonatomic, readwrite) NSUInteger value;
+@property (nonatomic, readwrite) UInt32 highResolutionValue;
 
 @end
 
@@ -45,6 +45,9 @@
 	self.dataByte1 = value;
 }
 
+- (NSUInteger)lowResolutionValue { return self.pressure; }
+- (void)setLowResolutionValue:(NSUInteger)value { self.pressure = value; }
+
 @end
 
 #pragma mark -
@@ -60,6 +63,7 @@
 // MIKMIDICommand already implements these. This keeps the compiler happy.
 @dynamic channel;
 @dynamic value;
+@dynamic highResolutionValue;
 @dynamic timestamp;
 @dynamic dataByte1;
 @dynamic dataByte2;
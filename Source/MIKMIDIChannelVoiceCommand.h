@@ -33,6 +33,20 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly) NSUInteger value;
 
+/**
+ *  The value of the command at MIDI 2.0 resolution. This is a 16-bit value for
+ *  note on and note off velocities, and a 32-bit value for control changes,
+ *  RPN and NRPN parameter changes, key and channel pressure, and pitch bends.
+ *  For program changes, it is the same as the program number.
+ *
+ *  For commands created from MIDI 2.0 messages, this is the value as it was
+ *  received. Otherwise, it is the command's MIDI 1.0 value (including the LSB of
+ *  14-bit control changes), scaled up as described in the MIDI 2.0 specification.
+ *
+ *  @see -[MIKMIDICommand universalMIDIPacketDataWithProtocol:group:]
+ */
+@property (nonatomic, readonly) UInt32 highResolutionValue;
+
 @end
 
 /**
@@ -43,6 +57,11 @@ NS_ASSUME_NONNULL_BEGIN
 @property (nonatomic, readwrite) UInt8 channel;
 @property (nonatomic, readwrite) NSUInteger value;
 
+/**
+ *  Setting this also sets the command's MIDI 1.0 value to the new value, scaled down.
+ */
+@property (nonatomic, readwrite) UInt32 highResolutionValue;
+
 @property (nonatomic, strong, readwrite) NSDate *timestamp;
 @property (nonatomic, readwrite) MIKMIDICommandType commandType;
 @property (nonatomic, readwrite) UInt8 dataByte1;
@@ -10,6 +10,7 @@
 #import "MIKMIDIChannelVoiceCommand.h"
 #import "MIKMIDICommand_SubclassMethods.h"
 #import "MIKMIDIUtilities.h"
+#import "MIKMIDIUniversalPacket.h"
 
 #if !__has_feature(objc_arc)
 #error MIKMIDIChannelVoiceCommand.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIChannelVoiceCommand.m in the Build Phases for this target
@@ -19,10 +20,18 @@
 
 @property (nonatomic, readwrite) UInt8 channel;
 @property (nonatomic, readwrite) NSUInteger value;
+@property (nonatomic, readwrite) UInt32 highResolutionValue;
 
 @end
 
 @implementation MIKMIDIChannelVoiceCommand
+{
+	// A value with more resolution than the MIDI 1.0 data holds. Only used while the data
+	// still has the MIDI 1.0 value it had when this was set.
+	BOOL _hasHighResolutionValue;
+	UInt32 _highResolutionValue;
+	NSUInteger _lowResolutionValueForHighResolutionValue;
+}
 
 + (void)load { [super load]; [MIKMIDICommand registerSubclass:self]; }
 + (NSArray *)supportedMIDICommandTypes { return  @[]; }
@@ -48,6 +57,48 @@
 	return [NSString stringWithFormat:@"channel %d", self.channel];
 }
 
+- (id)copyWithZone:(NSZone *)zone
+{
+	MIKMIDIChannelVoiceCommand *result = [super copyWithZone:zone];
+	[result takeHighResolutionValueFromCommand:self];
+	return result;
+}
+
+- (id)mutableCopy
+{
+	MIKMIDIChannelVoiceCommand *result = [super mutableCopy];
+	[result takeHighResolutionValueFromCommand:self];
+	return result;
+}
+
+- (NSData *)universalMIDIPacketDataWithProtocol:(MIKMIDIProtocol)protocol group:(UInt8)group
+{
+	UInt8 bitCount = [[self class] highResolutionValueBitCount];
+	UInt8 status = self.statusByte;
+	if (protocol != MIKMIDIProtocol2_0 || bitCount < 16 || status < 0x80 || status >= 0xF0) {
+		return [super universalMIDIPacketDataWithProtocol:protocol group:group];
+	}
+	// A MIDI 1.0 note on with a velocity of 0 is a note off, which translation takes care of
+	if ((status & 0xF0) == 0x90 && self.lowResolutionValue == 0) {
+		return [super universalMIDIPacketDataWithProtocol:protocol group:group];
+	}
+
+	UInt8 index = ((status & 0xF0) < 0xC0) ? self.dataByte1 & 0x7F : 0; // Note or controller number
+	UInt32 value = self.highResolutionValue;
+	if (bitCount == 16) value <<= 16; // Note velocities are in the top 16 bits, above attribute data
+	MIKMIDIUniversalMessage message = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(group, status, index, 0, value);
+	return [NSData dataWithBytes:message.words length:MIKMIDIUniversalMessageWordCountForType(MIKMIDIUniversalMessageTypeMIDI2ChannelVoice) * sizeof(UInt32)];
+}
+
+#pragma mark - Private
+
+- (void)takeHighResolutionValueFromCommand:(MIKMIDIChannelVoiceCommand *)command
+{
+	_hasHighResolutionValue = command->_hasHighResolutionValue;
+	_highResolutionValue = command->_highResolutionValue;
+	_lowResolutionValueForHighResolutionValue = command->_lowResolutionValueForHighResolutionValue;
+}
+
 #pragma mark - Properties
 
 - (UInt8)channel
@@ -76,6 +127,32 @@
 	self.dataByte2 = value & 0x7F;
 }
 
++ (UInt8)highResolutionValueBitCount { return 32; }
+
+- (UInt8)lowResolutionValueBitCount { return 7; }
+- (NSUInteger)lowResolutionValue { return self.value; }
+- (void)setLowResolutionValue:(NSUInteger)value { self.value = value; }
+
+- (UInt32)highResolutionValue
+{
+	NSUInteger lowResolutionValue = self.lowResolutionValue;
+	if (_hasHighResolutionValue && lowResolutionValue == _lowResolutionValueForHighResolutionValue) return _highResolutionValue;
+	return MIKMIDIUniversalScaleUp((UInt32)lowResolutionValue, self.lowResolutionValueBitCount, [[self class] highResolutionValueBitCount]);
+}
+
+- (void)setHighResolutionValue:(UInt32)highResolutionValue
+{
+	if (![[self class] isMutable]) return MIKMIDI_RAISE_MUTATION_ATTEMPT_EXCEPTION;
+	
+	UInt8 bitCount = [[self class] highResolutionValueBitCount];
+	if (bitCount < 32) highResolutionValue = MIN(highResolutionValue, (1U << bitCount) - 1);
+	self.lowResolutionValue = MIKMIDIUniversalScaleDown(highResolutionValue, bitCount, self.lowResolutionValueBitCount);
+	
+	_highResolutionValue = highResolutionValue;
+	_lowResolutionValueForHighResolutionValue = self.lowResolutionValue;
+	_hasHighResolutionValue = YES;
+}
+
 @end
 
 @implementation MIKMutableMIDIChannelVoiceCommand
@@ -92,6 +169,7 @@
 // MIKMIDICommand already implements these. This keeps the compiler happy.
 @dynamic channel;
 @dynamic value;
+@dynamic highResolutionValue;
 @dynamic timestamp;
 @dynamic dataByte1;
 @dynamic dataByte2;
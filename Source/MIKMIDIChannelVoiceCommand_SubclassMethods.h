@@ -15,6 +15,24 @@ NS_ASSUME_NONNULL_BEGIN
 @interface MIKMIDIChannelVoiceCommand ()
 
 @property (nonatomic, readwrite) NSUInteger value;
+@property (nonatomic, readwrite) UInt32 highResolutionValue;
+
+/**
+ *  The number of bits in highResolutionValue. Subclasses override this if it isn't 32.
+ */
++ (UInt8)highResolutionValueBitCount;
+
+/**
+ *  The MIDI 1.0 value that highResolutionValue is scaled from and to. By default, this is value.
+ *  Subclasses whose MIDI 1.0 value is elsewhere, or has more than 7 bits, override this and
+ *  lowResolutionValueBitCount.
+ */
+@property (nonatomic, readwrite) NSUInteger lowResolutionValue;
+
+/**
+ *  The number of bits in lowResolutionValue. 7 by default.
+ */
+@property (nonatomic, readonly) UInt8 lowResolutionValueBitCount;
 
 @end
 
@@ -9,8 +9,13 @@
 #import "MIKMIDICommand.h"
 #import "MIKMIDIErrors.h"
 #import "MIKMIDICommand_SubclassMethods.h"
+#import "MIKMIDIPacketListArena.h"
+#import "MIKMIDIPrivateUtilities.h"
 
 @implementation MIKMIDIClientSourceEndpoint
+{
+	MIKMIDIPacketListArena *_packetListArena;
+}
 
 + (NSArray *)representedMIDIObjectTypes; { return @[@(kMIDIObjectType_Source)]; }
 
@@ -43,6 +48,7 @@
 	
 	self = [super initWithObjectRef:midiOut];
 	if (self) {
+		_packetListArena = [[MIKMIDIPacketListArena alloc] init];
 	}
 	return self;
 }
@@ -54,16 +60,17 @@
 
 - (BOOL)sendCommands:(NSArray *)commands error:(NSError **)error
 {
-    commands = [self commandsByTransformingForTransmissionCommands:commands];
+    commands = MIKMIDICommandsByTransformingForTransmission(commands);
     if (![commands count]) return NO;
 
     error = error ? error : &(NSError *__autoreleasing){ nil };
 
-    MIDIPacketList *packetList;
-    if (!MIKCreateMIDIPacketListFromCommands(&packetList, commands)) return NO;
-    OSStatus err = MIDIReceived(self.objectRef, packetList);
-
-    free(packetList);
+    MIDIEndpointRef endpointRef = self.objectRef;
+    __block OSStatus err = noErr;
+    BOOL encoded = [_packetListArena encodeCommands:commands usingBlock:^(const MIDIPacketList *packetList) {
+        err = MIDIReceived(endpointRef, packetList);
+    }];
+    if (!encoded) return NO;
     if (err != noErr) {
         *error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
         return NO;
@@ -72,19 +79,4 @@
     return YES;
 }
 
-#pragma mark - Private
-
-- (NSArray *)commandsByTransformingForTransmissionCommands:(NSArray *)commands
-{
-    NSMutableArray *transformedCommands = [NSMutableArray array];
-    for (MIKMIDICommand *command in commands) {
-        if ([command respondsToSelector:@selector(commandsForTransmission)]) {
-            [transformedCommands addObjectsFromArray:[command commandsForTransmission]];
-        } else {
-            [transformedCommands addObject:command];
-        }
-    }
-    return transformedCommands;
-}
-
 @end
@@ -10,6 +10,8 @@
 #import <AudioToolbox/AudioToolbox.h>
 #import "MIKMIDICompilerCompatibility.h"
 
+@protocol MIKMIDITimeSource;
+
 /**
  *  Returns the number of MIDITimeStamps that would occur during a specified time interval.
  *
@@ -34,6 +36,10 @@ NS_ASSUME_NONNULL_BEGIN
  *
  *  Instances of MIKMIDIClock can be used to convert between MIDITimeStamp
  *  and MusicTimeStamp.
+ *
+ *  Converting time stamps and getting the tempo never take a lock or allocate memory, so they
+ *  can be called from any thread, including real-time audio threads, while the clock is
+ *  being synced on another.
  */
 @interface MIKMIDIClock : NSObject
 
@@ -53,7 +59,7 @@ NS_ASSUME_NONNULL_BEGIN
  *	@param tempo The beats per minute at which MusicTimeStamps should tick.
  *
  *  @note When this method is called, historical tempo and timing information more than 1 second
- *  old is pruned. At that point, calls to -musicTimeStampForMIDITimeStamp:,
+ *  old, or from more than 256 syncs ago, is pruned. At that point, calls to -musicTimeStampForMIDITimeStamp:,
  *  -midiTimeStampForMusicTimeStamp:, -tempoAtMIDITimeStamp:, and -tempoAtMusicTimeStamp:
  *  with time stamps more than one second older than the time stamps set with this method
  *  may not necessarily return accurate information.
@@ -170,6 +176,14 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (readonly, nonatomic) Float64 currentTempo;
 
+/**
+ *  The time source the clock uses to decide which of its past tempos are old enough
+ *  to be forgotten. The default is +[MIKMIDIHostTimeSource hostTimeSource].
+ *
+ *  Setting this on a synced clock has no effect.
+ */
+@property (nonatomic, strong) id<MIKMIDITimeSource> timeSource;
+
 #pragma mark - Deprecated Methods
 
 /**
@@ -8,7 +8,9 @@
 
 #import "MIKMIDIClock.h"
 #import "MIKMIDIUtilities.h"
+#import "MIKMIDIHostTimeSource.h"
 #import <mach/mach_time.h>
+#include <stdatomic.h>
 
 #if !__has_feature(objc_arc)
 #error MIKMIDIClock.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIClock.m in the Build Phases for this target
@@ -16,6 +18,23 @@
 
 
 #define kDurationToKeepHistoricalClocks	1.0
+#define kMaximumNumberOfHistoricalClocks	256
+
+
+// The tempo and timing information set by a call to -syncMusicTimeStamp:withMIDITimeStamp:tempo:
+typedef struct {
+    Float64 tempo;
+    MIDITimeStamp lastSyncedMIDITimeStamp;
+    MusicTimeStamp lastSyncedMusicTimeStamp;
+    Float64 musicTimeStampsPerMIDITimeStamp;
+    Float64 midiTimeStampsPerMusicTimeStamp;
+} MIKMIDIClockSegment;
+
+// A segment that was in effect until the clock was synced again at endMIDITimeStamp
+typedef struct {
+    MIDITimeStamp endMIDITimeStamp;
+    MIKMIDIClockSegment segment;
+} MIKMIDIHistoricalClock;
 
 
 #pragma mark -
@@ -28,23 +47,22 @@
 #pragma mark -
 @interface MIKMIDIClock ()
 {
-    Float64 _currentTempo;
-    MIDITimeStamp _timeStampZero;
-    MIDITimeStamp _lastSyncedMIDITimeStamp;
-    MusicTimeStamp _lastSyncedMusicTimeStamp;
+    // Readers never block. Instead, the clock's state is protected by a sequence lock: _version is odd while
+    // the state is being changed, and readers retry if it changed while they were reading.
+    atomic_uint _version;
     
-    Float64 _musicTimeStampsPerMIDITimeStamp;
-    Float64 _midiTimeStampsPerMusicTimeStamp;
+    BOOL _ready;
+    MIKMIDIClockSegment _currentSegment;
     
-    CFMutableDictionaryRef _historicalClocks;
-    CFMutableSetRef _historicalClockMIDITimeStampsSet;
-    CFMutableArrayRef _historicalClockMIDITimeStampsArray;
+    // A ring buffer, oldest first
+    MIKMIDIHistoricalClock _historicalClocks[kMaximumNumberOfHistoricalClocks];
+    NSUInteger _firstHistoricalClockIndex;
+    NSUInteger _numberOfHistoricalClocks;
     
+    // Serializes changes to the clock
     dispatch_queue_t _clockQueue;
 }
 
-@property (nonatomic, getter=isReady) BOOL ready;
-
 @end
 
 
@@ -59,132 +77,111 @@
 }
 
 - (instancetype)init
-{
-    return [self initWithQueue:YES];
-}
-
-- (instancetype)initWithQueue:(BOOL)createQueue
 {
     if (self = [super init]) {
-        if (createQueue) {
-            NSString *queueLabel = [[[NSBundle mainBundle] bundleIdentifier] stringByAppendingFormat:@".%@.%p", [self class], self];
-            dispatch_queue_attr_t attr = DISPATCH_QUEUE_SERIAL;
-            
+        NSString *queueLabel = [[[NSBundle mainBundle] bundleIdentifier] stringByAppendingFormat:@".%@.%p", [self class], self];
+        dispatch_queue_attr_t attr = DISPATCH_QUEUE_SERIAL;
+        
 #if defined (__MAC_10_10) || defined (__IPHONE_8_0)
-            if (@available(macOS 10.10, iOS 8, *)) {
-                if (&dispatch_queue_attr_make_with_qos_class != NULL) {
-                    attr = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INTERACTIVE, 0);
-                }
+        if (@available(macOS 10.10, iOS 8, *)) {
+            if (&dispatch_queue_attr_make_with_qos_class != NULL) {
+                attr = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INTERACTIVE, 0);
             }
-#endif
-            
-            _clockQueue = dispatch_queue_create(queueLabel.UTF8String, attr);
         }
+#endif
+        
+        _clockQueue = dispatch_queue_create(queueLabel.UTF8String, attr);
+        atomic_init(&_version, 0);
+        _timeSource = [MIKMIDIHostTimeSource hostTimeSource];
     }
     return self;
 }
 
-- (void)dealloc
-{
-    releaseHistoricalClocks(self);
-}
-
 #pragma mark - Queue
 
 static void dispatchToClockQueue(MIKMIDIClock *self, void(^block)(void))
 {
     if (!block) return;
-    
-    dispatch_queue_t queue = self->_clockQueue;
-    if (queue) {
-        dispatch_sync(queue, block);
-    } else {
-        block();
-    }
+    dispatch_sync(self->_clockQueue, block);
+}
+
+#pragma mark - Sequence Lock
+
+static inline unsigned beginReadingClock(MIKMIDIClock *self)
+{
+    unsigned version;
+    while ((version = atomic_load_explicit(&self->_version, memory_order_acquire)) & 1) {} // Changes are only a few stores long
+    return version;
+}
+
+// Returns NO if the clock changed since beginReadingClock(), in which case anything read must be discarded.
+static inline BOOL finishReadingClock(MIKMIDIClock *self, unsigned version)
+{
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&self->_version, memory_order_relaxed) == version;
+}
+
+// Must only be called on the clock queue.
+static inline void beginChangingClock(MIKMIDIClock *self)
+{
+    atomic_fetch_add_explicit(&self->_version, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+}
+
+static inline void finishChangingClock(MIKMIDIClock *self)
+{
+    atomic_fetch_add_explicit(&self->_version, 1, memory_order_release);
 }
 
 #pragma mark - Time Stamps
 
 - (void)syncMusicTimeStamp:(MusicTimeStamp)musicTimeStamp withMIDITimeStamp:(MIDITimeStamp)midiTimeStamp tempo:(Float64)tempo
 {
+    // Work out everything that's needed before readers are held off
+    MIDITimeStamp now = self.timeSource.currentMIDITimeStamp;
+    MIDITimeStamp historyDuration = MIKMIDIClockMIDITimeStampsPerTimeInterval(kDurationToKeepHistoricalClocks);
+    MIDITimeStamp oldTimeStamp = (now > historyDuration) ? now - historyDuration : 0;
+    Float64 secondsPerMIDITimeStamp = MIKMIDIClockSecondsPerMIDITimeStamp();
+    Float64 secondsPerMusicTimeStamp = 60.0 / tempo;
+    Float64 midiTimeStampsPerMusicTimeStamp = secondsPerMusicTimeStamp / secondsPerMIDITimeStamp;
+    
+    MIKMIDIClockSegment segment;
+    segment.tempo = tempo;
+    segment.lastSyncedMIDITimeStamp = midiTimeStamp;
+    segment.lastSyncedMusicTimeStamp = musicTimeStamp;
+    segment.midiTimeStampsPerMusicTimeStamp = midiTimeStampsPerMusicTimeStamp;
+    segment.musicTimeStampsPerMIDITimeStamp = secondsPerMIDITimeStamp / secondsPerMusicTimeStamp;
+    
     [self willChangeValueForKey:@"ready"];
     dispatchToClockQueue(self, ^{
-        if (self->_lastSyncedMIDITimeStamp != 0) {
-            // Add a clock to the historical clocks
-            NSNumber *midiTimeStampNumber = @(midiTimeStamp);
-            
-            if (!self->_historicalClocks) {
-                self->_historicalClocks = CFDictionaryCreateMutable(NULL, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
-                self->_historicalClockMIDITimeStampsSet = CFSetCreateMutable(NULL, 0, &kCFTypeSetCallBacks);
-                self->_historicalClockMIDITimeStampsArray = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
-            } else {
-                // Remove clocks old enough to not be needed anymore
-                MIDITimeStamp oldTimeStamp = MIKMIDIGetCurrentTimeStamp() - MIKMIDIClockMIDITimeStampsPerTimeInterval(kDurationToKeepHistoricalClocks);
-                
-                CFIndex count = CFArrayGetCount(self->_historicalClockMIDITimeStampsArray);
-                CFMutableArrayRef timeStampsToRemove = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
-                CFMutableSetRef indexesToRemoveSet = CFSetCreateMutable(NULL, 0, &kCFTypeSetCallBacks);
-                CFMutableArrayRef indexesToRemoveArray = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
-                
-                for (CFIndex i = 0; i < count; i++) {
-                    NSNumber *timeStampNumber = (__bridge NSNumber *)CFArrayGetValueAtIndex(self->_historicalClockMIDITimeStampsArray, i);
-                    MIDITimeStamp timeStamp = timeStampNumber.unsignedLongLongValue;
-                    if (timeStamp <= oldTimeStamp) {
-                        void *timeStampValue = (__bridge void *)timeStampNumber;
-                        
-                        CFArrayAppendValue(timeStampsToRemove, timeStampValue);
-                        if (!CFSetContainsValue(indexesToRemoveSet, timeStampValue)) {
-                            CFSetAddValue(indexesToRemoveSet, timeStampValue);
-                            CFArrayAppendValue(indexesToRemoveArray, timeStampValue);
-                        }
-                    } else {
-                        break;
-                    }
-                }
-                
-                CFIndex timeStampsToRemoveCount = CFArrayGetCount(timeStampsToRemove);
-                for (CFIndex i = (timeStampsToRemoveCount - 1); i >= 0; i--) {
-                    const void *timeStampValue = CFArrayGetValueAtIndex(timeStampsToRemove, i);
-                    CFDictionaryRemoveValue(self->_historicalClocks, timeStampValue);
-                    CFSetRemoveValue(self->_historicalClockMIDITimeStampsSet, timeStampValue);
-                    CFArrayRemoveValueAtIndex(self->_historicalClockMIDITimeStampsArray, i);
-                }
-                
-                CFRelease(timeStampsToRemove);
-                CFRelease(indexesToRemoveSet);
-                CFRelease(indexesToRemoveArray);
+        beginChangingClock(self);
+        
+        if (self->_ready) {
+            // Remove clocks old enough to not be needed anymore
+            while (self->_numberOfHistoricalClocks && historicalClockAtIndex(self, 0)->endMIDITimeStamp <= oldTimeStamp) {
+                self->_firstHistoricalClockIndex = (self->_firstHistoricalClockIndex + 1) % kMaximumNumberOfHistoricalClocks;
+                self->_numberOfHistoricalClocks--;
             }
             
-            // Add clock to history
-            MIKMIDIClock *historicalClock = [[MIKMIDIClock alloc] initWithQueue:NO];
-            historicalClock->_currentTempo = self->_currentTempo;
-            historicalClock->_timeStampZero = self->_timeStampZero;
-            historicalClock->_lastSyncedMIDITimeStamp = self->_lastSyncedMIDITimeStamp;
-			historicalClock->_lastSyncedMusicTimeStamp = self->_lastSyncedMusicTimeStamp;
-            historicalClock->_musicTimeStampsPerMIDITimeStamp = self->_musicTimeStampsPerMIDITimeStamp;
-            historicalClock->_midiTimeStampsPerMusicTimeStamp = self->_midiTimeStampsPerMusicTimeStamp;
-            
-            void *midiTimeStampValue = (__bridge void *)midiTimeStampNumber;
-            CFDictionaryAddValue(self->_historicalClocks, midiTimeStampValue, (__bridge void *)historicalClock);
-            
-            if (!CFSetContainsValue(self->_historicalClockMIDITimeStampsSet, midiTimeStampValue)) {
-                CFSetAddValue(self->_historicalClockMIDITimeStampsSet, midiTimeStampValue);
-                CFArrayAppendValue(self->_historicalClockMIDITimeStampsArray, midiTimeStampValue);
+            // Add clock to history, unless there's already one that ended at this time stamp
+            NSUInteger count = self->_numberOfHistoricalClocks;
+            if (!count || historicalClockAtIndex(self, count - 1)->endMIDITimeStamp != midiTimeStamp) {
+                if (count == kMaximumNumberOfHistoricalClocks) {
+                    self->_firstHistoricalClockIndex = (self->_firstHistoricalClockIndex + 1) % kMaximumNumberOfHistoricalClocks;
+                    count--;
+                }
+                MIKMIDIHistoricalClock *historicalClock = &self->_historicalClocks[(self->_firstHistoricalClockIndex + count) % kMaximumNumberOfHistoricalClocks];
+                historicalClock->endMIDITimeStamp = midiTimeStamp;
+                historicalClock->segment = self->_currentSegment;
+                self->_numberOfHistoricalClocks = count + 1;
             }
         }
         
         // Update new tempo and timing information
-        Float64 secondsPerMIDITimeStamp = MIKMIDIClockSecondsPerMIDITimeStamp();
-        Float64 secondsPerMusicTimeStamp = 60.0 / tempo;
-        Float64 midiTimeStampsPerMusicTimeStamp = secondsPerMusicTimeStamp / secondsPerMIDITimeStamp;
-        
-        self->_currentTempo = tempo;
-        self->_lastSyncedMIDITimeStamp = midiTimeStamp;
-        self->_lastSyncedMusicTimeStamp = musicTimeStamp;
-        self->_timeStampZero = midiTimeStamp - (musicTimeStamp * midiTimeStampsPerMusicTimeStamp);
-        self->_midiTimeStampsPerMusicTimeStamp = midiTimeStampsPerMusicTimeStamp;
-        self->_musicTimeStampsPerMIDITimeStamp = secondsPerMIDITimeStamp / secondsPerMusicTimeStamp;
+        self->_currentSegment = segment;
         self->_ready = YES;
+        
+        finishChangingClock(self);
     });
     [self didChangeValueForKey:@"ready"];
 }
@@ -193,28 +190,25 @@ static void dispatchToClockQueue(MIKMIDIClock *self, void(^block)(void))
 {
     [self willChangeValueForKey:@"ready"];
     dispatchToClockQueue(self, ^{
+        beginChangingClock(self);
         self->_ready = NO;
-        self->_currentTempo = 0;
-        self->_lastSyncedMIDITimeStamp = 0;
-        releaseHistoricalClocks(self);
+        self->_currentSegment.tempo = 0;
+        self->_currentSegment.lastSyncedMIDITimeStamp = 0;
+        self->_numberOfHistoricalClocks = 0;
+        finishChangingClock(self);
     });
     [self didChangeValueForKey:@"ready"];
 }
 
 static MusicTimeStamp musicTimeStampForMIDITimeStamp(MIKMIDIClock *self, MIDITimeStamp midiTimeStamp)
 {
-    __block MusicTimeStamp musicTimeStamp = 0;
+    MusicTimeStamp musicTimeStamp;
+    unsigned version;
     
-    dispatchToClockQueue(self, ^{
-        if (!self->_ready) return;
-        
-        MIDITimeStamp lastSyncedMIDITimeStamp = self->_lastSyncedMIDITimeStamp;
-        if (midiTimeStamp >= lastSyncedMIDITimeStamp) {
-            musicTimeStamp = musicTimeStampForMIDITimeStampWithHistoricalClock(midiTimeStamp, self);
-        } else {
-            musicTimeStamp = musicTimeStampForMIDITimeStampWithHistoricalClock(midiTimeStamp, clockForMIDITimeStamp(self, midiTimeStamp));
-        }
-    });
+    do {
+        version = beginReadingClock(self);
+        musicTimeStamp = self->_ready ? musicTimeStampForMIDITimeStampWithSegment(midiTimeStamp, segmentForMIDITimeStamp(self, midiTimeStamp)) : 0;
+    } while (!finishReadingClock(self, version));
     
     return musicTimeStamp;
 }
@@ -224,37 +218,51 @@ static MusicTimeStamp musicTimeStampForMIDITimeStamp(MIKMIDIClock *self, MIDITim
     return musicTimeStampForMIDITimeStamp(self, midiTimeStamp);
 }
 
-static MusicTimeStamp musicTimeStampForMIDITimeStampWithHistoricalClock(MIDITimeStamp midiTimeStamp, MIKMIDIClock *clock)
+// Conversions are made relative to the time stamps the segment was synced at. The MIDI time stamp of music time stamp 0
+// may be before MIDI time stamp 0, as it is when rendering offline from MIDI time stamp 0 at a later beat, so it can't be kept.
+static MusicTimeStamp musicTimeStampForMIDITimeStampWithSegment(MIDITimeStamp midiTimeStamp, const MIKMIDIClockSegment *segment)
 {
-    if (midiTimeStamp == clock->_lastSyncedMIDITimeStamp) return clock->_lastSyncedMusicTimeStamp;
-    MIDITimeStamp timeStampZero = clock->_timeStampZero;
-    return (midiTimeStamp >= timeStampZero) ? ((midiTimeStamp - timeStampZero) * clock->_musicTimeStampsPerMIDITimeStamp) : -((timeStampZero - midiTimeStamp) * clock->_musicTimeStampsPerMIDITimeStamp);
+    MIDITimeStamp lastSyncedMIDITimeStamp = segment->lastSyncedMIDITimeStamp;
+    if (midiTimeStamp == lastSyncedMIDITimeStamp) return segment->lastSyncedMusicTimeStamp;
+    MusicTimeStamp offset = (midiTimeStamp > lastSyncedMIDITimeStamp) ? ((midiTimeStamp - lastSyncedMIDITimeStamp) * segment->musicTimeStampsPerMIDITimeStamp) : -((lastSyncedMIDITimeStamp - midiTimeStamp) * segment->musicTimeStampsPerMIDITimeStamp);
+    return segment->lastSyncedMusicTimeStamp + offset;
+}
+
+// MIDI time stamps can't be negative, so music time stamps before MIDI time stamp 0 give 0
+static MIDITimeStamp midiTimeStampForMusicTimeStampWithSegment(MusicTimeStamp musicTimeStamp, const MIKMIDIClockSegment *segment)
+{
+    MIDITimeStamp lastSyncedMIDITimeStamp = segment->lastSyncedMIDITimeStamp;
+    Float64 offset = round((musicTimeStamp - segment->lastSyncedMusicTimeStamp) * segment->midiTimeStampsPerMusicTimeStamp);
+    if (offset >= 0) return lastSyncedMIDITimeStamp + (MIDITimeStamp)offset;
+    return (-offset < lastSyncedMIDITimeStamp) ? lastSyncedMIDITimeStamp - (MIDITimeStamp)(-offset) : 0;
 }
 
 static MIDITimeStamp midiTimeStampForMusicTimeStamp(MIKMIDIClock *self, MusicTimeStamp musicTimeStamp)
 {
-    __block MIDITimeStamp midiTimeStamp = 0;
+    MIDITimeStamp midiTimeStamp;
+    unsigned version;
     
-    dispatchToClockQueue(self, ^{
-        if (!self->_ready) return;
-        if (musicTimeStamp == self->_lastSyncedMusicTimeStamp) { midiTimeStamp = self->_lastSyncedMIDITimeStamp; return; }
+    do {
+        version = beginReadingClock(self);
+        midiTimeStamp = 0;
+        if (!self->_ready) continue;
         
-        midiTimeStamp = round(musicTimeStamp * self->_midiTimeStampsPerMusicTimeStamp) + self->_timeStampZero;
+        const MIKMIDIClockSegment *currentSegment = &self->_currentSegment;
+        if (musicTimeStamp == currentSegment->lastSyncedMusicTimeStamp) { midiTimeStamp = currentSegment->lastSyncedMIDITimeStamp; continue; }
         
-        if (midiTimeStamp < self->_lastSyncedMIDITimeStamp && self->_historicalClockMIDITimeStampsArray) {
-            CFIndex historicalClockMIDITimeStampsCount = CFArrayGetCount(self->_historicalClockMIDITimeStampsArray);
-            for (CFIndex i = (historicalClockMIDITimeStampsCount - 1); i >= 0; i--) {
-                const void *midiTimeStampValue = CFArrayGetValueAtIndex(self->_historicalClockMIDITimeStampsArray, i);
-                
-                MIKMIDIClock *clock = (__bridge MIKMIDIClock *)CFDictionaryGetValue(self->_historicalClocks, midiTimeStampValue);
-                MIDITimeStamp historicalMIDITimeStamp = round(musicTimeStamp * clock->_midiTimeStampsPerMusicTimeStamp) + clock->_timeStampZero;
-                if (historicalMIDITimeStamp >= clock->_lastSyncedMIDITimeStamp) {
+        midiTimeStamp = midiTimeStampForMusicTimeStampWithSegment(musicTimeStamp, currentSegment);
+        
+        if (midiTimeStamp < currentSegment->lastSyncedMIDITimeStamp) {
+            for (NSUInteger i = numberOfHistoricalClocks(self); i > 0; i--) {
+                const MIKMIDIClockSegment *segment = &historicalClockAtIndex(self, i - 1)->segment;
+                MIDITimeStamp historicalMIDITimeStamp = midiTimeStampForMusicTimeStampWithSegment(musicTimeStamp, segment);
+                if (historicalMIDITimeStamp >= segment->lastSyncedMIDITimeStamp) {
                     midiTimeStamp = historicalMIDITimeStamp;
                     break;
                 }
             }
         }
-    });
+    } while (!finishReadingClock(self, version));
     
     return midiTimeStamp;
 }
@@ -266,11 +274,13 @@ static MIDITimeStamp midiTimeStampForMusicTimeStamp(MIKMIDIClock *self, MusicTim
 
 static MIDITimeStamp midiTimeStampsPerMusicTimeStamp(MIKMIDIClock *self, MusicTimeStamp musicTimeStamp)
 {
-    __block MIDITimeStamp midiTimeStamps = 0;
+    MIDITimeStamp midiTimeStamps;
+    unsigned version;
     
-    dispatchToClockQueue(self, ^{
-        if (self->_ready) midiTimeStamps = musicTimeStamp * self->_midiTimeStampsPerMusicTimeStamp;
-    });
+    do {
+        version = beginReadingClock(self);
+        midiTimeStamps = self->_ready ? musicTimeStamp * self->_currentSegment.midiTimeStampsPerMusicTimeStamp : 0;
+    } while (!finishReadingClock(self, version));
     
     return midiTimeStamps;
 }
@@ -284,17 +294,13 @@ static MIDITimeStamp midiTimeStampsPerMusicTimeStamp(MIKMIDIClock *self, MusicTi
 
 static Float64 tempoAtMIDITimeStamp(MIKMIDIClock *self, MIDITimeStamp midiTimeStamp)
 {
-    __block Float64 tempo = 0;
+    Float64 tempo;
+    unsigned version;
     
-    dispatchToClockQueue(self, ^{
-        if (self->_ready) {
-            if (midiTimeStamp >= self->_lastSyncedMIDITimeStamp) {
-                tempo = self->_currentTempo;
-            } else {
-                tempo = [clockForMIDITimeStamp(self, midiTimeStamp) currentTempo];
-            }
-        }
-    });
+    do {
+        version = beginReadingClock(self);
+        tempo = self->_ready ? segmentForMIDITimeStamp(self, midiTimeStamp)->tempo : 0;
+    } while (!finishReadingClock(self, version));
     
     return tempo;
 }
@@ -316,39 +322,63 @@ Float64 tempoAtMusicTimeStamp(MIKMIDIClock *self, MusicTimeStamp musicTimeStamp)
 
 #pragma mark - Historical Clocks
 
-static MIKMIDIClock *clockForMIDITimeStamp(MIKMIDIClock *self, MIDITimeStamp midiTimeStamp)
+// These may be called while reading the clock, when the state might be changing underneath them,
+// so they stay inside the buffer whatever they read. The results are thrown away in that case anyway.
+
+static NSUInteger numberOfHistoricalClocks(MIKMIDIClock *self)
 {
-    MIKMIDIClock *clock = self;
+    return MIN(self->_numberOfHistoricalClocks, kMaximumNumberOfHistoricalClocks);
+}
+
+// Index 0 is the oldest clock.
+static MIKMIDIHistoricalClock *historicalClockAtIndex(MIKMIDIClock *self, NSUInteger index)
+{
+    return &self->_historicalClocks[(self->_firstHistoricalClockIndex + index) % kMaximumNumberOfHistoricalClocks];
+}
+
+static const MIKMIDIClockSegment *segmentForMIDITimeStamp(MIKMIDIClock *self, MIDITimeStamp midiTimeStamp)
+{
+    const MIKMIDIClockSegment *segment = &self->_currentSegment;
+    if (midiTimeStamp >= segment->lastSyncedMIDITimeStamp) return segment;
     
-    if (self->_historicalClockMIDITimeStampsArray) {
-        CFIndex count = CFArrayGetCount(self->_historicalClockMIDITimeStampsArray);
-        for (CFIndex i = (count - 1); i >= 0; i--) {
-            NSNumber *historicalClockTimeStamp = (__bridge NSNumber *)CFArrayGetValueAtIndex(self->_historicalClockMIDITimeStampsArray, i);
-            if ([historicalClockTimeStamp unsignedLongLongValue] > midiTimeStamp) {
-                clock = (__bridge MIKMIDIClock *)CFDictionaryGetValue(self->_historicalClocks, (__bridge void *)historicalClockTimeStamp);
-            } else {
-                break;
-            }
+    for (NSUInteger i = numberOfHistoricalClocks(self); i > 0; i--) {
+        MIKMIDIHistoricalClock *historicalClock = historicalClockAtIndex(self, i - 1);
+        if (historicalClock->endMIDITimeStamp > midiTimeStamp) {
+            segment = &historicalClock->segment;
+        } else {
+            break;
         }
     }
     
-    return clock;
+    return segment;
 }
 
-static void releaseHistoricalClocks(MIKMIDIClock *self)
+#pragma mark - Properties
+
+- (BOOL)isReady
 {
-    if (self->_historicalClocks) {
-        CFRelease(self->_historicalClocks);
-        self->_historicalClocks = NULL;
-    }
-    if (self->_historicalClockMIDITimeStampsSet) {
-        CFRelease(self->_historicalClockMIDITimeStampsSet);
-        self->_historicalClockMIDITimeStampsSet = NULL;
-    }
-    if (self->_historicalClockMIDITimeStampsArray) {
-        CFRelease(self->_historicalClockMIDITimeStampsArray);
-        self->_historicalClockMIDITimeStampsArray = NULL;
-    }
+    BOOL ready;
+    unsigned version;
+    
+    do {
+        version = beginReadingClock(self);
+        ready = _ready;
+    } while (!finishReadingClock(self, version));
+    
+    return ready;
+}
+
+- (Float64)currentTempo
+{
+    Float64 tempo;
+    unsigned version;
+    
+    do {
+        version = beginReadingClock(self);
+        tempo = _currentSegment.tempo;
+    } while (!finishReadingClock(self, version));
+    
+    return tempo;
 }
 
 #pragma mark - Synced Clock
@@ -453,6 +483,7 @@ Float64 MIKMIDIClockMIDITimeStampsPerTimeInterval(NSTimeInterval timeInterval)
     // Ignored selectors
     if (selector == @selector(syncMusicTimeStamp:withMIDITimeStamp:tempo:)) return;
     if (selector == @selector(unsyncMusicTimeStampsAndTemposFromMIDITimeStamps)) return;
+    if (selector == @selector(setTimeSource:)) return;
     if (selector == @selector(setMusicTimeStamp:withTempo:atMIDITimeStamp:)) return;	// deprecated
     
     // Pass through remaining selectors
@@ -55,6 +55,17 @@ typedef NS_ENUM(NSUInteger, MIKMIDICommandType) {
 	MIKMIDICommandTypeSystemKeepAlive = 0xfe,
 };
 
+/**
+ *  MIDI protocols for Universal MIDI Packet (UMP) messages. These values match
+ *  CoreMIDI's MIDIProtocolID, which is only available on newer OS versions.
+ */
+typedef NS_ENUM(NSInteger, MIKMIDIProtocol) {
+	/** Channel voice messages are MIDI 1.0 messages, with 7 and 14-bit values. */
+	MIKMIDIProtocol1_0 = 1,
+	/** Channel voice messages are MIDI 2.0 messages, with 16 and 32-bit values. */
+	MIKMIDIProtocol2_0 = 2,
+};
+
 @class MIKMIDIMappingItem;
 
 NS_ASSUME_NONNULL_BEGIN
@@ -156,6 +167,42 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (__kindof instancetype)commandForCommandType:(MIKMIDICommandType)commandType; // Most useful for mutable commands
 
+/**
+ *  Creates commands from Universal MIDI Packet (UMP) messages, as found in a CoreMIDI MIDIEventPacket.
+ *
+ *  MIDI 1.0 channel voice, system common and system real time messages become the same commands
+ *  they would in a MIDIPacket. MIDI 2.0 channel voice messages become commands of the same type, keeping
+ *  their full resolution in highResolutionValue (see MIKMIDIChannelVoiceCommand), and RPN and NRPN
+ *  messages become MIKMIDIParameterChangeCommand instances. System exclusive messages are reassembled
+ *  into MIKMIDISystemExclusiveCommand instances. Messages MIKMIDI has no command for, like per-note
+ *  controllers and utility messages, are skipped, as is a message that is cut off at the end of words.
+ *
+ *  @param words     The UMP words, in host byte order.
+ *  @param wordCount The number of words in words.
+ *  @param timeStamp The MIDITimeStamp to give the commands.
+ *
+ *  @return An NSArray of MIKMIDICommand instances. May be empty.
+ */
++ (MIKArrayOf(MIKMIDICommand *) *)commandsWithUniversalMIDIPacketWords:(const UInt32 *)words count:(NSUInteger)wordCount timeStamp:(MIDITimeStamp)timeStamp;
+
+/**
+ *  Returns the receiver as Universal MIDI Packet (UMP) messages, as used in a CoreMIDI MIDIEventList.
+ *
+ *  With MIKMIDIProtocol2_0, channel voice commands become MIDI 2.0 messages carrying their
+ *  highResolutionValue. A 14-bit control change becomes one control change, and an
+ *  MIKMIDIParameterChangeCommand one RPN or NRPN message, rather than the series of control
+ *  changes they are made of in MIDI 1.0. With MIKMIDIProtocol1_0, channel voice commands become
+ *  MIDI 1.0 messages. With either, system exclusive commands become as many data 64 messages as
+ *  they need, and other system messages become system messages.
+ *
+ *  @param protocol The protocol to use for channel voice messages.
+ *  @param group    The UMP group, 0-15.
+ *
+ *  @return An NSData containing the messages' UInt32 words, in host byte order, or nil if the
+ *  receiver's data isn't a complete MIDI message.
+ */
+- (nullable NSData *)universalMIDIPacketDataWithProtocol:(MIKMIDIProtocol)protocol group:(UInt8)group;
+
 /**
  * Returns a boolean value that indicates whether the receiver is equal to another command.
  * Compares command type, timestamp, and raw data to determine if the two commands are equal.
@@ -245,4 +292,28 @@ NS_ASSUME_NONNULL_BEGIN
  */
 BOOL MIKCreateMIDIPacketListFromCommands(MIDIPacketList * _Nonnull * _Nonnull outPacketList, MIKArrayOf(MIKMIDICommand *) *commands);
 
+/**
+ *  Returns the number of bytes a MIDIPacketList containing an array of MIKMIDICommand instances may need.
+ *  This allows for each command needing its own, aligned, packet, so it may be more than is actually used.
+ *
+ *  @param commands An array of MIKMIDICommand instances.
+ *
+ *  @return The size of the buffer to pass to MIKMIDIPacketListInitWithCommands(), or 0 if commands is empty.
+ */
+ByteCount MIKMIDIPacketListSizeForCommands(MIKArrayOf(MIKMIDICommand *) *commands);
+
+/**
+ *  Initializes a MIDIPacketList in an existing buffer with the contents of an array of MIKMIDICommand instances,
+ *  without allocating any memory. Commands' bytes are copied directly into the list, and consecutive commands with
+ *  the same time stamp share a packet, except for system exclusive messages.
+ *  Used by MIKMIDI when sending commands. Typically, this is not needed by clients of MIKMIDI.
+ *
+ *  @param packetList A buffer to initialize as a MIDIPacketList.
+ *  @param listSize   The size of the buffer, usually as returned by MIKMIDIPacketListSizeForCommands().
+ *  @param commands   An array of MIKMIDICommand instances.
+ *
+ *  @return YES if all of the commands fit in the buffer, NO otherwise.
+ */
+BOOL MIKMIDIPacketListInitWithCommands(MIDIPacketList *packetList, ByteCount listSize, MIKArrayOf(MIKMIDICommand *) *commands);
+
 NS_ASSUME_NONNULL_END
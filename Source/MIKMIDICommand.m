@@ -10,6 +10,11 @@
 #include <mach/mach_time.h>
 #import "MIKMIDICommand_SubclassMethods.h"
 #import "MIKMIDIUtilities.h"
+#import "MIKMIDIChannelVoiceCommand_SubclassMethods.h"
+#import "MIKMIDIParameterChangeCommand.h"
+#import "MIKMIDISystemExclusiveCommand.h"
+#import "MIKMIDIMessageParser.h"
+#import "MIKMIDIUniversalPacket.h"
 
 #if !__has_feature(objc_arc)
 #error MIKMIDICommand.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDICommand.m in the Build Phases for this target
@@ -17,6 +22,22 @@
 
 static NSMutableSet *registeredMIKMIDICommandSubclasses;
 
+#define kMIKMIDICommandUniversalMessageBufferSize	16
+
+static MIKMIDICommand *MIKMIDICommandWithShortMessage(UInt8 status, UInt8 data1, UInt8 data2, MIDITimeStamp timeStamp)
+{
+	int dataLength = MIKMIDIMessageParserDataLengthForStatus(status);
+	if (dataLength < 0) return nil;
+
+	MIDIPacket packet;
+	packet.timeStamp = timeStamp;
+	packet.length = 1 + dataLength;
+	packet.data[0] = status;
+	packet.data[1] = data1 & 0x7F;
+	packet.data[2] = data2 & 0x7F;
+	return [MIKMIDICommand commandWithMIDIPacket:&packet];
+}
+
 @interface MIKMIDICommand ()
 
 @end
@@ -64,19 +85,18 @@ static NSMutableSet *registeredMIKMIDICommandSubclasses;
 			// For sysex, the packet can only contain a single MIDI message (as per documentation for MIDIPacket)
 			standardLength = inputPacket->length;
 		}
-		if (dataOffset > (inputPacket->length - standardLength)) break;
-
-		// This is gross, but it's the only way I can find to reliably create a
-		// single-message MIDIPacket.
-		MIDIPacketList packetList;
-		MIDIPacket *midiPacket = MIDIPacketListInit(&packetList);
-		midiPacket = MIDIPacketListAdd(&packetList,
-										  sizeof(MIDIPacketList),
-										  midiPacket,
-										  inputPacket->timeStamp,
-										  standardLength,
-										  packetData);
-        
+		if (standardLength <= 0 || dataOffset > (inputPacket->length - standardLength)) break;
+
+		// A packet containing a single message can be used as is. Otherwise, copy the message into its own packet.
+		MIDIPacket *midiPacket = inputPacket;
+		MIDIPacket messagePacket;
+		if (standardLength != inputPacket->length) {
+			messagePacket.timeStamp = inputPacket->timeStamp;
+			messagePacket.length = standardLength;
+			memcpy(messagePacket.data, packetData, standardLength);
+			midiPacket = &messagePacket;
+		}
+
 		MIKMIDICommand *command = [MIKMIDICommand commandWithMIDIPacket:midiPacket];
 		if (command) [result addObject:command];
 		dataOffset += standardLength;
@@ -93,6 +113,99 @@ static NSMutableSet *registeredMIKMIDICommandSubclasses;
 	return [[subclass alloc] init];
 }
 
++ (NSArray *)commandsWithUniversalMIDIPacketWords:(const UInt32 *)words count:(NSUInteger)wordCount timeStamp:(MIDITimeStamp)timeStamp
+{
+	NSMutableArray *result = [NSMutableArray array];
+	NSMutableData *sysexDataByGroup[16] = {nil};
+	NSUInteger offset = 0;
+	while (offset < wordCount) {
+		MIKMIDIUniversalMessage messages[kMIKMIDICommandUniversalMessageBufferSize];
+		size_t wordsConsumed = 0;
+		size_t count = MIKMIDIUniversalPacketParse(words + offset, wordCount - offset, messages, kMIKMIDICommandUniversalMessageBufferSize, &wordsConsumed);
+		if (!count) break; // The last message is cut off
+		offset += wordsConsumed;
+
+		for (size_t i = 0; i < count; i++) {
+			const MIKMIDIUniversalMessage *message = &messages[i];
+			switch (MIKMIDIUniversalMessageGetType(message)) {
+				case MIKMIDIUniversalMessageTypeSystem:
+				case MIKMIDIUniversalMessageTypeMIDI1ChannelVoice: {
+					MIKMIDICommand *command = MIKMIDICommandWithShortMessage(MIKMIDIUniversalMessageGetStatus(message), MIKMIDIUniversalMessageGetData1(message),
+																			MIKMIDIUniversalMessageGetData2(message), timeStamp);
+					if (command) [result addObject:command];
+					break;
+				}
+				case MIKMIDIUniversalMessageTypeMIDI2ChannelVoice:
+					[result addObjectsFromArray:[self commandsWithMIDI2ChannelVoiceMessage:message timeStamp:timeStamp]];
+					break;
+				case MIKMIDIUniversalMessageTypeData64: {
+					UInt8 group = MIKMIDIUniversalMessageGetGroup(message);
+					UInt8 bytes[MIKMIDIUniversalSystemExclusiveBytesPerMessage];
+					UInt8 status = 0;
+					size_t length = MIKMIDIUniversalMessageGetSystemExclusiveBytes(message, bytes, &status);
+					if (status == MIKMIDIUniversalSystemExclusiveStatusComplete || status == MIKMIDIUniversalSystemExclusiveStatusStart) {
+						sysexDataByGroup[group] = [NSMutableData dataWithBytes:(UInt8[]){MIKMIDICommandTypeSystemExclusive} length:1];
+					}
+					NSMutableData *sysexData = sysexDataByGroup[group];
+					if (!sysexData) break; // The start of this message was missed
+					[sysexData appendBytes:bytes length:length];
+					if (status == MIKMIDIUniversalSystemExclusiveStatusComplete || status == MIKMIDIUniversalSystemExclusiveStatusEnd) {
+						[sysexData appendBytes:(UInt8[]){0xF7} length:1];
+						[result addObject:[[MIKMIDISystemExclusiveCommand alloc] initWithRawData:sysexData timeStamp:timeStamp]];
+						sysexDataByGroup[group] = nil;
+					}
+					break;
+				}
+				default:
+					break;
+			}
+		}
+	}
+	return result;
+}
+
++ (NSArray *)commandsWithMIDI2ChannelVoiceMessage:(const MIKMIDIUniversalMessage *)message timeStamp:(MIDITimeStamp)timeStamp
+{
+	UInt8 status = MIKMIDIUniversalMessageGetStatus(message);
+	UInt8 opcode = status & 0xF0;
+	UInt32 value = MIKMIDIUniversalMessageGetValue(message);
+
+	// RPN and NRPN messages have no single MIDI 1.0 message to translate to
+	BOOL isRelative = (opcode == MIKMIDIUniversalOpcodeRelativeRegisteredController || opcode == MIKMIDIUniversalOpcodeRelativeAssignableController);
+	if (isRelative || opcode == MIKMIDIUniversalOpcodeRegisteredController || opcode == MIKMIDIUniversalOpcodeAssignableController) {
+		BOOL isRegistered = (opcode == MIKMIDIUniversalOpcodeRegisteredController || opcode == MIKMIDIUniversalOpcodeRelativeRegisteredController);
+		MIKMutableMIDIParameterChangeCommand *command = [[MIKMutableMIDIParameterChangeCommand alloc] init];
+		command.channel = status & 0x0F;
+		command.parameterType = isRegistered ? MIKMIDIParameterTypeRegistered : MIKMIDIParameterTypeNonRegistered;
+		command.parameterNumber = ((MIKMIDIUniversalMessageGetData1(message) & 0x7F) << 7) | (MIKMIDIUniversalMessageGetData2(message) & 0x7F);
+		if (isRelative) {
+			command.dataIncrement = (SInt32)value;
+		} else {
+			command.highResolutionValue = value;
+		}
+		command.midiTimestamp = timeStamp;
+		return @[[command copy]];
+	}
+
+	MIKMIDIUniversalMessage translated[MIKMIDIUniversalMessageMaximumMIDI1TranslationCount];
+	size_t count = MIKMIDIUniversalMessageTranslateToMIDI1(message, translated, MIKMIDIUniversalMessageMaximumMIDI1TranslationCount);
+	NSMutableArray *result = [NSMutableArray arrayWithCapacity:count];
+	for (size_t i = 0; i < count; i++) {
+		MIKMIDICommand *command = MIKMIDICommandWithShortMessage(MIKMIDIUniversalMessageGetStatus(&translated[i]), MIKMIDIUniversalMessageGetData1(&translated[i]),
+																MIKMIDIUniversalMessageGetData2(&translated[i]), timeStamp);
+		if (command) [result addObject:command];
+	}
+
+	// Keep the value's full resolution. Program changes have none to keep.
+	MIKMIDIChannelVoiceCommand *command = [result lastObject];
+	if (count == 1 && opcode != 0xC0 && [command isKindOfClass:[MIKMIDIChannelVoiceCommand class]]) {
+		MIKMIDIChannelVoiceCommand *highResolutionCommand = [command mutableCopy];
+		highResolutionCommand.highResolutionValue = (opcode == 0x80 || opcode == 0x90) ? (value >> 16) : value;
+		result[0] = [highResolutionCommand copy];
+	}
+	return result;
+}
+
 - (id)init
 {
     return [self initWithMIDIPacket:NULL];
@@ -122,6 +235,47 @@ static NSMutableSet *registeredMIKMIDICommandSubclasses;
     return @"";
 }
 
+- (NSData *)universalMIDIPacketDataWithProtocol:(MIKMIDIProtocol)protocol group:(UInt8)group
+{
+	NSData *data = self.internalData;
+	const UInt8 *bytes = [data bytes];
+	NSUInteger length = [data length];
+	if (!length) return nil;
+
+	NSMutableData *result = [NSMutableData data];
+	if (bytes[0] == MIKMIDICommandTypeSystemExclusive) {
+		size_t capacity = MIKMIDIUniversalSystemExclusiveMessageCount(length);
+		NSMutableData *messages = [NSMutableData dataWithLength:capacity * sizeof(MIKMIDIUniversalMessage)];
+		size_t count = MIKMIDIUniversalMessagesMakeSystemExclusive(group, bytes, length, [messages mutableBytes], capacity);
+		[result setLength:count * MIKMIDIUniversalMessageWordCountForType(MIKMIDIUniversalMessageTypeData64) * sizeof(UInt32)];
+		MIKMIDIUniversalPacketWrite([messages bytes], count, [result mutableBytes], [result length] / sizeof(UInt32));
+		return [result length] ? result : nil;
+	}
+
+	// Some commands, like 14-bit control changes, are made of more than one MIDI 1.0 message
+	MIKMIDIMessageParser parser;
+	MIKMIDIMessageParserInit(&parser);
+	size_t offset = 0;
+	while (offset < length) {
+		MIKMIDIParsedMessage parsedMessages[kMIKMIDICommandUniversalMessageBufferSize];
+		size_t bytesConsumed = 0;
+		size_t count = MIKMIDIMessageParserParse(&parser, bytes + offset, length - offset, 0, parsedMessages, kMIKMIDICommandUniversalMessageBufferSize, &bytesConsumed);
+		offset += bytesConsumed;
+		for (size_t i = 0; i < count; i++) {
+			MIKMIDIParsedMessage *parsedMessage = &parsedMessages[i];
+			if (parsedMessage->kind != MIKMIDIParsedMessageKindShort) continue;
+
+			MIKMIDIUniversalMessage message;
+			if (!MIKMIDIUniversalMessageMakeMIDI1(group, parsedMessage->status, parsedMessage->data1, parsedMessage->data2, &message)) continue;
+			MIKMIDIUniversalMessage translatedMessage;
+			if (protocol == MIKMIDIProtocol2_0 && MIKMIDIUniversalMessageTranslateToMIDI2(&message, &translatedMessage)) message = translatedMessage;
+			[result appendBytes:message.words length:MIKMIDIUniversalMessageWordCountForType(MIKMIDIUniversalMessageGetType(&message)) * sizeof(UInt32)];
+		}
+		if (!bytesConsumed) break;
+	}
+	return [result length] ? result : nil;
+}
+
 - (NSString *)description
 {
     NSDateFormatter *dateFormatter = [[NSDateFormatter alloc] init];
@@ -340,17 +494,31 @@ ByteCount MIKMIDIPacketListSizeForCommands(NSArray *commands)
 		return 0;
 	}
 
-	// Compute the size of static members of MIDIPacketList and (MIDIPacket * [commands count])
-	ByteCount packetListSize = offsetof(MIDIPacketList, packet) + offsetof(MIDIPacket, data) * [commands count];
-
-	// Compute the total number of MIDI bytes in all commands
+	// Each command could need its own packet, which may be padded to 4-byte alignment (see MIDIPacketNext()).
+	// internalData is used rather than data, which would copy it.
+	ByteCount packetListSize = offsetof(MIDIPacketList, packet);
 	for (MIKMIDICommand *command in commands) {
-		packetListSize += [[command data] length];
+		packetListSize += offsetof(MIDIPacket, data) + [command.internalData length] + 3;
 	}
 
 	return packetListSize;
 }
 
+BOOL MIKMIDIPacketListInitWithCommands(MIDIPacketList *packetList, ByteCount listSize, NSArray *commands)
+{
+	if (packetList == NULL || listSize < sizeof(packetList->numPackets)) {
+		return NO;
+	}
+
+	MIDIPacket *currentPacket = MIDIPacketListInit(packetList);
+	for (MIKMIDICommand *command in commands) {
+		NSData *data = command.internalData;
+		currentPacket = MIDIPacketListAdd(packetList, listSize, currentPacket, command.midiTimestamp, [data length], [data bytes]);
+		if (!currentPacket) return NO;
+	}
+	return YES;
+}
+
 BOOL MIKCreateMIDIPacketListFromCommands(MIDIPacketList **outPacketList, NSArray *commands)
 {
 	if (outPacketList == NULL || commands == nil || [commands count] == 0) {
@@ -368,19 +536,9 @@ BOOL MIKCreateMIDIPacketListFromCommands(MIDIPacketList **outPacketList, NSArray
 		return NO;
 	}
 
-	MIDIPacket *currentPacket = MIDIPacketListInit(packetList);
-	for (NSUInteger i=0; i<[commands count]; i++) {
-		MIKMIDICommand *command = [commands objectAtIndex:i];
-		currentPacket = MIDIPacketListAdd(packetList,
-										  listSize,
-										  currentPacket,
-										  command.midiTimestamp,
-										  [command.data length],
-										  [command.data bytes]);
-		if (!currentPacket && (i < [commands count] - 1)) {
-			free(packetList);
-			return NO;
-		}
+	if (!MIKMIDIPacketListInitWithCommands(packetList, listSize, commands)) {
+		free(packetList);
+		return NO;
 	}
 
 	*outPacketList = packetList;
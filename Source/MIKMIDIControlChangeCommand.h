@@ -122,6 +122,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, readwrite) UInt8 channel;
 @property (nonatomic, readwrite) NSUInteger value;
+@property (nonatomic, readwrite) UInt32 highResolutionValue;
 
 @property (nonatomic, readwrite) NSUInteger controllerNumber;
 @property (nonatomic, readwrite) NSUInteger controllerValue;
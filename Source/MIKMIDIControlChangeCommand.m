@@ -128,6 +128,20 @@
 	return @[self];
 }
 
+- (NSData *)universalMIDIPacketDataWithProtocol:(MIKMIDIProtocol)protocol group:(UInt8)group
+{
+	// In MIDI 2.0, a 14-bit control change is a single control change with a 32-bit value
+	NSArray *commands = (protocol == MIKMIDIProtocol1_0) ? [self commandsForTransmission] : nil;
+	if ([commands count] < 2) return [super universalMIDIPacketDataWithProtocol:protocol group:group];
+
+	NSMutableData *result = [NSMutableData data];
+	for (MIKMIDIControlChangeCommand *command in commands) {
+		NSData *data = [command universalMIDIPacketDataWithProtocol:protocol group:group];
+		if (data) [result appendData:data];
+	}
+	return [result length] ? result : nil;
+}
+
 #pragma mark - Private
 
 #pragma mark - Properties
@@ -190,6 +204,18 @@
 	[self.internalData replaceBytesInRange:NSMakeRange(3, 1) withBytes:&LSB length:1];
 }
 
+- (UInt8)lowResolutionValueBitCount { return self.isFourteenBitCommand ? 14 : 7; }
+- (NSUInteger)lowResolutionValue { return self.isFourteenBitCommand ? self.fourteenBitValue : self.controllerValue; }
+
+- (void)setLowResolutionValue:(NSUInteger)value
+{
+	if (self.isFourteenBitCommand) {
+		self.fourteenBitValue = value;
+	} else {
+		self.controllerValue = value;
+	}
+}
+
 @dynamic channel; // MIKMIDIChannelVoiceCommand already implements a getter *and* setter for this. This keeps the compiler happy.
 
 @end
@@ -203,6 +229,7 @@
 // One of the super classes already implements a getter *and* setter for these. @dynamic keeps the compiler happy.
 @dynamic channel;
 @dynamic value;
+@dynamic highResolutionValue;
 @dynamic controllerNumber;
 @dynamic controllerValue;
 @dynamic fourteenBitCommand;
@@ -0,0 +1,77 @@
+//
+//  MIKMIDIDeferredCommandArray.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMIDI/CoreMIDI.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDICommand;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  A compact description of a received command, from which an MIKMIDICommand can be created later.
+ */
+typedef struct {
+	MIDITimeStamp timeStamp;
+	/** The command's bytes. A 14-bit control change has four: status, controller number, MSB value and LSB value.
+	 A parameter change has the nine or twelve bytes of the three or four control changes it's made of. */
+	UInt8 bytes[12];
+	/** The number of bytes used in bytes, or 0 for a command that was created already. Even then, bytes[0] is its status byte. */
+	UInt8 length;
+	/** For a command that was created already, its index in the array's prebuilt commands. */
+	UInt32 prebuiltCommandIndex;
+} MIKMIDICommandRecord;
+
+/**
+ *  An immutable array of MIKMIDICommands that are only created when one of them is first accessed.
+ *  Until then, the array holds a copy of the compact records it was created with. Commands are all
+ *  created at once, the first time any of them are needed, and safely from any thread.
+ *
+ *  MIKMIDIInputPort uses this so that parsing incoming MIDI doesn't create an object per message,
+ *  and commands that no handler looks at are never created.
+ *
+ *  @note This class is for internal MIKMIDI use only.
+ */
+@interface MIKMIDIDeferredCommandArray : NSArray
+
+/**
+ *  Creates an array.
+ *
+ *  @param records          The records to create commands from. They are copied.
+ *  @param count            The number of records.
+ *  @param prebuiltCommands Commands that have been created already, such as system exclusive commands,
+ *  which records with a length of 0 refer to by index. May be nil.
+ *
+ *  @return An initialized array.
+ */
+- (instancetype)initWithRecords:(const MIKMIDICommandRecord *)records count:(NSUInteger)count prebuiltCommands:(nullable MIKArrayOf(MIKMIDICommand *) *)prebuiltCommands;
+
+/**
+ *  Returns an array of the commands whose records pass a test, without creating any commands
+ *  that haven't been created already.
+ *
+ *  @param test A block called with each record, in order, which returns YES if its command should be included.
+ *
+ *  @return An array of the commands that passed. The receiver if all of them passed.
+ */
+- (MIKArrayOf(MIKMIDICommand *) *)arrayWithRecordsPassingTest:(BOOL (^)(const MIKMIDICommandRecord *record))test;
+
+@end
+
+/**
+ *  Creates the command described by a record.
+ *
+ *  @param record           The record.
+ *  @param prebuiltCommands The prebuilt commands the record may refer to.
+ *
+ *  @return An MIKMIDICommand.
+ */
+MIKMIDICommand *MIKMIDICommandFromRecord(const MIKMIDICommandRecord *record, MIKArrayOf(MIKMIDICommand *) * _Nullable prebuiltCommands);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,133 @@
+//
+//  MIKMIDIDeferredCommandArray.m
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIDeferredCommandArray.h"
+#import "MIKMIDICommand.h"
+#import "MIKMIDIControlChangeCommand.h"
+#import "MIKMIDIParameterChangeCommand.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDIDeferredCommandArray.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIDeferredCommandArray.m in the Build Phases for this target
+#endif
+
+MIKMIDICommand *MIKMIDICommandFromRecord(const MIKMIDICommandRecord *record, NSArray *prebuiltCommands)
+{
+	if (record->length == 0) return prebuiltCommands[record->prebuiltCommandIndex];
+
+	MIDIPacket packet;
+	packet.timeStamp = record->timeStamp;
+	if (record->length > 4) {
+		// An RPN or NRPN parameter change, made from the control changes in bytes
+		packet.length = MIN(record->length, sizeof(record->bytes));
+		memcpy(packet.data, record->bytes, packet.length);
+		return [[MIKMIDIParameterChangeCommand alloc] initWithMIDIPacket:&packet];
+	}
+	packet.length = MIN(record->length, 3);
+	memcpy(packet.data, record->bytes, packet.length);
+	MIKMIDICommand *command = [MIKMIDICommand commandWithMIDIPacket:&packet];
+	if (record->length < 4) return command;
+
+	// A 14-bit control change, made from its MSB and LSB control changes
+	packet.data[1] = record->bytes[1] + 32;
+	packet.data[2] = record->bytes[3];
+	MIKMIDICommand *lsbCommand = [MIKMIDICommand commandWithMIDIPacket:&packet];
+	MIKMIDICommand *fourteenBitCommand = [MIKMIDIControlChangeCommand commandByCoalescingMSBCommand:(MIKMIDIControlChangeCommand *)command
+																					  andLSBCommand:(MIKMIDIControlChangeCommand *)lsbCommand];
+	return fourteenBitCommand ?: command;
+}
+
+@interface MIKMIDIDeferredCommandArray ()
+
+@property (atomic, strong) NSArray *commands;
+
+@end
+
+@implementation MIKMIDIDeferredCommandArray
+{
+	MIKMIDICommandRecord *_records;
+	NSUInteger _count;
+	NSArray *_prebuiltCommands;
+}
+
+- (instancetype)initWithRecords:(const MIKMIDICommandRecord *)records count:(NSUInteger)count prebuiltCommands:(NSArray *)prebuiltCommands
+{
+	self = [super init];
+	if (self) {
+		_records = malloc(MAX(count, 1) * sizeof(MIKMIDICommandRecord));
+		if (count) memcpy(_records, records, count * sizeof(MIKMIDICommandRecord));
+		_count = count;
+		_prebuiltCommands = [prebuiltCommands copy];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	free(_records);
+}
+
+- (NSArray *)arrayWithRecordsPassingTest:(BOOL (^)(const MIKMIDICommandRecord *))test
+{
+	NSMutableIndexSet *passingIndexes = [NSMutableIndexSet indexSet];
+	for (NSUInteger i = 0; i < _count; i++) {
+		if (test(&_records[i])) [passingIndexes addIndex:i];
+	}
+	if ([passingIndexes count] == _count) return self;
+	if (![passingIndexes count]) return @[];
+	
+	// Commands that exist already are shared rather than created again
+	NSArray *commands = self.commands;
+	if (commands) return [commands objectsAtIndexes:passingIndexes];
+	
+	MIKMIDICommandRecord *passingRecords = malloc([passingIndexes count] * sizeof(MIKMIDICommandRecord));
+	__block NSUInteger passingCount = 0;
+	[passingIndexes enumerateIndexesUsingBlock:^(NSUInteger idx, BOOL *stop) {
+		passingRecords[passingCount++] = self->_records[idx];
+	}];
+	NSArray *result = [[MIKMIDIDeferredCommandArray alloc] initWithRecords:passingRecords count:passingCount prebuiltCommands:_prebuiltCommands];
+	free(passingRecords);
+	return result;
+}
+
+#pragma mark - NSArray
+
+- (NSUInteger)count
+{
+	return _count;
+}
+
+- (id)objectAtIndex:(NSUInteger)index
+{
+	return [[self createdCommands] objectAtIndex:index];
+}
+
+- (NSUInteger)countByEnumeratingWithState:(NSFastEnumerationState *)state objects:(id __unsafe_unretained [])buffer count:(NSUInteger)len
+{
+	return [[self createdCommands] countByEnumeratingWithState:state objects:buffer count:len];
+}
+
+#pragma mark - Private
+
+- (NSArray *)createdCommands
+{
+	NSArray *commands = self.commands;
+	if (commands) return commands;
+
+	@synchronized(self) {
+		if (!self.commands) {
+			NSMutableArray *createdCommands = [NSMutableArray arrayWithCapacity:_count];
+			for (NSUInteger i = 0; i < _count; i++) {
+				[createdCommands addObject:MIKMIDICommandFromRecord(&_records[i], _prebuiltCommands)];
+			}
+			self.commands = createdCommands;
+		}
+		return self.commands;
+	}
+}
+
+@end
@@ -16,6 +16,7 @@
 @class MIKMIDIDestinationEndpoint;
 @class MIKMIDICommand;
 @class MIKMIDIOutputPort;
+@class MIKMIDIInputFilter;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -91,6 +92,35 @@ extern NSString * const MIKMIDIEndpointKey;
  */
 - (nullable id)connectDevice:(MIKMIDIDevice *)device error:(NSError **)error eventHandler:(MIKMIDIEventHandlerBlock)eventHandler;
 
+/**
+ *  Used to connect to a MIDI device, choosing where and how the event handler is called.
+ *  Otherwise the same as -connectDevice:error:eventHandler:.
+ *
+ *  @param device		An MIKMIDIDevice instance that should be connected.
+ *  @param deliveryMode	Where and how eventHandler is called. See MIKMIDIEventDeliveryMode.
+ *  @param error		If an error occurs, upon returns contains an NSError object that describes the problem.
+ *  If you are not interested in possible errors, you may pass in NULL.
+ *  @param eventHandler A block which will be called anytime incoming MIDI messages are received from the device.
+ *
+ *  @return A connection token to be used to disconnect the input, or nil if an error occurred. The connection token is opaque.
+ */
+- (nullable id)connectDevice:(MIKMIDIDevice *)device deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode error:(NSError **)error eventHandler:(MIKMIDIEventHandlerBlock)eventHandler;
+
+/**
+ *  Used to connect to a MIDI device, passing only the messages that get through filter to the event handler.
+ *  Otherwise the same as -connectDevice:deliveryMode:error:eventHandler:.
+ *
+ *  @param device		An MIKMIDIDevice instance that should be connected.
+ *  @param deliveryMode	Where and how eventHandler is called. See MIKMIDIEventDeliveryMode.
+ *  @param filter		Which messages to pass to eventHandler, or nil for all of them. The filter is copied. See MIKMIDIInputFilter.
+ *  @param error		If an error occurs, upon returns contains an NSError object that describes the problem.
+ *  If you are not interested in possible errors, you may pass in NULL.
+ *  @param eventHandler A block which will be called anytime incoming MIDI messages that get through filter are received from the device.
+ *
+ *  @return A connection token to be used to disconnect the input, or nil if an error occurred. The connection token is opaque.
+ */
+- (nullable id)connectDevice:(MIKMIDIDevice *)device deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode filter:(nullable MIKMIDIInputFilter *)filter error:(NSError **)error eventHandler:(MIKMIDIEventHandlerBlock)eventHandler;
+
 /**
  *  Used to connect to a single MIDI input/source endpoint. Returns a token that must be kept and passed into the
  *  -disconnectConnectionforToken: method.
@@ -104,6 +134,41 @@ extern NSString * const MIKMIDIEndpointKey;
  */
 - (nullable id)connectInput:(MIKMIDISourceEndpoint *)endpoint error:(NSError **)error eventHandler:(MIKMIDIEventHandlerBlock)eventHandler;
 
+/**
+ *  Used to connect to a single MIDI input/source endpoint, choosing where and how the event handler
+ *  is called. Otherwise the same as -connectInput:error:eventHandler:.
+ *
+ *  For the lowest latency, use MIKMIDIEventDeliveryModeReadThread or MIKMIDIEventDeliveryModeHighPriorityQueue,
+ *  which don't wait for the main thread.
+ *
+ *  @param endpoint		An MIKMIDISourceEndpoint instance that should be connected.
+ *  @param deliveryMode	Where and how eventHandler is called. See MIKMIDIEventDeliveryMode.
+ *  @param error		If an error occurs, upon returns contains an NSError object that describes the problem.
+ *  If you are not interested in possible errors, you may pass in NULL.
+ *  @param eventHandler A block which will be called anytime incoming MIDI messages are received from the endpoint.
+ *
+ *  @return A connection token to be used to disconnect the input, or nil if an error occurred. The connection token is opaque.
+ */
+- (nullable id)connectInput:(MIKMIDISourceEndpoint *)endpoint deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode error:(NSError **)error eventHandler:(MIKMIDIEventHandlerBlock)eventHandler;
+
+/**
+ *  Used to connect to a single MIDI input/source endpoint, passing only the messages that get through
+ *  filter to the event handler. Otherwise the same as -connectInput:deliveryMode:error:eventHandler:.
+ *
+ *  Filters are applied before MIKMIDICommand objects are created, so filtering out messages a handler
+ *  doesn't need, like clock ticks and active sensing, saves much more work than ignoring them in the handler.
+ *
+ *  @param endpoint		An MIKMIDISourceEndpoint instance that should be connected.
+ *  @param deliveryMode	Where and how eventHandler is called. See MIKMIDIEventDeliveryMode.
+ *  @param filter		Which messages to pass to eventHandler, or nil for all of them. The filter is copied. See MIKMIDIInputFilter.
+ *  @param error		If an error occurs, upon returns contains an NSError object that describes the problem.
+ *  If you are not interested in possible errors, you may pass in NULL.
+ *  @param eventHandler A block which will be called anytime incoming MIDI messages that get through filter are received from the endpoint.
+ *
+ *  @return A connection token to be used to disconnect the input, or nil if an error occurred. The connection token is opaque.
+ */
+- (nullable id)connectInput:(MIKMIDISourceEndpoint *)endpoint deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode filter:(nullable MIKMIDIInputFilter *)filter error:(NSError **)error eventHandler:(MIKMIDIEventHandlerBlock)eventHandler;
+
 /**
  *  Disconnects a previously connected MIDI device or input/source endpoint. The connectionToken argument
  *  must be a token previously returned by -connectDevice:error:eventHandler: or -connectInput:error:eventHandler:.
@@ -108,6 +108,16 @@ static MIKMIDIDeviceManager *sharedDeviceManager;
 #pragma mark - Public
 
 - (nullable id)connectDevice:(MIKMIDIDevice *)device error:(NSError **)error eventHandler:(MIKMIDIEventHandlerBlock)eventHandler
+{
+	return [self connectDevice:device deliveryMode:MIKMIDIEventDeliveryModeMainQueue error:error eventHandler:eventHandler];
+}
+
+- (nullable id)connectDevice:(MIKMIDIDevice *)device deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode error:(NSError **)error eventHandler:(MIKMIDIEventHandlerBlock)eventHandler
+{
+	return [self connectDevice:device deliveryMode:deliveryMode filter:nil error:error eventHandler:eventHandler];
+}
+
+- (nullable id)connectDevice:(MIKMIDIDevice *)device deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode filter:(MIKMIDIInputFilter *)filter error:(NSError **)error eventHandler:(MIKMIDIEventHandlerBlock)eventHandler
 {
 	error = error ?: &(NSError *__autoreleasing){ nil };
 	NSMutableArray *sources = [device.entities valueForKeyPath:@"@unionOfArrays.sources"];
@@ -118,7 +128,7 @@ static MIKMIDIDeviceManager *sharedDeviceManager;
 	
 	NSMutableArray *tokens = [NSMutableArray array];
 	for (MIKMIDISourceEndpoint *source in sources) {
-		id token = [self.inputPort connectToSource:source error:error eventHandler:eventHandler];
+		id token = [self.inputPort connectToSource:source deliveryMode:deliveryMode filter:filter error:error eventHandler:eventHandler];
 		if (!token) {
 			for (id token in tokens) { [self disconnectConnectionForToken:token]; }
 			return nil;
@@ -131,7 +141,17 @@ static MIKMIDIDeviceManager *sharedDeviceManager;
 
 - (id)connectInput:(MIKMIDISourceEndpoint *)endpoint error:(NSError **)error eventHandler:(MIKMIDIEventHandlerBlock)eventHandler
 {
-	id result = [self.inputPort connectToSource:endpoint error:error eventHandler:eventHandler];
+	return [self connectInput:endpoint deliveryMode:MIKMIDIEventDeliveryModeMainQueue error:error eventHandler:eventHandler];
+}
+
+- (id)connectInput:(MIKMIDISourceEndpoint *)endpoint deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode error:(NSError **)error eventHandler:(MIKMIDIEventHandlerBlock)eventHandler
+{
+	return [self connectInput:endpoint deliveryMode:deliveryMode filter:nil error:error eventHandler:eventHandler];
+}
+
+- (id)connectInput:(MIKMIDISourceEndpoint *)endpoint deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode filter:(MIKMIDIInputFilter *)filter error:(NSError **)error eventHandler:(MIKMIDIEventHandlerBlock)eventHandler
+{
+	id result = [self.inputPort connectToSource:endpoint deliveryMode:deliveryMode filter:filter error:error eventHandler:eventHandler];
 	if (!result) return nil;
 	return @[result];
 }
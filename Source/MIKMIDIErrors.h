@@ -65,6 +65,24 @@ typedef NS_ENUM(NSInteger, MIKMIDIErrorCode) {
 	 *  instruments.
 	 */
 	MIKMIDISynthesizerDoesNotSupportInstrumentSelectionError,
+	
+	/**
+	 *  An error occurred reading a MIDI file because its contents are not
+	 *  valid Standard MIDI File data.
+	 */
+	MIKMIDIInvalidMIDIFileErrorCode,
+	
+	/**
+	 *  An MIKMIDISystemExclusiveSender couldn't start sending because it
+	 *  was already sending, or had already used up its input stream.
+	 */
+	MIKMIDISystemExclusiveSenderBusyErrorCode,
+	
+	/**
+	 *  Data passed to MIKMIDISystemExclusiveSender doesn't start with a
+	 *  system exclusive status byte (0xF0).
+	 */
+	MIKMIDIInvalidSystemExclusiveDataErrorCode,
 };
 
 NSString *MIKMIDIDefaultLocalizedErrorDescriptionForErrorCode(MIKMIDIErrorCode code);
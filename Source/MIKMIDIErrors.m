@@ -18,6 +18,8 @@ NSString *MIKMIDIDefaultLocalizedErrorDescriptionForErrorCode(MIKMIDIErrorCode c
 {
 	NSDictionary *descriptions =
 	@{@(MIKMIDIDeviceHasNoSourcesErrorCode) : NSLocalizedString(@"MIDI Device has no sources.", @"MIDI Device has no sources."),
+	  @(MIKMIDISystemExclusiveSenderBusyErrorCode) : NSLocalizedString(@"System exclusive data is already being sent.", @"System exclusive data is already being sent."),
+	  @(MIKMIDIInvalidSystemExclusiveDataErrorCode) : NSLocalizedString(@"The data is not a system exclusive message.", @"The data is not a system exclusive message."),
 	  @(MIKMIDIUnknownErrorCode) : NSLocalizedString(@"An unknown MIDI error occurred.", @"An unknown MIDI error occurred.")};
 	return descriptions[@(code)] ?: NSLocalizedString(@"A MIDI error occurred.", @"Generic error description");
 }
@@ -0,0 +1,32 @@
+//
+//  MIKMIDIEvent+MIKMIDIPrivate.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIEvent.h"
+#import "MIKMIDICompilerCompatibility.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface MIKMIDIEvent ()
+
+/**
+ *  Initializes an event directly from its data bytes. Unlike -initWithTimeStamp:midiEventType:data:,
+ *  this doesn't look up the subclass for eventType, so it's cheap enough to use for creating many events
+ *  at once, e.g. when they're unpacked from an MIKMIDIEventStore.
+ *
+ *  @param timeStamp The time stamp for the event.
+ *  @param eventType The type of the event. The receiver's class must support it.
+ *  @param bytes     The event's data.
+ *  @param length    The number of bytes of data.
+ *
+ *  @return An initialized event.
+ */
+- (instancetype)initWithTimeStamp:(MusicTimeStamp)timeStamp midiEventType:(MIKMIDIEventType)eventType bytes:(const void *)bytes length:(NSUInteger)length;
+
+@end
+
+NS_ASSUME_NONNULL_END
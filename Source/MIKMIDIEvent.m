@@ -8,6 +8,7 @@
 
 #import "MIKMIDIEvent.h"
 #import "MIKMIDIEvent_SubclassMethods.h"
+#import "MIKMIDIEvent+MIKMIDIPrivate.h"
 #import "MIKMIDIMetaEvent.h"
 #import "MIKMIDIUtilities.h"
 
@@ -64,6 +65,17 @@ static NSMutableSet *registeredMIKMIDIEventSubclasses;
 	return self;
 }
 
+- (instancetype)initWithTimeStamp:(MusicTimeStamp)timeStamp midiEventType:(MIKMIDIEventType)eventType bytes:(const void *)bytes length:(NSUInteger)length
+{
+	self = [super init];
+	if (self) {
+		_timeStamp = timeStamp;
+		_eventType = eventType;
+		_internalData = [NSMutableData dataWithBytes:bytes length:length];
+	}
+	return self;
+}
+
 - (instancetype)initWithTimeStamp:(MusicTimeStamp)timeStamp midiEventType:(MIKMIDIEventType)eventType
 {
 	return [self initWithTimeStamp:timeStamp midiEventType:eventType data:nil];
@@ -98,8 +110,10 @@ static NSMutableSet *registeredMIKMIDIEventSubclasses;
 - (NSUInteger)hash
 {
 	MusicTimeStamp timestamp = self.timeStamp;
-	if (timestamp == 0) return [self.data hash];
-	return (NSUInteger)(timestamp * [self.data hash]);
+	// Same as [self.data hash], without copying the data
+	NSUInteger dataHash = [self.internalData hash];
+	if (timestamp == 0) return dataHash;
+	return (NSUInteger)(timestamp * dataHash);
 }
 
 #pragma mark - Private
@@ -202,6 +216,9 @@ static NSMutableSet *registeredMIKMIDIEventSubclasses;
 
 - (id)copyWithZone:(NSZone *)zone
 {
+	// Immutable events can't change, so there's no need for a separate copy of their data
+	if (![[self class] isMutable]) return self;
+
 	Class copyClass = [[self class] immutableCounterpartClass];
 	MIKMIDIEvent *result = [[copyClass alloc] init];
 	result.internalData = self.internalData;
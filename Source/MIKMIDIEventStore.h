@@ -0,0 +1,144 @@
+//
+//  MIKMIDIEventStore.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import "MIKMIDICompilerCompatibility.h"
+#import "MIKMIDIEvent.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  The block called for each event by -[MIKMIDIEventStore enumerateEventsOfClass:fromTimeStamp:toTimeStamp:usingBlock:].
+ *
+ *  @param index     The index of the event in the store, which can be passed to -eventsAtIndexes:.
+ *  @param timeStamp The event's timestamp.
+ *  @param eventType The event's type.
+ *  @param bytes     The event's data, in the same form as -[MIKMIDIEvent data]. Only valid during the call.
+ *  @param length    The number of bytes of data.
+ *  @param stop      Set to YES to stop enumerating.
+ */
+typedef void(^MIKMIDIEventStoreEnumerationBlock)(NSUInteger index, MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *bytes, NSUInteger length, BOOL *stop);
+
+/**
+ *  MIKMIDIEventStore holds a set of MIKMIDIEvents in timestamp order. It is the backing store
+ *  for MIKMIDITrack's events.
+ *
+ *  Events are kept in a list of short sorted runs, so finding, adding and removing an event,
+ *  and locating the start of a range of events, take O(log n) time, without the whole
+ *  store ever needing to be re-sorted. Events with the same timestamp are kept in the order
+ *  they were added. As with an NSSet, the store never contains two equal events.
+ *
+ *  Note and channel events, which make up nearly all of a typical track, aren't kept as objects.
+ *  Their timestamps, types and data are packed into parallel arrays, taking 17 bytes per event,
+ *  and an event object is only created for one when it's returned from the store. The store doesn't
+ *  keep the object, but returns it again for as long as something else does. Event data can also be
+ *  read without creating any objects, using -enumerateEventsOfClass:fromTimeStamp:toTimeStamp:usingBlock:.
+ *
+ *  Copying a store copies its packed events, not objects for them.
+ *
+ *  Events can be read from more than one thread at a time, but changing the store is not thread safe.
+ *
+ *  @note This class is for internal MIKMIDI use only. It is used by MIKMIDITrack.
+ */
+@interface MIKMIDIEventStore : NSObject <NSCopying>
+
+/**
+ *  Creates a store containing events. Events need not be sorted, and duplicates are ignored.
+ *
+ *  @param events An array of MIKMIDIEvents. Events that are already in timestamp order are
+ *  stored without being sorted again. Events that are kept as objects must not be mutated while in the store.
+ *
+ *  @return An initialized store.
+ */
+- (instancetype)initWithEvents:(MIKArrayOf(MIKMIDIEvent *) *)events;
+
+/**
+ *  Adds an event to the store, after any events already in the store with the same timestamp.
+ *
+ *  @param event The event to add. If it's kept as an object, it must not be mutated while in the store.
+ *
+ *  @return YES if the event was added, NO if the store already contained an equal event.
+ */
+- (BOOL)addEvent:(MIKMIDIEvent *)event;
+
+/**
+ *  Removes the event in the store that is equal to event.
+ *
+ *  @param event The event to remove.
+ *
+ *  @return YES if the event was removed, NO if the store didn't contain it.
+ */
+- (BOOL)removeEvent:(MIKMIDIEvent *)event;
+
+/**
+ *  Returns whether the store contains an event equal to event.
+ */
+- (BOOL)containsEvent:(MIKMIDIEvent *)event;
+
+/**
+ *  Returns the events between two timestamps, inclusive, in timestamp order.
+ *
+ *  @param eventClass     The class of events to return, or Nil for all events.
+ *  @param startTimeStamp The first timestamp to include.
+ *  @param endTimeStamp   The last timestamp to include.
+ *
+ *  @return An array of the matching events.
+ */
+- (MIKArrayOf(MIKMIDIEvent *) *)eventsOfClass:(nullable Class)eventClass fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  Calls a block with each of the events between two timestamps, inclusive, in timestamp order,
+ *  without creating any event objects.
+ *
+ *  @param eventClass     The class of events to enumerate, or Nil for all events.
+ *  @param startTimeStamp The first timestamp to include.
+ *  @param endTimeStamp   The last timestamp to include.
+ *  @param block          The block to call with each event. It must not change the store.
+ */
+- (void)enumerateEventsOfClass:(nullable Class)eventClass fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingBlock:(MIKMIDIEventStoreEnumerationBlock)block;
+
+/**
+ *  Returns the events at a set of indexes, as passed to the block of
+ *  -enumerateEventsOfClass:fromTimeStamp:toTimeStamp:usingBlock:. Indexes are only valid until the store changes.
+ *
+ *  @param indexes The indexes of the events to return.
+ *
+ *  @return An array of the events, in timestamp order.
+ */
+- (MIKArrayOf(MIKMIDIEvent *) *)eventsAtIndexes:(NSIndexSet *)indexes;
+
+/**
+ *  Returns the timestamp of the first event after a timestamp, without creating any event objects.
+ *
+ *  @param timeStamp The timestamp to look after.
+ *
+ *  @return The timestamp of the first event later than timeStamp, or DBL_MAX if there isn't one.
+ */
+- (MusicTimeStamp)timeStampOfFirstEventAfterTimeStamp:(MusicTimeStamp)timeStamp;
+
+/**
+ *  All of the events in the store, in timestamp order.
+ */
+@property (nonatomic, readonly) MIKArrayOf(MIKMIDIEvent *) *allEvents;
+
+/**
+ *  The latest time at which an event in the store ends. That is the end time stamp of the last
+ *  note to end, or the time stamp of the last event, whichever is later. -DBL_MAX if the store is empty.
+ *  Calculated without creating any event objects.
+ */
+@property (nonatomic, readonly) MusicTimeStamp endTimeStamp;
+
+/**
+ *  The number of events in the store.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+@end
+
+NS_ASSUME_NONNULL_END
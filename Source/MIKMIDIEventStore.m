@@ -0,0 +1,605 @@
+//
+//  MIKMIDIEventStore.m
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIEventStore.h"
+#import "MIKMIDIEvent.h"
+#import "MIKMIDIEvent_SubclassMethods.h"
+#import "MIKMIDIEvent+MIKMIDIPrivate.h"
+#import "MIKMIDINoteEvent.h"
+#import "MIKMIDIPolyphonicKeyPressureEvent.h"
+#import "MIKMIDIControlChangeEvent.h"
+#import "MIKMIDIProgramChangeEvent.h"
+#import "MIKMIDIChannelPressureEvent.h"
+#import "MIKMIDIPitchBendChangeEvent.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDIEventStore.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIEventStore.m in the Build Phases for this target
+#endif
+
+// Large enough that the list of chunks stays short, small enough that inserting into a chunk is cheap.
+static const NSUInteger MIKMIDIEventStoreMaximumChunkSize = 512;
+
+// Stands in for the event type of events that are kept as objects. No packed event type has this value.
+static const UInt8 MIKMIDIEventStoreObjectEventType = MIKMIDIEventTypeNULL;
+
+typedef struct {
+	NSUInteger chunk;
+	NSUInteger index;
+} MIKMIDIEventStorePosition;
+
+// The class that packed events of eventType are created as, or Nil if events of that type aren't packed.
+static Class MIKMIDIEventStoreClassForEventType(MIKMIDIEventType eventType)
+{
+	switch (eventType) {
+		case MIKMIDIEventTypeMIDINoteMessage: return [MIKMIDINoteEvent class];
+		case MIKMIDIEventTypeMIDIPolyphonicKeyPressureMessage: return [MIKMIDIPolyphonicKeyPressureEvent class];
+		case MIKMIDIEventTypeMIDIControlChangeMessage: return [MIKMIDIControlChangeEvent class];
+		case MIKMIDIEventTypeMIDIProgramChangeMessage: return [MIKMIDIProgramChangeEvent class];
+		case MIKMIDIEventTypeMIDIChannelPressureMessage: return [MIKMIDIChannelPressureEvent class];
+		case MIKMIDIEventTypeMIDIPitchBendChangeMessage: return [MIKMIDIPitchBendChangeEvent class];
+		default: return Nil;
+	}
+}
+
+static NSUInteger MIKMIDIEventStoreDataLengthForEventType(MIKMIDIEventType eventType)
+{
+	return (eventType == MIKMIDIEventTypeMIDINoteMessage) ? sizeof(MIDINoteMessage) : sizeof(MIDIChannelMessage);
+}
+
+// Gets the packed form of event, if events of its type are packed, whatever event's class. Two events with
+// the same timestamp are equal if and only if their packed forms are equal, as with -[MIKMIDIEvent isEqual:].
+static BOOL MIKMIDIEventStorePack(MIKMIDIEvent *event, UInt8 *outEventType, UInt64 *outPayload)
+{
+	MIKMIDIEventType eventType = event.eventType;
+	if (!MIKMIDIEventStoreClassForEventType(eventType)) return NO;
+
+	NSData *data = event.internalData;
+	NSUInteger length = [data length];
+	if (length != MIKMIDIEventStoreDataLengthForEventType(eventType)) return NO;
+
+	UInt64 payload = 0;
+	memcpy(&payload, [data bytes], length);
+	*outEventType = (UInt8)eventType;
+	*outPayload = payload;
+	return YES;
+}
+
+#pragma mark -
+
+// A run of consecutive events, stored as parallel arrays. Note and channel events of the standard classes are
+// packed into a timestamp, an event type and 8 bytes of data. Other events are kept as objects.
+@interface MIKMIDIEventStoreChunk : NSObject
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity;
+
+- (void)insertEvent:(MIKMIDIEvent *)event atIndex:(NSUInteger)index;
+- (void)removeEventAtIndex:(NSUInteger)index;
+- (void)appendEventsInRange:(NSRange)range ofChunk:(MIKMIDIEventStoreChunk *)chunk;
+- (void)truncateToCount:(NSUInteger)count;
+
+// Creates an event object for a packed event, unless one created earlier is still in use.
+- (MIKMIDIEvent *)eventAtIndex:(NSUInteger)index;
+- (Class)classOfEventAtIndex:(NSUInteger)index;
+- (MusicTimeStamp)endTimeStampOfEventAtIndex:(NSUInteger)index;
+// Gets the type and data of an event without creating an object for it. bytes is valid until the chunk changes.
+- (void)getEventType:(MIKMIDIEventType *)outEventType bytes:(const void **)outBytes length:(NSUInteger *)outLength atIndex:(NSUInteger)index;
+
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) const MusicTimeStamp *timeStamps;
+@property (nonatomic, readonly) const UInt8 *eventTypes;
+@property (nonatomic, readonly) const UInt64 *payloads;
+// nil unless the chunk contains events that aren't packed. Holds NSNull for packed events.
+@property (nonatomic, strong, readonly) NSMutableArray *objects;
+
+@end
+
+@implementation MIKMIDIEventStoreChunk
+{
+	NSUInteger _capacity;
+	MusicTimeStamp *_timeStamps;
+	UInt8 *_eventTypes;
+	UInt64 *_payloads;
+	// nil until an object has been created for a packed event. Holds a weak reference to the object created
+	// for each packed event, so the same object is returned while it's in use, but the chunk doesn't keep it.
+	NSPointerArray *_createdEvents;
+}
+
+- (instancetype)initWithCapacity:(NSUInteger)capacity
+{
+	self = [super init];
+	if (self) {
+		[self ensureCapacity:MAX(capacity, 1)];
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	free(_timeStamps);
+	free(_eventTypes);
+	free(_payloads);
+}
+
+- (void)ensureCapacity:(NSUInteger)capacity
+{
+	if (capacity <= _capacity) return;
+	capacity = MAX(capacity, _capacity * 2);
+	_timeStamps = reallocf(_timeStamps, capacity * sizeof(*_timeStamps));
+	_eventTypes = reallocf(_eventTypes, capacity * sizeof(*_eventTypes));
+	_payloads = reallocf(_payloads, capacity * sizeof(*_payloads));
+	if (!_timeStamps || !_eventTypes || !_payloads) {
+		[NSException raise:NSMallocException format:@"Unable to allocate storage for %lu events.", (unsigned long)capacity];
+	}
+	_capacity = capacity;
+}
+
+- (void)insertEvent:(MIKMIDIEvent *)event atIndex:(NSUInteger)index
+{
+	[self ensureCapacity:_count + 1];
+	NSUInteger tailCount = _count - index;
+	memmove(_timeStamps + index + 1, _timeStamps + index, tailCount * sizeof(*_timeStamps));
+	memmove(_eventTypes + index + 1, _eventTypes + index, tailCount * sizeof(*_eventTypes));
+	memmove(_payloads + index + 1, _payloads + index, tailCount * sizeof(*_payloads));
+
+	UInt8 eventType = MIKMIDIEventStoreObjectEventType;
+	UInt64 payload = 0;
+	// Subclasses and mutable events may have more to them than their data, so they're kept as they are.
+	BOOL packed = ([event class] == MIKMIDIEventStoreClassForEventType(event.eventType)) && MIKMIDIEventStorePack(event, &eventType, &payload);
+	_timeStamps[index] = event.timeStamp;
+	_eventTypes[index] = packed ? eventType : MIKMIDIEventStoreObjectEventType;
+	_payloads[index] = payload;
+
+	if (!packed && !_objects) {
+		_objects = [NSMutableArray arrayWithCapacity:_capacity];
+		for (NSUInteger i = 0; i < _count; i++) [_objects addObject:[NSNull null]];
+	}
+	[_objects insertObject:packed ? (id)[NSNull null] : event atIndex:index];
+	[_createdEvents insertPointer:NULL atIndex:index];
+	_count++;
+}
+
+- (void)removeEventAtIndex:(NSUInteger)index
+{
+	NSUInteger tailCount = _count - index - 1;
+	memmove(_timeStamps + index, _timeStamps + index + 1, tailCount * sizeof(*_timeStamps));
+	memmove(_eventTypes + index, _eventTypes + index + 1, tailCount * sizeof(*_eventTypes));
+	memmove(_payloads + index, _payloads + index + 1, tailCount * sizeof(*_payloads));
+	[_objects removeObjectAtIndex:index];
+	[_createdEvents removePointerAtIndex:index];
+	_count--;
+}
+
+- (void)appendEventsInRange:(NSRange)range ofChunk:(MIKMIDIEventStoreChunk *)chunk
+{
+	[self ensureCapacity:_count + range.length];
+	memcpy(_timeStamps + _count, chunk->_timeStamps + range.location, range.length * sizeof(*_timeStamps));
+	memcpy(_eventTypes + _count, chunk->_eventTypes + range.location, range.length * sizeof(*_eventTypes));
+	memcpy(_payloads + _count, chunk->_payloads + range.location, range.length * sizeof(*_payloads));
+
+	if (chunk.objects && !_objects) {
+		_objects = [NSMutableArray arrayWithCapacity:_capacity];
+		for (NSUInteger i = 0; i < _count; i++) [_objects addObject:[NSNull null]];
+	}
+	if (chunk.objects) {
+		[_objects addObjectsFromArray:[chunk.objects subarrayWithRange:range]];
+	} else if (_objects) {
+		for (NSUInteger i = 0; i < range.length; i++) [_objects addObject:[NSNull null]];
+	}
+
+	if (chunk->_createdEvents && !_createdEvents) {
+		_createdEvents = [NSPointerArray weakObjectsPointerArray];
+		_createdEvents.count = _count;
+	}
+	if (chunk->_createdEvents) {
+		for (NSUInteger i = 0; i < range.length; i++) [_createdEvents addPointer:[chunk->_createdEvents pointerAtIndex:range.location + i]];
+	} else {
+		_createdEvents.count = _count + range.length;
+	}
+	_count += range.length;
+}
+
+- (void)truncateToCount:(NSUInteger)count
+{
+	if (count >= _count) return;
+	[_objects removeObjectsInRange:NSMakeRange(count, _count - count)];
+	_createdEvents.count = count;
+	_count = count;
+}
+
+- (MIKMIDIEvent *)eventAtIndex:(NSUInteger)index
+{
+	MIKMIDIEventType eventType = _eventTypes[index];
+	if (eventType == MIKMIDIEventStoreObjectEventType) return _objects[index];
+
+	// Immutable events can safely be shared, so an object that's still in use is returned again.
+	MIKMIDIEvent *existingEvent = (__bridge MIKMIDIEvent *)[_createdEvents pointerAtIndex:index];
+	if (existingEvent) return existingEvent;
+
+	Class eventClass = MIKMIDIEventStoreClassForEventType(eventType);
+	MIKMIDIEvent *event = [[eventClass alloc] initWithTimeStamp:_timeStamps[index]
+												  midiEventType:eventType
+														  bytes:&_payloads[index]
+														 length:MIKMIDIEventStoreDataLengthForEventType(eventType)];
+	if (!_createdEvents) {
+		_createdEvents = [NSPointerArray weakObjectsPointerArray];
+		_createdEvents.count = _count;
+	}
+	[_createdEvents replacePointerAtIndex:index withPointer:(__bridge void *)event];
+	return event;
+}
+
+- (Class)classOfEventAtIndex:(NSUInteger)index
+{
+	MIKMIDIEventType eventType = _eventTypes[index];
+	if (eventType == MIKMIDIEventStoreObjectEventType) return [_objects[index] class];
+	return MIKMIDIEventStoreClassForEventType(eventType);
+}
+
+- (void)getEventType:(MIKMIDIEventType *)outEventType bytes:(const void **)outBytes length:(NSUInteger *)outLength atIndex:(NSUInteger)index
+{
+	MIKMIDIEventType eventType = _eventTypes[index];
+	if (eventType == MIKMIDIEventStoreObjectEventType) {
+		MIKMIDIEvent *event = _objects[index];
+		NSData *data = event.internalData;
+		*outEventType = event.eventType;
+		*outBytes = [data bytes];
+		*outLength = [data length];
+		return;
+	}
+	*outEventType = eventType;
+	*outBytes = &_payloads[index];
+	*outLength = MIKMIDIEventStoreDataLengthForEventType(eventType);
+}
+
+- (MusicTimeStamp)endTimeStampOfEventAtIndex:(NSUInteger)index
+{
+	MIKMIDIEventType eventType = _eventTypes[index];
+	if (eventType == MIKMIDIEventTypeMIDINoteMessage) {
+		MIDINoteMessage message;
+		memcpy(&message, &_payloads[index], sizeof(message));
+		return _timeStamps[index] + message.duration;
+	}
+	if (eventType == MIKMIDIEventStoreObjectEventType) {
+		MIKMIDIEvent *event = _objects[index];
+		if ([event respondsToSelector:@selector(endTimeStamp)]) return [(MIKMIDINoteEvent *)event endTimeStamp];
+	}
+	return _timeStamps[index];
+}
+
+@end
+
+#pragma mark -
+
+// Returns the index of the first event in chunk whose timestamp is at or after timeStamp.
+static NSUInteger MIKMIDIEventStoreSearch(MIKMIDIEventStoreChunk *chunk, MusicTimeStamp timeStamp)
+{
+	const MusicTimeStamp *timeStamps = chunk.timeStamps;
+	NSUInteger low = 0, high = chunk.count;
+	while (low < high) {
+		NSUInteger middle = low + (high - low) / 2;
+		if (timeStamps[middle] < timeStamp) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+@interface MIKMIDIEventStore ()
+
+// Each chunk is a non-empty, sorted run of events, and every event in a chunk
+// comes at or after the events in the chunks before it.
+@property (nonatomic, strong) NSMutableArray *chunks;
+@property (nonatomic, readwrite) NSUInteger count;
+
+@end
+
+@implementation MIKMIDIEventStore
+
+- (instancetype)init
+{
+	return [self initWithEvents:@[]];
+}
+
+- (instancetype)initWithEvents:(NSArray *)events
+{
+	self = [super init];
+	if (self) {
+		NSArray *uniqueEvents = [[NSOrderedSet orderedSetWithArray:events] array];
+
+		MusicTimeStamp lastTimeStamp = -DBL_MAX;
+		for (MIKMIDIEvent *event in uniqueEvents) {
+			MusicTimeStamp timeStamp = event.timeStamp;
+			if (timeStamp < lastTimeStamp) {
+				uniqueEvents = [uniqueEvents sortedArrayWithOptions:NSSortStable usingComparator:^NSComparisonResult(MIKMIDIEvent *event1, MIKMIDIEvent *event2) {
+					if (event1.timeStamp < event2.timeStamp) return NSOrderedAscending;
+					if (event1.timeStamp > event2.timeStamp) return NSOrderedDescending;
+					return NSOrderedSame;
+				}];
+				break;
+			}
+			lastTimeStamp = timeStamp;
+		}
+
+		// Leave room in each chunk, so the first few insertions don't have to split it.
+		NSUInteger count = [uniqueEvents count];
+		NSUInteger chunkSize = MIKMIDIEventStoreMaximumChunkSize / 2;
+		_chunks = [NSMutableArray arrayWithCapacity:count / chunkSize + 1];
+		for (NSUInteger i = 0; i < count; i += chunkSize) {
+			NSUInteger length = MIN(chunkSize, count - i);
+			MIKMIDIEventStoreChunk *chunk = [[MIKMIDIEventStoreChunk alloc] initWithCapacity:length];
+			for (NSUInteger j = 0; j < length; j++) {
+				[chunk insertEvent:uniqueEvents[i + j] atIndex:j];
+			}
+			[_chunks addObject:chunk];
+		}
+		_count = count;
+	}
+	return self;
+}
+
+#pragma mark - NSCopying
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	MIKMIDIEventStore *result = [[[self class] alloc] init];
+	@synchronized(self) {
+		for (MIKMIDIEventStoreChunk *chunk in self.chunks) {
+			MIKMIDIEventStoreChunk *chunkCopy = [[MIKMIDIEventStoreChunk alloc] initWithCapacity:chunk.count];
+			[chunkCopy appendEventsInRange:NSMakeRange(0, chunk.count) ofChunk:chunk];
+			[result.chunks addObject:chunkCopy];
+		}
+		result.count = self.count;
+	}
+	return result;
+}
+
+#pragma mark - Public
+
+- (BOOL)addEvent:(MIKMIDIEvent *)event
+{
+	MIKMIDIEventStorePosition position;
+	if ([self findEvent:event position:&position]) return NO;
+
+	NSMutableArray *chunks = self.chunks;
+	if (![chunks count]) {
+		MIKMIDIEventStoreChunk *chunk = [[MIKMIDIEventStoreChunk alloc] initWithCapacity:MIKMIDIEventStoreMaximumChunkSize / 2];
+		[chunk insertEvent:event atIndex:0];
+		[chunks addObject:chunk];
+		self.count = 1;
+		return YES;
+	}
+
+	MIKMIDIEventStoreChunk *chunk = chunks[position.chunk];
+	[chunk insertEvent:event atIndex:position.index];
+	NSUInteger chunkCount = chunk.count;
+	if (chunkCount > MIKMIDIEventStoreMaximumChunkSize) {
+		NSRange secondHalf = NSMakeRange(chunkCount / 2, chunkCount - chunkCount / 2);
+		MIKMIDIEventStoreChunk *newChunk = [[MIKMIDIEventStoreChunk alloc] initWithCapacity:MIKMIDIEventStoreMaximumChunkSize];
+		[newChunk appendEventsInRange:secondHalf ofChunk:chunk];
+		[chunk truncateToCount:secondHalf.location];
+		[chunks insertObject:newChunk atIndex:position.chunk + 1];
+	}
+	self.count++;
+	return YES;
+}
+
+- (BOOL)removeEvent:(MIKMIDIEvent *)event
+{
+	MIKMIDIEventStorePosition position;
+	if (![self findEvent:event position:&position]) return NO;
+
+	NSMutableArray *chunks = self.chunks;
+	MIKMIDIEventStoreChunk *chunk = chunks[position.chunk];
+	[chunk removeEventAtIndex:position.index];
+	if (!chunk.count) {
+		[chunks removeObjectAtIndex:position.chunk];
+	} else if (position.chunk + 1 < [chunks count]) {
+		// Merge chunks that have become small, so the number of chunks stays proportional to the number of events.
+		MIKMIDIEventStoreChunk *nextChunk = chunks[position.chunk + 1];
+		if (chunk.count + nextChunk.count <= MIKMIDIEventStoreMaximumChunkSize / 2) {
+			[chunk appendEventsInRange:NSMakeRange(0, nextChunk.count) ofChunk:nextChunk];
+			[chunks removeObjectAtIndex:position.chunk + 1];
+		}
+	}
+	self.count--;
+	return YES;
+}
+
+- (BOOL)containsEvent:(MIKMIDIEvent *)event
+{
+	return [self findEvent:event position:NULL];
+}
+
+- (NSArray *)eventsOfClass:(Class)eventClass fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	// Creating event objects changes the chunks, and unlike changes to the events, reading them from more than one thread is allowed
+	@synchronized(self) {
+		return [self unsynchronizedEventsOfClass:eventClass fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+	}
+}
+
+- (void)enumerateEventsOfClass:(Class)eventClass fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp usingBlock:(MIKMIDIEventStoreEnumerationBlock)block
+{
+	@synchronized(self) {
+		NSArray *chunks = self.chunks;
+		NSUInteger chunkCount = [chunks count];
+		MIKMIDIEventStorePosition start = [self positionForTimeStamp:startTimeStamp];
+		NSUInteger eventIndex = 0;
+		for (NSUInteger i = 0; i < start.chunk; i++) eventIndex += [chunks[i] count];
+		eventIndex += start.index;
+
+		BOOL stop = NO;
+		for (NSUInteger i = start.chunk; i < chunkCount; i++) {
+			MIKMIDIEventStoreChunk *chunk = chunks[i];
+			const MusicTimeStamp *timeStamps = chunk.timeStamps;
+			NSUInteger eventCount = chunk.count;
+			for (NSUInteger j = (i == start.chunk) ? start.index : 0; j < eventCount; j++, eventIndex++) {
+				if (timeStamps[j] > endTimeStamp) return;
+				if (eventClass && ![[chunk classOfEventAtIndex:j] isSubclassOfClass:eventClass]) continue;
+
+				MIKMIDIEventType eventType;
+				const void *bytes;
+				NSUInteger length;
+				[chunk getEventType:&eventType bytes:&bytes length:&length atIndex:j];
+				block(eventIndex, timeStamps[j], eventType, bytes, length, &stop);
+				if (stop) return;
+			}
+		}
+	}
+}
+
+- (NSArray *)eventsAtIndexes:(NSIndexSet *)indexes
+{
+	NSMutableArray *result = [NSMutableArray arrayWithCapacity:[indexes count]];
+	@synchronized(self) {
+		NSArray *chunks = self.chunks;
+		NSUInteger chunkCount = [chunks count];
+		__block NSUInteger chunkIndex = 0;
+		__block NSUInteger chunkStart = 0; // The index of the first event in chunks[chunkIndex]
+		[indexes enumerateIndexesUsingBlock:^(NSUInteger index, BOOL *stop) {
+			while (chunkIndex < chunkCount && index >= chunkStart + [chunks[chunkIndex] count]) {
+				chunkStart += [chunks[chunkIndex] count];
+				chunkIndex++;
+			}
+			if (chunkIndex == chunkCount) { *stop = YES; return; }
+			[result addObject:[chunks[chunkIndex] eventAtIndex:index - chunkStart]];
+		}];
+	}
+	return result;
+}
+
+- (MusicTimeStamp)timeStampOfFirstEventAfterTimeStamp:(MusicTimeStamp)timeStamp
+{
+	NSArray *chunks = self.chunks;
+	NSUInteger chunkCount = [chunks count];
+	MIKMIDIEventStorePosition position = [self positionForTimeStamp:timeStamp];
+	for (NSUInteger i = position.chunk; i < chunkCount; i++) {
+		MIKMIDIEventStoreChunk *chunk = chunks[i];
+		const MusicTimeStamp *timeStamps = chunk.timeStamps;
+		NSUInteger eventCount = chunk.count;
+		for (NSUInteger j = (i == position.chunk) ? position.index : 0; j < eventCount; j++) {
+			if (timeStamps[j] > timeStamp) return timeStamps[j];
+		}
+	}
+	return DBL_MAX;
+}
+
+#pragma mark - Private
+
+- (NSArray *)unsynchronizedEventsOfClass:(Class)eventClass fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	NSMutableArray *result = [NSMutableArray array];
+	NSArray *chunks = self.chunks;
+	NSUInteger chunkCount = [chunks count];
+	MIKMIDIEventStorePosition start = [self positionForTimeStamp:startTimeStamp];
+	for (NSUInteger i = start.chunk; i < chunkCount; i++) {
+		MIKMIDIEventStoreChunk *chunk = chunks[i];
+		const MusicTimeStamp *timeStamps = chunk.timeStamps;
+		NSUInteger eventCount = chunk.count;
+		for (NSUInteger j = (i == start.chunk) ? start.index : 0; j < eventCount; j++) {
+			if (timeStamps[j] > endTimeStamp) return result;
+			// Check the class first, so only the events being returned are created.
+			if (eventClass && ![[chunk classOfEventAtIndex:j] isSubclassOfClass:eventClass]) continue;
+			[result addObject:[chunk eventAtIndex:j]];
+		}
+	}
+	return result;
+}
+
+// Returns the position of the first event with a timestamp at or after timeStamp.
+// The position may be one past the end of a chunk.
+- (MIKMIDIEventStorePosition)positionForTimeStamp:(MusicTimeStamp)timeStamp
+{
+	NSArray *chunks = self.chunks;
+	NSUInteger low = 0, high = [chunks count];
+	while (low < high) {
+		NSUInteger middle = low + (high - low) / 2;
+		MIKMIDIEventStoreChunk *chunk = chunks[middle];
+		if (chunk.timeStamps[0] < timeStamp) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	// low chunks start before the position, so it's in the last of them, if any.
+	if (low == 0) return (MIKMIDIEventStorePosition){0, 0};
+	NSUInteger chunk = low - 1;
+	return (MIKMIDIEventStorePosition){chunk, MIKMIDIEventStoreSearch(chunks[chunk], timeStamp)};
+}
+
+// Looks through the events with event's timestamp. Returns YES and the position of the equal event if
+// there is one. Otherwise, returns NO and the position after the last event with that timestamp.
+- (BOOL)findEvent:(MIKMIDIEvent *)event position:(MIKMIDIEventStorePosition *)outPosition
+{
+	// Reads objects, which -eventsOfClass:fromTimeStamp:toTimeStamp: may be creating on another thread
+	@synchronized(self) {
+		return [self unsynchronizedFindEvent:event position:outPosition];
+	}
+}
+
+- (BOOL)unsynchronizedFindEvent:(MIKMIDIEvent *)event position:(MIKMIDIEventStorePosition *)outPosition
+{
+	UInt8 packedEventType = MIKMIDIEventStoreObjectEventType;
+	UInt64 packedPayload = 0;
+	BOOL canBePacked = MIKMIDIEventStorePack(event, &packedEventType, &packedPayload);
+
+	NSArray *chunks = self.chunks;
+	NSUInteger chunkCount = [chunks count];
+	MusicTimeStamp timeStamp = event.timeStamp;
+	MIKMIDIEventStorePosition position = [self positionForTimeStamp:timeStamp];
+	BOOL found = NO;
+	while (position.chunk < chunkCount) {
+		MIKMIDIEventStoreChunk *chunk = chunks[position.chunk];
+		if (position.index == chunk.count) {
+			if (position.chunk + 1 == chunkCount) break;
+			position = (MIKMIDIEventStorePosition){position.chunk + 1, 0};
+			continue;
+		}
+
+		NSUInteger index = position.index;
+		if (chunk.timeStamps[index] != timeStamp) break;
+		UInt8 eventType = chunk.eventTypes[index];
+		if (eventType == MIKMIDIEventStoreObjectEventType) {
+			MIKMIDIEvent *candidate = chunk.objects[index];
+			found = (candidate == event || [candidate isEqual:event]);
+		} else {
+			found = canBePacked && eventType == packedEventType && chunk.payloads[index] == packedPayload;
+		}
+		if (found) break;
+		position.index++;
+	}
+
+	if (outPosition) *outPosition = position;
+	return found;
+}
+
+#pragma mark - Properties
+
+- (NSArray *)allEvents
+{
+	return [self eventsOfClass:Nil fromTimeStamp:-DBL_MAX toTimeStamp:DBL_MAX];
+}
+
+- (MusicTimeStamp)endTimeStamp
+{
+	MusicTimeStamp result = -DBL_MAX;
+	@synchronized(self) {
+		for (MIKMIDIEventStoreChunk *chunk in self.chunks) {
+			NSUInteger eventCount = chunk.count;
+			for (NSUInteger i = 0; i < eventCount; i++) {
+				result = MAX(result, [chunk endTimeStampOfEventAtIndex:i]);
+			}
+		}
+	}
+	return result;
+}
+
+@end
@@ -0,0 +1,142 @@
+//
+//  MIKMIDIFileDecoder.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import "MIKMIDIFileParser.h"
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDIEvent;
+@class MIKMIDIMetaTrackSequenceNameEvent;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  MIKMIDIFileDecoder turns the contents of a Standard MIDI File into MIKMIDIEvent instances
+ *  using MIKMIDI's own SMF parser (see MIKMIDIFileParser.h), rather than going through
+ *  MusicSequenceFileLoadData() and reading the resulting events back out of a MusicSequence.
+ *
+ *  Note on and note off pairs are combined into MIKMIDINoteEvents, tempo meta events become
+ *  MIKMIDITempoEvents, and timestamps are converted from ticks to beats.
+ *
+ *  If the first track chunk of a format 1 file is a conductor track holding nothing but tempo and
+ *  time signature events, as MIKMIDIFileEncoder writes a sequence's tempo track, it's read as the
+ *  file's tempo track, and isn't counted as one of its tracks. Track indexes start after it. Otherwise,
+ *  as with MusicSequenceFileLoadData(), every track chunk is a track.
+ *
+ *  Instances are safe to use from multiple threads at once.
+ *
+ *  @note This class is for internal MIKMIDI use only. It is used by MIKMIDISequence.
+ */
+@interface MIKMIDIFileDecoder : NSObject
+
+/**
+ *  Creates a decoder for the MIDI file contained in data. Only the file's header is parsed
+ *  and its track chunks located. Events are not decoded until requested.
+ *
+ *  @param data  An NSData instance containing Standard MIDI File data. The data is retained, not copied.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return An initialized decoder, or nil if data is not a valid Standard MIDI File.
+ */
+- (nullable instancetype)initWithData:(NSData *)data error:(NSError **)error;
+
+/**
+ *  Decodes the events in the file's conductor track chunk.
+ *
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return An array of MIKMIDIEvents sorted by timestamp, which is empty if the file has no conductor track chunk, or nil if an error occurred.
+ */
+- (nullable MIKArrayOf(MIKMIDIEvent *) *)tempoTrackEventsWithError:(NSError **)error;
+
+/**
+ *  Decodes the events in a track.
+ *
+ *  @param index            The index of the track, not counting the conductor track chunk.
+ *  @param tempoTrackEvents If non-nil, tempo and time signature events found in the track
+ *                          are added to this array instead of being included in the returned array.
+ *  @param error            If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return An array of MIKMIDIEvents sorted by timestamp, or nil if an error occurred.
+ */
+- (nullable MIKArrayOf(MIKMIDIEvent *) *)eventsForTrackAtIndex:(NSUInteger)index
+											   tempoTrackEvents:(nullable NSMutableArray *)tempoTrackEvents
+														  error:(NSError **)error;
+
+/**
+ *  Decodes the events in all of the file's tracks, not including the conductor track chunk, decoding up to maximumConcurrentTracks
+ *  tracks at the same time on separate threads.
+ *
+ *  The result is the same regardless of maximumConcurrentTracks: tracks are returned in file order,
+ *  and tempo track events are added to tempoTrackEvents in the order a serial decode would add them.
+ *  If more than one track fails to decode, the error is the one for the first of them.
+ *
+ *  @param tempoTrackEvents        If non-nil, tempo and time signature events are added to this array
+ *                                 instead of being included in the returned arrays.
+ *  @param maximumConcurrentTracks The maximum number of tracks to decode at once. Pass 1 to decode all tracks on the calling thread.
+ *  @param error                   If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return An array containing an array of MIKMIDIEvents for each track, or nil if an error occurred.
+ */
+- (nullable MIKArrayOf(MIKArrayOf(MIKMIDIEvent *) *) *)eventsForAllTracksWithTempoTrackEvents:(nullable NSMutableArray *)tempoTrackEvents
+																	  maximumConcurrentTracks:(NSUInteger)maximumConcurrentTracks
+																						error:(NSError **)error;
+
+/**
+ *  Reads through the track at index, without creating events for the bulk of its contents,
+ *  to determine the information MIKMIDISequence needs before a track's events are loaded.
+ *
+ *  @param index            The index of the track, not counting the conductor track chunk.
+ *  @param tempoTrackEvents If non-nil, the tempo and time signature events in the track are added to this array.
+ *  @param length           Upon return, the length in beats the track will have once its events are decoded. May be NULL.
+ *  @param nameEvent        Upon return, the first track name meta event in the track, or nil if there isn't one. May be NULL.
+ *  @param error            If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return YES if the track could be read, NO if an error occurred.
+ */
+- (BOOL)scanTrackAtIndex:(NSUInteger)index
+		tempoTrackEvents:(nullable NSMutableArray *)tempoTrackEvents
+				  length:(nullable MusicTimeStamp *)length
+			   nameEvent:(MIKMIDIMetaTrackSequenceNameEvent *_Nullable *_Nullable)nameEvent
+				   error:(NSError **)error;
+
+/**
+ *  The data the receiver was created with.
+ */
+@property (nonatomic, strong, readonly) NSData *data;
+
+/**
+ *  The contents of the file's header chunk.
+ */
+@property (nonatomic, readonly) MIKMIDIFileHeader header;
+
+/**
+ *  Whether the file's first track chunk is a conductor track, which is read as the tempo track.
+ */
+@property (nonatomic, readonly) BOOL hasTempoTrack;
+
+/**
+ *  The number of tracks found in the file, not counting the conductor track chunk.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfTracks;
+
+/**
+ *  The number of ticks per quarter note used by the file.
+ */
+@property (nonatomic, readonly) SInt16 timeResolution;
+
+/**
+ *  Whether the receiver is able to decode the file's events. This is NO for files
+ *  whose timing is specified in SMPTE frames rather than ticks per quarter note.
+ */
+@property (nonatomic, readonly) BOOL canDecodeEvents;
+
+@end
+
+NS_ASSUME_NONNULL_END
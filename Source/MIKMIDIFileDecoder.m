@@ -0,0 +1,435 @@
+//
+//  MIKMIDIFileDecoder.m
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIFileDecoder.h"
+#import "MIKMIDIEvent.h"
+#import "MIKMIDITempoEvent.h"
+#import "MIKMIDIMetaEvent.h"
+#import "MIKMIDIMetaTrackSequenceNameEvent.h"
+#import "MIKMIDIErrors.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDIFileDecoder.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIFileDecoder.m in the Build Phases for this target
+#endif
+
+// Intermediate representation used while pairing note ons with their note offs.
+typedef struct {
+	MIKMIDIFileEvent event;
+	uint64_t endTick;
+	int32_t nextPendingNote;
+	UInt8 releaseVelocity;
+	BOOL isNoteOff;
+} MIKMIDIFileDecoderRecord;
+
+static const uint64_t MIKMIDIFileDecoderUnpairedNote = UINT64_MAX;
+
+// Tempo and time signature changes apply to the whole sequence, so they are moved to its tempo track.
+static inline BOOL MIKMIDIFileDecoderIsTempoTrackMetaType(uint8_t metaType)
+{
+	return metaType == MIKMIDIFileMetaTypeTempo || metaType == MIKMIDIFileMetaTypeTimeSignature;
+}
+
+static MIKMIDIEvent *MIKMIDIFileDecoderMetaEvent(const MIKMIDIFileEvent *fileEvent, MusicTimeStamp timeStamp)
+{
+	if (fileEvent->metaType == MIKMIDIFileMetaTypeTempo) {
+		if (fileEvent->payloadLength < 3) return nil;
+		const uint8_t *p = fileEvent->payload;
+		uint32_t microsecondsPerQuarterNote = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+		if (!microsecondsPerQuarterNote) return nil;
+		return [MIKMIDITempoEvent tempoEventWithTimeStamp:timeStamp tempo:60000000.0 / microsecondsPerQuarterNote];
+	}
+	
+	NSMutableData *data = [NSMutableData dataWithLength:MIKMIDIEventMetadataStartOffset + fileEvent->payloadLength];
+	MIDIMetaEvent *metaEvent = (MIDIMetaEvent *)[data mutableBytes];
+	metaEvent->metaEventType = fileEvent->metaType;
+	metaEvent->dataLength = fileEvent->payloadLength;
+	memcpy((UInt8 *)[data mutableBytes] + MIKMIDIEventMetadataStartOffset, fileEvent->payload, fileEvent->payloadLength);
+	return [MIKMIDIEvent midiEventWithTimeStamp:timeStamp eventType:kMusicEventType_Meta data:data];
+}
+
+// Whether every event in chunk would be moved to the tempo track, so reading it as a track of its own would
+// leave an empty track. This is how MIKMIDIFileEncoder writes a sequence's tempo track.
+static BOOL MIKMIDIFileDecoderIsConductorTrackChunk(MIKMIDIFileTrackChunk chunk)
+{
+	MIKMIDIFileTrackReader reader;
+	MIKMIDIFileTrackReaderInit(&reader, chunk);
+	MIKMIDIFileEvent event;
+	MIKMIDIFileResult result;
+	while ((result = MIKMIDIFileTrackReaderNextEvent(&reader, &event)) == MIKMIDIFileResultOK) {
+		if (event.kind != MIKMIDIFileEventKindMeta || !MIKMIDIFileDecoderIsTempoTrackMetaType(event.metaType)) return NO;
+	}
+	return (result == MIKMIDIFileResultEndOfTrack);
+}
+
+@interface MIKMIDIFileDecoder ()
+{
+	MIKMIDIFileTrackChunk *_trackChunks; // Starts with the conductor track chunk, if there is one
+	NSUInteger _firstTrackChunkIndex; // 1 if there's a conductor track chunk, otherwise 0
+}
+
+@property (nonatomic, strong, readwrite) NSData *data;
+@property (nonatomic, readwrite) MIKMIDIFileHeader header;
+@property (nonatomic, readwrite) NSUInteger numberOfTracks;
+
+@end
+
+@implementation MIKMIDIFileDecoder
+
+- (instancetype)initWithData:(NSData *)data error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+
+	self = [super init];
+	if (self) {
+		_data = data;
+
+		const uint8_t *bytes = [data bytes];
+		size_t length = [data length];
+		MIKMIDIFileHeader header;
+		MIKMIDIFileResult result = MIKMIDIFileParseHeader(bytes, length, &header, NULL);
+		if (result != MIKMIDIFileResultOK) {
+			*error = [self errorForResult:result];
+			return nil;
+		}
+		_header = header;
+
+		size_t count = 0;
+		_trackChunks = calloc(MAX(header.numberOfTracks, 1), sizeof(MIKMIDIFileTrackChunk));
+		if (!_trackChunks) {
+			*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+			return nil;
+		}
+		result = MIKMIDIFileIndexTrackChunks(bytes, length, &header, _trackChunks, header.numberOfTracks, &count);
+		if (result != MIKMIDIFileResultOK) {
+			*error = [self errorForResult:result];
+			return nil;
+		}
+		NSUInteger numberOfTrackChunks = MIN(count, header.numberOfTracks);
+		_hasTempoTrack = (header.format == 1 && numberOfTrackChunks > 0 && MIKMIDIFileDecoderIsConductorTrackChunk(_trackChunks[0]));
+		_firstTrackChunkIndex = _hasTempoTrack ? 1 : 0;
+		_numberOfTracks = numberOfTrackChunks - _firstTrackChunkIndex;
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	free(_trackChunks);
+}
+
+#pragma mark - Decoding
+
+- (NSArray *)eventsForTrackAtIndex:(NSUInteger)index tempoTrackEvents:(NSMutableArray *)tempoTrackEvents error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+
+	if (index >= self.numberOfTracks || !self.canDecodeEvents) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return nil;
+	}
+
+	return [self eventsForTrackChunk:_trackChunks[_firstTrackChunkIndex + index] tempoTrackEvents:tempoTrackEvents error:error];
+}
+
+- (NSArray *)tempoTrackEventsWithError:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+
+	if (!self.canDecodeEvents) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return nil;
+	}
+	if (!self.hasTempoTrack) return @[];
+
+	return [self eventsForTrackChunk:_trackChunks[0] tempoTrackEvents:nil error:error];
+}
+
+- (NSArray *)eventsForTrackChunk:(MIKMIDIFileTrackChunk)trackChunk tempoTrackEvents:(NSMutableArray *)tempoTrackEvents error:(NSError **)error
+{
+	MIKMIDIFileTrackReader reader;
+	MIKMIDIFileTrackReaderInit(&reader, trackChunk);
+
+	// Each channel voice event takes at least 2 bytes, so this is a generous first guess.
+	size_t capacity = MAX(trackChunk.length / 3, 16);
+	size_t count = 0;
+	MIKMIDIFileDecoderRecord *records = malloc(capacity * sizeof(MIKMIDIFileDecoderRecord));
+	if (!records) {
+		*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+		return nil;
+	}
+
+	// Pending note ons are kept in per channel/note FIFO lists threaded through the records array.
+	int32_t pendingHeads[16 * 128], pendingTails[16 * 128];
+	memset(pendingHeads, 0xFF, sizeof(pendingHeads));
+	memset(pendingTails, 0xFF, sizeof(pendingTails));
+
+	MIKMIDIFileEvent event;
+	MIKMIDIFileResult result;
+	while ((result = MIKMIDIFileTrackReaderNextEvent(&reader, &event)) == MIKMIDIFileResultOK) {
+		if (count == capacity) {
+			MIKMIDIFileDecoderRecord *newRecords = realloc(records, 2 * capacity * sizeof(MIKMIDIFileDecoderRecord));
+			if (!newRecords) {
+				free(records);
+				*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:ENOMEM userInfo:nil];
+				return nil;
+			}
+			records = newRecords;
+			capacity *= 2;
+		}
+
+		MIKMIDIFileDecoderRecord *record = &records[count];
+		record->event = event;
+		record->endTick = 0;
+		record->nextPendingNote = -1;
+		record->releaseVelocity = 0;
+		record->isNoteOff = NO;
+
+		if (event.kind == MIKMIDIFileEventKindChannel) {
+			UInt8 type = event.status & 0xF0;
+			NSUInteger key = ((event.status & 0x0F) << 7) | event.data1;
+			if (type == 0x90 && event.data2 > 0) {
+				record->endTick = MIKMIDIFileDecoderUnpairedNote;
+				if (pendingTails[key] >= 0) {
+					records[pendingTails[key]].nextPendingNote = (int32_t)count;
+				} else {
+					pendingHeads[key] = (int32_t)count;
+				}
+				pendingTails[key] = (int32_t)count;
+			} else if (type == 0x80 || type == 0x90) {
+				record->isNoteOff = YES;
+				int32_t noteOnIndex = pendingHeads[key];
+				if (noteOnIndex >= 0) {
+					records[noteOnIndex].endTick = event.tick;
+					records[noteOnIndex].releaseVelocity = (type == 0x80) ? event.data2 : 0;
+					pendingHeads[key] = records[noteOnIndex].nextPendingNote;
+					if (pendingHeads[key] < 0) pendingTails[key] = -1;
+				}
+			}
+		}
+		count++;
+	}
+
+	if (result != MIKMIDIFileResultEndOfTrack) {
+		free(records);
+		*error = [self errorForResult:result];
+		return nil;
+	}
+	uint64_t endOfTrackTick = event.tick;
+
+	double ticksPerBeat = (double)self.timeResolution;
+	NSMutableArray *events = [NSMutableArray arrayWithCapacity:count];
+	for (size_t i = 0; i < count; i++) {
+		MIKMIDIFileDecoderRecord *record = &records[i];
+		if (record->isNoteOff) continue;
+
+		MIKMIDIFileEvent *fileEvent = &record->event;
+		MusicTimeStamp timeStamp = (double)fileEvent->tick / ticksPerBeat;
+		MIKMIDIEvent *midiEvent = nil;
+		NSMutableArray *destination = events;
+
+		switch (fileEvent->kind) {
+			case MIKMIDIFileEventKindChannel: {
+				if ((fileEvent->status & 0xF0) == 0x90) {
+					uint64_t endTick = record->endTick;
+					if (endTick == MIKMIDIFileDecoderUnpairedNote) endTick = MAX(endOfTrackTick, fileEvent->tick);
+					MIDINoteMessage message = {
+						.channel = fileEvent->status & 0x0F,
+						.note = fileEvent->data1,
+						.velocity = fileEvent->data2,
+						.releaseVelocity = record->releaseVelocity,
+						.duration = (Float32)((double)(endTick - fileEvent->tick) / ticksPerBeat),
+					};
+					NSData *data = [NSData dataWithBytes:&message length:sizeof(message)];
+					midiEvent = [MIKMIDIEvent midiEventWithTimeStamp:timeStamp eventType:kMusicEventType_MIDINoteMessage data:data];
+				} else {
+					MIDIChannelMessage message = {
+						.status = fileEvent->status,
+						.data1 = fileEvent->data1,
+						.data2 = fileEvent->data2,
+					};
+					NSData *data = [NSData dataWithBytes:&message length:sizeof(message)];
+					midiEvent = [MIKMIDIEvent midiEventWithTimeStamp:timeStamp eventType:kMusicEventType_MIDIChannelMessage data:data];
+				}
+				break;
+			}
+			case MIKMIDIFileEventKindMeta:
+				midiEvent = MIKMIDIFileDecoderMetaEvent(fileEvent, timeStamp);
+				if (tempoTrackEvents && MIKMIDIFileDecoderIsTempoTrackMetaType(fileEvent->metaType)) destination = tempoTrackEvents;
+				break;
+			case MIKMIDIFileEventKindSystemExclusive: {
+				// MIDIRawData holds the complete message, including the leading 0xF0 that the file stores as the event's status.
+				UInt32 prefixLength = (fileEvent->status == 0xF0) ? 1 : 0;
+				UInt32 rawLength = prefixLength + fileEvent->payloadLength;
+				NSMutableData *data = [NSMutableData dataWithLength:offsetof(MIDIRawData, data) + rawLength];
+				MIDIRawData *rawData = (MIDIRawData *)[data mutableBytes];
+				rawData->length = rawLength;
+				if (prefixLength) rawData->data[0] = 0xF0;
+				memcpy(rawData->data + prefixLength, fileEvent->payload, fileEvent->payloadLength);
+				midiEvent = [MIKMIDIEvent midiEventWithTimeStamp:timeStamp eventType:kMusicEventType_MIDIRawData data:data];
+				break;
+			}
+		}
+
+		if (midiEvent) [destination addObject:midiEvent];
+	}
+
+	free(records);
+	return events;
+}
+
+- (NSArray *)eventsForAllTracksWithTempoTrackEvents:(NSMutableArray *)tempoTrackEvents
+							  maximumConcurrentTracks:(NSUInteger)maximumConcurrentTracks
+												error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+
+	NSUInteger numberOfTracks = self.numberOfTracks;
+	NSUInteger workerCount = MAX(MIN(maximumConcurrentTracks, numberOfTracks), 1);
+
+	// Worker w decodes tracks w, w + workerCount, w + 2 * workerCount, etc. into its own arrays, so that
+	// nothing is shared between workers, and the results can be put back in file order afterwards.
+	// A worker that fails stores the error in place of the track's events and stops.
+	NSMutableArray *eventsByWorker = [NSMutableArray arrayWithCapacity:workerCount];
+	NSMutableArray *tempoTrackEventsByWorker = [NSMutableArray arrayWithCapacity:workerCount];
+	for (NSUInteger i = 0; i < workerCount; i++) {
+		[eventsByWorker addObject:[NSMutableArray array]];
+		[tempoTrackEventsByWorker addObject:[NSMutableArray array]];
+	}
+
+	dispatch_apply(workerCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t worker) {
+		NSMutableArray *workerEvents = eventsByWorker[worker];
+		NSMutableArray *workerTempoTrackEvents = tempoTrackEventsByWorker[worker];
+		for (NSUInteger i = worker; i < numberOfTracks; i += workerCount) {
+			@autoreleasepool {
+				NSMutableArray *trackTempoEvents = [NSMutableArray array];
+				NSError *trackError = nil;
+				NSArray *events = [self eventsForTrackAtIndex:i tempoTrackEvents:trackTempoEvents error:&trackError];
+				if (!events) {
+					[workerEvents addObject:trackError];
+					return;
+				}
+				[workerEvents addObject:events];
+				[workerTempoTrackEvents addObject:trackTempoEvents];
+			}
+		}
+	});
+
+	NSMutableArray *result = [NSMutableArray arrayWithCapacity:numberOfTracks];
+	for (NSUInteger i = 0; i < numberOfTracks; i++) {
+		id events = eventsByWorker[i % workerCount][i / workerCount];
+		if ([events isKindOfClass:[NSError class]]) {
+			*error = events;
+			return nil;
+		}
+		[result addObject:events];
+		[tempoTrackEvents addObjectsFromArray:tempoTrackEventsByWorker[i % workerCount][i / workerCount]];
+	}
+	return result;
+}
+
+- (BOOL)scanTrackAtIndex:(NSUInteger)index
+		tempoTrackEvents:(NSMutableArray *)tempoTrackEvents
+				  length:(MusicTimeStamp *)length
+			   nameEvent:(MIKMIDIMetaTrackSequenceNameEvent **)nameEvent
+				   error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+
+	if (index >= self.numberOfTracks || !self.canDecodeEvents) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return NO;
+	}
+
+	MIKMIDIFileTrackReader reader;
+	MIKMIDIFileTrackReaderInit(&reader, _trackChunks[_firstTrackChunkIndex + index]);
+
+	// Only count note ons per channel/note, which is enough to know which note offs
+	// will be dropped, and whether any notes are left sounding at the end of the track.
+	UInt16 pendingNoteCounts[16 * 128] = {0};
+	NSUInteger totalPendingNotes = 0;
+	uint64_t lastTick = 0;
+	double ticksPerBeat = (double)self.timeResolution;
+	MIKMIDIMetaTrackSequenceNameEvent *name = nil;
+
+	MIKMIDIFileEvent event;
+	MIKMIDIFileResult result;
+	while ((result = MIKMIDIFileTrackReaderNextEvent(&reader, &event)) == MIKMIDIFileResultOK) {
+		switch (event.kind) {
+			case MIKMIDIFileEventKindChannel: {
+				UInt8 type = event.status & 0xF0;
+				NSUInteger key = ((event.status & 0x0F) << 7) | event.data1;
+				if (type == 0x90 && event.data2 > 0) {
+					pendingNoteCounts[key]++;
+					totalPendingNotes++;
+				} else if (type == 0x80 || type == 0x90) {
+					if (!pendingNoteCounts[key]) continue; // Unmatched note off, not decoded as an event.
+					pendingNoteCounts[key]--;
+					totalPendingNotes--;
+				}
+				break;
+			}
+			case MIKMIDIFileEventKindMeta: {
+				MusicTimeStamp timeStamp = (double)event.tick / ticksPerBeat;
+				if (MIKMIDIFileDecoderIsTempoTrackMetaType(event.metaType)) {
+					MIKMIDIEvent *tempoTrackEvent = MIKMIDIFileDecoderMetaEvent(&event, timeStamp);
+					if (tempoTrackEvent) [tempoTrackEvents addObject:tempoTrackEvent];
+					continue;
+				}
+				if (event.metaType == MIKMIDIFileMetaTypeTrackName && !name) {
+					name = (MIKMIDIMetaTrackSequenceNameEvent *)MIKMIDIFileDecoderMetaEvent(&event, timeStamp);
+				}
+				break;
+			}
+			case MIKMIDIFileEventKindSystemExclusive:
+				break;
+		}
+		lastTick = MAX(lastTick, event.tick);
+	}
+
+	if (result != MIKMIDIFileResultEndOfTrack) {
+		*error = [self errorForResult:result];
+		return NO;
+	}
+
+	// Notes without a note off last until the end of the track.
+	if (totalPendingNotes) lastTick = MAX(lastTick, event.tick);
+
+	if (length) *length = (double)lastTick / ticksPerBeat;
+	if (nameEvent) *nameEvent = name;
+	return YES;
+}
+
+#pragma mark - Private
+
+- (NSError *)errorForResult:(MIKMIDIFileResult)result
+{
+	NSString *reason = nil;
+	switch (result) {
+		case MIKMIDIFileResultNotAMIDIFile: reason = @"The data does not start with a valid MThd chunk."; break;
+		case MIKMIDIFileResultTruncated: reason = @"The file ends in the middle of a chunk or event."; break;
+		case MIKMIDIFileResultMalformedEvent: reason = @"A track contains a malformed event."; break;
+		case MIKMIDIFileResultMissingRunningStatus: reason = @"A track uses running status before any status byte."; break;
+		default: reason = @"The data could not be parsed as a Standard MIDI File."; break;
+	}
+	return [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidMIDIFileErrorCode userInfo:@{NSLocalizedFailureReasonErrorKey : reason}];
+}
+
+#pragma mark - Properties
+
+- (SInt16)timeResolution
+{
+	return (SInt16)(self.canDecodeEvents ? self.header.division : 0);
+}
+
+- (BOOL)canDecodeEvents
+{
+	MIKMIDIFileHeader header = self.header;
+	return MIKMIDIFileHeaderHasMetricalDivision(&header) ? YES : NO;
+}
+
+@end
@@ -0,0 +1,99 @@
+//
+//  MIKMIDIFileEncoder.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDITrack;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  MIKMIDIFileEncoder writes MIKMIDITracks out as a format 1 Standard MIDI File using
+ *  MIKMIDI's own SMF writer (see MIKMIDIFileWriter.h), rather than MusicSequenceFileCreateData().
+ *
+ *  The file is streamed to its destination one small buffer at a time, so the memory
+ *  needed does not grow with the size of the file.
+ *
+ *  Note events are written as note on/note off pairs, tempo events as tempo meta events,
+ *  and meta, channel and raw data (system exclusive) events as themselves. Other event
+ *  types can't be represented in a MIDI file, and are skipped.
+ *
+ *  The tempo track is written as its own track chunk, the first in the file, followed by a
+ *  chunk for each of the other tracks. When MIKMIDISequence reads a file back, a first chunk
+ *  holding nothing but tempo and time signature events is read into its tempo track, so the
+ *  sequence has the same tracks it was written with. If the tempo track holds other events,
+ *  they're read back as an extra first track, as MusicSequenceFileLoadData() would.
+ *
+ *  @note This class is for internal MIKMIDI use only. It is used by MIKMIDISequence.
+ */
+@interface MIKMIDIFileEncoder : NSObject
+
+/**
+ *  Creates an encoder for the given tracks.
+ *
+ *  @param tempoTrack     The tempo track, which is written as the first track chunk. May be nil.
+ *  @param tracks         The tracks to write, in order.
+ *  @param timeResolution The number of ticks per quarter note to use in the file.
+ *
+ *  @return An initialized encoder.
+ */
+- (instancetype)initWithTempoTrack:(nullable MIKMIDITrack *)tempoTrack tracks:(MIKArrayOf(MIKMIDITrack *) *)tracks timeResolution:(SInt16)timeResolution;
+
+/**
+ *  Writes the file to a file descriptor, starting at its current offset.
+ *
+ *  If the file descriptor is seekable, each track is written in a single pass, and its
+ *  length filled in afterwards. Otherwise, each track is encoded twice: once to measure its
+ *  length, and once to write it.
+ *
+ *  @param fileDescriptor An open, writable file descriptor. It is not closed.
+ *  @param error          If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return YES if the file was written successfully, NO if an error occurred.
+ */
+- (BOOL)writeToFileDescriptor:(int)fileDescriptor error:(NSError **)error;
+
+/**
+ *  Writes the file to an output stream. As output streams can't seek, each track is
+ *  encoded twice: once to measure its length, and once to write it.
+ *
+ *  @param stream The stream to write to. It is opened if it isn't open already, and is not closed.
+ *  @param error  If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return YES if the file was written successfully, NO if an error occurred.
+ */
+- (BOOL)writeToOutputStream:(NSOutputStream *)stream error:(NSError **)error;
+
+/**
+ *  Returns the complete file as an NSData instance.
+ *
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem.
+ *
+ *  @return The contents of the file, or nil if an error occurred.
+ */
+- (nullable NSData *)dataWithError:(NSError **)error;
+
+/**
+ *  The tempo track the receiver writes.
+ */
+@property (nonatomic, strong, readonly, nullable) MIKMIDITrack *tempoTrack;
+
+/**
+ *  The tracks the receiver writes.
+ */
+@property (nonatomic, copy, readonly) MIKArrayOf(MIKMIDITrack *) *tracks;
+
+/**
+ *  The number of ticks per quarter note used in the file.
+ */
+@property (nonatomic, readonly) SInt16 timeResolution;
+
+@end
+
+NS_ASSUME_NONNULL_END
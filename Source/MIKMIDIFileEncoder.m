@@ -0,0 +1,322 @@
+//
+//  MIKMIDIFileEncoder.m
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIFileEncoder.h"
+#import <AudioToolbox/AudioToolbox.h>
+#include <unistd.h>
+#include <errno.h>
+#import "MIKMIDIFileWriter.h"
+#import "MIKMIDITrack.h"
+#import "MIKMIDITrack_Protected.h"
+#import "MIKMIDIEventStore.h"
+#import "MIKMIDIEvent.h"
+#import "MIKMIDIMetaEvent.h"
+#import "MIKMIDIErrors.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDIFileEncoder.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIFileEncoder.m in the Build Phases for this target
+#endif
+
+#pragma mark - Outputs
+
+typedef struct {
+	int fileDescriptor;
+	off_t startOffset;
+	int errorNumber;
+} MIKMIDIFileEncoderFileDescriptorOutput;
+
+static MIKMIDIFileResult MIKMIDIFileEncoderWriteToFileDescriptor(void *context, const uint8_t *bytes, size_t length)
+{
+	MIKMIDIFileEncoderFileDescriptorOutput *output = context;
+	while (length) {
+		ssize_t written = write(output->fileDescriptor, bytes, length);
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			output->errorNumber = errno;
+			return MIKMIDIFileResultOutputFailed;
+		}
+		bytes += written;
+		length -= (size_t)written;
+	}
+	return MIKMIDIFileResultOK;
+}
+
+static MIKMIDIFileResult MIKMIDIFileEncoderPatchFileDescriptor(void *context, uint64_t offset, const uint8_t *bytes, size_t length)
+{
+	MIKMIDIFileEncoderFileDescriptorOutput *output = context;
+	off_t position = output->startOffset + (off_t)offset;
+	while (length) {
+		ssize_t written = pwrite(output->fileDescriptor, bytes, length, position);
+		if (written < 0) {
+			if (errno == EINTR) continue;
+			output->errorNumber = errno;
+			return MIKMIDIFileResultOutputFailed;
+		}
+		bytes += written;
+		position += written;
+		length -= (size_t)written;
+	}
+	return MIKMIDIFileResultOK;
+}
+
+static MIKMIDIFileResult MIKMIDIFileEncoderWriteToOutputStream(void *context, const uint8_t *bytes, size_t length)
+{
+	NSOutputStream *stream = (__bridge NSOutputStream *)context;
+	while (length) {
+		NSInteger written = [stream write:bytes maxLength:length];
+		if (written <= 0) return MIKMIDIFileResultOutputFailed;
+		bytes += written;
+		length -= (size_t)written;
+	}
+	return MIKMIDIFileResultOK;
+}
+
+static MIKMIDIFileResult MIKMIDIFileEncoderWriteToData(void *context, const uint8_t *bytes, size_t length)
+{
+	[(__bridge NSMutableData *)context appendBytes:bytes length:length];
+	return MIKMIDIFileResultOK;
+}
+
+static MIKMIDIFileResult MIKMIDIFileEncoderPatchData(void *context, uint64_t offset, const uint8_t *bytes, size_t length)
+{
+	[(__bridge NSMutableData *)context replaceBytesInRange:NSMakeRange((NSUInteger)offset, length) withBytes:bytes];
+	return MIKMIDIFileResultOK;
+}
+
+// Used to measure a track before writing it to an output that can't be patched.
+static MIKMIDIFileResult MIKMIDIFileEncoderDiscard(void *context, const uint8_t *bytes, size_t length)
+{
+	return MIKMIDIFileResultOK;
+}
+
+static MIKMIDIFileResult MIKMIDIFileEncoderDiscardPatch(void *context, uint64_t offset, const uint8_t *bytes, size_t length)
+{
+	return MIKMIDIFileResultOK;
+}
+
+#pragma mark - Events
+
+// bytes and length are the event's data, as returned by -[MIKMIDIEvent data].
+static MIKMIDIFileResult MIKMIDIFileEncoderWriteEvent(MIKMIDIFileWriter *writer, MusicTimeStamp timeStamp, MIKMIDIEventType eventType,
+													  const UInt8 *bytes, NSUInteger length, double ticksPerBeat)
+{
+	uint64_t tick = (uint64_t)llround(MAX(timeStamp, 0) * ticksPerBeat);
+
+	switch (eventType) {
+		case MIKMIDIEventTypeMIDINoteMessage: {
+			if (length < sizeof(MIDINoteMessage)) break;
+			const MIDINoteMessage *message = (const MIDINoteMessage *)bytes;
+			uint64_t endTick = tick + (uint64_t)llround(MAX(message->duration, 0) * ticksPerBeat);
+			return MIKMIDIFileWriterWriteNote(writer, tick, endTick, message->channel, message->note, message->velocity, message->releaseVelocity);
+		}
+
+		case MIKMIDIEventTypeExtendedTempo: {
+			if (length < sizeof(ExtendedTempoEvent)) break;
+			Float64 bpm = ((const ExtendedTempoEvent *)bytes)->bpm;
+			if (bpm <= 0) break;
+			uint32_t microsecondsPerQuarterNote = (uint32_t)MIN(MAX(llround(60000000.0 / bpm), 1), 0xFFFFFF);
+			uint8_t payload[3] = {(microsecondsPerQuarterNote >> 16) & 0xFF, (microsecondsPerQuarterNote >> 8) & 0xFF, microsecondsPerQuarterNote & 0xFF};
+			return MIKMIDIFileWriterWriteMetaEvent(writer, tick, MIKMIDIFileMetaTypeTempo, payload, sizeof(payload));
+		}
+
+		case MIKMIDIEventTypeMIDIChannelMessage:
+		case MIKMIDIEventTypeMIDIPolyphonicKeyPressureMessage:
+		case MIKMIDIEventTypeMIDIControlChangeMessage:
+		case MIKMIDIEventTypeMIDIProgramChangeMessage:
+		case MIKMIDIEventTypeMIDIChannelPressureMessage:
+		case MIKMIDIEventTypeMIDIPitchBendChangeMessage: {
+			if (length < sizeof(MIDIChannelMessage)) break;
+			const MIDIChannelMessage *message = (const MIDIChannelMessage *)bytes;
+			if (MIKMIDIFileDataLengthForChannelStatus(message->status) < 0) break;
+			return MIKMIDIFileWriterWriteChannelEvent(writer, tick, message->status, message->data1, message->data2);
+		}
+
+		case MIKMIDIEventTypeMIDIRawData: {
+			if (length < offsetof(MIDIRawData, data)) break;
+			const MIDIRawData *rawData = (const MIDIRawData *)bytes;
+			UInt32 rawLength = (UInt32)MIN(rawData->length, length - offsetof(MIDIRawData, data));
+			if (!rawLength) break;
+			// Files store a leading 0xF0 as the event's status. Anything else is written as an escape.
+			if (rawData->data[0] == 0xF0) {
+				return MIKMIDIFileWriterWriteSystemExclusiveEvent(writer, tick, 0xF0, rawData->data + 1, rawLength - 1);
+			}
+			return MIKMIDIFileWriterWriteSystemExclusiveEvent(writer, tick, 0xF7, rawData->data, rawLength);
+		}
+
+		case MIKMIDIEventTypeMeta:
+		case MIKMIDIEventTypeMetaSequence:
+		case MIKMIDIEventTypeMetaText:
+		case MIKMIDIEventTypeMetaCopyright:
+		case MIKMIDIEventTypeMetaTrackSequenceName:
+		case MIKMIDIEventTypeMetaInstrumentName:
+		case MIKMIDIEventTypeMetaLyricText:
+		case MIKMIDIEventTypeMetaMarkerText:
+		case MIKMIDIEventTypeMetaCuePoint:
+		case MIKMIDIEventTypeMetaMIDIChannelPrefix:
+		case MIKMIDIEventTypeMetaEndOfTrack:
+		case MIKMIDIEventTypeMetaTempoSetting:
+		case MIKMIDIEventTypeMetaSMPTEOffset:
+		case MIKMIDIEventTypeMetaTimeSignature:
+		case MIKMIDIEventTypeMetaKeySignature:
+		case MIKMIDIEventTypeMetaSequenceSpecificEvent: {
+			if (length < MIKMIDIEventMetadataStartOffset) break;
+			const MIDIMetaEvent *metaEvent = (const MIDIMetaEvent *)bytes;
+			UInt32 payloadLength = (UInt32)MIN(metaEvent->dataLength, length - MIKMIDIEventMetadataStartOffset);
+			return MIKMIDIFileWriterWriteMetaEvent(writer, tick, metaEvent->metaEventType, bytes + MIKMIDIEventMetadataStartOffset, payloadLength);
+		}
+
+		default:
+			// User, parameter, AU preset and extended note events have no Standard MIDI File representation.
+			break;
+	}
+	return MIKMIDIFileResultOK;
+}
+
+static MIKMIDIFileResult MIKMIDIFileEncoderWriteTrack(MIKMIDIFileWriter *writer, MIKMIDIEventStore *events, double ticksPerBeat, uint32_t length, uint32_t *actualLength)
+{
+	__block MIKMIDIFileResult result = MIKMIDIFileWriterBeginTrack(writer, length);
+	if (result != MIKMIDIFileResultOK) return result;
+	[events enumerateEventsOfClass:Nil fromTimeStamp:-DBL_MAX toTimeStamp:DBL_MAX usingBlock:^(NSUInteger index, MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *bytes, NSUInteger eventLength, BOOL *stop) {
+		result = MIKMIDIFileEncoderWriteEvent(writer, timeStamp, eventType, bytes, eventLength, ticksPerBeat);
+		if (result != MIKMIDIFileResultOK) *stop = YES;
+	}];
+	if (result != MIKMIDIFileResultOK) return result;
+	return MIKMIDIFileWriterEndTrack(writer, actualLength);
+}
+
+@interface MIKMIDIFileEncoder ()
+
+@property (nonatomic, strong, readwrite) MIKMIDITrack *tempoTrack;
+@property (nonatomic, copy, readwrite) NSArray *tracks;
+@property (nonatomic, readwrite) SInt16 timeResolution;
+
+@end
+
+@implementation MIKMIDIFileEncoder
+
+- (instancetype)initWithTempoTrack:(MIKMIDITrack *)tempoTrack tracks:(NSArray *)tracks timeResolution:(SInt16)timeResolution
+{
+	self = [super init];
+	if (self) {
+		_tempoTrack = tempoTrack;
+		_tracks = [tracks copy];
+		_timeResolution = timeResolution;
+	}
+	return self;
+}
+
+#pragma mark - Public
+
+- (BOOL)writeToFileDescriptor:(int)fileDescriptor error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+
+	MIKMIDIFileEncoderFileDescriptorOutput output = {
+		.fileDescriptor = fileDescriptor,
+		.startOffset = lseek(fileDescriptor, 0, SEEK_CUR),
+	};
+	// Pipes and sockets can't be patched.
+	MIKMIDIFileWriterPatchFunction patch = (output.startOffset >= 0) ? MIKMIDIFileEncoderPatchFileDescriptor : NULL;
+
+	MIKMIDIFileResult result = [self writeUsingFunction:MIKMIDIFileEncoderWriteToFileDescriptor patchFunction:patch context:&output];
+	if (result == MIKMIDIFileResultOutputFailed) {
+		*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:output.errorNumber userInfo:nil];
+		return NO;
+	}
+	if (result != MIKMIDIFileResultOK) {
+		*error = [self errorForResult:result];
+		return NO;
+	}
+	return YES;
+}
+
+- (BOOL)writeToOutputStream:(NSOutputStream *)stream error:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+
+	if ([stream streamStatus] == NSStreamStatusNotOpen) [stream open];
+
+	MIKMIDIFileResult result = [self writeUsingFunction:MIKMIDIFileEncoderWriteToOutputStream patchFunction:NULL context:(__bridge void *)stream];
+	if (result == MIKMIDIFileResultOutputFailed) {
+		*error = [stream streamError] ?: [NSError MIKMIDIErrorWithCode:MIKMIDIUnknownErrorCode userInfo:nil];
+		return NO;
+	}
+	if (result != MIKMIDIFileResultOK) {
+		*error = [self errorForResult:result];
+		return NO;
+	}
+	return YES;
+}
+
+- (NSData *)dataWithError:(NSError **)error
+{
+	error = error ?: &(NSError *__autoreleasing){ nil };
+
+	NSMutableData *data = [NSMutableData data];
+	MIKMIDIFileResult result = [self writeUsingFunction:MIKMIDIFileEncoderWriteToData patchFunction:MIKMIDIFileEncoderPatchData context:(__bridge void *)data];
+	if (result != MIKMIDIFileResultOK) {
+		*error = [self errorForResult:result];
+		return nil;
+	}
+	return data;
+}
+
+#pragma mark - Private
+
+- (MIKMIDIFileResult)writeUsingFunction:(MIKMIDIFileWriterWriteFunction)write patchFunction:(MIKMIDIFileWriterPatchFunction)patch context:(void *)context
+{
+	// The tempo track is written first, as the conductor track of the file
+	NSMutableArray *tracks = [NSMutableArray arrayWithCapacity:[self.tracks count] + 1];
+	if (self.tempoTrack) [tracks addObject:self.tempoTrack];
+	[tracks addObjectsFromArray:self.tracks];
+	NSUInteger numberOfChunks = [tracks count];
+	if (numberOfChunks > UINT16_MAX || self.timeResolution <= 0) return MIKMIDIFileResultInvalidArgument;
+	double ticksPerBeat = (double)self.timeResolution;
+
+	MIKMIDIFileWriter writer;
+	MIKMIDIFileWriterInit(&writer, write, patch, context);
+	MIKMIDIFileHeader header = {
+		.format = 1,
+		.numberOfTracks = (uint16_t)numberOfChunks,
+		.division = (uint16_t)self.timeResolution,
+	};
+	MIKMIDIFileResult result = MIKMIDIFileWriterWriteHeader(&writer, &header);
+
+	for (NSUInteger i = 0; i < numberOfChunks; i++) {
+		if (result != MIKMIDIFileResultOK) break;
+		@autoreleasepool {
+			// Read the packed events, rather than creating an object for every event
+			MIKMIDIEventStore *events = [tracks[i] copyOfEventStore];
+			uint32_t length = MIKMIDIFileWriterUnknownTrackLength;
+			if (!patch) {
+				// There's no going back to fill in the length, so work it out first.
+				MIKMIDIFileWriter counter;
+				MIKMIDIFileWriterInit(&counter, MIKMIDIFileEncoderDiscard, MIKMIDIFileEncoderDiscardPatch, NULL);
+				result = MIKMIDIFileEncoderWriteTrack(&counter, events, ticksPerBeat, MIKMIDIFileWriterUnknownTrackLength, &length);
+				MIKMIDIFileWriterDestroy(&counter);
+				if (result != MIKMIDIFileResultOK) break;
+			}
+			result = MIKMIDIFileEncoderWriteTrack(&writer, events, ticksPerBeat, length, NULL);
+		}
+	}
+
+	if (result == MIKMIDIFileResultOK) result = MIKMIDIFileWriterFlush(&writer);
+	MIKMIDIFileWriterDestroy(&writer);
+	return result;
+}
+
+- (NSError *)errorForResult:(MIKMIDIFileResult)result
+{
+	NSString *reason = @"The sequence could not be written as a Standard MIDI File.";
+	if (result == MIKMIDIFileResultInvalidArgument) {
+		reason = @"The sequence has more tracks, or events further apart, than a Standard MIDI File can represent.";
+	}
+	return [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:@{NSLocalizedFailureReasonErrorKey : reason}];
+}
+
+@end
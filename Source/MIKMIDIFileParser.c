@@ -0,0 +1,216 @@
+//
+//  MIKMIDIFileParser.c
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#include "MIKMIDIFileParser.h"
+#include <string.h>
+
+static inline uint32_t MIKMIDIFileReadUInt32(const uint8_t *bytes)
+{
+	return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | (uint32_t)bytes[3];
+}
+
+static inline uint16_t MIKMIDIFileReadUInt16(const uint8_t *bytes)
+{
+	return (uint16_t)((bytes[0] << 8) | bytes[1]);
+}
+
+MIKMIDIFileResult MIKMIDIFileReadVariableLengthQuantity(const uint8_t **cursor, const uint8_t *end, uint32_t *value)
+{
+	const uint8_t *p = *cursor;
+	uint32_t result = 0;
+	for (int i = 0; i < 4; i++) {
+		if (p >= end) return MIKMIDIFileResultTruncated;
+		uint8_t byte = *p++;
+		result = (result << 7) | (byte & 0x7F);
+		if (!(byte & 0x80)) {
+			*cursor = p;
+			*value = result;
+			return MIKMIDIFileResultOK;
+		}
+	}
+	return MIKMIDIFileResultMalformedEvent;
+}
+
+MIKMIDIFileResult MIKMIDIFileParseHeader(const uint8_t *bytes, size_t length, MIKMIDIFileHeader *header, size_t *firstChunkOffset)
+{
+	if (!bytes || !header) return MIKMIDIFileResultInvalidArgument;
+	if (length < 14) return MIKMIDIFileResultTruncated;
+	if (memcmp(bytes, "MThd", 4) != 0) return MIKMIDIFileResultNotAMIDIFile;
+
+	uint32_t headerLength = MIKMIDIFileReadUInt32(bytes + 4);
+	if (headerLength < 6) return MIKMIDIFileResultNotAMIDIFile;
+	if ((size_t)headerLength > length - 8) return MIKMIDIFileResultTruncated;
+
+	header->format = MIKMIDIFileReadUInt16(bytes + 8);
+	header->numberOfTracks = MIKMIDIFileReadUInt16(bytes + 10);
+	header->division = MIKMIDIFileReadUInt16(bytes + 12);
+	if (header->format > 2) return MIKMIDIFileResultNotAMIDIFile;
+
+	if (firstChunkOffset) *firstChunkOffset = 8 + (size_t)headerLength;
+	return MIKMIDIFileResultOK;
+}
+
+MIKMIDIFileResult MIKMIDIFileIndexTrackChunks(const uint8_t *bytes, size_t length, const MIKMIDIFileHeader *header, MIKMIDIFileTrackChunk *chunks, size_t capacity, size_t *count)
+{
+	if (!bytes || !header || !count) return MIKMIDIFileResultInvalidArgument;
+
+	MIKMIDIFileHeader scratch;
+	size_t offset = 0;
+	MIKMIDIFileResult result = MIKMIDIFileParseHeader(bytes, length, &scratch, &offset);
+	if (result != MIKMIDIFileResultOK) return result;
+
+	size_t found = 0;
+	while (offset + 8 <= length && found < header->numberOfTracks) {
+		uint32_t chunkLength = MIKMIDIFileReadUInt32(bytes + offset + 4);
+		const uint8_t *chunkData = bytes + offset + 8;
+		size_t available = length - (offset + 8);
+		int isTrack = (memcmp(bytes + offset, "MTrk", 4) == 0);
+
+		if ((size_t)chunkLength > available) {
+			// Some writers get the length of the last chunk wrong. Be lenient with
+			// track chunks, since the End of Track event delimits the data anyway.
+			if (!isTrack) break;
+			chunkLength = (uint32_t)available;
+		}
+
+		if (isTrack) {
+			if (chunks && found < capacity) {
+				chunks[found].bytes = chunkData;
+				chunks[found].length = chunkLength;
+			}
+			found++;
+		}
+		offset += 8 + (size_t)chunkLength;
+	}
+
+	*count = found;
+	return MIKMIDIFileResultOK;
+}
+
+void MIKMIDIFileTrackReaderInit(MIKMIDIFileTrackReader *reader, MIKMIDIFileTrackChunk chunk)
+{
+	reader->cursor = chunk.bytes;
+	reader->end = chunk.bytes + chunk.length;
+	reader->tick = 0;
+	reader->runningStatus = 0;
+	reader->finished = 0;
+}
+
+int MIKMIDIFileDataLengthForChannelStatus(uint8_t status)
+{
+	switch (status & 0xF0) {
+		case 0x80:
+		case 0x90:
+		case 0xA0:
+		case 0xB0:
+		case 0xE0:
+			return 2;
+		case 0xC0:
+		case 0xD0:
+			return 1;
+		default:
+			return -1;
+	}
+}
+
+MIKMIDIFileResult MIKMIDIFileTrackReaderNextEvent(MIKMIDIFileTrackReader *reader, MIKMIDIFileEvent *event)
+{
+	if (!reader || !event) return MIKMIDIFileResultInvalidArgument;
+	if (reader->finished) return MIKMIDIFileResultEndOfTrack;
+
+	const uint8_t *p = reader->cursor;
+	const uint8_t *end = reader->end;
+
+	if (p >= end) {
+		reader->finished = 1;
+		event->tick = reader->tick;
+		return MIKMIDIFileResultEndOfTrack;
+	}
+
+	uint32_t delta = 0;
+	MIKMIDIFileResult result = MIKMIDIFileReadVariableLengthQuantity(&p, end, &delta);
+	if (result != MIKMIDIFileResultOK) return result;
+	if (p >= end) return MIKMIDIFileResultTruncated;
+
+	uint64_t tick = reader->tick + delta;
+	uint8_t status = *p;
+
+	memset(event, 0, sizeof(*event));
+	event->tick = tick;
+
+	if (status == 0xFF) {
+		p++;
+		if (p >= end) return MIKMIDIFileResultTruncated;
+		uint8_t type = *p++;
+		uint32_t length = 0;
+		result = MIKMIDIFileReadVariableLengthQuantity(&p, end, &length);
+		if (result != MIKMIDIFileResultOK) return result;
+		if ((size_t)(end - p) < length) return MIKMIDIFileResultTruncated;
+
+		event->kind = MIKMIDIFileEventKindMeta;
+		event->status = 0xFF;
+		event->metaType = type;
+		event->payload = p;
+		event->payloadLength = length;
+		p += length;
+
+		// Running status is cancelled by meta events in practice, though some
+		// files rely on it persisting, so leave it alone.
+		reader->cursor = p;
+		reader->tick = tick;
+		if (type == MIKMIDIFileMetaTypeEndOfTrack) {
+			reader->finished = 1;
+			return MIKMIDIFileResultEndOfTrack;
+		}
+		return MIKMIDIFileResultOK;
+	}
+
+	if (status == 0xF0 || status == 0xF7) {
+		p++;
+		uint32_t length = 0;
+		result = MIKMIDIFileReadVariableLengthQuantity(&p, end, &length);
+		if (result != MIKMIDIFileResultOK) return result;
+		if ((size_t)(end - p) < length) return MIKMIDIFileResultTruncated;
+
+		event->kind = MIKMIDIFileEventKindSystemExclusive;
+		event->status = status;
+		event->payload = p;
+		event->payloadLength = length;
+		p += length;
+
+		reader->runningStatus = 0;
+		reader->cursor = p;
+		reader->tick = tick;
+		return MIKMIDIFileResultOK;
+	}
+
+	if (status & 0x80) {
+		if (MIKMIDIFileDataLengthForChannelStatus(status) < 0) return MIKMIDIFileResultMalformedEvent;
+		reader->runningStatus = status;
+		p++;
+	} else {
+		status = reader->runningStatus;
+		if (!status) return MIKMIDIFileResultMissingRunningStatus;
+	}
+
+	int dataLength = MIKMIDIFileDataLengthForChannelStatus(status);
+	if (end - p < dataLength) return MIKMIDIFileResultTruncated;
+
+	// A status byte where a data byte belongs means the track is corrupt
+	if ((p[0] & 0x80) || (dataLength > 1 && (p[1] & 0x80))) return MIKMIDIFileResultMalformedEvent;
+
+	event->kind = MIKMIDIFileEventKindChannel;
+	event->status = status;
+	event->data1 = p[0];
+	if (dataLength > 1) event->data2 = p[1];
+	p += dataLength;
+
+	reader->cursor = p;
+	reader->tick = tick;
+	return MIKMIDIFileResultOK;
+}
@@ -0,0 +1,190 @@
+//
+//  MIKMIDIFileParser.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#ifndef MIKMIDIFileParser_h
+#define MIKMIDIFileParser_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  A small, portable reader for Standard MIDI Files (SMF).
+ *
+ *  The parser operates directly on a buffer containing the file's contents
+ *  and never copies or allocates. Meta event and system exclusive payloads
+ *  returned by the reader point into the original buffer, so the buffer must
+ *  outlive any MIKMIDIFileEvent obtained from it.
+ *
+ *  This file has no dependency on Foundation, CoreMIDI or AudioToolbox, and
+ *  can be compiled and tested on any platform with a C99 compiler.
+ */
+
+/**
+ *  Result codes returned by the MIKMIDIFile* functions.
+ */
+typedef enum {
+	MIKMIDIFileResultOK = 0,
+	MIKMIDIFileResultEndOfTrack = 1,
+	MIKMIDIFileResultInvalidArgument = -1,
+	MIKMIDIFileResultNotAMIDIFile = -2,
+	MIKMIDIFileResultTruncated = -3,
+	/** An event has an undefined status byte, or a status byte where a data byte belongs. */
+	MIKMIDIFileResultMalformedEvent = -4,
+	MIKMIDIFileResultMissingRunningStatus = -5,
+	/** Returned by MIKMIDIFileWriter when its output could not be written. */
+	MIKMIDIFileResultOutputFailed = -6,
+} MIKMIDIFileResult;
+
+/**
+ *  The kinds of events that can be found in a track chunk.
+ */
+typedef enum {
+	MIKMIDIFileEventKindChannel = 0,
+	MIKMIDIFileEventKindMeta,
+	MIKMIDIFileEventKindSystemExclusive,
+} MIKMIDIFileEventKind;
+
+/**
+ *  Meta event types used by the reader and writer.
+ */
+enum {
+	MIKMIDIFileMetaTypeEndOfTrack = 0x2F,
+	MIKMIDIFileMetaTypeTempo = 0x51,
+	MIKMIDIFileMetaTypeTimeSignature = 0x58,
+	MIKMIDIFileMetaTypeTrackName = 0x03,
+};
+
+/**
+ *  The contents of the MThd chunk.
+ */
+typedef struct {
+	uint16_t format;
+	uint16_t numberOfTracks;
+	/** Raw division word. If the high bit is clear, this is the number of ticks per quarter note. */
+	uint16_t division;
+} MIKMIDIFileHeader;
+
+/**
+ *  The location of a single MTrk chunk's data in the file buffer.
+ */
+typedef struct {
+	const uint8_t *bytes;
+	uint32_t length;
+} MIKMIDIFileTrackChunk;
+
+/**
+ *  A single event decoded from a track chunk.
+ */
+typedef struct {
+	/** Absolute time of the event in ticks from the start of the track. */
+	uint64_t tick;
+	MIKMIDIFileEventKind kind;
+	/** The full status byte (including channel) for channel events, 0xFF for meta events, and 0xF0 or 0xF7 for system exclusive events. */
+	uint8_t status;
+	/** The meta event type, for meta events. */
+	uint8_t metaType;
+	/** The first and second data bytes for channel events. Unused data bytes are 0. */
+	uint8_t data1;
+	uint8_t data2;
+	/** Payload of meta and system exclusive events. Points into the file buffer. */
+	const uint8_t *payload;
+	uint32_t payloadLength;
+} MIKMIDIFileEvent;
+
+/**
+ *  Sequential reader for the events in a single track chunk.
+ */
+typedef struct {
+	const uint8_t *cursor;
+	const uint8_t *end;
+	uint64_t tick;
+	uint8_t runningStatus;
+	int finished;
+} MIKMIDIFileTrackReader;
+
+/**
+ *  Returns nonzero if the division in header is expressed in ticks per quarter note
+ *  (as opposed to SMPTE frames).
+ */
+static inline int MIKMIDIFileHeaderHasMetricalDivision(const MIKMIDIFileHeader *header)
+{
+	return (header->division & 0x8000) == 0 && header->division != 0;
+}
+
+/**
+ *  Reads a variable-length quantity.
+ *
+ *  @param cursor Pointer to the first byte of the quantity. Advanced past the quantity on success.
+ *  @param end    Pointer one past the last readable byte.
+ *  @param value  On success, the decoded value.
+ *
+ *  @return MIKMIDIFileResultOK, or an error if the quantity is truncated or longer than 4 bytes.
+ */
+MIKMIDIFileResult MIKMIDIFileReadVariableLengthQuantity(const uint8_t **cursor, const uint8_t *end, uint32_t *value);
+
+/**
+ *  Parses the MThd chunk at the beginning of a file buffer.
+ *
+ *  @param bytes   The file's contents.
+ *  @param length  The length of bytes.
+ *  @param header  On success, filled in with the header's values.
+ *  @param firstChunkOffset On success, the offset of the chunk following MThd. May be NULL.
+ *
+ *  @return MIKMIDIFileResultOK, or an error code.
+ */
+MIKMIDIFileResult MIKMIDIFileParseHeader(const uint8_t *bytes, size_t length, MIKMIDIFileHeader *header, size_t *firstChunkOffset);
+
+/**
+ *  Locates the MTrk chunks in a file without decoding any of their events.
+ *  Chunks of other types are skipped, as required by the SMF specification.
+ *
+ *  @param bytes    The file's contents.
+ *  @param length   The length of bytes.
+ *  @param header   The header previously parsed with MIKMIDIFileParseHeader().
+ *  @param chunks   Array to fill in with the track chunks found. May be NULL to only count chunks.
+ *  @param capacity The number of elements in chunks.
+ *  @param count    On return, the number of track chunks found (which may exceed capacity).
+ *
+ *  @return MIKMIDIFileResultOK, or an error code.
+ */
+MIKMIDIFileResult MIKMIDIFileIndexTrackChunks(const uint8_t *bytes, size_t length, const MIKMIDIFileHeader *header, MIKMIDIFileTrackChunk *chunks, size_t capacity, size_t *count);
+
+/**
+ *  Prepares reader to read the events in chunk.
+ */
+void MIKMIDIFileTrackReaderInit(MIKMIDIFileTrackReader *reader, MIKMIDIFileTrackChunk chunk);
+
+/**
+ *  Decodes the next event in a track.
+ *
+ *  The End of Track meta event is consumed by the reader and reported by returning
+ *  MIKMIDIFileResultEndOfTrack, with event->tick set to its time.
+ *  A chunk that ends without an End of Track event is treated as if it had one.
+ *
+ *  @param reader A reader initialized with MIKMIDIFileTrackReaderInit().
+ *  @param event  On success, the decoded event.
+ *
+ *  @return MIKMIDIFileResultOK if an event was decoded, MIKMIDIFileResultEndOfTrack at the end of the track, or an error.
+ */
+MIKMIDIFileResult MIKMIDIFileTrackReaderNextEvent(MIKMIDIFileTrackReader *reader, MIKMIDIFileEvent *event);
+
+/**
+ *  Returns the number of data bytes that follow a channel message status byte, or -1
+ *  if status is not a channel message status byte.
+ */
+int MIKMIDIFileDataLengthForChannelStatus(uint8_t status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MIKMIDIFileParser_h */
@@ -0,0 +1,315 @@
+//
+//  MIKMIDIFileWriter.c
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#include "MIKMIDIFileWriter.h"
+#include <stdlib.h>
+#include <string.h>
+
+static inline void MIKMIDIFileWriteUInt32(uint32_t value, uint8_t *bytes)
+{
+	bytes[0] = (value >> 24) & 0xFF;
+	bytes[1] = (value >> 16) & 0xFF;
+	bytes[2] = (value >> 8) & 0xFF;
+	bytes[3] = value & 0xFF;
+}
+
+size_t MIKMIDIFileWriteVariableLengthQuantity(uint32_t value, uint8_t *bytes)
+{
+	if (value > 0x0FFFFFFF) return 0;
+
+	size_t length = 1;
+	for (uint32_t remaining = value >> 7; remaining; remaining >>= 7) length++;
+	for (size_t i = 0; i < length; i++) {
+		uint8_t byte = (value >> (7 * (length - 1 - i))) & 0x7F;
+		bytes[i] = (i < length - 1) ? (byte | 0x80) : byte;
+	}
+	return length;
+}
+
+void MIKMIDIFileWriterInit(MIKMIDIFileWriter *writer, MIKMIDIFileWriterWriteFunction write, MIKMIDIFileWriterPatchFunction patch, void *context)
+{
+	memset(writer, 0, sizeof(*writer));
+	writer->write = write;
+	writer->patch = patch;
+	writer->context = context;
+	writer->result = write ? MIKMIDIFileResultOK : MIKMIDIFileResultInvalidArgument;
+}
+
+void MIKMIDIFileWriterDestroy(MIKMIDIFileWriter *writer)
+{
+	free(writer->pendingNoteOffs);
+	writer->pendingNoteOffs = NULL;
+	writer->pendingNoteOffCount = 0;
+	writer->pendingNoteOffCapacity = 0;
+}
+
+MIKMIDIFileResult MIKMIDIFileWriterFlush(MIKMIDIFileWriter *writer)
+{
+	if (writer->result != MIKMIDIFileResultOK) return writer->result;
+	if (!writer->bufferLength) return MIKMIDIFileResultOK;
+
+	writer->result = writer->write(writer->context, writer->buffer, writer->bufferLength);
+	writer->bufferLength = 0;
+	return writer->result;
+}
+
+static void MIKMIDIFileWriterAppend(MIKMIDIFileWriter *writer, const uint8_t *bytes, size_t length)
+{
+	if (writer->result != MIKMIDIFileResultOK || !length) return;
+
+	if (writer->bufferLength + length > MIKMIDIFileWriterBufferSize) {
+		if (MIKMIDIFileWriterFlush(writer) != MIKMIDIFileResultOK) return;
+	}
+	if (length > MIKMIDIFileWriterBufferSize) {
+		// Too big to be worth buffering, eg. a large sysex dump
+		writer->result = writer->write(writer->context, bytes, length);
+	} else {
+		memcpy(writer->buffer + writer->bufferLength, bytes, length);
+		writer->bufferLength += length;
+	}
+	writer->offset += length;
+}
+
+// Overwrites previously appended bytes, in the buffer if they're still there, otherwise via the patch function.
+static void MIKMIDIFileWriterOverwrite(MIKMIDIFileWriter *writer, uint64_t offset, const uint8_t *bytes, size_t length)
+{
+	if (writer->result != MIKMIDIFileResultOK) return;
+
+	uint64_t bufferStart = writer->offset - writer->bufferLength;
+	if (offset >= bufferStart) {
+		memcpy(writer->buffer + (offset - bufferStart), bytes, length);
+	} else if (writer->patch) {
+		writer->result = writer->patch(writer->context, offset, bytes, length);
+	} else {
+		writer->result = MIKMIDIFileResultInvalidArgument;
+	}
+}
+
+static void MIKMIDIFileWriterAppendDeltaTime(MIKMIDIFileWriter *writer, uint64_t tick)
+{
+	uint64_t delta = tick - writer->tick;
+	if (delta > 0x0FFFFFFF) {
+		writer->result = MIKMIDIFileResultInvalidArgument;
+		return;
+	}
+
+	uint8_t bytes[4];
+	size_t length = MIKMIDIFileWriteVariableLengthQuantity((uint32_t)delta, bytes);
+	MIKMIDIFileWriterAppend(writer, bytes, length);
+	writer->tick = tick;
+}
+
+static inline int MIKMIDIFileWriterNoteOffPrecedes(const MIKMIDIFileWriterPendingNoteOff *a, const MIKMIDIFileWriterPendingNoteOff *b)
+{
+	return a->tick < b->tick || (a->tick == b->tick && a->order < b->order);
+}
+
+static int MIKMIDIFileWriterPushNoteOff(MIKMIDIFileWriter *writer, MIKMIDIFileWriterPendingNoteOff noteOff)
+{
+	if (writer->pendingNoteOffCount == writer->pendingNoteOffCapacity) {
+		size_t capacity = writer->pendingNoteOffCapacity ? writer->pendingNoteOffCapacity * 2 : 64;
+		MIKMIDIFileWriterPendingNoteOff *noteOffs = realloc(writer->pendingNoteOffs, capacity * sizeof(*noteOffs));
+		if (!noteOffs) return 0;
+		writer->pendingNoteOffs = noteOffs;
+		writer->pendingNoteOffCapacity = capacity;
+	}
+
+	MIKMIDIFileWriterPendingNoteOff *heap = writer->pendingNoteOffs;
+	size_t i = writer->pendingNoteOffCount++;
+	while (i > 0) {
+		size_t parent = (i - 1) / 2;
+		if (!MIKMIDIFileWriterNoteOffPrecedes(&noteOff, &heap[parent])) break;
+		heap[i] = heap[parent];
+		i = parent;
+	}
+	heap[i] = noteOff;
+	return 1;
+}
+
+static MIKMIDIFileWriterPendingNoteOff MIKMIDIFileWriterPopNoteOff(MIKMIDIFileWriter *writer)
+{
+	MIKMIDIFileWriterPendingNoteOff *heap = writer->pendingNoteOffs;
+	MIKMIDIFileWriterPendingNoteOff result = heap[0];
+	MIKMIDIFileWriterPendingNoteOff last = heap[--writer->pendingNoteOffCount];
+	size_t count = writer->pendingNoteOffCount;
+
+	size_t i = 0;
+	while (1) {
+		size_t child = 2 * i + 1;
+		if (child >= count) break;
+		if (child + 1 < count && MIKMIDIFileWriterNoteOffPrecedes(&heap[child + 1], &heap[child])) child++;
+		if (!MIKMIDIFileWriterNoteOffPrecedes(&heap[child], &last)) break;
+		heap[i] = heap[child];
+		i = child;
+	}
+	if (count) heap[i] = last;
+	return result;
+}
+
+static void MIKMIDIFileWriterAppendChannelEvent(MIKMIDIFileWriter *writer, uint64_t tick, uint8_t status, uint8_t data1, uint8_t data2)
+{
+	MIKMIDIFileWriterAppendDeltaTime(writer, tick);
+
+	uint8_t bytes[3];
+	size_t length = 0;
+	if (status != writer->runningStatus) bytes[length++] = status;
+	bytes[length++] = data1 & 0x7F;
+	if (MIKMIDIFileDataLengthForChannelStatus(status) > 1) bytes[length++] = data2 & 0x7F;
+	MIKMIDIFileWriterAppend(writer, bytes, length);
+	writer->runningStatus = status;
+}
+
+// Writes the note offs due at or before tick
+static void MIKMIDIFileWriterWritePendingNoteOffs(MIKMIDIFileWriter *writer, uint64_t tick)
+{
+	while (writer->pendingNoteOffCount && writer->pendingNoteOffs[0].tick <= tick && writer->result == MIKMIDIFileResultOK) {
+		MIKMIDIFileWriterPendingNoteOff noteOff = MIKMIDIFileWriterPopNoteOff(writer);
+		MIKMIDIFileWriterAppendChannelEvent(writer, noteOff.tick, noteOff.status, noteOff.note, noteOff.velocity);
+	}
+}
+
+// Common checks and housekeeping before writing an event at tick
+static int MIKMIDIFileWriterPrepareForEvent(MIKMIDIFileWriter *writer, uint64_t tick)
+{
+	if (writer->result != MIKMIDIFileResultOK) return 0;
+	if (!writer->inTrack || tick < writer->tick) {
+		writer->result = MIKMIDIFileResultInvalidArgument;
+		return 0;
+	}
+	MIKMIDIFileWriterWritePendingNoteOffs(writer, tick);
+	return writer->result == MIKMIDIFileResultOK;
+}
+
+MIKMIDIFileResult MIKMIDIFileWriterWriteHeader(MIKMIDIFileWriter *writer, const MIKMIDIFileHeader *header)
+{
+	if (writer->result != MIKMIDIFileResultOK) return writer->result;
+	if (!header || writer->offset != 0) return (writer->result = MIKMIDIFileResultInvalidArgument);
+
+	uint8_t bytes[14] = {'M', 'T', 'h', 'd', 0, 0, 0, 6};
+	bytes[8] = header->format >> 8;
+	bytes[9] = header->format & 0xFF;
+	bytes[10] = header->numberOfTracks >> 8;
+	bytes[11] = header->numberOfTracks & 0xFF;
+	bytes[12] = header->division >> 8;
+	bytes[13] = header->division & 0xFF;
+	MIKMIDIFileWriterAppend(writer, bytes, sizeof(bytes));
+	return writer->result;
+}
+
+MIKMIDIFileResult MIKMIDIFileWriterBeginTrack(MIKMIDIFileWriter *writer, uint32_t length)
+{
+	if (writer->result != MIKMIDIFileResultOK) return writer->result;
+	if (writer->inTrack) return (writer->result = MIKMIDIFileResultInvalidArgument);
+
+	uint8_t bytes[8] = {'M', 'T', 'r', 'k'};
+	MIKMIDIFileWriteUInt32(length == MIKMIDIFileWriterUnknownTrackLength ? 0 : length, bytes + 4);
+	MIKMIDIFileWriterAppend(writer, bytes, sizeof(bytes));
+
+	writer->inTrack = 1;
+	writer->trackStartOffset = writer->offset;
+	writer->expectedTrackLength = length;
+	writer->tick = 0;
+	writer->runningStatus = 0;
+	writer->pendingNoteOffCount = 0;
+	writer->nextNoteOffOrder = 0;
+	return writer->result;
+}
+
+MIKMIDIFileResult MIKMIDIFileWriterWriteChannelEvent(MIKMIDIFileWriter *writer, uint64_t tick, uint8_t status, uint8_t data1, uint8_t data2)
+{
+	if (MIKMIDIFileDataLengthForChannelStatus(status) < 0) return (writer->result = MIKMIDIFileResultInvalidArgument);
+	if (!MIKMIDIFileWriterPrepareForEvent(writer, tick)) return writer->result;
+
+	MIKMIDIFileWriterAppendChannelEvent(writer, tick, status, data1, data2);
+	return writer->result;
+}
+
+MIKMIDIFileResult MIKMIDIFileWriterWriteNote(MIKMIDIFileWriter *writer, uint64_t tick, uint64_t endTick, uint8_t channel, uint8_t note, uint8_t velocity, uint8_t releaseVelocity)
+{
+	if (!MIKMIDIFileWriterPrepareForEvent(writer, tick)) return writer->result;
+
+	// A note on with a velocity of 0 would be read as a note off anyway, so say so, and don't end the note a second time
+	if (velocity == 0) {
+		MIKMIDIFileWriterAppendChannelEvent(writer, tick, 0x80 | (channel & 0x0F), note, releaseVelocity);
+		return writer->result;
+	}
+
+	MIKMIDIFileWriterAppendChannelEvent(writer, tick, 0x90 | (channel & 0x0F), note, velocity);
+
+	// Note ons with a velocity of 0 make the most of running status, but can't carry a release velocity
+	MIKMIDIFileWriterPendingNoteOff noteOff = {
+		.tick = endTick > tick ? endTick : tick,
+		.order = writer->nextNoteOffOrder++,
+		.status = (releaseVelocity ? 0x80 : 0x90) | (channel & 0x0F),
+		.note = note & 0x7F,
+		.velocity = releaseVelocity & 0x7F,
+	};
+	if (!MIKMIDIFileWriterPushNoteOff(writer, noteOff)) writer->result = MIKMIDIFileResultInvalidArgument;
+	return writer->result;
+}
+
+MIKMIDIFileResult MIKMIDIFileWriterWriteMetaEvent(MIKMIDIFileWriter *writer, uint64_t tick, uint8_t metaType, const uint8_t *payload, uint32_t payloadLength)
+{
+	if (metaType == MIKMIDIFileMetaTypeEndOfTrack) return writer->result;
+	if (payloadLength && !payload) return (writer->result = MIKMIDIFileResultInvalidArgument);
+	if (!MIKMIDIFileWriterPrepareForEvent(writer, tick)) return writer->result;
+
+	MIKMIDIFileWriterAppendDeltaTime(writer, tick);
+	uint8_t bytes[6] = {0xFF, metaType};
+	size_t length = MIKMIDIFileWriteVariableLengthQuantity(payloadLength, bytes + 2);
+	if (!length) return (writer->result = MIKMIDIFileResultInvalidArgument);
+	MIKMIDIFileWriterAppend(writer, bytes, 2 + length);
+	MIKMIDIFileWriterAppend(writer, payload, payloadLength);
+
+	// Meta and system exclusive events cancel running status
+	writer->runningStatus = 0;
+	return writer->result;
+}
+
+MIKMIDIFileResult MIKMIDIFileWriterWriteSystemExclusiveEvent(MIKMIDIFileWriter *writer, uint64_t tick, uint8_t status, const uint8_t *payload, uint32_t payloadLength)
+{
+	if ((status != 0xF0 && status != 0xF7) || (payloadLength && !payload)) return (writer->result = MIKMIDIFileResultInvalidArgument);
+	if (!MIKMIDIFileWriterPrepareForEvent(writer, tick)) return writer->result;
+
+	MIKMIDIFileWriterAppendDeltaTime(writer, tick);
+	uint8_t bytes[5] = {status};
+	size_t length = MIKMIDIFileWriteVariableLengthQuantity(payloadLength, bytes + 1);
+	if (!length) return (writer->result = MIKMIDIFileResultInvalidArgument);
+	MIKMIDIFileWriterAppend(writer, bytes, 1 + length);
+	MIKMIDIFileWriterAppend(writer, payload, payloadLength);
+
+	writer->runningStatus = 0;
+	return writer->result;
+}
+
+MIKMIDIFileResult MIKMIDIFileWriterEndTrack(MIKMIDIFileWriter *writer, uint32_t *length)
+{
+	if (writer->result != MIKMIDIFileResultOK) return writer->result;
+	if (!writer->inTrack) return (writer->result = MIKMIDIFileResultInvalidArgument);
+
+	MIKMIDIFileWriterWritePendingNoteOffs(writer, UINT64_MAX);
+	MIKMIDIFileWriterAppendDeltaTime(writer, writer->tick);
+	const uint8_t endOfTrack[] = {0xFF, MIKMIDIFileMetaTypeEndOfTrack, 0x00};
+	MIKMIDIFileWriterAppend(writer, endOfTrack, sizeof(endOfTrack));
+	if (writer->result != MIKMIDIFileResultOK) return writer->result;
+
+	uint64_t trackLength = writer->offset - writer->trackStartOffset;
+	if (trackLength > UINT32_MAX - 1) return (writer->result = MIKMIDIFileResultInvalidArgument);
+
+	if (writer->expectedTrackLength == MIKMIDIFileWriterUnknownTrackLength) {
+		uint8_t bytes[4];
+		MIKMIDIFileWriteUInt32((uint32_t)trackLength, bytes);
+		MIKMIDIFileWriterOverwrite(writer, writer->trackStartOffset - 4, bytes, sizeof(bytes));
+	} else if (writer->expectedTrackLength != trackLength) {
+		writer->result = MIKMIDIFileResultInvalidArgument;
+	}
+
+	writer->inTrack = 0;
+	if (length && writer->result == MIKMIDIFileResultOK) *length = (uint32_t)trackLength;
+	return writer->result;
+}
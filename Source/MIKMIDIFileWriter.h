@@ -0,0 +1,181 @@
+//
+//  MIKMIDIFileWriter.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#ifndef MIKMIDIFileWriter_h
+#define MIKMIDIFileWriter_h
+
+#include "MIKMIDIFileParser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  A small, portable, streaming writer for Standard MIDI Files (SMF). The counterpart
+ *  of the reader in MIKMIDIFileParser.h.
+ *
+ *  Output is passed to a write function in chunks of at most MIKMIDIFileWriterBufferSize
+ *  bytes, so the memory used does not depend on the size of the file being written.
+ *  Channel events are written using running status, and note offs are written as
+ *  note ons with a velocity of 0 where that doesn't lose the release velocity.
+ *
+ *  Like MIKMIDIFileParser.h, this file has no dependency on Foundation, CoreMIDI or AudioToolbox.
+ */
+
+/**
+ *  The number of bytes the writer buffers before passing them on to its write function.
+ */
+#define MIKMIDIFileWriterBufferSize 4096
+
+/**
+ *  Pass to MIKMIDIFileWriterBeginTrack() when the length of the track isn't known in advance.
+ *  The chunk's length is then filled in by MIKMIDIFileWriterEndTrack().
+ */
+#define MIKMIDIFileWriterUnknownTrackLength UINT32_MAX
+
+/**
+ *  Called with bytes to be appended to the output.
+ *
+ *  @return MIKMIDIFileResultOK, or an error code, which MIKMIDIFileWriter returns from then on.
+ */
+typedef MIKMIDIFileResult (*MIKMIDIFileWriterWriteFunction)(void *context, const uint8_t *bytes, size_t length);
+
+/**
+ *  Called to overwrite bytes that were previously passed to the write function, at offset from the start of the output.
+ *
+ *  @return MIKMIDIFileResultOK, or an error code, which MIKMIDIFileWriter returns from then on.
+ */
+typedef MIKMIDIFileResult (*MIKMIDIFileWriterPatchFunction)(void *context, uint64_t offset, const uint8_t *bytes, size_t length);
+
+/**
+ *  A note off waiting to be written, once the writer reaches its time.
+ */
+typedef struct {
+	uint64_t tick;
+	uint64_t order;
+	uint8_t status;
+	uint8_t note;
+	uint8_t velocity;
+} MIKMIDIFileWriterPendingNoteOff;
+
+/**
+ *  The state of a file being written. Treat the contents as private.
+ */
+typedef struct {
+	MIKMIDIFileWriterWriteFunction write;
+	MIKMIDIFileWriterPatchFunction patch;
+	void *context;
+	MIKMIDIFileResult result;
+
+	uint8_t buffer[MIKMIDIFileWriterBufferSize];
+	size_t bufferLength;
+	/** The number of bytes output so far, including those still in buffer. */
+	uint64_t offset;
+
+	int inTrack;
+	uint64_t trackStartOffset;
+	uint32_t expectedTrackLength;
+	uint64_t tick;
+	uint8_t runningStatus;
+
+	/** Min-heap of note offs, ordered by tick, then by the order the notes were written in. */
+	MIKMIDIFileWriterPendingNoteOff *pendingNoteOffs;
+	size_t pendingNoteOffCount;
+	size_t pendingNoteOffCapacity;
+	uint64_t nextNoteOffOrder;
+} MIKMIDIFileWriter;
+
+/**
+ *  Prepares writer for use. Call MIKMIDIFileWriterDestroy() when finished with it.
+ *
+ *  @param writer  The writer to initialize.
+ *  @param write   The function to pass output to.
+ *  @param patch   The function used to fill in the length of tracks written with MIKMIDIFileWriterUnknownTrackLength,
+ *                 when the start of the track has already been passed to write. May be NULL, in which case
+ *                 tracks whose length isn't known in advance must fit in MIKMIDIFileWriterBufferSize bytes.
+ *  @param context Passed to write and patch.
+ */
+void MIKMIDIFileWriterInit(MIKMIDIFileWriter *writer, MIKMIDIFileWriterWriteFunction write, MIKMIDIFileWriterPatchFunction patch, void *context);
+
+/**
+ *  Frees the memory used by writer. Does not flush buffered output.
+ */
+void MIKMIDIFileWriterDestroy(MIKMIDIFileWriter *writer);
+
+/**
+ *  Writes the MThd chunk. This must be the first thing written to a file.
+ */
+MIKMIDIFileResult MIKMIDIFileWriterWriteHeader(MIKMIDIFileWriter *writer, const MIKMIDIFileHeader *header);
+
+/**
+ *  Starts a new MTrk chunk.
+ *
+ *  @param writer The writer.
+ *  @param length The length of the chunk's data, or MIKMIDIFileWriterUnknownTrackLength.
+ *                If a length is given, MIKMIDIFileWriterEndTrack() fails if the track's actual length differs.
+ */
+MIKMIDIFileResult MIKMIDIFileWriterBeginTrack(MIKMIDIFileWriter *writer, uint32_t length);
+
+/**
+ *  Writes a channel message. Events in a track must be written in order of increasing tick.
+ *  Note on and note off messages written this way aren't paired up by the writer. Use
+ *  MIKMIDIFileWriterWriteNote() to write a note as a whole.
+ */
+MIKMIDIFileResult MIKMIDIFileWriterWriteChannelEvent(MIKMIDIFileWriter *writer, uint64_t tick, uint8_t status, uint8_t data1, uint8_t data2);
+
+/**
+ *  Writes a note on at tick, and its note off at endTick. The note off is written once the
+ *  writer reaches endTick, before any other event at that tick.
+ *
+ *  velocity is written as given. A note with a velocity of 0 can't be played, and readers, including
+ *  MIKMIDIFileParser, take a note on with a velocity of 0 for a note off, so such a note is written
+ *  as a single note off (0x8n) at tick instead, and endTick is ignored.
+ */
+MIKMIDIFileResult MIKMIDIFileWriterWriteNote(MIKMIDIFileWriter *writer, uint64_t tick, uint64_t endTick, uint8_t channel, uint8_t note, uint8_t velocity, uint8_t releaseVelocity);
+
+/**
+ *  Writes a meta event. End of Track events are written by MIKMIDIFileWriterEndTrack(), and are ignored here.
+ */
+MIKMIDIFileResult MIKMIDIFileWriterWriteMetaEvent(MIKMIDIFileWriter *writer, uint64_t tick, uint8_t metaType, const uint8_t *payload, uint32_t payloadLength);
+
+/**
+ *  Writes a system exclusive event.
+ *
+ *  @param status  0xF0 for a complete message or its first packet, 0xF7 for continuation packets and escapes.
+ *  @param payload The bytes following status, including the terminating 0xF7, if any.
+ */
+MIKMIDIFileResult MIKMIDIFileWriterWriteSystemExclusiveEvent(MIKMIDIFileWriter *writer, uint64_t tick, uint8_t status, const uint8_t *payload, uint32_t payloadLength);
+
+/**
+ *  Writes any remaining note offs and an End of Track event, and fills in the track's length.
+ *
+ *  @param writer The writer.
+ *  @param length On success, the length of the chunk's data. May be NULL.
+ */
+MIKMIDIFileResult MIKMIDIFileWriterEndTrack(MIKMIDIFileWriter *writer, uint32_t *length);
+
+/**
+ *  Passes any buffered output to the write function.
+ */
+MIKMIDIFileResult MIKMIDIFileWriterFlush(MIKMIDIFileWriter *writer);
+
+/**
+ *  Encodes value as a variable-length quantity.
+ *
+ *  @param value  The value to encode. Must be at most 0x0FFFFFFF.
+ *  @param bytes  A buffer of at least 4 bytes.
+ *
+ *  @return The number of bytes used, or 0 if value is too large.
+ */
+size_t MIKMIDIFileWriteVariableLengthQuantity(uint32_t value, uint8_t *bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MIKMIDIFileWriter_h */
@@ -0,0 +1,31 @@
+//
+//  MIKMIDIHostTimeSource.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "MIKMIDITimeSource.h"
+#import "MIKMIDICompilerCompatibility.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  MIKMIDIHostTimeSource is a time source that follows the system's monotonic host clock,
+ *  the same clock MIKMIDIGetCurrentTimeStamp() and CoreMIDI use. It's the default time source
+ *  for every object that has one.
+ */
+@interface MIKMIDIHostTimeSource : NSObject <MIKMIDITimeSource>
+
+/**
+ *  The shared host time source. MIKMIDIHostTimeSource has no state, so there's no need for another.
+ *
+ *  @return The shared host time source.
+ */
++ (instancetype)hostTimeSource;
+
+@end
+
+NS_ASSUME_NONNULL_END
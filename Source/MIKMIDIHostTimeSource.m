@@ -0,0 +1,43 @@
+//
+//  MIKMIDIHostTimeSource.m
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIHostTimeSource.h"
+#import "MIKMIDIUtilities.h"
+#import "MIKMIDIClock.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDIHostTimeSource.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIHostTimeSource.m in the Build Phases for this target
+#endif
+
+@implementation MIKMIDIHostTimeSource
+
++ (instancetype)hostTimeSource
+{
+	static MIKMIDIHostTimeSource *hostTimeSource = nil;
+	static dispatch_once_t onceToken;
+	dispatch_once(&onceToken, ^{
+		hostTimeSource = [[self alloc] init];
+	});
+	return hostTimeSource;
+}
+
+- (MIDITimeStamp)currentMIDITimeStamp
+{
+	return MIKMIDIGetCurrentTimeStamp();
+}
+
+- (void)dispatchAtMIDITimeStamp:(MIDITimeStamp)midiTimeStamp queue:(dispatch_queue_t)queue block:(dispatch_block_t)block
+{
+	MIDITimeStamp now = MIKMIDIGetCurrentTimeStamp();
+	if (midiTimeStamp <= now) return dispatch_async(queue, block);
+
+	int64_t nanoseconds = (int64_t)((midiTimeStamp - now) * MIKMIDIClockSecondsPerMIDITimeStamp() * NSEC_PER_SEC);
+	dispatch_after(dispatch_time(DISPATCH_TIME_NOW, nanoseconds), queue, block);
+}
+
+@end
@@ -0,0 +1,130 @@
+//
+//  MIKMIDIInputFilter.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDICommand;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Bit mask values for the kinds of MIDI messages an MIKMIDIInputFilter lets through.
+ */
+typedef NS_OPTIONS(NSUInteger, MIKMIDIMessageTypeMask) {
+	MIKMIDIMessageTypeMaskNoteOff = 1 << 0,
+	MIKMIDIMessageTypeMaskNoteOn = 1 << 1,
+	MIKMIDIMessageTypeMaskPolyphonicKeyPressure = 1 << 2,
+	/** Includes 14-bit control changes, and RPN and NRPN parameter changes. */
+	MIKMIDIMessageTypeMaskControlChange = 1 << 3,
+	MIKMIDIMessageTypeMaskProgramChange = 1 << 4,
+	MIKMIDIMessageTypeMaskChannelPressure = 1 << 5,
+	MIKMIDIMessageTypeMaskPitchWheelChange = 1 << 6,
+	MIKMIDIMessageTypeMaskSystemExclusive = 1 << 7,
+	/** MIDI time code quarter frame, song position pointer, song select and tune request messages. */
+	MIKMIDIMessageTypeMaskSystemCommon = 1 << 8,
+	MIKMIDIMessageTypeMaskTimingClock = 1 << 9,
+	/** Start, continue and stop messages. */
+	MIKMIDIMessageTypeMaskTransport = 1 << 10,
+	MIKMIDIMessageTypeMaskActiveSensing = 1 << 11,
+	MIKMIDIMessageTypeMaskSystemReset = 1 << 12,
+	/** Messages with the undefined status bytes 0xF4, 0xF5, 0xF9 and 0xFD. */
+	MIKMIDIMessageTypeMaskUndefined = 1 << 13,
+
+	MIKMIDIMessageTypeMaskChannelVoice = MIKMIDIMessageTypeMaskNoteOff | MIKMIDIMessageTypeMaskNoteOn | MIKMIDIMessageTypeMaskPolyphonicKeyPressure |
+										 MIKMIDIMessageTypeMaskControlChange | MIKMIDIMessageTypeMaskProgramChange |
+										 MIKMIDIMessageTypeMaskChannelPressure | MIKMIDIMessageTypeMaskPitchWheelChange,
+	MIKMIDIMessageTypeMaskSystemRealTime = MIKMIDIMessageTypeMaskTimingClock | MIKMIDIMessageTypeMaskTransport |
+										   MIKMIDIMessageTypeMaskActiveSensing | MIKMIDIMessageTypeMaskSystemReset,
+	MIKMIDIMessageTypeMaskAll = MIKMIDIMessageTypeMaskChannelVoice | MIKMIDIMessageTypeMaskSystemExclusive |
+								MIKMIDIMessageTypeMaskSystemCommon | MIKMIDIMessageTypeMaskSystemRealTime | MIKMIDIMessageTypeMaskUndefined,
+};
+
+/**
+ *  MIKMIDIInputFilter describes which incoming MIDI messages are passed to an event handler.
+ *
+ *  Pass a filter to -[MIKMIDIDeviceManager connectInput:deliveryMode:filter:error:eventHandler:] (or
+ *  -connectDevice:deliveryMode:filter:error:eventHandler:). Filters are applied to messages' raw bytes
+ *  as they are received, before MIKMIDICommand objects are created for them, so messages that are
+ *  filtered out cost almost nothing. If nothing in a packet list gets through, the event handler
+ *  isn't called at all.
+ *
+ *  A message must pass every test to get through. The default filter lets everything through.
+ *
+ *  Filters are copied when a connection is made, so changing a filter afterwards doesn't affect
+ *  existing connections, and each connection counts messages for decimation separately.
+ */
+@interface MIKMIDIInputFilter : NSObject <NSCopying>
+
+/**
+ *  Convenience method for creating a filter that lets through messages of the given types.
+ *
+ *  @param messageTypes The kinds of messages to let through.
+ *
+ *  @return An initialized MIKMIDIInputFilter.
+ */
++ (instancetype)filterWithMessageTypes:(MIKMIDIMessageTypeMask)messageTypes;
+
+/**
+ *  The kinds of messages to let through. The default is MIKMIDIMessageTypeMaskAll.
+ */
+@property (nonatomic) MIKMIDIMessageTypeMask messageTypes;
+
+/**
+ *  The channels to let channel voice messages through on. Bit n is set to let through channel n (0-15).
+ *  The default is 0xFFFF, all channels.
+ */
+@property (nonatomic) UInt16 channelMask;
+
+/**
+ *  The notes to let note on, note off and polyphonic key pressure messages through for.
+ *  The default is {0, 128}, all notes.
+ */
+@property (nonatomic) NSRange noteRange;
+
+/**
+ *  The controller numbers to let control changes through for. For a 14-bit control change,
+ *  this is the MSB's controller number. RPN and NRPN parameter changes aren't tested against this.
+ *  The default is {0, 128}, all controllers.
+ */
+@property (nonatomic) NSRange controllerRange;
+
+/**
+ *  Lets through only one of every factor messages of the given types, for thinning out
+ *  floods of messages like clock ticks, aftertouch, or pitch bends. Messages are counted
+ *  separately for each type, after the other tests have been applied, and the first one is
+ *  always let through. A factor of 0 or 1 lets every message through, which is the default.
+ *
+ *  @param factor       The decimation factor.
+ *  @param messageTypes The kinds of messages to decimate.
+ */
+- (void)setDecimationFactor:(NSUInteger)factor forMessageTypes:(MIKMIDIMessageTypeMask)messageTypes;
+
+/**
+ *  Returns the decimation factor for a kind of messages.
+ *
+ *  @param messageType A single MIKMIDIMessageTypeMask value.
+ *
+ *  @return The decimation factor set with -setDecimationFactor:forMessageTypes:, or 1.
+ */
+- (NSUInteger)decimationFactorForMessageType:(MIKMIDIMessageTypeMask)messageType;
+
+/**
+ *  Returns the commands that get through the filter. This is used by MIKMIDIInputPort, and
+ *  counts the commands for decimation. Commands received by MIKMIDIInputPort that haven't been
+ *  created yet are tested without creating them.
+ *
+ *  @param commands An array of MIKMIDICommand instances.
+ *
+ *  @return The commands that got through, in the same order. May be commands itself.
+ */
+- (MIKArrayOf(MIKMIDICommand *) *)filteredCommands:(MIKArrayOf(MIKMIDICommand *) *)commands;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,143 @@
+//
+//  MIKMIDIInputFilter.m
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIInputFilter.h"
+#import "MIKMIDICommand.h"
+#import "MIKMIDIDeferredCommandArray.h"
+#include <stdatomic.h>
+
+#if !__has_feature(objc_arc)
+#error MIKMIDIInputFilter.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIInputFilter.m in the Build Phases for this target
+#endif
+
+#define kMIKMIDIInputFilterNumberOfMessageTypes	14
+
+// Returns the bit number of the status byte's MIKMIDIMessageTypeMask value, or -1 if it isn't a status byte
+static NSInteger MIKMIDIInputFilterMessageTypeIndexForStatus(UInt8 status)
+{
+	if (status < 0x80) return -1;
+	if (status < 0xF0) return (status >> 4) - 8; // Channel voice messages are in status byte order
+	switch (status) {
+		case 0xF0: return 7;
+		case 0xF8: return 9;
+		case 0xFA:
+		case 0xFB:
+		case 0xFC: return 10;
+		case 0xFE: return 11;
+		case 0xFF: return 12;
+		case 0xF4:
+		case 0xF5:
+		case 0xF9:
+		case 0xFD: return 13; // Undefined
+		default: return 8; // System common
+	}
+}
+
+@implementation MIKMIDIInputFilter
+{
+	NSUInteger _decimationFactors[kMIKMIDIInputFilterNumberOfMessageTypes];
+	atomic_uint_fast32_t _decimationCounters[kMIKMIDIInputFilterNumberOfMessageTypes];
+}
+
++ (instancetype)filterWithMessageTypes:(MIKMIDIMessageTypeMask)messageTypes
+{
+	MIKMIDIInputFilter *filter = [[self alloc] init];
+	filter.messageTypes = messageTypes;
+	return filter;
+}
+
+- (instancetype)init
+{
+	self = [super init];
+	if (self) {
+		_messageTypes = MIKMIDIMessageTypeMaskAll;
+		_channelMask = 0xFFFF;
+		_noteRange = NSMakeRange(0, 128);
+		_controllerRange = NSMakeRange(0, 128);
+		for (NSUInteger i = 0; i < kMIKMIDIInputFilterNumberOfMessageTypes; i++) {
+			_decimationFactors[i] = 1;
+			atomic_init(&_decimationCounters[i], 0);
+		}
+	}
+	return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+	MIKMIDIInputFilter *result = [[[self class] alloc] init];
+	result.messageTypes = self.messageTypes;
+	result.channelMask = self.channelMask;
+	result.noteRange = self.noteRange;
+	result.controllerRange = self.controllerRange;
+	memcpy(result->_decimationFactors, _decimationFactors, sizeof(_decimationFactors));
+	return result;
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"%@ message types: 0x%lx channels: 0x%x notes: %@ controllers: %@", [super description],
+			(unsigned long)self.messageTypes, self.channelMask, NSStringFromRange(self.noteRange), NSStringFromRange(self.controllerRange)];
+}
+
+#pragma mark - Public
+
+- (void)setDecimationFactor:(NSUInteger)factor forMessageTypes:(MIKMIDIMessageTypeMask)messageTypes
+{
+	for (NSUInteger i = 0; i < kMIKMIDIInputFilterNumberOfMessageTypes; i++) {
+		if (messageTypes & ((MIKMIDIMessageTypeMask)1 << i)) _decimationFactors[i] = MAX(factor, 1);
+	}
+}
+
+- (NSUInteger)decimationFactorForMessageType:(MIKMIDIMessageTypeMask)messageType
+{
+	for (NSUInteger i = 0; i < kMIKMIDIInputFilterNumberOfMessageTypes; i++) {
+		if (messageType & ((MIKMIDIMessageTypeMask)1 << i)) return _decimationFactors[i];
+	}
+	return 1;
+}
+
+- (NSArray *)filteredCommands:(NSArray *)commands
+{
+	if ([commands isKindOfClass:[MIKMIDIDeferredCommandArray class]]) {
+		return [(MIKMIDIDeferredCommandArray *)commands arrayWithRecordsPassingTest:^BOOL(const MIKMIDICommandRecord *record) {
+			return [self passesMessageWithBytes:record->bytes length:record->length];
+		}];
+	}
+
+	NSIndexSet *passingIndexes = [commands indexesOfObjectsPassingTest:^BOOL(MIKMIDICommand *command, NSUInteger idx, BOOL *stop) {
+		NSData *data = command.data;
+		return [data length] && [self passesMessageWithBytes:[data bytes] length:[data length]];
+	}];
+	if ([passingIndexes count] == [commands count]) return commands;
+	return [commands objectsAtIndexes:passingIndexes];
+}
+
+#pragma mark - Private
+
+// bytes is a message's bytes, or a record's. For records of system exclusive messages, length is 0.
+- (BOOL)passesMessageWithBytes:(const UInt8 *)bytes length:(NSUInteger)length
+{
+	UInt8 status = bytes[0];
+	NSInteger typeIndex = MIKMIDIInputFilterMessageTypeIndexForStatus(status);
+	if (typeIndex < 0 || !(_messageTypes & ((MIKMIDIMessageTypeMask)1 << typeIndex))) return NO;
+
+	if (status < 0xF0) {
+		if (!(_channelMask & (1 << (status & 0x0F)))) return NO;
+		UInt8 kind = status & 0xF0;
+		BOOL isNoteMessage = (kind == 0x80 || kind == 0x90 || kind == 0xA0);
+		if (isNoteMessage && length > 1 && !NSLocationInRange(bytes[1], _noteRange)) return NO;
+		// Longer control changes are RPN and NRPN parameter changes, whose first controller is just the parameter number MSB
+		if (kind == 0xB0 && length > 1 && length <= 4 && !NSLocationInRange(bytes[1], _controllerRange)) return NO;
+	}
+
+	NSUInteger factor = _decimationFactors[typeIndex];
+	if (factor <= 1) return YES;
+	return (atomic_fetch_add(&_decimationCounters[typeIndex], 1) % factor) == 0;
+}
+
+@end
@@ -12,9 +12,34 @@
 
 @class MIKMIDIEndpoint;
 @class MIKMIDICommand;
+@class MIKMIDIInputFilter;
+@protocol MIKMIDITimeSource;
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ *  Describes where a fragment passed to an MIKMIDISystemExclusiveFragmentHandlerBlock falls in
+ *  its system exclusive message.
+ */
+typedef NS_OPTIONS(NSUInteger, MIKMIDISystemExclusiveFragmentFlags) {
+	/** The fragment is the start of a message, and begins with 0xF0. */
+	MIKMIDISystemExclusiveFragmentFlagStart = 1 << 0,
+	/** The fragment is the end of a message. It ends with 0xF7, unless the message was cut off by another status byte, or timed out. */
+	MIKMIDISystemExclusiveFragmentFlagEnd = 1 << 1,
+	/** Set along with MIKMIDISystemExclusiveFragmentFlagEnd when no more of the message was received within sysexTimeOut. The fragment is empty. */
+	MIKMIDISystemExclusiveFragmentFlagTimedOut = 1 << 2,
+};
+
+/**
+ *  A block to be called with parts of system exclusive messages as they are received.
+ *
+ *  @param source    The source the fragment was received from, or nil if it isn't known.
+ *  @param fragment  The fragment's bytes. Real time messages received in the middle of a system exclusive message aren't included.
+ *  @param timeStamp The time stamp of the packet the fragment was received in.
+ *  @param flags     Where the fragment falls in its message.
+ */
+typedef void(^MIKMIDISystemExclusiveFragmentHandlerBlock)(MIKMIDISourceEndpoint * _Nullable source, NSData *fragment, MIDITimeStamp timeStamp, MIKMIDISystemExclusiveFragmentFlags flags);
+
 /**
  *  MIKMIDIInputPort is an Objective-C wrapper for CoreMIDI's MIDIPort class, and is only for source ports.
  *  It is not intended for use by clients/users of of MIKMIDI. Rather, it should be thought of as an
@@ -25,12 +50,44 @@ NS_ASSUME_NONNULL_BEGIN
 - (id _Nullable)connectToSource:(MIKMIDISourceEndpoint *)source
 						  error:(NSError **)error
 				   eventHandler:(MIKMIDIEventHandlerBlock)eventHandler;
+- (id _Nullable)connectToSource:(MIKMIDISourceEndpoint *)source
+				   deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode
+						  error:(NSError **)error
+				   eventHandler:(MIKMIDIEventHandlerBlock)eventHandler;
+- (id _Nullable)connectToSource:(MIKMIDISourceEndpoint *)source
+				   deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode
+						 filter:(nullable MIKMIDIInputFilter *)filter
+						  error:(NSError **)error
+				   eventHandler:(MIKMIDIEventHandlerBlock)eventHandler;
 - (void)disconnectConnectionForToken:(id)token;
 
 @property (nonatomic, strong, readonly) MIKArrayOf(MIKMIDIEndpoint *) *connectedSources;
 
 @property (nonatomic) BOOL coalesces14BitControlChangeCommands; // Default is YES
 
+/**
+ *  How long a control change that may be the MSB of a 14-bit control change is held back, waiting
+ *  for its LSB, before it is delivered on its own. MSBs and LSBs are paired separately for each
+ *  source and channel, so commands from other sources or on other channels can come between them.
+ *  If any other command comes on the MSB's channel first, the MSB is delivered on its own right away,
+ *  ahead of that command, so commands on a channel are always delivered in the order they came.
+ *  The default is 0.004 (4 ms).
+ */
+@property (atomic) NSTimeInterval fourteenBitControlChangeCoalescingWindow;
+
+/**
+ *  If YES, Registered (RPN) and Non-Registered (NRPN) Parameter Number control change sequences are
+ *  assembled into MIKMIDIParameterChangeCommands, one for each data entry, increment or decrement,
+ *  instead of being delivered as separate control changes. The parameter number control changes
+ *  themselves (99, 98, 101 and 100) are not delivered. Parameter selections are kept separately for
+ *  each source and channel. Data entry, increment and decrement control changes received when no
+ *  parameter is selected are delivered as they are.
+ *
+ *  When coalesces14BitControlChangeCommands is also YES, a data entry MSB and LSB become a single
+ *  parameter change with a 14-bit value. The default is NO.
+ */
+@property (nonatomic) BOOL coalescesParameterNumberCommands;
+
 /**
  * Time before sysex transmissions are considered over.
  *
@@ -39,6 +96,29 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (assign) NSTimeInterval sysexTimeOut;
 
+/**
+ *  If set, system exclusive messages are streamed to this block a fragment at a time, as they are
+ *  received, instead of being collected into MIKMIDISystemExclusiveCommands for event handlers.
+ *  Only the fragment being delivered is kept in memory, so this is the way to receive dumps too
+ *  large to hold at once. The block is called on the thread MIDI is received on, which is usually
+ *  CoreMIDI's high priority read thread, or on an internal queue for time-outs, and should return quickly.
+ */
+@property (atomic, copy, nullable) MIKMIDISystemExclusiveFragmentHandlerBlock systemExclusiveFragmentHandler;
+
+/**
+ *  The largest system exclusive message, in bytes, that will be collected into an
+ *  MIKMIDISystemExclusiveCommand. Longer messages are discarded as soon as they pass this length,
+ *  so a misbehaving device can't make the port hold an unbounded amount of memory. Has no effect
+ *  on fragments passed to systemExclusiveFragmentHandler. 0, the default, means no limit.
+ */
+@property (atomic) NSUInteger maximumSystemExclusiveLength;
+
+/**
+ *  The time source used to time out system exclusive messages and unpaired 14-bit control change
+ *  MSBs. The default is +[MIKMIDIHostTimeSource hostTimeSource].
+ */
+@property (nonatomic, strong) id<MIKMIDITimeSource> timeSource;
+
 @end
 
 NS_ASSUME_NONNULL_END
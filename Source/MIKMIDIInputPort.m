@@ -13,39 +13,100 @@
 #import "MIKMIDISourceEndpoint.h"
 #import "MIKMIDICommand.h"
 #import "MIKMIDISystemExclusiveCommand.h"
-#import "MIKMIDIControlChangeCommand.h"
+#import "MIKMIDIParameterChangeCommand.h"
 #import "MIKMIDIUtilities.h"
+#import "MIKMIDIClock.h"
+#import "MIKMIDIHostTimeSource.h"
+#import "MIKMIDIMessageParser.h"
+#import "MIKMIDIDeferredCommandArray.h"
+#import "MIKMIDIInputFilter.h"
+#include <stdatomic.h>
 
 #if !__has_feature(objc_arc)
 #error MIKMIDIInputPort.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIInputPort.m in the Build Phases for this target
 #endif
 
+#define kMIKMIDIInputPortParsedMessageBufferSize	64
+#define kMIKMIDIInputPortNumberOfChannels	16
+#define kMIKMIDIInputPortNumberOf14BitControllers	32
+#define kMIKMIDIInputPortUnknownValue	0x80
+
+// The Registered or Non-Registered Parameter Number selected on a channel. Values are kMIKMIDIInputPortUnknownValue until received.
+typedef struct {
+	UInt8 registeredNumber[2]; // MSB, LSB
+	UInt8 nonRegisteredNumber[2];
+	UInt8 selectedType; // MIKMIDIParameterType of the last number received, or kMIKMIDIInputPortUnknownValue if none is selected
+	UInt8 dataEntryMSB; // Of the last data entry for the selected parameter, for a data entry LSB on its own
+} MIKMIDIInputPortParameterSelection;
+
 @interface MIKMIDIConnectionTokenAndEventHandler : NSObject
 
-- (instancetype)initWithConnectionToken:(NSString *)token eventHandler:(MIKMIDIEventHandlerBlock)eventHandler;
+- (instancetype)initWithConnectionToken:(NSString *)token deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode filter:(MIKMIDIInputFilter *)filter eventHandler:(MIKMIDIEventHandlerBlock)eventHandler;
+
+- (void)deliverCommands:(NSArray *)commands fromSource:(MIKMIDISourceEndpoint *)source deliveryQueue:(dispatch_queue_t)deliveryQueue;
 
 @property (nonatomic, strong, readonly) NSString *connectionToken;
+@property (nonatomic, readonly) MIKMIDIEventDeliveryMode deliveryMode;
+@property (nonatomic, strong, readonly) MIKMIDIInputFilter *filter;
 @property (nonatomic, strong, readonly) MIKMIDIEventHandlerBlock eventHandler;
 
 @end
 
+// Parsing and 14-bit control change pairing state for one connected source
+@interface MIKMIDIInputPortSourceState : NSObject
+
+- (instancetype)initWithSource:(MIKMIDISourceEndpoint *)source;
+
+- (NSUInteger)pair14BitControlChangeRecords:(MIKMIDICommandRecord *)records count:(NSUInteger)count deadline:(MIDITimeStamp)deadline;
+- (NSUInteger)assembleParameterChangeRecords:(MIKMIDICommandRecord *)records count:(NSUInteger)count;
+- (NSArray *)takeCommandsExpiringBy:(MIDITimeStamp)midiTimeStamp assemblingParameterChanges:(BOOL)assembleParameterChanges earliestRemainingDeadline:(MIDITimeStamp *)earliestRemainingDeadline;
+- (void)endSysex; // Call while synchronized on the state
+
+@property (nonatomic, strong, readonly) MIKMIDISourceEndpoint *source;
+@property (nonatomic, readonly) MIKMIDIMessageParser *parser;
+@property (nonatomic, readonly) BOOL hasPendingMSBs;
+@property (atomic, copy) void (^commandHandler)(NSArray <MIKMIDICommand*> *commands);
+
+// The system exclusive message being received. Guarded by @synchronized(self), except that isReceivingSysex
+// may be read without locking, to skip taking the lock when no message is being received.
+@property (nonatomic) BOOL isReceivingSysex;
+@property (nonatomic, strong) NSMutableData *sysexData; // nil when streaming the message, or discarding it
+@property (nonatomic) NSUInteger sysexLength;
+@property (nonatomic) MIDITimeStamp sysexStartTimeStamp;
+@property (nonatomic) MIDITimeStamp sysexTimeOutMIDITimeStamp;
+@property (nonatomic) BOOL isSysexTimeOutScheduled;
+
+@end
+
 @interface MIKMIDIInputPort ()
 
 @property (nonatomic, strong) NSMutableArray *internalSources;
 @property (nonatomic, strong) MIKMapTableOf(MIKMIDIEndpoint *, NSMutableArray *) *handlerTokenPairsByEndpoint;
+// An immutable copy of handlerTokenPairsByEndpoint, so incoming commands can be delivered without going through handlerTokenQueue
+@property (atomic, strong) MIKMapTableOf(MIKMIDIEndpoint *, NSArray *) *handlerTokenPairsSnapshot;
 @property (nonatomic) dispatch_queue_t handlerTokenQueue;
+@property (nonatomic) dispatch_queue_t eventDeliveryQueue;
 
-@property (nonatomic, strong) NSMutableArray *bufferedMSBCommands;
 @property (nonatomic) dispatch_queue_t bufferedCommandQueue;
 
-@property (atomic, strong) NSMutableData *sysexData;
-@property (atomic, strong) NSTimer *sysexTimeOutTimer;
-@property (assign) MIDITimeStamp sysexStartTimeStamp;
-@property (readonly) BOOL isCoalescingSysex;
-
 @end
 
 @implementation MIKMIDIInputPort
+{
+	// Parsing buffers. Only used by -interpretPacketList:sourceState:, which CoreMIDI never calls concurrently.
+	MIKMIDICommandRecord *_records;
+	NSUInteger _recordCount;
+	NSUInteger _recordCapacity;
+	NSMutableArray *_prebuiltCommands;
+	
+	// Guarded by @synchronized(_sourceStatesBySource). States are kept until the port is deallocated, even after their
+	// source is disconnected, because CoreMIDI may still be running a read callback that was passed one.
+	MIKMapTableOf(MIKMIDISourceEndpoint *, MIKMIDIInputPortSourceState *) *_sourceStatesBySource;
+	MIKMIDIInputPortSourceState *_unknownSourceState;
+	
+	// The time stamp of the earliest scheduled block to send 14-bit control change MSBs whose LSB never came, or 0 if none is.
+	atomic_uint_fast64_t _pendingMSBExpiryMIDITimeStamp;
+}
 
 - (instancetype)initWithClient:(MIDIClientRef)clientRef name:(NSString *)name
 {
@@ -64,23 +125,40 @@
 		_handlerTokenQueue = dispatch_queue_create("com.mixedinkey.MIKMIDI.com.mixedinkey.MIKMIDI.MIKMIDIInputPort.handlerTokenQueue", DISPATCH_QUEUE_SERIAL);
 		dispatch_sync(_handlerTokenQueue, ^{
 			self->_handlerTokenPairsByEndpoint = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsStrongMemory];
+			[self updateHandlerTokenPairsSnapshot];
 		});
 		
+		dispatch_queue_attr_t attr = DISPATCH_QUEUE_SERIAL;
+#if defined (__MAC_10_10) || defined (__IPHONE_8_0)
+		if (@available(macOS 10.10, iOS 8, *)) {
+			if (&dispatch_queue_attr_make_with_qos_class != NULL) {
+				attr = dispatch_queue_attr_make_with_qos_class(DISPATCH_QUEUE_SERIAL, QOS_CLASS_USER_INTERACTIVE, 0);
+			}
+		}
+#endif
+		_eventDeliveryQueue = dispatch_queue_create("com.mixedinkey.MIKMIDI.MIKMIDIInputPort.eventDeliveryQueue", attr);
+		
 		_internalSources = [[NSMutableArray alloc] init];
 		_coalesces14BitControlChangeCommands = YES;
 		
 		_bufferedCommandQueue = dispatch_queue_create("com.mixedinkey.MIKMIDI.MIKMIDIInputPort.bufferedCommandQueue", DISPATCH_QUEUE_SERIAL);
-		dispatch_sync(_bufferedCommandQueue, ^{ self.bufferedMSBCommands = [[NSMutableArray alloc] init]; });
+		
+		_sourceStatesBySource = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsStrongMemory];
+		atomic_init(&_pendingMSBExpiryMIDITimeStamp, 0);
+		_fourteenBitControlChangeCoalescingWindow = 0.004;
 		
 		_sysexTimeOut = 1.0; // seconds
+		_timeSource = [MIKMIDIHostTimeSource hostTimeSource];
 	}
 	return self;
 }
 
 - (void)dealloc
 {
+	free(_records);
 	MIKMIDI_GCD_RELEASE(_bufferedCommandQueue);
 	MIKMIDI_GCD_RELEASE(_handlerTokenQueue);
+	MIKMIDI_GCD_RELEASE(_eventDeliveryQueue);
 }
 
 #pragma mark - Public
@@ -88,6 +166,23 @@
 - (id)connectToSource:(MIKMIDISourceEndpoint *)source
 				error:(NSError **)error
 		 eventHandler:(MIKMIDIEventHandlerBlock)eventHandler
+{
+	return [self connectToSource:source deliveryMode:MIKMIDIEventDeliveryModeMainQueue error:error eventHandler:eventHandler];
+}
+
+- (id)connectToSource:(MIKMIDISourceEndpoint *)source
+		 deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode
+				error:(NSError **)error
+		 eventHandler:(MIKMIDIEventHandlerBlock)eventHandler
+{
+	return [self connectToSource:source deliveryMode:deliveryMode filter:nil error:error eventHandler:eventHandler];
+}
+
+- (id)connectToSource:(MIKMIDISourceEndpoint *)source
+		 deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode
+			   filter:(MIKMIDIInputFilter *)filter
+				error:(NSError **)error
+		 eventHandler:(MIKMIDIEventHandlerBlock)eventHandler
 {
 	error = error ?: &(NSError *__autoreleasing){ nil };
 	if (![self.connectedSources containsObject:source] &&
@@ -96,7 +191,7 @@
 	}
 	
 	NSString *uuidString = [self createNewConnectionToken];
-	[self addConnectionToken:uuidString andEventHandler:eventHandler forSource:source];
+	[self addConnectionToken:uuidString deliveryMode:deliveryMode filter:filter andEventHandler:eventHandler forSource:source];
 	return uuidString;
 }
 
@@ -125,7 +220,10 @@
 	if ([self.connectedSources containsObject:source]) return YES;
 	
 	error = error ? error : &(NSError *__autoreleasing){ nil };
-	OSStatus err = MIDIPortConnectSource(self.portRef, source.objectRef, (__bridge void *)source);
+	// The source's state is passed to the read callback, so it doesn't have to be looked up for every packet list.
+	// _sourceStatesBySource keeps it alive until the port is deallocated.
+	MIKMIDIInputPortSourceState *state = [self sourceStateForSource:source];
+	OSStatus err = MIDIPortConnectSource(self.portRef, source.objectRef, (__bridge void *)state);
 	if (err != noErr) {
 		*error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 		return NO;
@@ -138,6 +236,7 @@
 {
 	OSStatus err = MIDIPortDisconnectSource(self.portRef, source.objectRef);
 	if (err != noErr) NSLog(@"Error disconnecting MIDI source %@ from port %@", source, self);
+	// The source's state isn't removed. A read callback for it may still be running, and reconnecting reuses it.
 	[self removeInternalSourcesObject:source];
 }
 
@@ -167,28 +266,41 @@
 }
 
 - (void)addConnectionToken:(NSString *)connectionToken andEventHandler:(MIKMIDIEventHandlerBlock)eventHandler forSource:(MIKMIDISourceEndpoint *)source
+{
+	[self addConnectionToken:connectionToken deliveryMode:MIKMIDIEventDeliveryModeMainQueue andEventHandler:eventHandler forSource:source];
+}
+
+- (void)addConnectionToken:(NSString *)connectionToken deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode andEventHandler:(MIKMIDIEventHandlerBlock)eventHandler forSource:(MIKMIDISourceEndpoint *)source
+{
+	[self addConnectionToken:connectionToken deliveryMode:deliveryMode filter:nil andEventHandler:eventHandler forSource:source];
+}
+
+- (void)addConnectionToken:(NSString *)connectionToken deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode filter:(MIKMIDIInputFilter *)filter andEventHandler:(MIKMIDIEventHandlerBlock)eventHandler forSource:(MIKMIDISourceEndpoint *)source
 {
 	MIKMIDIConnectionTokenAndEventHandler *tokenHandlerPair =
-	[[MIKMIDIConnectionTokenAndEventHandler alloc] initWithConnectionToken:connectionToken eventHandler:eventHandler];
-	dispatch_async(self.handlerTokenQueue, ^{
+	[[MIKMIDIConnectionTokenAndEventHandler alloc] initWithConnectionToken:connectionToken deliveryMode:deliveryMode filter:filter eventHandler:eventHandler];
+	// Synchronous, so commands that arrive as soon as this returns go to the new handler
+	dispatch_sync(self.handlerTokenQueue, ^{
 		NSMutableArray *tokenPairs = [self.handlerTokenPairsByEndpoint objectForKey:source];
 		if (!tokenPairs) {
 			tokenPairs = [NSMutableArray array];
 			[self.handlerTokenPairsByEndpoint setObject:tokenPairs forKey:source];
 		}
 		[tokenPairs addObject:tokenHandlerPair];
+		[self updateHandlerTokenPairsSnapshot];
 	});
 }
 
 - (void)removeEventHandlerForConnectionToken:(NSString *)connectionToken source:(MIKMIDISourceEndpoint *)source
 {
-	dispatch_async(self.handlerTokenQueue, ^{
+	dispatch_sync(self.handlerTokenQueue, ^{
 		NSMutableArray *handlerPairs = [self.handlerTokenPairsByEndpoint objectForKey:source];
 		for (MIKMIDIConnectionTokenAndEventHandler *pair in [handlerPairs copy]) {
 			if ([pair.connectionToken isEqual:connectionToken]) {
 				[handlerPairs removeObject:pair];
 			}
 		}
+		[self updateHandlerTokenPairsSnapshot];
 	});
 }
 
@@ -209,103 +321,219 @@
 	return result;
 }
 
-#pragma mark Coaelescing
+// Must be called on handlerTokenQueue
+- (void)updateHandlerTokenPairsSnapshot
+{
+	NSMapTable *snapshot = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsStrongMemory];
+	for (MIKMIDIEndpoint *endpoint in self.handlerTokenPairsByEndpoint) {
+		NSArray *handlerPairs = [[self.handlerTokenPairsByEndpoint objectForKey:endpoint] copy];
+		if ([handlerPairs count]) [snapshot setObject:handlerPairs forKey:endpoint];
+	}
+	self.handlerTokenPairsSnapshot = snapshot;
+}
+
+#pragma mark Parsing
 
-- (BOOL)commandIsPossibleMSBOf14BitCommand:(MIKMIDICommand *)command
+// Parses bytes, adding records for the resulting commands to _records
+- (void)parseBytes:(const Byte *)bytes length:(NSUInteger)length timeStamp:(MIDITimeStamp)timeStamp sourceState:(MIKMIDIInputPortSourceState *)state
 {
-	if (command.commandType != MIKMIDICommandTypeControlChange) return NO;
-	
-	MIKMIDIControlChangeCommand *controlChange = (MIKMIDIControlChangeCommand *)command;
-	
-	if (controlChange.isFourteenBitCommand) return NO; // Already coalesced
-	return controlChange.controllerNumber < 32;
-}
-
-- (NSArray *)commandsByCoalescingCommands:(NSArray *)commands
-{
-	NSMutableArray *coalescedCommands = [commands mutableCopy];
-	MIKMIDICommand *lastCommand = commands.firstObject;
-	for (MIKMIDICommand *command in commands) {
-		MIKMIDIControlChangeCommand *coalesced =
-		[MIKMIDIControlChangeCommand commandByCoalescingMSBCommand:(MIKMIDIControlChangeCommand *)lastCommand
-													 andLSBCommand:(MIKMIDIControlChangeCommand *)command];
-		if (coalesced) {
-			[coalescedCommands removeObject:command];
-			NSUInteger lastCommandIndex = [coalescedCommands indexOfObject:lastCommand];
-			[coalescedCommands replaceObjectAtIndex:lastCommandIndex withObject:coalesced];
+	MIKMIDIMessageParser *parser = state.parser;
+	MIKMIDIParsedMessage messages[kMIKMIDIInputPortParsedMessageBufferSize];
+	while (length) {
+		size_t bytesConsumed = 0;
+		size_t count = MIKMIDIMessageParserParse(parser, bytes, length, timeStamp, messages, kMIKMIDIInputPortParsedMessageBufferSize, &bytesConsumed);
+		for (size_t i = 0; i < count; i++) {
+			const MIKMIDIParsedMessage *message = &messages[i];
+			if (message->kind == MIKMIDIParsedMessageKindSystemExclusiveFragment) {
+				[self coalesceSysexFragment:message sourceState:state];
+				continue;
+			}
+			MIKMIDICommandRecord *record = [self addRecord];
+			record->timeStamp = message->timeStamp;
+			record->bytes[0] = message->status;
+			record->bytes[1] = message->data1;
+			record->bytes[2] = message->data2;
+			record->length = message->length;
 		}
-		lastCommand = command;
+		bytes += bytesConsumed;
+		length -= bytesConsumed;
 	}
-	return [coalescedCommands copy];
 }
 
-- (BOOL)coalesceSysexFromMIDIPacket:(const MIDIPacket *)packet toCommandInArray:(NSMutableArray **)commandsArray
-{	
-	const Byte *data = packet->data;
-	
-	Byte firstByte = data[0];
+- (void)reserveRecordCapacity:(NSUInteger)capacity
+{
+	if (capacity <= _recordCapacity) return;
+	// Kept between packet lists, so once it's big enough it's never reallocated
+	_recordCapacity = MAX(MAX(2 * _recordCapacity, 64), capacity);
+	_records = realloc(_records, _recordCapacity * sizeof(MIKMIDICommandRecord));
+}
+
+- (MIKMIDICommandRecord *)addRecord
+{
+	[self reserveRecordCapacity:_recordCount + 1];
+	MIKMIDICommandRecord *record = &_records[_recordCount++];
+	memset(record, 0, sizeof(*record));
+	return record;
+}
+
+// Returns the commands parsed so far, and starts over
+- (NSArray *)takeParsedCommands
+{
+	NSArray *result = [[MIKMIDIDeferredCommandArray alloc] initWithRecords:_records count:_recordCount prebuiltCommands:_prebuiltCommands];
+	_recordCount = 0;
+	_prebuiltCommands = nil;
+	return result;
+}
+
+#pragma mark Coalescing
+
+// Sends 14-bit control change MSBs whose LSB hasn't come within the coalescing window as they are.
+// scheduledMIDITimeStamp is the time stamp the calling block was scheduled for.
+- (void)sendExpiredMSBsScheduledAtMIDITimeStamp:(MIDITimeStamp)scheduledMIDITimeStamp
+{
+	// Unless an earlier block has been scheduled since, there's none scheduled now
+	uint_fast64_t expected = scheduledMIDITimeStamp;
+	atomic_compare_exchange_strong(&_pendingMSBExpiryMIDITimeStamp, &expected, 0);
 	
-	if (self.sysexData == nil) {
-		// Check for Sysex Begin
-		if (firstByte != kMIKMIDISysexBeginDelimiter) {
-			return NO;
-		}
-		
-		self.sysexData = [NSMutableData new];
-		self.sysexStartTimeStamp = packet->timeStamp;
-	} else if (firstByte > 0x7F && firstByte != kMIKMIDISysexEndDelimiter) {
-		// Invalid Start Byte: send sysex buffered until now, even if invalid
-		[*commandsArray addObject:[self commandByCoalescingSysexData]];
-		// Parse current packet normally
-		return NO;
+	MIDITimeStamp now = self.timeSource.currentMIDITimeStamp;
+	MIDITimeStamp earliestRemainingDeadline = UINT64_MAX;
+	for (MIKMIDIInputPortSourceState *state in [self allSourceStates]) {
+		MIDITimeStamp deadline = UINT64_MAX;
+		NSArray *commands = [state takeCommandsExpiringBy:now assemblingParameterChanges:self.coalescesParameterNumberCommands earliestRemainingDeadline:&deadline];
+		earliestRemainingDeadline = MIN(earliestRemainingDeadline, deadline);
+		void (^commandHandler)(NSArray *) = state.commandHandler;
+		if ([commands count] && commandHandler) commandHandler(commands);
 	}
+	if (earliestRemainingDeadline != UINT64_MAX) [self schedulePendingMSBExpiryAtMIDITimeStamp:earliestRemainingDeadline];
+}
+
+- (void)schedulePendingMSBExpiryAtMIDITimeStamp:(MIDITimeStamp)midiTimeStamp
+{
+	// A block that's already scheduled for the same time or earlier will do. There can be a later one, if
+	// fourteenBitControlChangeCoalescingWindow was made shorter, in which case an earlier one is scheduled too.
+	uint_fast64_t scheduled = atomic_load(&_pendingMSBExpiryMIDITimeStamp);
+	do {
+		if (scheduled && scheduled <= midiTimeStamp) return;
+	} while (!atomic_compare_exchange_weak(&_pendingMSBExpiryMIDITimeStamp, &scheduled, midiTimeStamp));
+	
+	__weak typeof(self) weakSelf = self;
+	[self.timeSource dispatchAtMIDITimeStamp:midiTimeStamp queue:self.bufferedCommandQueue block:^{
+		[weakSelf sendExpiredMSBsScheduledAtMIDITimeStamp:midiTimeStamp];
+	}];
+}
+
+- (void)coalesceSysexFragment:(const MIKMIDIParsedMessage *)fragment sourceState:(MIKMIDIInputPortSourceState *)state
+{
+	MIKMIDISystemExclusiveFragmentHandlerBlock fragmentHandler = self.systemExclusiveFragmentHandler;
+	NSUInteger maximumLength = self.maximumSystemExclusiveLength;
+	BOOL isStart = (fragment->flags & MIKMIDIParsedMessageFlagSystemExclusiveStart) != 0;
+	BOOL isEnd = (fragment->flags & MIKMIDIParsedMessageFlagSystemExclusiveEnd) != 0;
+	MIKMIDISystemExclusiveCommand *command = nil;
+	MIDITimeStamp startTimeStamp = 0;
 	
-	for (UInt16 idx = 0; idx < packet->length; idx++) {
-		Byte byte = data[idx];
+	@synchronized(state) {
+		if (isStart) {
+			state.isReceivingSysex = YES;
+			state.sysexStartTimeStamp = fragment->timeStamp;
+			state.sysexLength = 0;
+			state.sysexData = fragmentHandler ? nil : [NSMutableData dataWithCapacity:fragment->length];
+		}
+		if (!state.isReceivingSysex) return; // The rest of a message that timed out
 		
-		// Append byte
-		[self.sysexData appendBytes:&byte length:1];
+		state.sysexLength += fragment->length;
+		if (maximumLength && state.sysexLength > maximumLength) state.sysexData = nil; // Too long. The rest is ignored.
+		[state.sysexData appendBytes:fragment->bytes length:fragment->length];
 		
-		// Check for Sysex End
-		if (byte == kMIKMIDISysexEndDelimiter) {
-			[*commandsArray addObject:[self commandByCoalescingSysexData]];
-			break;
+		// A message cut off by another status byte is sent as it is, even though it's invalid
+		if (isEnd) {
+			startTimeStamp = state.sysexStartTimeStamp;
+			if (state.sysexData) command = [[MIKMIDISystemExclusiveCommand alloc] initWithRawData:state.sysexData timeStamp:startTimeStamp];
+			[state endSysex];
 		}
 	}
 	
-	return YES;
+	if (fragmentHandler) {
+		MIKMIDISystemExclusiveFragmentFlags flags = 0;
+		if (isStart) flags |= MIKMIDISystemExclusiveFragmentFlagStart;
+		if (isEnd) flags |= MIKMIDISystemExclusiveFragmentFlagEnd;
+		fragmentHandler(state.source, [NSData dataWithBytes:fragment->bytes length:fragment->length], fragment->timeStamp, flags);
+	}
+	if (command) {
+		if (!_prebuiltCommands) _prebuiltCommands = [NSMutableArray array];
+		MIKMIDICommandRecord *record = [self addRecord];
+		record->timeStamp = startTimeStamp;
+		record->bytes[0] = MIKMIDICommandTypeSystemExclusive;
+		record->prebuiltCommandIndex = (UInt32)[_prebuiltCommands count];
+		[_prebuiltCommands addObject:command];
+	}
 }
 
-- (MIKMIDISystemExclusiveCommand *)commandByCoalescingSysexData
+// Starts or extends the time-out for a system exclusive message still being received
+- (void)updateSysexTimeOutForSourceState:(MIKMIDIInputPortSourceState *)state
 {
-	NSParameterAssert(self.sysexData);
-	
-	MIKMIDISystemExclusiveCommand *command = [[MIKMIDISystemExclusiveCommand alloc] initWithRawData:self.sysexData timeStamp:self.sysexStartTimeStamp];
+	// Most packet lists aren't part of a system exclusive message, so don't bother with the clock or the lock for them
+	if (!state.isReceivingSysex) return;
 	
-	// Clear Sysex Buffer & Timestamp
-	self.sysexData = nil;
-	self.sysexStartTimeStamp = 0;
-	
-	// Clear Sysex Timer
-	[self.sysexTimeOutTimer invalidate];
-	self.sysexTimeOutTimer = nil;
-	
-	return command;
+	BOOL shouldSchedule = NO;
+	MIDITimeStamp timeOut = self.timeSource.currentMIDITimeStamp + MIKMIDIClockMIDITimeStampsPerTimeInterval(self.sysexTimeOut);
+	@synchronized(state) {
+		if (!state.isReceivingSysex) return;
+		state.sysexTimeOutMIDITimeStamp = timeOut;
+		shouldSchedule = !state.isSysexTimeOutScheduled;
+		state.isSysexTimeOutScheduled = YES;
+	}
+	if (shouldSchedule) [self scheduleSysexTimeOutAtMIDITimeStamp:timeOut forSourceState:state];
+}
+
+// Force-ends the source's system exclusive message at midiTimeStamp, unless it ended or the time-out was extended first.
+// There is only ever one of these scheduled for each source.
+- (void)scheduleSysexTimeOutAtMIDITimeStamp:(MIDITimeStamp)midiTimeStamp forSourceState:(MIKMIDIInputPortSourceState *)state
+{
+	// Weakify Self
+	__weak typeof(self) weakSelf = self;
+	[self.timeSource dispatchAtMIDITimeStamp:midiTimeStamp queue:self.bufferedCommandQueue block:^{
+		// Strongify Self
+		__strong typeof(self) self = weakSelf;
+		MIDITimeStamp extendedTimeOut = 0;
+		MIDITimeStamp startTimeStamp = 0;
+		NSData *sysexData = nil;
+		@synchronized(state) {
+			MIDITimeStamp timeOut = state.sysexTimeOutMIDITimeStamp;
+			state.isSysexTimeOutScheduled = state.isReceivingSysex && timeOut > midiTimeStamp;
+			if (!state.isReceivingSysex) return;
+			if (state.isSysexTimeOutScheduled) {
+				extendedTimeOut = timeOut;
+			} else {
+				sysexData = state.sysexData;
+				startTimeStamp = state.sysexStartTimeStamp;
+				[state endSysex];
+			}
+		}
+		if (extendedTimeOut) {
+			[self scheduleSysexTimeOutAtMIDITimeStamp:extendedTimeOut forSourceState:state];
+			return;
+		}
+		
+		// Force-End Sysex
+		MIKMIDISystemExclusiveFragmentHandlerBlock fragmentHandler = self.systemExclusiveFragmentHandler;
+		if (fragmentHandler) {
+			fragmentHandler(state.source, [NSData data], midiTimeStamp, MIKMIDISystemExclusiveFragmentFlagEnd | MIKMIDISystemExclusiveFragmentFlagTimedOut);
+		}
+		void (^commandHandler)(NSArray *) = state.commandHandler;
+		if (sysexData && commandHandler) {
+			commandHandler(@[[[MIKMIDISystemExclusiveCommand alloc] initWithRawData:sysexData timeStamp:startTimeStamp]]);
+		}
+	}];
 }
 
 #pragma mark Command Handling
 
 - (void)sendCommands:(NSArray *)commands toEventHandlersFromSource:(MIKMIDISourceEndpoint *)source
 {
-	dispatch_async(self.handlerTokenQueue, ^{
-		NSArray *handlerPairs = [self.handlerTokenPairsByEndpoint objectForKey:source];
-		for (MIKMIDIConnectionTokenAndEventHandler *handlerTokenPair in handlerPairs) {
-			MIKMIDIEventHandlerBlock eventHandler = handlerTokenPair.eventHandler;
-			dispatch_async(dispatch_get_main_queue(), ^{
-				eventHandler(source, commands);
-			});
-		}
-	});
+	NSArray *handlerPairs = [self.handlerTokenPairsSnapshot objectForKey:source];
+	for (MIKMIDIConnectionTokenAndEventHandler *handlerTokenPair in handlerPairs) {
+		[handlerTokenPair deliverCommands:commands fromSource:source deliveryQueue:self.eventDeliveryQueue];
+	}
 }
 
 #pragma mark - Callbacks
@@ -315,101 +543,75 @@ void MIKMIDIPortReadCallback(const MIDIPacketList *pktList, void *readProcRefCon
 {
 	@autoreleasepool {
 		MIKMIDIInputPort *self = (__bridge MIKMIDIInputPort *)readProcRefCon;
-		MIKMIDISourceEndpoint *source = (__bridge MIKMIDISourceEndpoint *)srcConnRefCon;
-		
-		[self interpretPacketList:pktList handleResultingCommands:^(NSArray <MIKMIDICommand*> *receivedCommands) {
-			[self sendCommands:receivedCommands toEventHandlersFromSource:source];
-		}];
+		MIKMIDIInputPortSourceState *state = (__bridge MIKMIDIInputPortSourceState *)srcConnRefCon;
+		[self interpretPacketList:pktList sourceState:state];
 	}
 }
 
 - (void)interpretPacketList:(const MIDIPacketList *)pktList handleResultingCommands:(void (^_Nonnull)(NSArray <MIKMIDICommand*> *receivedCommands))completionBlock
 {
-	NSMutableArray *receivedCommands = [NSMutableArray array];
-	
-	// Get the first packet
-	MIDIPacket *packet = (MIDIPacket *)pktList->packet;
-	
-	for (UInt32 i = 0; i < pktList->numPackets; i++)
-	{
-		// Ignore empty packets
-		if (packet->length == 0) {
-			packet = MIDIPacketNext(packet);
-			continue;
-		}
-		
-		// Try Sysex Coalescing, otherwise parse MIDI commands
-		if (![self coalesceSysexFromMIDIPacket:packet toCommandInArray:&receivedCommands]) {
-			[receivedCommands addObjectsFromArray:[MIKMIDICommand commandsWithMIDIPacket:packet]];
-		}
-		
+	MIKMIDIInputPortSourceState *state = [self sourceStateForSource:nil];
+	state.commandHandler = completionBlock;
+	[self interpretPacketList:pktList sourceState:state];
+}
+
+- (void)interpretPacketList:(const MIDIPacketList *)pktList sourceState:(MIKMIDIInputPortSourceState *)state
+{
+	const MIDIPacket *packet = pktList->packet;
+	for (UInt32 i = 0; i < pktList->numPackets; i++) {
+		[self parseBytes:packet->data length:packet->length timeStamp:packet->timeStamp sourceState:state];
 		packet = MIDIPacketNext(packet);
 	}
 	
 	// Safeguard against sysex time-out
-	if (self.isCoalescingSysex) {
-		// Create or extend time-out timer
-		if (!self.sysexTimeOutTimer) {
-			// Weakify Self
-			__weak typeof(self) weakSelf = self;
-
-			self.sysexTimeOutTimer = [NSTimer timerWithTimeInterval:self.sysexTimeOut repeats:NO block:^(NSTimer *t) {
-				// Strongify Self
-				__strong typeof(self) self = weakSelf;
-				// Force-End Sysex, if necessary
-				if (self.isCoalescingSysex) {
-					completionBlock(@[[self commandByCoalescingSysexData]]);
-				}
-            }];
-
-			// Run Timer
-			NSRunLoop *currentRunLoop = [NSRunLoop currentRunLoop];
-			NSRunLoopMode mode = currentRunLoop.currentMode ?: NSDefaultRunLoopMode;
-			[currentRunLoop addTimer:self.sysexTimeOutTimer forMode:mode];
-		} else {
-			self.sysexTimeOutTimer.fireDate = [NSDate dateWithTimeIntervalSinceNow:self.sysexTimeOut];
-		}
-		return;
-	}
-	
-	// Clear Sysex Timer
-	[self.sysexTimeOutTimer invalidate];
-	self.sysexTimeOutTimer = nil;
+	[self updateSysexTimeOutForSourceState:state];
 	
-	// Handle Commands
-	if (receivedCommands.count == 0) {
-		return;
+	if (_recordCount && self.coalesces14BitControlChangeCommands) {
+		MIDITimeStamp deadline = self.timeSource.currentMIDITimeStamp + MIKMIDIClockMIDITimeStampsPerTimeInterval(self.fourteenBitControlChangeCoalescingWindow);
+		[self reserveRecordCapacity:_recordCount + kMIKMIDIInputPortNumberOfChannels];
+		_recordCount = [state pair14BitControlChangeRecords:_records count:_recordCount deadline:deadline];
+		if (state.hasPendingMSBs) [self schedulePendingMSBExpiryAtMIDITimeStamp:deadline];
+	}
+	if (_recordCount && self.coalescesParameterNumberCommands) {
+		_recordCount = [state assembleParameterChangeRecords:_records count:_recordCount];
 	}
 	
-	if (self.coalesces14BitControlChangeCommands) {
-		dispatch_sync(self.bufferedCommandQueue, ^{
-			if ([self.bufferedMSBCommands count]) {
-				[receivedCommands insertObject:self.bufferedMSBCommands.firstObject atIndex:0];
-				[self.bufferedMSBCommands removeObjectAtIndex:0];
-			}
-		});
-		receivedCommands = [[self commandsByCoalescingCommands:receivedCommands] mutableCopy];
-		MIKMIDICommand *finalCommand = [receivedCommands lastObject];
-		if ([self commandIsPossibleMSBOf14BitCommand:finalCommand]) {
-			// Hold back and wait for a possible LSB command to come in.
-			dispatch_sync(self.bufferedCommandQueue, ^{ [self.bufferedMSBCommands addObject:finalCommand]; });
-			[receivedCommands removeLastObject];
-			
-			// Wait 4ms, then send the buffered command if it hasn't been coalesced (and therefore set to nil)
-			dispatch_time_t popTime = dispatch_time(DISPATCH_TIME_NOW, (int64_t)(4 * NSEC_PER_MSEC));
-			dispatch_after(popTime, self.bufferedCommandQueue, ^(void){
-				if (![self.bufferedMSBCommands containsObject:finalCommand]) return;
-				[self.bufferedMSBCommands removeObject:finalCommand];
-				completionBlock(@[finalCommand]);
-			});
+	// Handle Commands
+	if (_recordCount == 0) return;
+	NSArray *commands = [self takeParsedCommands];
+	void (^commandHandler)(NSArray *) = state.commandHandler;
+	if (commandHandler) commandHandler(commands);
+}
+
+#pragma mark Source State
+
+- (MIKMIDIInputPortSourceState *)sourceStateForSource:(MIKMIDISourceEndpoint *)source
+{
+	@synchronized(_sourceStatesBySource) {
+		MIKMIDIInputPortSourceState *state = source ? [_sourceStatesBySource objectForKey:source] : _unknownSourceState;
+		if (state) return state;
+		
+		state = [[MIKMIDIInputPortSourceState alloc] initWithSource:source];
+		if (!source) {
+			_unknownSourceState = state;
+			return state;
 		}
+		__weak typeof(self) weakSelf = self;
+		state.commandHandler = ^(NSArray *commands) {
+			[weakSelf sendCommands:commands toEventHandlersFromSource:source];
+		};
+		[_sourceStatesBySource setObject:state forKey:source];
+		return state;
 	}
-	
-	if ([receivedCommands count] == 0) {
-		return;
+}
+
+- (NSArray *)allSourceStates
+{
+	@synchronized(_sourceStatesBySource) {
+		NSMutableArray *result = [[[_sourceStatesBySource objectEnumerator] allObjects] mutableCopy];
+		if (_unknownSourceState) [result addObject:_unknownSourceState];
+		return result;
 	}
-	
-	completionBlock(receivedCommands);
 }
 
 #pragma mark - Properties
@@ -437,6 +639,15 @@ void MIKMIDIPortReadCallback(const MIDIPacketList *pktList, void *readProcRefCon
 	_bufferedCommandQueue = commandsBufferQueue;
 }
 
+@synthesize eventDeliveryQueue = _eventDeliveryQueue;
+
+- (void)setEventDeliveryQueue:(dispatch_queue_t)eventDeliveryQueue
+{
+	MIKMIDI_GCD_RETAIN(eventDeliveryQueue);
+	MIKMIDI_GCD_RELEASE(_eventDeliveryQueue);
+	_eventDeliveryQueue = eventDeliveryQueue;
+}
+
 @synthesize handlerTokenQueue = _handlerTokenQueue;
 
 - (void)setHandlerTokenQueue:(dispatch_queue_t)handlerTokenQueue
@@ -446,25 +657,303 @@ void MIKMIDIPortReadCallback(const MIDIPacketList *pktList, void *readProcRefCon
 	_handlerTokenQueue = handlerTokenQueue;
 }
 
-- (BOOL)isCoalescingSysex
-{
-	return (self.sysexData != nil);
-}
-
 @end
 
 #pragma mark -
 
 @implementation MIKMIDIConnectionTokenAndEventHandler
+{
+	// Arrays of commands waiting to be delivered, for MIKMIDIEventDeliveryModeBatchedMainQueue. Guarded by @synchronized(self).
+	NSMutableArray *_pendingCommandArrays;
+}
 
-- (instancetype)initWithConnectionToken:(NSString *)token eventHandler:(MIKMIDIEventHandlerBlock)eventHandler
+- (instancetype)initWithConnectionToken:(NSString *)token deliveryMode:(MIKMIDIEventDeliveryMode)deliveryMode filter:(MIKMIDIInputFilter *)filter eventHandler:(MIKMIDIEventHandlerBlock)eventHandler
 {
 	self = [super init];
 	if (self) {
 		_connectionToken = [token copy];
+		_deliveryMode = deliveryMode;
+		_filter = [filter copy];
 		_eventHandler = [eventHandler copy];
 	}
 	return self;
 }
 
+- (void)deliverCommands:(NSArray *)commands fromSource:(MIKMIDISourceEndpoint *)source deliveryQueue:(dispatch_queue_t)deliveryQueue
+{
+	if (self.filter) {
+		commands = [self.filter filteredCommands:commands];
+		if (![commands count]) return;
+	}
+	
+	MIKMIDIEventHandlerBlock eventHandler = self.eventHandler;
+	switch (self.deliveryMode) {
+		case MIKMIDIEventDeliveryModeReadThread:
+			eventHandler(source, commands);
+			break;
+		case MIKMIDIEventDeliveryModeHighPriorityQueue:
+			dispatch_async(deliveryQueue, ^{ eventHandler(source, commands); });
+			break;
+		case MIKMIDIEventDeliveryModeBatchedMainQueue: {
+			// Only the first array since the last delivery schedules one. Later ones join it.
+			BOOL needsDelivery = NO;
+			@synchronized(self) {
+				needsDelivery = (_pendingCommandArrays == nil);
+				if (needsDelivery) _pendingCommandArrays = [NSMutableArray array];
+				[_pendingCommandArrays addObject:commands];
+			}
+			if (!needsDelivery) break;
+			dispatch_async(dispatch_get_main_queue(), ^{
+				NSArray *commandArrays = nil;
+				@synchronized(self) {
+					commandArrays = self->_pendingCommandArrays;
+					self->_pendingCommandArrays = nil;
+				}
+				if ([commandArrays count] == 1) {
+					eventHandler(source, [commandArrays firstObject]);
+					return;
+				}
+				eventHandler(source, [commandArrays valueForKeyPath:@"@unionOfArrays.self"]);
+			});
+			break;
+		}
+		case MIKMIDIEventDeliveryModeMainQueue:
+		default:
+			dispatch_async(dispatch_get_main_queue(), ^{ eventHandler(source, commands); });
+			break;
+	}
+}
+
+@end
+
+#pragma mark -
+
+@implementation MIKMIDIInputPortSourceState
+{
+	MIKMIDIMessageParser _parser;
+	
+	// A control change that may be the MSB of a 14-bit control change, waiting for its LSB, for each channel.
+	// Bit n of _pendingMSBChannelMask is set if channel n's entry is in use. Guarded by @synchronized(self).
+	UInt16 _pendingMSBChannelMask;
+	MIKMIDICommandRecord _pendingMSBRecords[kMIKMIDIInputPortNumberOfChannels];
+	MIDITimeStamp _pendingMSBDeadlines[kMIKMIDIInputPortNumberOfChannels];
+	atomic_size_t _numberOfPendingMSBs;
+	
+	// The RPN or NRPN selected on each channel, for assembling parameter changes. Guarded by @synchronized(self).
+	MIKMIDIInputPortParameterSelection _parameterSelections[kMIKMIDIInputPortNumberOfChannels];
+	
+	atomic_bool _isReceivingSysex;
+}
+
+- (instancetype)initWithSource:(MIKMIDISourceEndpoint *)source
+{
+	self = [super init];
+	if (self) {
+		_source = source;
+		MIKMIDIMessageParserInit(&_parser);
+		atomic_init(&_numberOfPendingMSBs, 0);
+		atomic_init(&_isReceivingSysex, false);
+		for (NSUInteger channel = 0; channel < kMIKMIDIInputPortNumberOfChannels; channel++) {
+			_parameterSelections[channel] = (MIKMIDIInputPortParameterSelection){
+				.registeredNumber = {kMIKMIDIInputPortUnknownValue, kMIKMIDIInputPortUnknownValue},
+				.nonRegisteredNumber = {kMIKMIDIInputPortUnknownValue, kMIKMIDIInputPortUnknownValue},
+				.selectedType = kMIKMIDIInputPortUnknownValue,
+				.dataEntryMSB = kMIKMIDIInputPortUnknownValue,
+			};
+		}
+	}
+	return self;
+}
+
+// Joins MSB and LSB control change pairs on the same channel into 14-bit control changes, in place, and returns
+// the new number of records. A possible MSB is held back until its LSB comes, and is sent on its own, in its place,
+// as soon as anything else comes on its channel, so commands are never reordered. MSBs whose LSB never comes are
+// taken by -takeCommandsExpiringBy:assemblingParameterChanges:earliestRemainingDeadline:. records must have room for
+// kMIKMIDIInputPortNumberOfChannels more than count, for MSBs held back from earlier packet lists.
+- (NSUInteger)pair14BitControlChangeRecords:(MIKMIDICommandRecord *)records count:(NSUInteger)count deadline:(MIDITimeStamp)deadline
+{
+	// Most packet lists have no control changes, and no MSBs waiting, so don't bother locking for them
+	BOOL hasControlChanges = (atomic_load(&_numberOfPendingMSBs) != 0);
+	for (NSUInteger i = 0; i < count && !hasControlChanges; i++) {
+		hasControlChanges = (records[i].length == 3 && (records[i].bytes[0] & 0xF0) == 0xB0 && records[i].bytes[1] < 64);
+	}
+	if (!hasControlChanges) return count;
+	
+	@synchronized(self) {
+		// Held back MSBs may be sent ahead of this packet list's records, so move those along to make room. After that,
+		// each record becomes at most one record besides the held back MSB it sends, so this never writes past the record being read.
+		NSUInteger offset = atomic_load(&_numberOfPendingMSBs);
+		if (offset) memmove(records + offset, records, count * sizeof(MIKMIDICommandRecord));
+		NSUInteger resultCount = 0;
+		for (NSUInteger i = offset; i < offset + count; i++) {
+			MIKMIDICommandRecord record = records[i];
+			if (record.bytes[0] < 0x80 || record.bytes[0] >= 0xF0) {
+				records[resultCount++] = record; // System messages don't belong to a channel
+				continue;
+			}
+			
+			UInt8 channel = record.bytes[0] & 0x0F;
+			UInt16 bit = (UInt16)1 << channel;
+			BOOL isControlChange = (record.length == 3 && (record.bytes[0] & 0xF0) == 0xB0 && record.bytes[1] < 64);
+			BOOL isMSB = isControlChange && (record.bytes[1] < kMIKMIDIInputPortNumberOf14BitControllers);
+			if (_pendingMSBChannelMask & bit) {
+				MIKMIDICommandRecord fourteenBitRecord = _pendingMSBRecords[channel];
+				_pendingMSBChannelMask &= ~bit;
+				atomic_fetch_sub(&_numberOfPendingMSBs, 1);
+				if (isControlChange && !isMSB && record.bytes[1] == fourteenBitRecord.bytes[1] + kMIKMIDIInputPortNumberOf14BitControllers) {
+					fourteenBitRecord.bytes[3] = record.bytes[2];
+					fourteenBitRecord.length = 4;
+					fourteenBitRecord.timeStamp = record.timeStamp;
+					records[resultCount++] = fourteenBitRecord;
+					continue;
+				}
+				records[resultCount++] = fourteenBitRecord; // Anything but its LSB means it was a 7-bit control change
+			}
+			
+			if (isMSB) {
+				_pendingMSBChannelMask |= bit;
+				_pendingMSBRecords[channel] = record;
+				_pendingMSBDeadlines[channel] = deadline;
+				atomic_fetch_add(&_numberOfPendingMSBs, 1);
+				continue;
+			}
+			records[resultCount++] = record;
+		}
+		return resultCount;
+	}
+}
+
+// YES if both bytes of the selected parameter's number have been received
+static BOOL MIKMIDIInputPortParameterSelectionIsComplete(const MIKMIDIInputPortParameterSelection *selection)
+{
+	if (selection->selectedType == kMIKMIDIInputPortUnknownValue) return NO;
+	BOOL isRegistered = (selection->selectedType == MIKMIDIParameterTypeRegistered);
+	const UInt8 *number = isRegistered ? selection->registeredNumber : selection->nonRegisteredNumber;
+	return number[0] != kMIKMIDIInputPortUnknownValue && number[1] != kMIKMIDIInputPortUnknownValue;
+}
+
+// Fills in record with the control changes of a parameter change, in the form MIKMIDIParameterChangeCommand's data takes.
+// For data entry, values are the MSB and LSB, and the LSB is left out if it's kMIKMIDIInputPortUnknownValue.
+// For increments and decrements, controller is 96 or 97 and values[0] is the data byte.
+static void MIKMIDIInputPortMakeParameterChangeRecord(MIKMIDICommandRecord *record, UInt8 channel, const MIKMIDIInputPortParameterSelection *selection, UInt8 controller, const UInt8 values[2])
+{
+	UInt8 status = 0xB0 | channel;
+	BOOL isRegistered = (selection->selectedType == MIKMIDIParameterTypeRegistered);
+	const UInt8 *number = isRegistered ? selection->registeredNumber : selection->nonRegisteredNumber;
+	UInt8 bytes[12] = {
+		status, isRegistered ? 101 : 99, number[0],
+		status, isRegistered ? 100 : 98, number[1],
+		status, controller, values[0],
+		status, 38, values[1],
+	};
+	memcpy(record->bytes, bytes, sizeof(bytes));
+	record->length = (controller == 6 && values[1] != kMIKMIDIInputPortUnknownValue) ? 12 : 9;
+}
+
+// Replaces RPN and NRPN control change sequences with parameter change records, in place, and returns the new
+// number of records. Must come after -pair14BitControlChangeRecords:count:deadline:, so that a data entry MSB
+// and LSB have already been paired, and a data entry MSB followed by a parameter number has been sent on its own.
+- (NSUInteger)assembleParameterChangeRecords:(MIKMIDICommandRecord *)records count:(NSUInteger)count
+{
+	// Only parameter number, data entry, and increment and decrement control changes matter
+	BOOL hasParameterControlChanges = NO;
+	for (NSUInteger i = 0; i < count && !hasParameterControlChanges; i++) {
+		if ((records[i].bytes[0] & 0xF0) != 0xB0 || records[i].length < 3 || records[i].length > 4) continue;
+		UInt8 controller = records[i].bytes[1];
+		hasParameterControlChanges = (controller == 6 || controller == 38 || (controller >= 96 && controller <= 101));
+	}
+	if (!hasParameterControlChanges) return count;
+	
+	@synchronized(self) {
+		// Each record becomes at most one record, so this never writes past the record being read
+		NSUInteger resultCount = 0;
+		for (NSUInteger i = 0; i < count; i++) {
+			MIKMIDICommandRecord record = records[i];
+			if ((record.bytes[0] & 0xF0) != 0xB0 || record.length < 3 || record.length > 4) {
+				records[resultCount++] = record;
+				continue;
+			}
+			
+			UInt8 channel = record.bytes[0] & 0x0F;
+			UInt8 controller = record.bytes[1];
+			MIKMIDIInputPortParameterSelection *selection = &_parameterSelections[channel];
+			BOOL isSelected = MIKMIDIInputPortParameterSelectionIsComplete(selection);
+			
+			if (controller >= 98 && controller <= 101) {
+				BOOL isRegistered = (controller >= 100);
+				UInt8 *number = isRegistered ? selection->registeredNumber : selection->nonRegisteredNumber;
+				number[(controller % 2) ? 0 : 1] = record.bytes[2];
+				selection->selectedType = isRegistered ? MIKMIDIParameterTypeRegistered : MIKMIDIParameterTypeNonRegistered;
+				selection->dataEntryMSB = kMIKMIDIInputPortUnknownValue;
+				// RPN 127/127 is the null function, which deselects the parameter
+				if (isRegistered && number[0] == 127 && number[1] == 127) selection->selectedType = kMIKMIDIInputPortUnknownValue;
+				continue;
+			}
+			
+			if (controller == 6 && isSelected) {
+				UInt8 LSB = (record.length == 4) ? record.bytes[3] : kMIKMIDIInputPortUnknownValue;
+				selection->dataEntryMSB = record.bytes[2];
+				MIKMIDIInputPortMakeParameterChangeRecord(&record, channel, selection, 6, (UInt8[2]){record.bytes[2], LSB});
+			} else if (controller == 38 && record.length == 3 && isSelected && selection->dataEntryMSB != kMIKMIDIInputPortUnknownValue) {
+				MIKMIDIInputPortMakeParameterChangeRecord(&record, channel, selection, 6, (UInt8[2]){selection->dataEntryMSB, record.bytes[2]});
+			} else if ((controller == 96 || controller == 97) && isSelected) {
+				MIKMIDIInputPortMakeParameterChangeRecord(&record, channel, selection, controller, (UInt8[2]){record.bytes[2], 0});
+			}
+			records[resultCount++] = record;
+		}
+		return resultCount;
+	}
+}
+
+static int MIKMIDICommandRecordCompareTimeStamps(const void *record1, const void *record2)
+{
+	MIDITimeStamp timeStamp1 = ((const MIKMIDICommandRecord *)record1)->timeStamp;
+	MIDITimeStamp timeStamp2 = ((const MIKMIDICommandRecord *)record2)->timeStamp;
+	return (timeStamp1 > timeStamp2) - (timeStamp1 < timeStamp2);
+}
+
+// Removes the MSBs whose deadline is at or before midiTimeStamp, and returns them as commands, in time order
+- (NSArray *)takeCommandsExpiringBy:(MIDITimeStamp)midiTimeStamp assemblingParameterChanges:(BOOL)assembleParameterChanges earliestRemainingDeadline:(MIDITimeStamp *)earliestRemainingDeadline
+{
+	*earliestRemainingDeadline = UINT64_MAX;
+	if (!atomic_load(&_numberOfPendingMSBs)) return nil;
+	
+	MIKMIDICommandRecord expiredRecords[kMIKMIDIInputPortNumberOfChannels];
+	NSUInteger count = 0;
+	@synchronized(self) {
+		UInt16 mask = _pendingMSBChannelMask;
+		for (NSUInteger channel = 0; mask; channel++, mask >>= 1) {
+			if (!(mask & 1)) continue;
+			MIDITimeStamp deadline = _pendingMSBDeadlines[channel];
+			if (deadline > midiTimeStamp) {
+				*earliestRemainingDeadline = MIN(*earliestRemainingDeadline, deadline);
+				continue;
+			}
+			expiredRecords[count++] = _pendingMSBRecords[channel];
+			_pendingMSBChannelMask &= ~((UInt16)1 << channel);
+			atomic_fetch_sub(&_numberOfPendingMSBs, 1);
+		}
+	}
+	if (!count) return nil;
+	
+	qsort(expiredRecords, count, sizeof(MIKMIDICommandRecord), MIKMIDICommandRecordCompareTimeStamps);
+	if (assembleParameterChanges) count = [self assembleParameterChangeRecords:expiredRecords count:count];
+	return [[MIKMIDIDeferredCommandArray alloc] initWithRecords:expiredRecords count:count prebuiltCommands:nil];
+}
+
+- (void)endSysex
+{
+	self.isReceivingSysex = NO;
+	self.sysexData = nil;
+	self.sysexLength = 0;
+	self.sysexStartTimeStamp = 0;
+}
+
+- (MIKMIDIMessageParser *)parser { return &_parser; }
+
+- (BOOL)isReceivingSysex { return atomic_load_explicit(&_isReceivingSysex, memory_order_relaxed); }
+- (void)setIsReceivingSysex:(BOOL)isReceivingSysex { atomic_store_explicit(&_isReceivingSysex, isReceivingSysex, memory_order_relaxed); }
+
+- (BOOL)hasPendingMSBs { return atomic_load(&_numberOfPendingMSBs) != 0; }
+
 @end
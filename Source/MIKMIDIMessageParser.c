@@ -0,0 +1,166 @@
+//
+//  MIKMIDIMessageParser.c
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#include "MIKMIDIMessageParser.h"
+#include <string.h>
+
+void MIKMIDIMessageParserInit(MIKMIDIMessageParser *parser)
+{
+	memset(parser, 0, sizeof(*parser));
+}
+
+int MIKMIDIMessageParserDataLengthForStatus(uint8_t status)
+{
+	if (status < 0x80) return -1;
+	if (status < 0xF0) return ((status & 0xE0) == 0xC0) ? 1 : 2; // Program change and channel pressure have one data byte
+	switch (status) {
+		case 0xF0:
+		case 0xF7:
+			return -1;
+		case 0xF1: // MTC quarter frame
+		case 0xF3: // Song select
+			return 1;
+		case 0xF2: // Song position pointer
+			return 2;
+		default: // Tune request, real time and undefined messages
+			return 0;
+	}
+}
+
+static inline void MIKMIDIMessageParserEmitShort(MIKMIDIParsedMessage *message, uint64_t timeStamp, uint8_t status, uint8_t data1, uint8_t data2, uint32_t length)
+{
+	message->timeStamp = timeStamp;
+	message->bytes = NULL;
+	message->length = length;
+	message->kind = MIKMIDIParsedMessageKindShort;
+	message->flags = 0;
+	message->status = status;
+	message->data1 = data1;
+	message->data2 = data2;
+}
+
+static inline void MIKMIDIMessageParserEmitFragment(MIKMIDIParsedMessage *message, uint64_t timeStamp, const uint8_t *bytes, size_t length, uint8_t flags)
+{
+	message->timeStamp = timeStamp;
+	message->bytes = bytes;
+	message->length = (uint32_t)length;
+	message->kind = MIKMIDIParsedMessageKindSystemExclusiveFragment;
+	message->flags = flags;
+	message->status = 0xF0;
+	message->data1 = 0;
+	message->data2 = 0;
+}
+
+// Returns the index of the first status byte at or after start, or length if there isn't one. System exclusive
+// messages are almost all data bytes, so like memchr(), this checks a word at a time.
+static inline size_t MIKMIDIMessageParserFindStatusByte(const uint8_t *bytes, size_t start, size_t length)
+{
+	size_t i = start;
+	for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+		uint64_t word;
+		memcpy(&word, bytes + i, sizeof(word));
+		if (word & UINT64_C(0x8080808080808080)) break;
+	}
+	for (; i < length; i++) {
+		if (bytes[i] & 0x80) return i;
+	}
+	return length;
+}
+
+size_t MIKMIDIMessageParserParse(MIKMIDIMessageParser *parser, const uint8_t *bytes, size_t length, uint64_t timeStamp,
+								 MIKMIDIParsedMessage *messages, size_t capacity, size_t *bytesConsumed)
+{
+	size_t count = 0;
+	size_t i = 0;
+	size_t fragmentStart = 0; // Start of the system exclusive bytes not yet reported, if in a system exclusive message
+	uint8_t fragmentFlags = 0;
+
+	// A byte produces at most two messages. One more slot is kept for the fragment that may be left at the end.
+	for (; i < length && count + MIKMIDIMessageParserMinimumCapacity <= capacity; i++) {
+		uint8_t byte = bytes[i];
+
+		if (byte >= 0xF8) {
+			// Real time messages can appear anywhere, even in the middle of other messages, without affecting them
+			if (parser->isInSystemExclusive) {
+				if (i > fragmentStart || fragmentFlags) {
+					MIKMIDIMessageParserEmitFragment(&messages[count++], timeStamp, bytes + fragmentStart, i - fragmentStart, fragmentFlags);
+				}
+				fragmentStart = i + 1;
+				fragmentFlags = 0;
+			}
+			MIKMIDIMessageParserEmitShort(&messages[count++], timeStamp, byte, 0, 0, 1);
+			continue;
+		}
+
+		if (parser->isInSystemExclusive) {
+			if (byte < 0x80) {
+				i = MIKMIDIMessageParserFindStatusByte(bytes, i + 1, length) - 1; // Skip to the next status byte
+				continue;
+			}
+
+			// End of exclusive, or any other status byte, ends the message
+			size_t end = (byte == 0xF7) ? i + 1 : i;
+			MIKMIDIMessageParserEmitFragment(&messages[count++], timeStamp, bytes + fragmentStart, end - fragmentStart,
+											 fragmentFlags | MIKMIDIParsedMessageFlagSystemExclusiveEnd);
+			parser->isInSystemExclusive = 0;
+			fragmentFlags = 0;
+			if (byte == 0xF7) continue;
+		}
+
+		if (byte >= 0x80) {
+			parser->dataCount = 0;
+			parser->isMessageInProgress = 0;
+			if (byte == 0xF0) {
+				parser->isInSystemExclusive = 1;
+				parser->status = 0;
+				fragmentStart = i;
+				fragmentFlags = MIKMIDIParsedMessageFlagSystemExclusiveStart;
+				continue;
+			}
+			if (byte == 0xF7) {
+				parser->status = 0; // Stray end of exclusive
+				continue;
+			}
+
+			if (MIKMIDIMessageParserDataLengthForStatus(byte) == 0) {
+				MIKMIDIMessageParserEmitShort(&messages[count++], timeStamp, byte, 0, 0, 1);
+				parser->status = 0;
+				continue;
+			}
+			parser->status = byte;
+			parser->timeStamp = timeStamp;
+			parser->isMessageInProgress = 1;
+			continue;
+		}
+
+		// Data bytes without a status byte to go with them are dropped
+		if (!parser->status) continue;
+
+		if (!parser->isMessageInProgress) {
+			// A new message using running status
+			parser->timeStamp = timeStamp;
+			parser->isMessageInProgress = 1;
+		}
+		parser->data[parser->dataCount++] = byte;
+		int dataLength = MIKMIDIMessageParserDataLengthForStatus(parser->status);
+		if (parser->dataCount < dataLength) continue;
+
+		MIKMIDIMessageParserEmitShort(&messages[count++], parser->timeStamp, parser->status,
+									  parser->data[0], (dataLength > 1) ? parser->data[1] : 0, (uint32_t)dataLength + 1);
+		parser->dataCount = 0;
+		parser->isMessageInProgress = 0;
+		if (parser->status >= 0xF0) parser->status = 0; // Only channel messages set running status
+	}
+
+	if (parser->isInSystemExclusive && (i > fragmentStart || fragmentFlags)) {
+		MIKMIDIMessageParserEmitFragment(&messages[count++], timeStamp, bytes + fragmentStart, i - fragmentStart, fragmentFlags);
+	}
+
+	*bytesConsumed = i;
+	return count;
+}
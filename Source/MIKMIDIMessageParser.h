@@ -0,0 +1,129 @@
+//
+//  MIKMIDIMessageParser.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#ifndef MIKMIDIMessageParser_h
+#define MIKMIDIMessageParser_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  A small, portable parser for MIDI 1.0 byte streams, as received from a MIDI input.
+ *
+ *  Bytes are fed to the parser as they arrive, in buffers of any size. Messages split
+ *  across buffers, running status, and real time messages interleaved with other messages,
+ *  including system exclusive messages, are all handled. Parsed messages are written to
+ *  a caller-supplied array, so parsing never allocates.
+ *
+ *  System exclusive messages aren't collected by the parser. Instead, their bytes are reported
+ *  as fragments pointing into the buffer being parsed, so the caller can decide whether and
+ *  where to keep them.
+ *
+ *  This file has no dependency on Foundation, CoreMIDI or AudioToolbox, and
+ *  can be compiled and tested on any platform with a C99 compiler.
+ */
+
+/**
+ *  The kinds of messages reported by the parser.
+ */
+typedef enum {
+	/** A channel, system common or system real time message, in status, data1 and data2. */
+	MIKMIDIParsedMessageKindShort = 0,
+	/** Part of a system exclusive message, in bytes and length. */
+	MIKMIDIParsedMessageKindSystemExclusiveFragment,
+} MIKMIDIParsedMessageKind;
+
+/**
+ *  Flags for system exclusive fragments.
+ */
+enum {
+	/** The fragment starts a system exclusive message, and begins with 0xF0. */
+	MIKMIDIParsedMessageFlagSystemExclusiveStart = 1 << 0,
+	/** The fragment ends a system exclusive message. It ends with 0xF7, unless the message was cut off by another status byte. */
+	MIKMIDIParsedMessageFlagSystemExclusiveEnd = 1 << 1,
+};
+
+/**
+ *  A message decoded by the parser.
+ */
+typedef struct {
+	/** The time stamp of the buffer the message started in. */
+	uint64_t timeStamp;
+	/** For system exclusive fragments, the fragment's bytes. Points into the buffer being parsed. */
+	const uint8_t *bytes;
+	/** For short messages, the number of bytes in the message, including the status byte. For fragments, the number of bytes in bytes. */
+	uint32_t length;
+	/** A MIKMIDIParsedMessageKind value. */
+	uint8_t kind;
+	/** MIKMIDIParsedMessageFlag values, for system exclusive fragments. */
+	uint8_t flags;
+	/** The full status byte (including channel) and data bytes of short messages. Unused data bytes are 0. */
+	uint8_t status;
+	uint8_t data1;
+	uint8_t data2;
+} MIKMIDIParsedMessage;
+
+/**
+ *  Parser state. Initialize with MIKMIDIMessageParserInit() before use. One parser should be
+ *  used for each input stream.
+ */
+typedef struct {
+	/** Time stamp of the message in progress. */
+	uint64_t timeStamp;
+	/** Status of the message in progress, or the running status. 0 if there is neither. */
+	uint8_t status;
+	uint8_t data[2];
+	uint8_t dataCount;
+	uint8_t isMessageInProgress;
+	uint8_t isInSystemExclusive;
+} MIKMIDIMessageParser;
+
+/**
+ *  The smallest capacity that can be passed to MIKMIDIMessageParserParse().
+ */
+#define MIKMIDIMessageParserMinimumCapacity	3
+
+/**
+ *  Prepares parser for use, or resets it, discarding any message in progress.
+ */
+void MIKMIDIMessageParserInit(MIKMIDIMessageParser *parser);
+
+/**
+ *  Parses bytes from a MIDI input stream.
+ *
+ *  If messages fills up before all of bytes has been parsed, parsing stops early. Call again,
+ *  starting at bytes + *bytesConsumed, to parse the rest.
+ *
+ *  @param parser        A parser initialized with MIKMIDIMessageParserInit().
+ *  @param bytes         The bytes to parse.
+ *  @param length        The length of bytes.
+ *  @param timeStamp     The time stamp of bytes. Messages are given the time stamp of the buffer they start in.
+ *  @param messages      Array to fill in with the parsed messages.
+ *  @param capacity      The number of elements in messages. Must be at least MIKMIDIMessageParserMinimumCapacity.
+ *  @param bytesConsumed On return, the number of bytes parsed.
+ *
+ *  @return The number of messages written to messages.
+ */
+size_t MIKMIDIMessageParserParse(MIKMIDIMessageParser *parser, const uint8_t *bytes, size_t length, uint64_t timeStamp,
+								 MIKMIDIParsedMessage *messages, size_t capacity, size_t *bytesConsumed);
+
+/**
+ *  Returns the number of data bytes that follow a status byte in a short message, or -1 if
+ *  status is a system exclusive or end of exclusive status byte, or not a status byte.
+ */
+int MIKMIDIMessageParserDataLengthForStatus(uint8_t status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MIKMIDIMessageParser_h */
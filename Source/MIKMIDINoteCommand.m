@@ -88,6 +88,14 @@
 	self.value = value;
 }
 
++ (UInt8)highResolutionValueBitCount { return 16; }
+
+- (void)setLowResolutionValue:(NSUInteger)value
+{
+	// A MIDI 2.0 note on velocity that scales down to 0 would make this a note off
+	self.value = self.isNoteOn ? MAX(value, 1) : value;
+}
+
 - (NSString *)additionalCommandDescription
 {
 	return [NSString stringWithFormat:@"%@ note: %lu velocity: %lu", [super additionalCommandDescription], (unsigned long)self.note, (unsigned long)self.velocity];
@@ -106,6 +114,7 @@
 @dynamic midiTimestamp;
 @dynamic channel;
 @dynamic value;
+@dynamic highResolutionValue;
 @dynamic note;
 @dynamic velocity;
 @dynamic noteOn;
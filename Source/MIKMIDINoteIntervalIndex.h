@@ -0,0 +1,72 @@
+//
+//  MIKMIDINoteIntervalIndex.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDIEventStore;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  MIKMIDINoteIntervalIndex answers questions about which notes are sounding over a span of time,
+ *  which can't be answered by looking at note start times alone.
+ *
+ *  It keeps only the start and end times of the notes in an MIKMIDIEventStore, not the notes themselves.
+ *  Queries return the notes' indexes in the store, for -[MIKMIDIEventStore eventsAtIndexes:], so the
+ *  index must be rebuilt whenever the store changes.
+ *
+ *  It's an immutable interval tree over a set of notes. Each node holds the latest end time of the
+ *  notes beneath it, so whole subtrees of notes that have already ended are skipped. Queries take
+ *  O(log n) time, plus time proportional to the number of notes returned.
+ *
+ *  Instances are safe to use from multiple threads at once.
+ *
+ *  @note This class is for internal MIKMIDI use only. It is used by MIKMIDITrack.
+ */
+@interface MIKMIDINoteIntervalIndex : NSObject
+
+/**
+ *  Creates an index of the notes in an event store, without creating objects for them.
+ *
+ *  @param eventStore The store containing the notes.
+ *
+ *  @return An initialized index.
+ */
+- (instancetype)initWithEventStore:(MIKMIDIEventStore *)eventStore;
+
+/**
+ *  Returns the notes that are sounding at timeStamp. That is, those that start at or before
+ *  timeStamp, and end after it.
+ *
+ *  @param timeStamp The time stamp to look for notes at.
+ *
+ *  @return The indexes of the notes in the event store.
+ */
+- (NSIndexSet *)indexesOfNotesSoundingAtTimeStamp:(MusicTimeStamp)timeStamp;
+
+/**
+ *  Returns the notes that sound at any point from startTimeStamp up to, but not including, endTimeStamp.
+ *  Notes with no duration are included if they start in that range.
+ *
+ *  @param startTimeStamp The start of the range.
+ *  @param endTimeStamp   The end of the range.
+ *
+ *  @return The indexes of the notes in the event store.
+ */
+- (NSIndexSet *)indexesOfNotesOverlappingRangeFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
+/**
+ *  The number of notes in the index.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+@end
+
+NS_ASSUME_NONNULL_END
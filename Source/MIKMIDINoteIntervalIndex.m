@@ -0,0 +1,132 @@
+//
+//  MIKMIDINoteIntervalIndex.m
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDINoteIntervalIndex.h"
+#import "MIKMIDIEventStore.h"
+#import "MIKMIDINoteEvent.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDINoteIntervalIndex.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDINoteIntervalIndex.m in the Build Phases for this target
+#endif
+
+// Adds the event store indexes of the notes under node, which covers notes [low, high), that come before limit
+// and end after timeStamp. maximumEndTimeStamps is a binary heap laid out with the root at 1.
+static void MIKMIDINoteIntervalIndexCollect(const MusicTimeStamp *maximumEndTimeStamps, const NSUInteger *eventIndexes, NSUInteger node,
+											NSUInteger low, NSUInteger high, NSUInteger limit, MusicTimeStamp timeStamp, NSMutableIndexSet *indexes)
+{
+	if (low >= limit || maximumEndTimeStamps[node] <= timeStamp) return;
+	if (high - low == 1) {
+		[indexes addIndex:eventIndexes[low]];
+		return;
+	}
+	NSUInteger middle = low + (high - low) / 2;
+	MIKMIDINoteIntervalIndexCollect(maximumEndTimeStamps, eventIndexes, 2 * node, low, middle, limit, timeStamp, indexes);
+	MIKMIDINoteIntervalIndexCollect(maximumEndTimeStamps, eventIndexes, 2 * node + 1, middle, high, limit, timeStamp, indexes);
+}
+
+@implementation MIKMIDINoteIntervalIndex
+{
+	NSUInteger *_eventIndexes;
+	MusicTimeStamp *_startTimeStamps;
+	MusicTimeStamp *_maximumEndTimeStamps;
+	NSUInteger _leafCount;
+}
+
+- (instancetype)initWithEventStore:(MIKMIDIEventStore *)eventStore
+{
+	self = [super init];
+	if (self) {
+		__block NSUInteger capacity = 0;
+		__block NSUInteger count = 0;
+		__block NSUInteger *eventIndexes = NULL;
+		__block MusicTimeStamp *startTimeStamps = NULL;
+		__block MusicTimeStamp *endTimeStamps = NULL;
+		[eventStore enumerateEventsOfClass:[MIKMIDINoteEvent class] fromTimeStamp:-DBL_MAX toTimeStamp:DBL_MAX usingBlock:^(NSUInteger index, MusicTimeStamp timeStamp, MIKMIDIEventType eventType, const void *bytes, NSUInteger length, BOOL *stop) {
+			if (count == capacity) {
+				capacity = MAX(capacity * 2, 64);
+				eventIndexes = reallocf(eventIndexes, capacity * sizeof(*eventIndexes));
+				startTimeStamps = reallocf(startTimeStamps, capacity * sizeof(*startTimeStamps));
+				endTimeStamps = reallocf(endTimeStamps, capacity * sizeof(*endTimeStamps));
+				if (!eventIndexes || !startTimeStamps || !endTimeStamps) {
+					[NSException raise:NSMallocException format:@"Unable to allocate an index of %lu notes.", (unsigned long)capacity];
+				}
+			}
+			MIDINoteMessage message = {0};
+			memcpy(&message, bytes, MIN(length, sizeof(message)));
+			eventIndexes[count] = index;
+			startTimeStamps[count] = timeStamp;
+			endTimeStamps[count] = timeStamp + message.duration;
+			count++;
+		}];
+		_count = count;
+		_eventIndexes = eventIndexes;
+		_startTimeStamps = startTimeStamps;
+
+		_leafCount = 1;
+		while (_leafCount < count) _leafCount *= 2;
+
+		_maximumEndTimeStamps = malloc(2 * _leafCount * sizeof(MusicTimeStamp));
+		for (NSUInteger i = 0; i < _leafCount; i++) {
+			_maximumEndTimeStamps[_leafCount + i] = (i < count) ? endTimeStamps[i] : -DBL_MAX;
+		}
+		for (NSUInteger node = _leafCount - 1; node > 0; node--) {
+			_maximumEndTimeStamps[node] = MAX(_maximumEndTimeStamps[2 * node], _maximumEndTimeStamps[2 * node + 1]);
+		}
+		free(endTimeStamps);
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	free(_eventIndexes);
+	free(_startTimeStamps);
+	free(_maximumEndTimeStamps);
+}
+
+#pragma mark - Public
+
+- (NSIndexSet *)indexesOfNotesSoundingAtTimeStamp:(MusicTimeStamp)timeStamp
+{
+	NSUInteger limit = [self numberOfNotesStartingBeforeTimeStamp:timeStamp orAt:YES];
+	NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+	MIKMIDINoteIntervalIndexCollect(_maximumEndTimeStamps, _eventIndexes, 1, 0, _leafCount, limit, timeStamp, indexes);
+	return indexes;
+}
+
+- (NSIndexSet *)indexesOfNotesOverlappingRangeFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	if (endTimeStamp <= startTimeStamp) return [NSIndexSet indexSet];
+
+	// Notes that start within the range all overlap it. Of those that start earlier, only the ones still sounding do.
+	NSUInteger firstInRange = [self numberOfNotesStartingBeforeTimeStamp:startTimeStamp orAt:NO];
+	NSUInteger limit = [self numberOfNotesStartingBeforeTimeStamp:endTimeStamp orAt:NO];
+	NSMutableIndexSet *indexes = [NSMutableIndexSet indexSet];
+	MIKMIDINoteIntervalIndexCollect(_maximumEndTimeStamps, _eventIndexes, 1, 0, _leafCount, firstInRange, startTimeStamp, indexes);
+	for (NSUInteger i = firstInRange; i < limit; i++) [indexes addIndex:_eventIndexes[i]];
+	return indexes;
+}
+
+#pragma mark - Private
+
+- (NSUInteger)numberOfNotesStartingBeforeTimeStamp:(MusicTimeStamp)timeStamp orAt:(BOOL)includeStartingAt
+{
+	NSUInteger low = 0, high = _count;
+	while (low < high) {
+		NSUInteger middle = low + (high - low) / 2;
+		MusicTimeStamp start = _startTimeStamps[middle];
+		if (start < timeStamp || (includeStartingAt && start == timeStamp)) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+@end
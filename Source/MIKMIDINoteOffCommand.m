@@ -71,6 +71,7 @@
 @dynamic midiTimestamp;
 @dynamic channel;
 @dynamic value;
+@dynamic highResolutionValue;
 @dynamic note;
 @dynamic velocity;
 
@@ -64,6 +64,7 @@
 @dynamic midiTimestamp;
 @dynamic channel;
 @dynamic value;
+@dynamic highResolutionValue;
 @dynamic note;
 @dynamic velocity;
 @dynamic noteOn;
@@ -11,6 +11,7 @@
 
 @class MIKMIDICommand;
 @class MIKMIDIDestinationEndpoint;
+@protocol MIKMIDITimeSource;
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -23,6 +24,60 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (BOOL)sendCommands:(MIKArrayOf(MIKMIDICommand *) *)commands toDestination:(MIKMIDIDestinationEndpoint *)destination error:(NSError **)error;
 
+/**
+ *  Sends a packet list immediately, bypassing batching.
+ *
+ *  @param packetList  The packet list to send.
+ *  @param destination The destination to send it to.
+ *  @param error       If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return YES if the packet list was sent, NO if an error occurred.
+ */
+- (BOOL)sendPacketList:(const MIDIPacketList *)packetList toDestination:(MIKMIDIDestinationEndpoint *)destination error:(NSError **)error;
+
+/**
+ *  Sends any batched commands immediately, rather than waiting for the batching interval to end.
+ */
+- (void)flushBatchedCommands;
+
+/**
+ *  When greater than 0, commands sent to each destination are collected for up to this many seconds,
+ *  then sent together in one packet list, instead of each call to -sendCommands:toDestination:error:
+ *  making its own MIDISend() call. This saves considerable overhead when many small messages are sent
+ *  one at a time, for example when updating the LEDs of a control surface. Commands are delayed by up
+ *  to the interval, so it should be short. 0.001 (1 ms) is a reasonable value.
+ *
+ *  While batching, -sendCommands:toDestination:error: returns YES once commands have been queued.
+ *  Errors sending them later are logged.
+ *
+ *  Setting this to 0 (the default) disables batching, and sends any batched commands.
+ */
+@property (nonatomic) NSTimeInterval batchingInterval;
+
+/**
+ *  When batching, commands for a destination are sent as soon as they add up to at least this many bytes,
+ *  without waiting for the end of the batching interval. The default is 512.
+ */
+@property (nonatomic) NSUInteger maximumBatchLength;
+
+/**
+ *  When batching, if a control change is sent for the same channel, controller and time stamp as one that
+ *  is still waiting to be sent, only the later of the two is sent. The default is YES.
+ *
+ *  A control change is only coalesced if no other message has been sent on its channel since the
+ *  earlier one, apart from other control changes that can be coalesced, so the order of control changes
+ *  and the notes and other messages around them is kept. Bank select (0 and 32), data entry (6 and 38),
+ *  data increment and decrement (96 and 97), parameter number (98 to 101) and channel mode (120 to 127)
+ *  controllers are never coalesced, as they only mean something together with the messages around them.
+ *  Turn this off if a device relies on every value of other controllers being sent.
+ */
+@property (nonatomic) BOOL coalescesControlChangeCommands;
+
+/**
+ *  The time source used to time batching intervals. The default is +[MIKMIDIHostTimeSource hostTimeSource].
+ */
+@property (nonatomic, strong) id<MIKMIDITimeSource> timeSource;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -11,12 +11,36 @@
 #import "MIKMIDIDestinationEndpoint.h"
 #import "MIKMIDICommand.h"
 #import "MIKMIDICommand_SubclassMethods.h"
+#import "MIKMIDIControlChangeCommand.h"
+#import "MIKMIDIPacketListArena.h"
+#import "MIKMIDIPrivateUtilities.h"
+#import "MIKMIDIClock.h"
+#import "MIKMIDIHostTimeSource.h"
 
 #if !__has_feature(objc_arc)
 #error MIKMIDIOutputPort.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIOutputPort.m in the Build Phases for this target
 #endif
 
+#define kMIKMIDIOutputPortDefaultMaximumBatchLength	512
+
+// Commands waiting to be sent to one destination
+@interface MIKMIDIOutputPortBatch : NSObject
+
+- (instancetype)initWithDestination:(MIKMIDIDestinationEndpoint *)destination;
+- (void)addCommand:(MIKMIDICommand *)command coalescingControlChanges:(BOOL)coalesce;
+- (NSArray *)commandsToSend;
+
+@property (nonatomic, strong, readonly) MIKMIDIDestinationEndpoint *destination;
+@property (nonatomic, readonly) NSUInteger length; // Total length of the commands' data
+
+@end
+
 @implementation MIKMIDIOutputPort
+{
+	MIKMIDIPacketListArena *_packetListArena;
+	dispatch_queue_t _batchQueue;
+	NSMutableDictionary *_batchesByDestination; // Keyed by destination endpoint ref. Only accessed on _batchQueue.
+}
 
 - (instancetype)initWithClient:(MIDIClientRef)clientRef name:(NSString *)name
 {
@@ -29,43 +53,209 @@
 											  &port);
 		if (error != noErr) { self = nil; return nil; }
 		self.portRef = port; // MIKMIDIPort will take care of disposing of the port when needed
+		_packetListArena = [[MIKMIDIPacketListArena alloc] init];
+		_batchQueue = dispatch_queue_create("com.mixedinkey.MIKMIDI.MIKMIDIOutputPort.batchQueue", DISPATCH_QUEUE_SERIAL);
+		_batchesByDestination = [NSMutableDictionary dictionary];
+		_maximumBatchLength = kMIKMIDIOutputPortDefaultMaximumBatchLength;
+		_coalescesControlChangeCommands = YES;
+		_timeSource = [MIKMIDIHostTimeSource hostTimeSource];
 	}
 	return self;
 }
 
+- (void)dealloc
+{
+	// Nothing else can be using the batches by now, so there's no need to go through _batchQueue
+	for (MIKMIDIOutputPortBatch *batch in [_batchesByDestination allValues]) {
+		[self flushBatch:batch];
+	}
+}
+
 - (BOOL)sendCommands:(NSArray *)commands toDestination:(MIKMIDIDestinationEndpoint *)destination error:(NSError **)error;
 {
-	commands = [self commandsByTransformingForTransmissionCommands:commands];
+	commands = MIKMIDICommandsByTransformingForTransmission(commands);
 	if (![commands count] || !destination) return NO;
 	
-	error = error ? error : &(NSError *__autoreleasing){ nil };
+	if (self.batchingInterval > 0) {
+		[self addCommands:commands toBatchForDestination:destination];
+		return YES;
+	}
 	
-	MIDIPacketList *packetList;
-	if (!MIKCreateMIDIPacketListFromCommands(&packetList, commands)) return NO;
+	return [self sendTransformedCommands:commands toDestination:destination error:error];
+}
+
+- (BOOL)sendPacketList:(const MIDIPacketList *)packetList toDestination:(MIKMIDIDestinationEndpoint *)destination error:(NSError **)error
+{
+	error = error ? error : &(NSError *__autoreleasing){ nil };
 	
 	OSStatus err = MIDISend(self.portRef, destination.objectRef, packetList);
-	free(packetList);
 	if (err != noErr) {
 		*error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 		return NO;
 	}
-	
 	return YES;
 }
 
+- (void)flushBatchedCommands
+{
+	dispatch_sync(_batchQueue, ^{
+		for (MIKMIDIOutputPortBatch *batch in [self->_batchesByDestination allValues]) {
+			[self flushBatch:batch];
+		}
+	});
+}
+
 #pragma mark - Private
 
-- (NSArray *)commandsByTransformingForTransmissionCommands:(NSArray *)commands
+- (BOOL)sendTransformedCommands:(NSArray *)commands toDestination:(MIKMIDIDestinationEndpoint *)destination error:(NSError **)error
+{
+	__block BOOL success = NO;
+	__block NSError *sendError = nil;
+	BOOL encoded = [_packetListArena encodeCommands:commands usingBlock:^(const MIDIPacketList *packetList) {
+		NSError *blockError = nil;
+		success = [self sendPacketList:packetList toDestination:destination error:&blockError];
+		sendError = blockError;
+	}];
+	if (error && sendError) *error = sendError;
+	return encoded && success;
+}
+
+- (void)addCommands:(NSArray *)commands toBatchForDestination:(MIKMIDIDestinationEndpoint *)destination
+{
+	BOOL coalesce = self.coalescesControlChangeCommands;
+	NSUInteger maximumBatchLength = self.maximumBatchLength;
+	dispatch_sync(_batchQueue, ^{
+		NSNumber *key = @(destination.objectRef);
+		MIKMIDIOutputPortBatch *batch = self->_batchesByDestination[key];
+		if (!batch) {
+			batch = [[MIKMIDIOutputPortBatch alloc] initWithDestination:destination];
+			self->_batchesByDestination[key] = batch;
+			[self scheduleFlushOfBatch:batch];
+		}
+		for (MIKMIDICommand *command in commands) {
+			// Copied so later changes to a mutable command don't change what's sent
+			[batch addCommand:[command copy] coalescingControlChanges:coalesce];
+		}
+		if (batch.length >= maximumBatchLength) [self flushBatch:batch];
+	});
+}
+
+// Must be called on _batchQueue
+- (void)scheduleFlushOfBatch:(MIKMIDIOutputPortBatch *)batch
 {
-	NSMutableArray *transformedCommands = [NSMutableArray array];
-	for (MIKMIDICommand *command in commands) {
-		if ([command respondsToSelector:@selector(commandsForTransmission)]) {
-			[transformedCommands addObjectsFromArray:[command commandsForTransmission]];
-		} else {
-			[transformedCommands addObject:command];
+	id<MIKMIDITimeSource> timeSource = self.timeSource;
+	MIDITimeStamp flushTimeStamp = timeSource.currentMIDITimeStamp + MIKMIDIClockMIDITimeStampsPerTimeInterval(self.batchingInterval);
+	__weak typeof(self) weakSelf = self;
+	[timeSource dispatchAtMIDITimeStamp:flushTimeStamp queue:_batchQueue block:^{
+		[weakSelf flushBatch:batch];
+	}];
+}
+
+// Must be called on _batchQueue. Does nothing if batch has already been sent.
+- (void)flushBatch:(MIKMIDIOutputPortBatch *)batch
+{
+	MIKMIDIDestinationEndpoint *destination = batch.destination;
+	NSNumber *key = @(destination.objectRef);
+	if (_batchesByDestination[key] != batch) return;
+	[_batchesByDestination removeObjectForKey:key];
+	
+	NSError *error = nil;
+	if (![self sendTransformedCommands:[batch commandsToSend] toDestination:destination error:&error]) {
+		NSLog(@"Sending batched MIDI commands to %@ failed with error %@ in %s.", destination, error, __PRETTY_FUNCTION__);
+	}
+}
+
+#pragma mark - Properties
+
+- (void)setBatchingInterval:(NSTimeInterval)batchingInterval
+{
+	_batchingInterval = batchingInterval;
+	if (batchingInterval <= 0) [self flushBatchedCommands];
+}
+
+@end
+
+// Bank select, data entry, data increment/decrement and parameter number (RPN/NRPN) controllers only mean
+// something together with the messages around them, so every one of them is sent, even when repeated.
+// Channel mode messages (120 to 127) act on the notes and controllers around them, so they aren't coalesced either.
+static BOOL MIKMIDIOutputPortCanCoalesceController(UInt8 controllerNumber)
+{
+	if (controllerNumber >= 120) return NO;
+	switch (controllerNumber) {
+		case 0:		// Bank select MSB
+		case 32:	// Bank select LSB
+		case 6:		// Data entry MSB
+		case 38:	// Data entry LSB
+		case 96:	// Data increment
+		case 97:	// Data decrement
+		case 98:	// NRPN LSB
+		case 99:	// NRPN MSB
+		case 100:	// RPN LSB
+		case 101:	// RPN MSB
+			return NO;
+		default:
+			return YES;
+	}
+}
+
+@implementation MIKMIDIOutputPortBatch
+{
+	NSMutableArray *_commands; // NSNull where a control change was replaced by a later one
+	NSMutableDictionary *_controlChangeIndexes; // Keyed by status byte << 8 | controller number
+	NSInteger _lastNonCoalescableCommandIndexes[16]; // For each channel, -1 if there isn't one
+}
+
+- (instancetype)initWithDestination:(MIKMIDIDestinationEndpoint *)destination
+{
+	self = [super init];
+	if (self) {
+		_destination = destination;
+		_commands = [NSMutableArray array];
+		_controlChangeIndexes = [NSMutableDictionary dictionary];
+		for (NSUInteger i = 0; i < 16; i++) _lastNonCoalescableCommandIndexes[i] = -1;
+	}
+	return self;
+}
+
+- (void)addCommand:(MIKMIDICommand *)command coalescingControlChanges:(BOOL)coalesce
+{
+	NSData *data = command.internalData;
+	const UInt8 *bytes = [data bytes];
+	BOOL isChannelMessage = [data length] > 0 && bytes[0] >= 0x80 && bytes[0] < 0xF0;
+	if (coalesce && [data length] == 3 && (bytes[0] & 0xF0) == 0xB0 && MIKMIDIOutputPortCanCoalesceController(bytes[1])) {
+		NSNumber *key = @((bytes[0] << 8) | bytes[1]);
+		NSNumber *previousIndex = _controlChangeIndexes[key];
+		MIKMIDICommand *previousCommand = previousIndex ? _commands[[previousIndex unsignedIntegerValue]] : nil;
+		// Only replace the earlier value if nothing but other coalescable control changes has been sent on
+		// the channel since, so moving it to the later position can't change how other messages are played.
+		// For example, a sustain pedal change must stay on the same side of the notes sent after it.
+		// Values scheduled for different times are all wanted, so only values for the same time are coalesced.
+		if (previousCommand && previousCommand.midiTimestamp == command.midiTimestamp &&
+			_lastNonCoalescableCommandIndexes[bytes[0] & 0x0F] < [previousIndex integerValue]) {
+			_length -= [previousCommand.internalData length];
+			_commands[[previousIndex unsignedIntegerValue]] = [NSNull null];
 		}
+		_controlChangeIndexes[key] = @([_commands count]);
+	} else if (isChannelMessage) {
+		_lastNonCoalescableCommandIndexes[bytes[0] & 0x0F] = [_commands count];
+	}
+	[_commands addObject:command];
+	_length += [data length];
+}
+
+- (NSArray *)commandsToSend
+{
+	NSMutableArray *result = [NSMutableArray arrayWithCapacity:[_commands count]];
+	for (id command in _commands) {
+		if (command != [NSNull null]) [result addObject:command];
 	}
-	return transformedCommands;
+	// Packets in a packet list must be in time order. The sort is stable so messages with the same time stamp stay in order.
+	[result sortWithOptions:NSSortStable usingComparator:^NSComparisonResult(MIKMIDICommand *command1, MIKMIDICommand *command2) {
+		if (command1.midiTimestamp < command2.midiTimestamp) return NSOrderedAscending;
+		if (command1.midiTimestamp > command2.midiTimestamp) return NSOrderedDescending;
+		return NSOrderedSame;
+	}];
+	return result;
 }
 
 @end
@@ -0,0 +1,52 @@
+//
+//  MIKMIDIPacketListArena.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMIDI/CoreMIDI.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDICommand;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  MIKMIDIPacketListArena builds MIDIPacketLists for sending without allocating memory.
+ *
+ *  Lists are built on the stack, which is enough for the handful of messages in a typical send.
+ *  A list that outgrows it is moved to a buffer owned by the arena, which grows as needed and is
+ *  reused for subsequent sends. If that buffer is already in use by another thread, or the list
+ *  is too big to be worth keeping a buffer for, a temporary buffer is allocated instead.
+ *
+ *  MIKMIDIOutputPort and MIKMIDIClientSourceEndpoint each have an arena.
+ *
+ *  @note This class is for internal MIKMIDI use only.
+ */
+@interface MIKMIDIPacketListArena : NSObject
+
+/**
+ *  Encodes commands into a MIDIPacketList and calls block with it. Commands with the same
+ *  time stamp are combined into one packet, except for system exclusive messages.
+ *
+ *  Safe to call from multiple threads at once.
+ *
+ *  @param commands An array of MIKMIDICommands.
+ *  @param block    A block to call with the packet list. The packet list is only valid until block returns.
+ *
+ *  @return YES if the commands were encoded and block was called, NO otherwise.
+ */
+- (BOOL)encodeCommands:(MIKArrayOf(MIKMIDICommand *) *)commands usingBlock:(void (^)(const MIDIPacketList *packetList))block;
+
+/**
+ *  The number of times a temporary buffer had to be allocated, because a packet list outgrew
+ *  the stack and the arena's buffer was in use or too small to grow into.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfTemporaryAllocations;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,138 @@
+//
+//  MIKMIDIPacketListArena.m
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIPacketListArena.h"
+#import <stdatomic.h>
+#import "MIKMIDICommand.h"
+#import "MIKMIDICommand_SubclassMethods.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDIPacketListArena.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIPacketListArena.m in the Build Phases for this target
+#endif
+
+#define kMIKMIDIPacketListArenaStackBufferSize	1024
+#define kMIKMIDIPacketListArenaMinimumBufferSize	4096
+#define kMIKMIDIPacketListArenaMaximumBufferSize	65536
+
+// Where the packet list being built currently lives
+typedef struct {
+	ByteCount size;
+	BOOL isUsingBuffer;
+	BOOL isTemporary;
+} MIKMIDIPacketListArenaList;
+
+@implementation MIKMIDIPacketListArena
+{
+	atomic_flag _bufferInUse;
+	MIDIPacketList *_buffer;
+	ByteCount _bufferSize;
+	atomic_ulong _numberOfTemporaryAllocations;
+}
+
+- (instancetype)init
+{
+	self = [super init];
+	if (self) {
+		atomic_flag_clear(&_bufferInUse);
+		atomic_init(&_numberOfTemporaryAllocations, 0);
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	free(_buffer);
+}
+
+- (BOOL)encodeCommands:(NSArray *)commands usingBlock:(void (^)(const MIDIPacketList *))block
+{
+	if (![commands count]) return NO;
+
+	// Start on the stack, and move somewhere bigger only when a command doesn't fit, so commands are only gone through once
+	UInt64 stackBuffer[kMIKMIDIPacketListArenaStackBufferSize / sizeof(UInt64)]; // UInt64 for alignment
+	MIDIPacketList *packetList = (MIDIPacketList *)stackBuffer;
+	MIKMIDIPacketListArenaList list = {sizeof(stackBuffer), NO, NO};
+
+	BOOL success = YES;
+	MIDIPacket *currentPacket = MIDIPacketListInit(packetList);
+	for (MIKMIDICommand *command in commands) {
+		NSData *data = command.internalData; // Not data, which would copy it
+		MIDIPacket *packet = MIDIPacketListAdd(packetList, list.size, currentPacket, command.midiTimestamp, [data length], [data bytes]);
+		if (!packet) {
+			ByteCount currentPacketOffset = (Byte *)currentPacket - (Byte *)packetList;
+			ByteCount usedSize = currentPacketOffset + (packetList->numPackets ? offsetof(MIDIPacket, data) + currentPacket->length : 0);
+			// The command may need a packet of its own, padded to 4-byte alignment (see MIDIPacketNext())
+			ByteCount minimumSize = usedSize + offsetof(MIDIPacket, data) + [data length] + 3;
+			packetList = [self growPacketList:packetList usedSize:usedSize minimumSize:minimumSize list:&list];
+			if (!packetList) { success = NO; break; }
+
+			currentPacket = (MIDIPacket *)((Byte *)packetList + currentPacketOffset);
+			packet = MIDIPacketListAdd(packetList, list.size, currentPacket, command.midiTimestamp, [data length], [data bytes]);
+			if (!packet) { success = NO; break; } // Too big for a packet at all
+		}
+		currentPacket = packet;
+	}
+
+	if (success) block(packetList);
+
+	if (list.isTemporary) free(packetList);
+	if (list.isUsingBuffer) atomic_flag_clear_explicit(&_bufferInUse, memory_order_release);
+	return success;
+}
+
+// Moves a packet list that's run out of room to one at least minimumSize bytes long, keeping its first usedSize bytes.
+// That's the arena's buffer if it's free and the list isn't too big for it, otherwise a temporary buffer.
+// Returns NULL if no memory could be had, freeing the list if it was temporary.
+- (MIDIPacketList *)growPacketList:(MIDIPacketList *)packetList usedSize:(ByteCount)usedSize minimumSize:(ByteCount)minimumSize list:(MIKMIDIPacketListArenaList *)list
+{
+	if (!list->isTemporary && minimumSize <= kMIKMIDIPacketListArenaMaximumBufferSize &&
+		(list->isUsingBuffer || !atomic_flag_test_and_set_explicit(&_bufferInUse, memory_order_acquire))) {
+		BOOL wasUsingBuffer = list->isUsingBuffer;
+		list->isUsingBuffer = YES;
+		if (minimumSize > _bufferSize) {
+			ByteCount bufferSize = MAX(MAX(minimumSize, 2 * _bufferSize), kMIKMIDIPacketListArenaMinimumBufferSize);
+			bufferSize = MIN(bufferSize, kMIKMIDIPacketListArenaMaximumBufferSize);
+			MIDIPacketList *buffer = realloc(_buffer, bufferSize); // Keeps the list if it's already in the buffer
+			if (buffer) {
+				_buffer = buffer;
+				_bufferSize = bufferSize;
+			}
+			if (wasUsingBuffer) packetList = _buffer;
+		}
+		if (minimumSize <= _bufferSize) {
+			if (!wasUsingBuffer) memcpy(_buffer, packetList, usedSize);
+			list->size = _bufferSize;
+			return _buffer;
+		}
+	}
+
+	ByteCount size = MAX(minimumSize, 2 * list->size);
+	if (list->isTemporary) {
+		MIDIPacketList *temporaryList = realloc(packetList, size);
+		if (!temporaryList) free(packetList);
+		list->size = size;
+		return temporaryList;
+	}
+
+	MIDIPacketList *temporaryList = malloc(size);
+	if (!temporaryList) return NULL;
+	memcpy(temporaryList, packetList, usedSize);
+	atomic_fetch_add_explicit(&_numberOfTemporaryAllocations, 1, memory_order_relaxed);
+	list->size = size;
+	list->isTemporary = YES;
+	return temporaryList;
+}
+
+#pragma mark - Properties
+
+- (NSUInteger)numberOfTemporaryAllocations
+{
+	return atomic_load_explicit(&_numberOfTemporaryAllocations, memory_order_relaxed);
+}
+
+@end
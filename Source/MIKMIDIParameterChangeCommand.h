@@ -0,0 +1,112 @@
+//
+//  MIKMIDIParameterChangeCommand.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIChannelVoiceCommand.h"
+#import "MIKMIDICompilerCompatibility.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  The kinds of parameter numbers a parameter change can address.
+ */
+typedef NS_ENUM(NSInteger, MIKMIDIParameterType) {
+	/** A Registered Parameter Number (RPN), selected with control changes 101 and 100. */
+	MIKMIDIParameterTypeRegistered,
+	/** A Non-Registered Parameter Number (NRPN), selected with control changes 99 and 98. */
+	MIKMIDIParameterTypeNonRegistered,
+};
+
+/**
+ *  A change to a Registered (RPN) or Non-Registered (NRPN) Parameter Number.
+ *
+ *  In MIDI 1.0, a parameter change is made of several control change messages: two select the
+ *  parameter, and one or two more set its value (data entry, control changes 6 and 38), or step
+ *  it up or down (data increment and decrement, control changes 96 and 97). When its
+ *  coalescesParameterNumberCommands property is set, MIKMIDIInputPort assembles these into a
+ *  single MIKMIDIParameterChangeCommand.
+ *
+ *  The command's data is the complete sequence of control change messages, so it can be sent
+ *  like any other command.
+ *
+ *  @see -[MIKMIDIInputPort coalescesParameterNumberCommands]
+ */
+@interface MIKMIDIParameterChangeCommand : MIKMIDIChannelVoiceCommand
+
+/**
+ *  Convenience method for creating a parameter change that sets a parameter's value.
+ *
+ *  @param parameterType   Whether the parameter is registered or non-registered.
+ *  @param parameterNumber The 14-bit parameter number.
+ *  @param value           The 14-bit value to set the parameter to.
+ *
+ *  @return An initialized MIKMIDIParameterChangeCommand instance.
+ */
++ (instancetype)parameterChangeCommandWithParameterType:(MIKMIDIParameterType)parameterType parameterNumber:(UInt16)parameterNumber value:(UInt16)value;
+
+/**
+ *  Whether the parameter is a Registered (RPN) or Non-Registered (NRPN) Parameter Number.
+ */
+@property (nonatomic, readonly) MIKMIDIParameterType parameterType;
+
+/**
+ *  The 14-bit parameter number (0-16383).
+ */
+@property (nonatomic, readonly) UInt16 parameterNumber;
+
+/**
+ *  The 14-bit value the parameter is set to (0-16383). If only the most significant 7 bits were
+ *  received (data entry MSB, control change 6), the 7 least significant bits are 0, and
+ *  hasFineValue is NO. 0 for increments and decrements.
+ */
+@property (nonatomic, readonly) NSUInteger value;
+
+/**
+ *  YES if the value's 7 least significant bits (data entry LSB, control change 38) are included.
+ */
+@property (nonatomic, readonly) BOOL hasFineValue;
+
+/**
+ *  For a data increment (control change 96), the positive number of steps to increment the
+ *  parameter by. For a data decrement (control change 97), the negative number of steps.
+ *  0 if the command sets the parameter's value.
+ *
+ *  Many devices ignore the data byte of increments and decrements, and step by one. A data byte
+ *  of 0 is treated as one step.
+ */
+@property (nonatomic, readonly) NSInteger dataIncrement;
+
+@end
+
+/**
+ *  The mutable counterpart of MIKMIDIParameterChangeCommand.
+ */
+@interface MIKMutableMIDIParameterChangeCommand : MIKMIDIParameterChangeCommand
+
+@property (nonatomic, readwrite) MIKMIDIParameterType parameterType;
+@property (nonatomic, readwrite) UInt16 parameterNumber;
+
+/**
+ *  Setting this makes the command set the parameter's value, with hasFineValue set to YES.
+ */
+@property (nonatomic, readwrite) NSUInteger value;
+@property (nonatomic, readwrite) UInt32 highResolutionValue;
+
+/**
+ *  Setting this to a non-zero value makes the command a data increment or decrement.
+ *  Values are clamped to -127...127.
+ */
+@property (nonatomic, readwrite) NSInteger dataIncrement;
+
+@property (nonatomic, readwrite) UInt8 channel;
+
+@property (nonatomic, strong, readwrite) NSDate *timestamp;
+@property (nonatomic, readwrite) MIDITimeStamp midiTimestamp;
+
+@end
+
+NS_ASSUME_NONNULL_END
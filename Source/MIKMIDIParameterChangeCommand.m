@@ -0,0 +1,194 @@
+//
+//  MIKMIDIParameterChangeCommand.m
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDIParameterChangeCommand.h"
+#import "MIKMIDIChannelVoiceCommand_SubclassMethods.h"
+#import "MIKMIDIUtilities.h"
+#import "MIKMIDIUniversalPacket.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDIParameterChangeCommand.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDIParameterChangeCommand.m in the Build Phases for this target
+#endif
+
+// The command's data is the control change messages that make it up:
+// parameter number MSB, parameter number LSB, then data entry MSB and LSB, or data increment or decrement.
+#define kMIKMIDIParameterChangeDataEntryLength		12
+#define kMIKMIDIParameterChangeDataIncrementLength	9
+
+static NSMutableData *MIKMIDIParameterChangeCreateData(UInt8 channel, MIKMIDIParameterType parameterType, UInt16 parameterNumber, NSInteger dataIncrement, NSUInteger value)
+{
+	UInt8 status = 0xB0 | (channel & 0x0F);
+	BOOL isRegistered = (parameterType == MIKMIDIParameterTypeRegistered);
+	UInt8 bytes[kMIKMIDIParameterChangeDataEntryLength] = {
+		status, isRegistered ? 101 : 99, (parameterNumber >> 7) & 0x7F,
+		status, isRegistered ? 100 : 98, parameterNumber & 0x7F,
+		status, 6, (value >> 7) & 0x7F,
+		status, 38, value & 0x7F,
+	};
+	if (!dataIncrement) return [NSMutableData dataWithBytes:bytes length:kMIKMIDIParameterChangeDataEntryLength];
+
+	bytes[7] = (dataIncrement > 0) ? 96 : 97;
+	bytes[8] = MIN(labs(dataIncrement), 127);
+	return [NSMutableData dataWithBytes:bytes length:kMIKMIDIParameterChangeDataIncrementLength];
+}
+
+@implementation MIKMIDIParameterChangeCommand
+
+// Not registered with MIKMIDICommand, because these are made of control change messages, which
+// MIKMIDIControlChangeCommand handles. They're only created by MIKMIDIInputPort, or directly.
++ (Class)immutableCounterpartClass; { return [MIKMIDIParameterChangeCommand class]; }
++ (Class)mutableCounterpartClass; { return [MIKMutableMIDIParameterChangeCommand class]; }
+
++ (instancetype)parameterChangeCommandWithParameterType:(MIKMIDIParameterType)parameterType parameterNumber:(UInt16)parameterNumber value:(UInt16)value
+{
+	MIKMutableMIDIParameterChangeCommand *command = [[[self mutableCounterpartClass] alloc] init];
+	command.parameterType = parameterType;
+	command.parameterNumber = parameterNumber;
+	command.value = value;
+	if (![[self class] isMutable]) { command = [command copy]; }
+	return command;
+}
+
+- (instancetype)initWithMIDIPacket:(MIDIPacket *)packet
+{
+	self = [super initWithMIDIPacket:packet];
+	if (self && !packet) {
+		self.internalData = MIKMIDIParameterChangeCreateData(0, MIKMIDIParameterTypeNonRegistered, 0, 0, 0);
+	}
+	return self;
+}
+
+- (NSString *)additionalCommandDescription
+{
+	NSString *type = (self.parameterType == MIKMIDIParameterTypeRegistered) ? @"RPN" : @"NRPN";
+	if (self.dataIncrement) {
+		return [NSString stringWithFormat:@"%@ %@ %lu increment: %ld", [super additionalCommandDescription], type, (unsigned long)self.parameterNumber, (long)self.dataIncrement];
+	}
+	return [NSString stringWithFormat:@"%@ %@ %lu value: %lu fine? %i", [super additionalCommandDescription], type, (unsigned long)self.parameterNumber, (unsigned long)self.value, self.hasFineValue];
+}
+
+// In MIDI 2.0, a parameter change is a single message, with a 32-bit value
+- (NSData *)universalMIDIPacketDataWithProtocol:(MIKMIDIProtocol)protocol group:(UInt8)group
+{
+	if (protocol != MIKMIDIProtocol2_0 || ![self parameterChangeBytes]) return [super universalMIDIPacketDataWithProtocol:protocol group:group];
+
+	BOOL isRegistered = (self.parameterType == MIKMIDIParameterTypeRegistered);
+	NSInteger dataIncrement = self.dataIncrement;
+	UInt8 opcode;
+	UInt32 value;
+	if (dataIncrement) {
+		opcode = isRegistered ? MIKMIDIUniversalOpcodeRelativeRegisteredController : MIKMIDIUniversalOpcodeRelativeAssignableController;
+		value = (UInt32)(SInt32)dataIncrement;
+	} else {
+		opcode = isRegistered ? MIKMIDIUniversalOpcodeRegisteredController : MIKMIDIUniversalOpcodeAssignableController;
+		value = self.highResolutionValue;
+	}
+	UInt16 parameterNumber = self.parameterNumber;
+	MIKMIDIUniversalMessage message = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(group, opcode | self.channel, (parameterNumber >> 7) & 0x7F, parameterNumber & 0x7F, value);
+	return [NSData dataWithBytes:message.words length:MIKMIDIUniversalMessageWordCountForType(MIKMIDIUniversalMessageTypeMIDI2ChannelVoice) * sizeof(UInt32)];
+}
+
+#pragma mark - Private
+
+- (const UInt8 *)parameterChangeBytes
+{
+	if ([self.internalData length] < kMIKMIDIParameterChangeDataIncrementLength) return NULL;
+	return [self.internalData bytes];
+}
+
+- (void)replaceDataWithChannel:(UInt8)channel parameterType:(MIKMIDIParameterType)parameterType parameterNumber:(UInt16)parameterNumber dataIncrement:(NSInteger)dataIncrement value:(NSUInteger)value
+{
+	if (![[self class] isMutable]) return MIKMIDI_RAISE_MUTATION_ATTEMPT_EXCEPTION;
+
+	self.internalData = MIKMIDIParameterChangeCreateData(channel, parameterType, parameterNumber, dataIncrement, value);
+}
+
+#pragma mark - Properties
+
+- (MIKMIDIParameterType)parameterType
+{
+	const UInt8 *bytes = [self parameterChangeBytes];
+	return (bytes && bytes[1] == 101) ? MIKMIDIParameterTypeRegistered : MIKMIDIParameterTypeNonRegistered;
+}
+
+- (void)setParameterType:(MIKMIDIParameterType)parameterType
+{
+	[self replaceDataWithChannel:self.channel parameterType:parameterType parameterNumber:self.parameterNumber dataIncrement:self.dataIncrement value:self.value];
+}
+
+- (UInt16)parameterNumber
+{
+	const UInt8 *bytes = [self parameterChangeBytes];
+	if (!bytes) return 0;
+	return ((bytes[2] & 0x7F) << 7) | (bytes[5] & 0x7F);
+}
+
+- (void)setParameterNumber:(UInt16)parameterNumber
+{
+	[self replaceDataWithChannel:self.channel parameterType:self.parameterType parameterNumber:parameterNumber dataIncrement:self.dataIncrement value:self.value];
+}
+
+- (NSUInteger)value
+{
+	const UInt8 *bytes = [self parameterChangeBytes];
+	if (!bytes || bytes[7] != 6) return 0;
+	NSUInteger LSB = self.hasFineValue ? (bytes[11] & 0x7F) : 0;
+	return ((bytes[8] & 0x7F) << 7) | LSB;
+}
+
+- (void)setValue:(NSUInteger)value
+{
+	[self replaceDataWithChannel:self.channel parameterType:self.parameterType parameterNumber:self.parameterNumber dataIncrement:0 value:MIN(value, 0x3FFF)];
+}
+
+- (UInt8)lowResolutionValueBitCount { return 14; }
+
+- (BOOL)hasFineValue
+{
+	return [self.internalData length] >= kMIKMIDIParameterChangeDataEntryLength;
+}
+
+- (NSInteger)dataIncrement
+{
+	const UInt8 *bytes = [self parameterChangeBytes];
+	if (!bytes || (bytes[7] != 96 && bytes[7] != 97)) return 0;
+	NSInteger steps = MAX(bytes[8] & 0x7F, 1);
+	return (bytes[7] == 96) ? steps : -steps;
+}
+
+- (void)setDataIncrement:(NSInteger)dataIncrement
+{
+	[self replaceDataWithChannel:self.channel parameterType:self.parameterType parameterNumber:self.parameterNumber dataIncrement:dataIncrement value:0];
+}
+
+- (void)setChannel:(UInt8)channel
+{
+	[self replaceDataWithChannel:channel parameterType:self.parameterType parameterNumber:self.parameterNumber dataIncrement:self.dataIncrement value:self.value];
+}
+
+@end
+
+#pragma mark -
+
+@implementation MIKMutableMIDIParameterChangeCommand
+
++ (BOOL)isMutable { return YES; }
+
+#pragma mark - Properties
+
+// MIKMIDIParameterChangeCommand already implements a getter *and* setter for these. @dynamic keeps the compiler happy.
+@dynamic parameterType;
+@dynamic parameterNumber;
+@dynamic value;
+@dynamic highResolutionValue;
+@dynamic dataIncrement;
+@dynamic channel;
+@dynamic timestamp;
+@dynamic midiTimestamp;
+
+@end
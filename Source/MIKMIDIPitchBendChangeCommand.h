@@ -33,6 +33,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, readwrite) UInt8 channel;
 @property (nonatomic, readwrite) NSUInteger value;
+@property (nonatomic, readwrite) UInt32 highResolutionValue;
 
 @property (nonatomic, strong, readwrite) NSDate *timestamp;
 @property (nonatomic, readwrite) MIKMIDICommandType commandType;
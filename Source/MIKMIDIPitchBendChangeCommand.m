@@ -49,6 +49,10 @@
 	self.dataByte2 = (pitchChange & 0x3F80) >> 7;
 }
 
+- (UInt8)lowResolutionValueBitCount { return 14; }
+- (NSUInteger)lowResolutionValue { return self.pitchChange; }
+- (void)setLowResolutionValue:(NSUInteger)value { self.pitchChange = (UInt16)value; }
+
 @end
 
 #pragma mark -
@@ -69,6 +73,7 @@
 // MIKMIDICommand already implements these. This keeps the compiler happy.
 @dynamic channel;
 @dynamic value;
+@dynamic highResolutionValue;
 @dynamic timestamp;
 @dynamic dataByte1;
 @dynamic dataByte2;
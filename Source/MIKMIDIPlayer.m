@@ -15,6 +15,7 @@
 #import "MIKMIDINoteEvent.h"
 #import "MIKMIDIClientDestinationEndpoint.h"
 #import "MIKMIDITempoEvent.h"
+#import "MIKMIDITempoMap.h"
 #import "MIKMIDIMetaTimeSignatureEvent.h"
 
 #if !__has_feature(objc_arc)
@@ -92,10 +93,7 @@
     if (err) return NSLog(@"MusicPlayerSetTime() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 
     Float64 sequenceDuration = self.sequence.durationInSeconds;
-    Float64 positionInTime;
-
-    err = MusicSequenceGetSecondsForBeats(self.sequence.musicSequence, position, &positionInTime);
-    if (err) return NSLog(@"MusicSequenceGetSecondsForBeats() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
+    Float64 positionInTime = [self.sequence.tempoMap secondsForTimeStamp:position];
 
     err = MusicPlayerStart(self.musicPlayer);
     if (err) return NSLog(@"MusicPlayerStart() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
@@ -59,6 +59,7 @@
 // MIKMIDICommand already implements these. This keeps the compiler happy.
 @dynamic channel;
 @dynamic value;
+@dynamic highResolutionValue;
 @dynamic timestamp;
 @dynamic dataByte1;
 @dynamic dataByte2;
@@ -16,4 +16,8 @@ NS_ASSUME_NONNULL_BEGIN
 NSUInteger MIKMIDIControlNumberFromCommand(MIKMIDIChannelVoiceCommand *command);
 float MIKMIDIControlValueFromChannelVoiceCommand(MIKMIDIChannelVoiceCommand *command);
 
+// Replaces commands that must be sent as several messages (e.g. 14-bit control changes) with those messages.
+// Returns commands itself if none of them need to be transformed, to save allocating a new array for every send.
+NSArray *MIKMIDICommandsByTransformingForTransmission(NSArray *commands);
+
 NS_ASSUME_NONNULL_END
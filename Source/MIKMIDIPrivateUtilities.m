@@ -8,6 +8,7 @@
 
 #import "MIKMIDIPrivateUtilities.h"
 #import "MIKMIDIChannelVoiceCommand.h"
+#import "MIKMIDICommand_SubclassMethods.h"
 #import "MIKMIDIControlChangeCommand.h"
 #import "MIKMIDINoteOnCommand.h"
 
@@ -31,4 +32,27 @@ float MIKMIDIControlValueFromChannelVoiceCommand(MIKMIDIChannelVoiceCommand *com
 	}
 	
 	return (float)command.value;
-}
\ No newline at end of file
+}
+
+NSArray *MIKMIDICommandsByTransformingForTransmission(NSArray *commands)
+{
+	NSMutableArray *transformedCommands = nil;
+	NSUInteger index = 0;
+	for (MIKMIDICommand *command in commands) {
+		BOOL isTransformed = [command respondsToSelector:@selector(commandsForTransmission)];
+		// 7-bit control changes are sent as is. Checking first saves creating an array for each of them.
+		if (isTransformed && [command isKindOfClass:[MIKMIDIControlChangeCommand class]]) {
+			isTransformed = [(MIKMIDIControlChangeCommand *)command isFourteenBitCommand];
+		}
+		if (isTransformed && !transformedCommands) {
+			transformedCommands = [NSMutableArray arrayWithArray:[commands subarrayWithRange:NSMakeRange(0, index)]];
+		}
+		if (isTransformed) {
+			[transformedCommands addObjectsFromArray:[command commandsForTransmission]];
+		} else {
+			[transformedCommands addObject:command];
+		}
+		index++;
+	}
+	return transformedCommands ?: commands;
+}
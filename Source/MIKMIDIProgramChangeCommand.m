@@ -44,6 +44,11 @@
 	self.dataByte1 = (UInt8)value;
 }
 
+// MIDI 2.0 program numbers are still 7 bits
++ (UInt8)highResolutionValueBitCount { return 7; }
+- (NSUInteger)lowResolutionValue { return self.programNumber; }
+- (void)setLowResolutionValue:(NSUInteger)value { self.programNumber = value; }
+
 @dynamic channel; // MIKMIDIChannelVoiceCommand already implements a getter *and* setter for this. This keeps the compiler happy.
 
 @end
@@ -57,6 +62,7 @@
 // One of the super classes already implements a getter *and* setter for these. @dynamic keeps the compiler happy.
 @dynamic channel;
 @dynamic value;
+@dynamic highResolutionValue;
 @dynamic programNumber;
 
 @end
\ No newline at end of file
@@ -17,6 +17,12 @@ NS_ASSUME_NONNULL_BEGIN
 
 @property (nonatomic, weak, readwrite, nullable) MIKMIDISequencer *sequencer;
 
+/**
+ *  The MusicSequence backing the receiver. Unlike -musicSequence, this does not cause
+ *  lazily loaded tracks to load their events.
+ */
+@property (nonatomic, readonly) MusicSequence underlyingMusicSequence;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -16,9 +16,48 @@
 @class MIKMIDIDestinationEndpoint;
 @class MIKMIDIMetaTimeSignatureEvent;
 @class MIKMIDITempoEvent;
+@class MIKMIDITempoMap;
 
 NS_ASSUME_NONNULL_BEGIN
 
+/**
+ *  Bit-mask constants used to control how MIKMIDISequence loads MIDI files.
+ *  Multiple options can be specified by ORing them together.
+ */
+typedef NS_OPTIONS(NSUInteger, MIKMIDISequenceLoadingOptions) {
+	/**
+	 *  Load the file as-is, decoding all events up front.
+	 */
+	MIKMIDISequenceLoadingOptionNone = 0,
+	
+	/**
+	 *  Alter the track structure of the file. The resulting sequence will contain a tempo track,
+	 *  1 track for each MIDI Channel that is found in the MIDI file, and 1 track for SysEx or MetaEvents
+	 *  as the last track in the sequence.
+	 */
+	MIKMIDISequenceLoadingOptionConvertMIDIChannelsToTracks = 1 << 0,
+	
+	/**
+	 *  Defer decoding each track's events until they're first needed. The tempo track, track names,
+	 *  track lengths, and the sequence's duration are available immediately, but a track's events
+	 *  are only decoded when they (or the track's musicTrack) are accessed, or the track is modified.
+	 *  Files loaded from a URL with this option are memory mapped when possible instead of being read into memory.
+	 *
+	 *  This option is ignored when combined with MIKMIDISequenceLoadingOptionConvertMIDIChannelsToTracks,
+	 *  and for files whose timing is specified in SMPTE frames.
+	 */
+	MIKMIDISequenceLoadingOptionLazy = 1 << 1,
+	
+	/**
+	 *  Decode the file's tracks concurrently, using up to one thread per active processor.
+	 *  This speeds up loading files with many tracks. The resulting sequence is identical
+	 *  to one loaded without this option.
+	 *
+	 *  This option has no effect when combined with MIKMIDISequenceLoadingOptionLazy.
+	 */
+	MIKMIDISequenceLoadingOptionConcurrentDecoding = 1 << 2,
+};
+
 /**
  *  Instances of MIKMIDISequence contain a collection of MIDI tracks. MIKMIDISequences may be thought
  *  of as MIDI "songs". They can be loaded from and saved to MIDI files. They can also be played
@@ -86,6 +125,30 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable instancetype)initWithFileAtURL:(NSURL *)fileURL convertMIDIChannelsToTracks:(BOOL)convertMIDIChannelsToTracks error:(NSError **)error;
 
+/**
+ *  Creates and initilazes a new instance of MIKMIDISequence from a MIDI file.
+ *
+ *  @param fileURL The URL of the MIDI file.
+ *  @param options Options controlling how the file is loaded. See MIKMIDISequenceLoadingOptions.
+ *  @param error If an error occurs, upon returns contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return A new instance of MIKMIDISequence containing the loaded file's MIDI sequence, or nil if an error occured.
+ */
++ (nullable instancetype)sequenceWithFileAtURL:(NSURL *)fileURL options:(MIKMIDISequenceLoadingOptions)options error:(NSError **)error;
+
+/**
+ *  Initilazes a new instance of MIKMIDISequence from a MIDI file.
+ *
+ *  @param fileURL The URL of the MIDI file.
+ *  @param options Options controlling how the file is loaded. See MIKMIDISequenceLoadingOptions.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return A new instance of MIKMIDISequence containing the loaded file's MIDI sequence, or nil if an error occured.
+ */
+- (nullable instancetype)initWithFileAtURL:(NSURL *)fileURL options:(MIKMIDISequenceLoadingOptions)options error:(NSError **)error;
+
 /**
  *  Creates and initializes a new instance of MIKMIDISequence from MIDI data.
  *
@@ -136,6 +199,19 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (nullable instancetype)initWithData:(NSData *)data convertMIDIChannelsToTracks:(BOOL)convertMIDIChannelsToTracks error:(NSError **)error;
 
+/**
+ *  Initializes a new instance of MIKMIDISequence from MIDI data.
+ *
+ *  @param data  An NSData instance containing the data for the MIDI sequence/file. When loading lazily,
+ *  the data is retained, not copied, and must not be mutated afterwards.
+ *  @param options Options controlling how the data is loaded. See MIKMIDISequenceLoadingOptions.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return A new instance of MIKMIDISequence, or nil if an error occured.
+ */
+- (nullable instancetype)initWithData:(NSData *)data options:(MIKMIDISequenceLoadingOptions)options error:(NSError **)error;
+
 /**
  *  Writes the MIDI sequence in Standard MIDI File format to a file at the specified URL.
  *
@@ -147,6 +223,20 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (BOOL)writeToURL:(NSURL *)fileURL error:(NSError **)error;
 
+/**
+ *  Writes the MIDI sequence in Standard MIDI File format to an output stream.
+ *
+ *  The file is written as it is generated, a small buffer at a time, so the whole file is
+ *  never held in memory at once.
+ *
+ *  @param stream The stream to write the MIDI file to. It is opened if it isn't already open, and is left open.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors,
+ *  you may pass in NULL.
+ *
+ *  @return Whether or not the write was successful.
+ */
+- (BOOL)writeToOutputStream:(NSOutputStream *)stream error:(NSError **)error;
+
 #pragma mark - Track Management
 
 /**
@@ -294,6 +384,9 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  *  The underlying MusicSequence that backs the instance of MIKMIDISequence.
+ *
+ *  @note For sequences loaded with MIKMIDISequenceLoadingOptionLazy, accessing this property
+ *  causes the events of all tracks to be loaded.
  */
 @property (nonatomic, readonly) MusicSequence musicSequence;
 
@@ -313,6 +406,15 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly) Float64 durationInSeconds;
 
+/**
+ *  A tempo map of the sequence's tempo track, for converting between MusicTimeStamps and seconds.
+ *  It is rebuilt when the tempo track's events change, so hold on to it rather than asking for it
+ *  repeatedly only if the tempo track won't be modified in the meantime.
+ *
+ *  This property can be observed using Key Value Observing.
+ */
+@property (nonatomic, readonly) MIKMIDITempoMap *tempoMap;
+
 /**
  *  The MIDI data that composes the sequence. This data is equivalent to an NSData representation of a standard MIDI file.
  */
@@ -11,11 +11,20 @@
 #import "MIKMIDITrack.h"
 #import "MIKMIDITrack_Protected.h"
 #import "MIKMIDITempoEvent.h"
+#import "MIKMIDITempoMap.h"
+#import "MIKMIDINoteEvent.h"
+#import "MIKMIDIChannelEvent.h"
 #import "MIKMIDIMetaTimeSignatureEvent.h"
+#import "MIKMIDIMetaTrackSequenceNameEvent.h"
 #import "MIKMIDIDestinationEndpoint.h"
 #import "MIKMIDISequence+MIKMIDIPrivate.h"
 #import "MIKMIDISequencer+MIKMIDIPrivate.h"
 #import "MIKMIDIErrors.h"
+#import "MIKMIDIFileDecoder.h"
+#import "MIKMIDIFileEncoder.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
 
 #if !__has_feature(objc_arc)
 #error MIKMIDISequence.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDISequence.m in the Build Phases for this target
@@ -31,9 +40,54 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 @property (nonatomic, strong) MIKMIDITrack *tempoTrack;
 @property (nonatomic, strong) NSMutableArray *internalTracks;
 @property (nonatomic) MusicTimeStamp lengthDefinedByTracks;
+@property (nonatomic) BOOL needsTempoMapUpdate;
 
 @end
 
+// Creates the track at index in a sequence being loaded from a file, backed by an empty musicTrack.
+typedef MIKMIDITrack *(^MIKMIDISequenceTrackFactory)(MIKMIDISequence *sequence, MusicTrack musicTrack, NSUInteger index);
+
+static NSArray *MIKMIDIEventsStableSortedByTimeStamp(NSArray *events)
+{
+	return [events sortedArrayWithOptions:NSSortStable usingComparator:^NSComparisonResult(MIKMIDIEvent *event1, MIKMIDIEvent *event2) {
+		if (event1.timeStamp < event2.timeStamp) return NSOrderedAscending;
+		if (event1.timeStamp > event2.timeStamp) return NSOrderedDescending;
+		return NSOrderedSame;
+	}];
+}
+
+// Mirrors kMusicSequenceLoadSMF_ChannelsToTracks: one track per MIDI channel used, in channel order,
+// followed by a track containing all the meta and system exclusive events.
+static NSMutableArray *MIKMIDIEventsSplitByChannel(NSArray *trackEvents)
+{
+	NSMutableArray *allEvents = [NSMutableArray array];
+	for (NSArray *events in trackEvents) {
+		[allEvents addObjectsFromArray:events];
+	}
+	
+	NSMutableArray *eventsByChannel[16] = {nil};
+	NSMutableArray *otherEvents = [NSMutableArray array];
+	for (MIKMIDIEvent *event in MIKMIDIEventsStableSortedByTimeStamp(allEvents)) {
+		NSInteger channel = -1;
+		if ([event isKindOfClass:[MIKMIDINoteEvent class]]) channel = [(MIKMIDINoteEvent *)event channel];
+		if ([event isKindOfClass:[MIKMIDIChannelEvent class]]) channel = [(MIKMIDIChannelEvent *)event channel];
+		
+		if (channel < 0 || channel > 15) {
+			[otherEvents addObject:event];
+			continue;
+		}
+		if (!eventsByChannel[channel]) eventsByChannel[channel] = [NSMutableArray array];
+		[eventsByChannel[channel] addObject:event];
+	}
+	
+	NSMutableArray *result = [NSMutableArray array];
+	for (NSUInteger i = 0; i < 16; i++) {
+		if (eventsByChannel[i]) [result addObject:eventsByChannel[i]];
+	}
+	if ([otherEvents count]) [result addObject:otherEvents];
+	return result;
+}
+
 
 @implementation MIKMIDISequence
 
@@ -73,9 +127,22 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 
 - (instancetype)initWithFileAtURL:(NSURL *)fileURL convertMIDIChannelsToTracks:(BOOL)convertMIDIChannelsToTracks error:(NSError **)error
 {
-	NSData *data = [NSData dataWithContentsOfURL:fileURL options:0 error:error];
+	MIKMIDISequenceLoadingOptions options = convertMIDIChannelsToTracks ? MIKMIDISequenceLoadingOptionConvertMIDIChannelsToTracks : MIKMIDISequenceLoadingOptionNone;
+	return [self initWithFileAtURL:fileURL options:options error:error];
+}
+
++ (instancetype)sequenceWithFileAtURL:(NSURL *)fileURL options:(MIKMIDISequenceLoadingOptions)options error:(NSError **)error
+{
+	return [[self alloc] initWithFileAtURL:fileURL options:options error:error];
+}
+
+- (instancetype)initWithFileAtURL:(NSURL *)fileURL options:(MIKMIDISequenceLoadingOptions)options error:(NSError **)error
+{
+	// A lazily loaded sequence keeps the file's data around, so map it rather than reading it all in.
+	NSDataReadingOptions readingOptions = (options & MIKMIDISequenceLoadingOptionLazy) ? NSDataReadingMappedIfSafe : 0;
+	NSData *data = [NSData dataWithContentsOfURL:fileURL options:readingOptions error:error];
 	if (!data) return nil;
-	return [self initWithData:data convertMIDIChannelsToTracks:convertMIDIChannelsToTracks error:error];
+	return [self initWithData:data options:options error:error];
 }
 
 + (instancetype)sequenceWithData:(NSData *)data error:(NSError **)error
@@ -94,8 +161,15 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 }
 
 - (instancetype)initWithData:(NSData *)data convertMIDIChannelsToTracks:(BOOL)convertMIDIChannelsToTracks error:(NSError **)error
+{
+	MIKMIDISequenceLoadingOptions options = convertMIDIChannelsToTracks ? MIKMIDISequenceLoadingOptionConvertMIDIChannelsToTracks : MIKMIDISequenceLoadingOptionNone;
+	return [self initWithData:data options:options error:error];
+}
+
+- (instancetype)initWithData:(NSData *)data options:(MIKMIDISequenceLoadingOptions)options error:(NSError **)error
 {
 	error = error ?: &(NSError *__autoreleasing){ nil };
+	BOOL convertMIDIChannelsToTracks = (options & MIKMIDISequenceLoadingOptionConvertMIDIChannelsToTracks) != 0;
 	
 	MusicSequence sequence;
 	OSStatus err = NewMusicSequence(&sequence);
@@ -105,6 +179,43 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 		return nil;
 	}
 	
+	// Decode the file ourselves if possible. This avoids having MusicSequenceFileLoadData() parse
+	// the file, only to then read every event back out of the resulting MusicSequence.
+	MIKMIDIFileDecoder *decoder = [[MIKMIDIFileDecoder alloc] initWithData:data error:NULL];
+	NSArray *conductorTrackEvents = decoder.canDecodeEvents ? [decoder tempoTrackEventsWithError:NULL] : nil;
+	if (conductorTrackEvents) {
+		// A conductor track chunk, as written by -dataValue, is read into the tempo track rather than as a track of its own.
+		NSMutableArray *tempoTrackEvents = [conductorTrackEvents mutableCopy];
+		NSUInteger numberOfTracks = 0;
+		MIKMIDISequenceTrackFactory trackFactory = nil;
+		if ((options & MIKMIDISequenceLoadingOptionLazy) && !convertMIDIChannelsToTracks) {
+			trackFactory = [[self class] lazyTrackFactoryForFileDecoder:decoder tempoTrackEvents:tempoTrackEvents];
+			numberOfTracks = decoder.numberOfTracks;
+		} else {
+			BOOL concurrent = (options & MIKMIDISequenceLoadingOptionConcurrentDecoding) != 0;
+			NSUInteger maximumConcurrentTracks = concurrent ? [[NSProcessInfo processInfo] activeProcessorCount] : 1;
+			NSArray *trackEvents = [decoder eventsForAllTracksWithTempoTrackEvents:tempoTrackEvents maximumConcurrentTracks:maximumConcurrentTracks error:NULL];
+			if (trackEvents) {
+				if (convertMIDIChannelsToTracks) trackEvents = MIKMIDIEventsSplitByChannel(trackEvents);
+				trackFactory = ^MIKMIDITrack *(MIKMIDISequence *sequence, MusicTrack musicTrack, NSUInteger index) {
+					return [MIKMIDITrack trackWithSequence:sequence musicTrack:musicTrack events:trackEvents[index]];
+				};
+				numberOfTracks = [trackEvents count];
+			}
+		}
+		
+		if (trackFactory) {
+			NSArray *sortedTempoTrackEvents = MIKMIDIEventsStableSortedByTimeStamp(tempoTrackEvents);
+			return [self initWithMusicSequence:sequence
+								timeResolution:decoder.timeResolution
+							  tempoTrackEvents:sortedTempoTrackEvents
+								numberOfTracks:numberOfTracks
+								  trackFactory:trackFactory
+										 error:error];
+		}
+	}
+	
+	// Fall back to MusicSequenceFileLoadData() for SMPTE-based files, and files our own decoder rejects.
 	MusicSequenceLoadFlags flags = convertMIDIChannelsToTracks ? kMusicSequenceLoadSMF_ChannelsToTracks : 0;
 	err = MusicSequenceFileLoadData(sequence, (__bridge CFDataRef)data, kMusicSequenceFile_MIDIType, flags);
 	if (err) {
@@ -116,12 +227,51 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 	return [self initWithMusicSequence:sequence error:error];
 }
 
+// Scans each track in the file for what's needed up front, and returns a factory that creates tracks
+// which decode their events on demand. Returns nil if any track couldn't be read.
++ (MIKMIDISequenceTrackFactory)lazyTrackFactoryForFileDecoder:(MIKMIDIFileDecoder *)decoder tempoTrackEvents:(NSMutableArray *)tempoTrackEvents
+{
+	NSUInteger numberOfTracks = decoder.numberOfTracks;
+	NSMutableArray *lengths = [NSMutableArray arrayWithCapacity:numberOfTracks];
+	NSMutableArray *nameEvents = [NSMutableArray arrayWithCapacity:numberOfTracks];
+	for (NSUInteger i = 0; i < numberOfTracks; i++) {
+		MusicTimeStamp length = 0;
+		MIKMIDIMetaTrackSequenceNameEvent *nameEvent = nil;
+		if (![decoder scanTrackAtIndex:i tempoTrackEvents:tempoTrackEvents length:&length nameEvent:&nameEvent error:NULL]) return nil;
+		[lengths addObject:@(length)];
+		[nameEvents addObject:nameEvent ?: [NSNull null]];
+	}
+	
+	return ^MIKMIDITrack *(MIKMIDISequence *sequence, MusicTrack musicTrack, NSUInteger index) {
+		id nameEvent = nameEvents[index];
+		if (nameEvent == [NSNull null]) nameEvent = nil;
+		return [MIKMIDITrack trackWithSequence:sequence
+									musicTrack:musicTrack
+								   fileDecoder:decoder
+									trackIndex:index
+										length:[lengths[index] doubleValue]
+									 nameEvent:nameEvent];
+	};
+}
+
 + (instancetype)sequenceWithMusicSequence:(MusicSequence)musicSequence error:(NSError **)error
 {
 	return [[self alloc] initWithMusicSequence:musicSequence error:error];
 }
 
 - (instancetype)initWithMusicSequence:(MusicSequence)musicSequence error:(NSError **)error
+{
+	return [self initWithMusicSequence:musicSequence timeResolution:0 tempoTrackEvents:nil numberOfTracks:0 trackFactory:nil error:error];
+}
+
+// If trackFactory is nil, the tracks are created from the existing contents of musicSequence. Otherwise,
+// musicSequence must be empty, and numberOfTracks new tracks are added to it, created by trackFactory.
+- (instancetype)initWithMusicSequence:(MusicSequence)musicSequence
+					   timeResolution:(SInt16)timeResolution
+					 tempoTrackEvents:(NSArray *)tempoTrackEvents
+					   numberOfTracks:(NSUInteger)numberOfTracks
+						 trackFactory:(MIKMIDISequenceTrackFactory)trackFactory
+								error:(NSError **)error
 {
 	error = error ? error : &(NSError *__autoreleasing){ nil };
 	
@@ -141,6 +291,35 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 			*error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
 			return nil;
 		}
+		
+		if (trackFactory) {
+			if (timeResolution > 0) {
+				err = MusicTrackSetProperty(tempoTrack, kSequenceTrackProperty_TimeResolution, &timeResolution, sizeof(timeResolution));
+				if (err) NSLog(@"MusicTrackSetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
+			}
+			self.tempoTrack = [MIKMIDITrack trackWithSequence:self musicTrack:tempoTrack events:tempoTrackEvents ?: @[]];
+			
+			NSMutableArray *tracks = [NSMutableArray arrayWithCapacity:numberOfTracks];
+			for (NSUInteger i = 0; i < numberOfTracks; i++) {
+				MusicTrack musicTrack;
+				err = MusicSequenceNewTrack(musicSequence, &musicTrack);
+				if (err) {
+					NSLog(@"MusicSequenceNewTrack() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
+					*error = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
+					return nil;
+				}
+				MIKMIDITrack *track = trackFactory(self, musicTrack, i);
+				if (!track) {
+					*error = [NSError MIKMIDIErrorWithCode:MIKMIDISequenceAddTrackFailedErrorCode userInfo:nil];
+					return nil;
+				}
+				[tracks addObject:track];
+			}
+			self.internalTracks = tracks;
+			self.length = MIKMIDISequenceLongestTrackLength;
+			return self;
+		}
+		
 		self.tempoTrack = [MIKMIDITrack trackWithSequence:self musicTrack:tempoTrack];
 		
 		UInt32 numTracks = 0;
@@ -173,10 +352,11 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 {
 	NSArray *tracks = self.internalTracks;
 	self.internalTracks = nil; // Unregister for KVO
+	[_tempoTrack removeObserver:self forKeyPath:@"events" context:MIKMIDISequenceKVOContext];
 	[self setCallBackBlock:^(MIKMIDITrack *t, MusicTimeStamp ts, const MusicEventUserData *ud, MusicTimeStamp ts2, MusicTimeStamp ts3) {}];
 	
 	for (MIKMIDITrack *track in tracks) {
-		OSStatus err = MusicSequenceDisposeTrack(_musicSequence, track.musicTrack);
+		OSStatus err = MusicSequenceDisposeTrack(_musicSequence, track.underlyingMusicTrack);
 		if (err) NSLog(@"MusicSequenceDisposeTrack() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 	}
 	
@@ -207,7 +387,7 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 	
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
 		MusicTrack musicTrack;
-		OSStatus err = MusicSequenceNewTrack(self.musicSequence, &musicTrack);
+		OSStatus err = MusicSequenceNewTrack(self->_musicSequence, &musicTrack);
 		if (err) {
 			NSLog(@"MusicSequenceNewTrack() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 			NSError *underlyingError = [NSError errorWithDomain:NSOSStatusErrorDomain code:err userInfo:nil];
@@ -235,7 +415,7 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 	__block BOOL success = NO;
 	
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
-		OSStatus err = MusicSequenceDisposeTrack(self.musicSequence, track.musicTrack);
+		OSStatus err = MusicSequenceDisposeTrack(self->_musicSequence, track.underlyingMusicTrack);
 		if (err) return NSLog(@"MusicSequenceDisposeTrack() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 		
 		NSInteger index = [self.internalTracks indexOfObject:track];
@@ -250,7 +430,47 @@ const MusicTimeStamp MIKMIDISequenceLongestTrackLength = -1;
 
 - (BOOL)writeToURL:(NSURL *)fileURL error:(NSError *__autoreleasing *)error
 {
-	return [self.dataValue writeToURL:fileURL options:NSDataWritingAtomic error:error];
+	error = error ?: &(NSError *__autoreleasing){ nil };
+	
+	if (![fileURL isFileURL]) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidArgumentError userInfo:nil];
+		return NO;
+	}
+	
+	// Stream the file into a temporary file next to the destination, then move it into place,
+	// so that a failed write doesn't leave a partial file behind.
+	NSString *path = [fileURL path];
+	NSString *temporaryName = [NSString stringWithFormat:@".%@.%@", [path lastPathComponent], [[NSProcessInfo processInfo] globallyUniqueString]];
+	NSString *temporaryPath = [[path stringByDeletingLastPathComponent] stringByAppendingPathComponent:temporaryName];
+	int fileDescriptor = open([temporaryPath fileSystemRepresentation], O_WRONLY | O_CREAT | O_EXCL, 0644);
+	if (fileDescriptor < 0) {
+		*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+		return NO;
+	}
+	
+	BOOL success = [[self fileEncoder] writeToFileDescriptor:fileDescriptor error:error];
+	if (close(fileDescriptor) && success) {
+		*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+		success = NO;
+	}
+	if (success && rename([temporaryPath fileSystemRepresentation], [path fileSystemRepresentation])) {
+		*error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+		success = NO;
+	}
+	if (!success) unlink([temporaryPath fileSystemRepresentation]);
+	return success;
+}
+
+- (BOOL)writeToOutputStream:(NSOutputStream *)stream error:(NSError *__autoreleasing *)error
+{
+	return [[self fileEncoder] writeToOutputStream:stream error:error];
+}
+
+- (MIKMIDIFileEncoder *)fileEncoder
+{
+	SInt16 timeResolution = self.tempoTrack.timeResolution;
+	if (timeResolution <= 0) timeResolution = 480; // The MusicSequence default.
+	return [[MIKMIDIFileEncoder alloc] initWithTempoTrack:self.tempoTrack tracks:self.tracks timeResolution:timeResolution];
 }
 
 #pragma mark - Callback
@@ -311,14 +531,7 @@ static void MIKSequenceCallback(void *inClientData, MusicSequence inSequence, Mu
 
 - (Float64)tempoAtTimeStamp:(MusicTimeStamp)timeStamp
 {
-	__block Float64 tempo = 0;
-	
-	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
-		NSArray *events = [self.tempoTrack eventsOfClass:[MIKMIDITempoEvent class] fromTimeStamp:0 toTimeStamp:timeStamp];
-		tempo = [[events lastObject] bpm];
-	}];
-	
-	return tempo;
+	return [[self.tempoMap tempoEventAtTimeStamp:timeStamp] bpm];
 }
 
 #pragma mark - Time Signature
@@ -381,6 +594,10 @@ static void MIKSequenceCallback(void *inClientData, MusicSequence inSequence, Mu
 		([keyPath isEqualToString:@"length"] || [keyPath isEqualToString:@"offset"])) {
 		[self updateLengthDefinedByTracks];
 	}
+	
+	if (object == self.tempoTrack && [keyPath isEqualToString:@"events"]) {
+		self.needsTempoMapUpdate = YES;
+	}
 }
 
 - (void)updateLengthDefinedByTracks
@@ -396,6 +613,16 @@ static void MIKSequenceCallback(void *inClientData, MusicSequence inSequence, Mu
 
 #pragma mark - Properties
 
+- (void)setTempoTrack:(MIKMIDITrack *)tempoTrack
+{
+	if (tempoTrack != _tempoTrack) {
+		[_tempoTrack removeObserver:self forKeyPath:@"events" context:MIKMIDISequenceKVOContext];
+		_tempoTrack = tempoTrack;
+		[_tempoTrack addObserver:self forKeyPath:@"events" options:0 context:MIKMIDISequenceKVOContext];
+		self.needsTempoMapUpdate = YES;
+	}
+}
+
 - (void)setInternalTracks:(NSMutableArray *)internalTracks
 {
 	if (internalTracks != _internalTracks) {
@@ -475,27 +702,57 @@ static void MIKSequenceCallback(void *inClientData, MusicSequence inSequence, Mu
 
 + (NSSet *)keyPathsForValuesAffectingDurationInSeconds
 {
-	return [NSSet setWithObjects:@"length", nil];
+	return [NSSet setWithObjects:@"length", @"tempoMap", nil];
 }
 
 - (Float64)durationInSeconds
 {
-	Float64 duration = 0;
-	OSStatus err = MusicSequenceGetSecondsForBeats(self.musicSequence, self.length, &duration);
-	if (err) NSLog(@"MusicSequenceGetSecondsForBeats() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
-	return duration;
+	return [self.tempoMap secondsForTimeStamp:self.length];
 }
 
-- (NSData *)dataValue
++ (NSSet *)keyPathsForValuesAffectingTempoMap
 {
-	CFDataRef data;
-	OSStatus err = MusicSequenceFileCreateData(self.musicSequence, kMusicSequenceFile_MIDIType, 0, 0, &data);
-	if (err) {
-		NSLog(@"MusicSequenceFileCreateData() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
-		return nil;
-	}
+	return [NSSet setWithObjects:@"needsTempoMapUpdate", nil];
+}
+
+@synthesize tempoMap = _tempoMap;
+- (MIKMIDITempoMap *)tempoMap
+{
+	__block MIKMIDITempoMap *tempoMap;
+	
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		if (!self->_tempoMap || self.needsTempoMapUpdate) {
+			// Only the part of the map after the first changed tempo event is recalculated
+			NSArray *tempoEvents = [self.tempoTrack eventsOfClass:[MIKMIDITempoEvent class] fromTimeStamp:-DBL_MAX toTimeStamp:DBL_MAX];
+			self->_tempoMap = self->_tempoMap ? [self->_tempoMap tempoMapWithTempoEvents:tempoEvents] : [[MIKMIDITempoMap alloc] initWithTempoEvents:tempoEvents];
+			self->_needsTempoMapUpdate = NO;
+		}
+		tempoMap = self->_tempoMap;
+	}];
 	
-	return (__bridge_transfer NSData *)data;
+	return tempoMap;
+}
+
+- (MusicSequence)musicSequence
+{
+	// Callers may read events straight out of the MusicSequence, so lazily loaded tracks need to be filled in first.
+	for (MIKMIDITrack *track in self.tracks) {
+		[track loadEventsIfNeeded];
+	}
+	return _musicSequence;
+}
+
+- (MusicSequence)underlyingMusicSequence
+{
+	return _musicSequence;
+}
+
+- (NSData *)dataValue
+{
+	NSError *error = nil;
+	NSData *data = [[self fileEncoder] dataWithError:&error];
+	if (!data) NSLog(@"Creating MIDI file data failed with error %@ in %s.", error, __PRETTY_FUNCTION__);
+	return data;
 }
 
 #pragma mark - Deprecated
@@ -15,6 +15,26 @@ NS_ASSUME_NONNULL_BEGIN
 
 - (void)dispatchSyncToProcessingQueueAsNeeded:(void (^)(void))block;
 
+/**
+ *  Wakes the sequencer up to process the sequence, if it's sleeping until the next event.
+ *  Called when a track's events, offset, or mute or solo status change during playback,
+ *  so new events aren't missed. Safe to call from any thread.
+ */
+- (void)setNeedsProcessing;
+
+@end
+
+@interface MIKMIDISequencer ()
+
+/**
+ *  Schedules the events between two MIDI time stamps, as the sequencer does periodically during playback,
+ *  then handles looping or stopping at the end of the sequence. Must be called on the processing queue.
+ *
+ *  @param fromMIDITimeStamp The MIDI time stamp events have been scheduled up to.
+ *  @param toMIDITimeStamp   The MIDI time stamp to schedule events up to.
+ */
+- (void)processSequenceFromMIDITimeStamp:(MIDITimeStamp)fromMIDITimeStamp toMIDITimeStamp:(MIDITimeStamp)toMIDITimeStamp;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -18,6 +18,7 @@
 @class MIKMIDISynthesizer;
 @class MIKMIDIClock;
 @protocol MIKMIDICommandScheduler;
+@protocol MIKMIDITimeSource;
 
 /**
  *  Types of click track statuses, that determine when the click track will be audible.
@@ -35,6 +36,30 @@ typedef NS_ENUM(NSInteger, MIKMIDISequencerClickTrackStatus) {
 	MIKMIDISequencerClickTrackStatusAlwaysEnabled
 };
 
+/**
+ *  Measurements of how the sequencer has been scheduling events since playback last started.
+ *
+ *  @see schedulingStatistics
+ */
+typedef struct {
+	/** The number of times the sequencer has woken up to schedule events. */
+	NSUInteger numberOfWakeUps;
+	/** How far ahead of the current time the sequencer scheduled events at its last wake-up, in seconds. */
+	NSTimeInterval lookAheadInterval;
+	/** How long the sequencer decided to sleep for after its last wake-up, in seconds. */
+	NSTimeInterval sleepInterval;
+	/** How late the last wake-up was, in seconds. */
+	NSTimeInterval lastWakeUpLateness;
+	/** The average lateness of all wake-ups, in seconds. */
+	NSTimeInterval averageWakeUpLateness;
+	/** The latest any wake-up has been, in seconds. */
+	NSTimeInterval maximumWakeUpLateness;
+	/** The number of events scheduled at the last wake-up. */
+	NSUInteger numberOfEventsScheduledAtLastWakeUp;
+	/** The largest number of events scheduled at a single wake-up. */
+	NSUInteger maximumNumberOfEventsScheduledAtOneWakeUp;
+} MIKMIDISequencerSchedulingStatistics;
+
 NS_ASSUME_NONNULL_BEGIN
 
 /**
@@ -152,6 +177,48 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (void)setLoopStartTimeStamp:(MusicTimeStamp)loopStartTimeStamp endTimeStamp:(MusicTimeStamp)loopEndTimeStamp;
 
+#pragma mark - Offline Rendering
+
+/**
+ *  Starts playback on a clock driven by the caller, rather than by the system clock.
+ *
+ *  Nothing is scheduled until -renderOfflineToMIDITimeStamp: is called, which schedules
+ *  every event up to the MIDI time stamp it's given immediately, as fast as possible. Events
+ *  are scheduled in the same order, with the same tempo changes, looping and stopping at the
+ *  end of the sequence, as in real time playback. This is useful for rendering a sequence to
+ *  audio or to another MIDI stream faster than real time.
+ *
+ *  MIDI time stamps in offline rendering are on the caller's timeline, so they don't need to
+ *  be anywhere near the current time. Command schedulers for offline rendering should usually
+ *  be set for each track with -setCommandScheduler:forTrack:, because commands scheduled with
+ *  a builtin synthesizer will play as soon as they're received.
+ *
+ *  Stop offline rendering with -stop, or let it stop at the end of the sequence. Recording
+ *  is not supported while rendering offline.
+ *
+ *  @param timeStamp The position in the sequence to begin rendering from.
+ *  @param midiTimeStamp The MIDITimeStamp timeStamp corresponds to.
+ *
+ *  @see -renderOfflineToMIDITimeStamp:
+ *  @see renderingOffline
+ */
+- (void)startOfflineRenderingAtTimeStamp:(MusicTimeStamp)timeStamp MIDITimeStamp:(MIDITimeStamp)midiTimeStamp;
+
+/**
+ *  Schedules every event up to a MIDI time stamp, then returns. The time stamp becomes
+ *  the sequencer's current time.
+ *
+ *  To render a whole sequence, call this method repeatedly with increasing time stamps until
+ *  -isPlaying returns NO. Rendering in steps no longer than an audio buffer, for example,
+ *  keeps the number of commands waiting in each command scheduler small.
+ *
+ *  Does nothing unless the sequencer was started with -startOfflineRenderingAtTimeStamp:MIDITimeStamp:,
+ *  or if midiTimeStamp isn't later than the time stamp rendering has already reached.
+ *
+ *  @param midiTimeStamp The MIDITimeStamp to schedule events up to.
+ */
+- (void)renderOfflineToMIDITimeStamp:(MIDITimeStamp)midiTimeStamp;
+
 
 #pragma mark - Recording
 
@@ -281,6 +348,13 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (readonly, nonatomic, getter=isRecording) BOOL recording;
 
+/**
+ *  Whether or not the sequencer is playing on a clock driven by the caller.
+ *
+ *  @see -startOfflineRenderingAtTimeStamp:MIDITimeStamp:
+ */
+@property (readonly, nonatomic, getter=isRenderingOffline) BOOL renderingOffline;
+
 /**
  *  The tempo the sequencer should play its sequence at. When set to 0, the sequence will be played using 
  *  the tempo events from the sequence's tempo track. Default is 0.
@@ -380,6 +454,17 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, getter=shouldCreateSynthsIfNeeded) BOOL createSynthsIfNeeded;
 
+/**
+ *  Whether or not the sequencer should play notes that are already held when playback starts.
+ *
+ *  When this property is YES and playback starts (or the current time stamp is changed during playback)
+ *  partway through a note, that note is played from the start position for the rest of its duration.
+ *  When NO, only notes that start at or after the start position are played. The default is NO.
+ *
+ *  @see -[MIKMIDITrack notesSoundingAtTimeStamp:]
+ */
+@property (nonatomic, getter=shouldChaseNotes) BOOL chaseNotes;
+
 /**
  *  The metronome to send click track events to.
  */
@@ -423,6 +508,41 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic) NSTimeInterval maximumLookAheadInterval;
 
+/**
+ *  Whether the sequencer adapts how far ahead it looks, and how often it wakes up, to the music
+ *  being played. The default is NO, where the sequencer wakes up every 50 ms and always looks
+ *  ahead by maximumLookAheadInterval.
+ *
+ *  When YES, maximumLookAheadInterval is an upper limit. The sequencer wakes up more often during
+ *  dense passages, so that fewer events are scheduled at once, and looks ahead just far enough to
+ *  cover the time until its next wake-up, allowing for how late recent wake-ups have been. When
+ *  there's nothing to schedule, it sleeps until shortly before the next event (for up to a
+ *  second), which saves power during sparse passages and rests. Changes to the sequence's tracks
+ *  wake it up early.
+ *
+ *  @see schedulingStatistics
+ */
+@property (nonatomic, getter=isAdaptiveLookAheadEnabled) BOOL adaptiveLookAheadEnabled;
+
+/**
+ *  Measurements of the sequencer's scheduling since playback last started, including the look-ahead
+ *  interval it chose and how late it woke up. Useful for tuning maximumLookAheadInterval, and
+ *  for checking how adaptiveLookAheadEnabled behaves on a particular device.
+ */
+@property (nonatomic, readonly) MIKMIDISequencerSchedulingStatistics schedulingStatistics;
+
+/**
+ *  The time source the sequencer plays against. It decides what time it is, and wakes the
+ *  sequencer up to schedule events. The default is +[MIKMIDIHostTimeSource hostTimeSource].
+ *
+ *  Setting an MIKMIDISimulatedTimeSource makes playback follow simulated time, so that, for
+ *  example, tests can play through a long sequence in a fraction of a second. The sequencer's
+ *  clock uses the same time source. This should only be changed while the sequencer isn't playing.
+ *
+ *  @see MIKMIDITimeSource
+ */
+@property (nonatomic, strong, null_resettable) id<MIKMIDITimeSource> timeSource;
+
 #pragma mark - Deprecated
 
 /**
@@ -10,6 +10,7 @@
 #import <mach/mach_time.h>
 #import "MIKMIDISequence.h"
 #import "MIKMIDITrack.h"
+#import "MIKMIDITrack_Protected.h"
 #import "MIKMIDIClock.h"
 #import "MIKMIDITempoEvent.h"
 #import "MIKMIDINoteEvent.h"
@@ -27,6 +28,7 @@
 #import "MIKMIDIDestinationEndpoint.h"
 #import "MIKMIDIControlChangeCommand.h"
 #import "MIKMIDIControlChangeEvent.h"
+#import "MIKMIDIHostTimeSource.h"
 
 
 #if !__has_feature(objc_arc)
@@ -34,6 +36,12 @@
 #endif
 
 #define kDefaultTempo	120
+#define kProcessingTimerInterval	0.05
+#define kMinimumProcessingTimerInterval	0.005	// With adaptive look-ahead
+#define kMaximumIdleProcessingTimerInterval	1.0	// With adaptive look-ahead, when there's nothing to schedule
+#define kTargetNumberOfEventsPerProcessingPass	32
+#define kLookAheadSafetyMargin	0.005
+#define kWakeUpLatenessEstimateDecay	0.95
 
 NSString * const MIKMIDISequencerWillLoopNotification = @"MIKMIDISequencerWillLoopNotification";
 const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
@@ -57,10 +65,25 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 @end
 
 
-@interface MIKMIDIPendingNoteOffsForTimeStamp : NSObject
-@property (nonatomic, strong) NSMutableArray *noteEventsWithEndTimeStamp;
-@property (nonatomic) MusicTimeStamp endTimeStamp;
-+ (instancetype)pendingNoteOffWithEndTimeStamp:(MusicTimeStamp)endTimeStamp;
+typedef struct {
+    MusicTimeStamp timeStamp;
+    NSUInteger order;
+    void *object;
+} MIKMIDISequencerHeapEntry;
+
+// Min-heap operations, ordering entries by timeStamp, then by order. heap must have room for another entry when pushing.
+static void MIKMIDISequencerHeapPush(MIKMIDISequencerHeapEntry *heap, NSUInteger *count, MIKMIDISequencerHeapEntry entry);
+static MIKMIDISequencerHeapEntry MIKMIDISequencerHeapPop(MIKMIDISequencerHeapEntry *heap, NSUInteger *count);
+
+
+// Note offs waiting to be scheduled, in order of their end time stamps, then the order they were added in.
+@interface MIKMIDIPendingNoteOffQueue : NSObject
+@property (nonatomic, readonly) NSUInteger count;
+@property (nonatomic, readonly) MusicTimeStamp nextEndTimeStamp; // DBL_MAX if the queue is empty
+- (void)addNoteOff:(MIKMIDIEventWithDestination *)noteOff;
+- (MIKMIDIEventWithDestination *)removeNextNoteOff;
+- (NSArray *)removeNoteOffsWithDestination:(id<MIKMIDICommandScheduler>)destination;
+- (NSArray *)removeAllNoteOffs;
 @end
 
 
@@ -70,6 +93,16 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 {
     void *_processingQueueKey;
     void *_processingQueueContext;
+    MIDITimeStamp _offlineMIDITimeStamp; // How far offline rendering has got. Stands in for the current time while rendering offline.
+    NSUInteger _processingTimerGeneration; // Incremented to stop the processing timer. Only used on the processing queue.
+
+    // Scheduling state. Only used on the processing queue.
+    NSTimeInterval _lookAheadInterval;
+    NSTimeInterval _wakeUpLatenessEstimate; // A peak of recent wake-up lateness, decaying with each wake-up
+    Float64 _eventsPerSecondEstimate; // Density of the events most recently scheduled
+    NSUInteger _numberOfScheduledEvents;
+    BOOL _processingTimerIsIdle; // Sleeping until shortly before the next event
+    MIKMIDISequencerSchedulingStatistics _schedulingStatistics;
 }
 
 @property (readonly, nonatomic) MIKMIDIClock *clock;
@@ -77,10 +110,11 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 @property (nonatomic, getter=isPlaying) BOOL playing;
 @property (nonatomic, getter=isRecording) BOOL recording;
 @property (nonatomic, getter=isLooping) BOOL looping;
+@property (nonatomic, getter=isRenderingOffline) BOOL renderingOffline;
 
 @property (nonatomic) MIDITimeStamp latestScheduledMIDITimeStamp;
 
-@property (nonatomic, strong) NSMutableDictionary *pendingNoteOffs;
+@property (nonatomic, strong) MIKMIDIPendingNoteOffQueue *pendingNoteOffs;
 
 @property (nonatomic, strong) NSMutableDictionary *pendingRecordedNoteEvents;
 
@@ -95,7 +129,6 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 @property (readonly, nonatomic) MusicTimeStamp sequenceLength;
 
 @property (nonatomic) dispatch_queue_t processingQueue;
-@property (nonatomic) dispatch_source_t processingTimer;
 
 @end
 
@@ -119,6 +152,8 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
         _processingQueueKey = &_processingQueueKey;
         _processingQueueContext = &_processingQueueContext;
         _maximumLookAheadInterval = 0.1;
+        _timeSource = [MIKMIDIHostTimeSource hostTimeSource];
+        _clock.timeSource = _timeSource;
     }
     return self;
 }
@@ -141,7 +176,6 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 - (void)dealloc
 {
     [_sequence removeObserver:self forKeyPath:@"tracks"];
-    self.processingTimer = NULL;
 }
 
 #pragma mark - Playback
@@ -158,7 +192,13 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 
 - (void)startPlaybackAtTimeStamp:(MusicTimeStamp)timeStamp adjustForPreRollWhenRecording:(BOOL)adjustForPreRoll
 {
-    MIDITimeStamp midiTimeStamp = MIKMIDIGetCurrentTimeStamp() + MIKMIDIClockMIDITimeStampsPerTimeInterval(0.001);
+    if (self.isRenderingOffline) {
+        // Carry on from where offline rendering has got to
+        [self startPlaybackAtTimeStamp:timeStamp MIDITimeStamp:_offlineMIDITimeStamp adjustForPreRollWhenRecording:adjustForPreRoll offline:YES];
+        return;
+    }
+
+    MIDITimeStamp midiTimeStamp = self.timeSource.currentMIDITimeStamp + MIKMIDIClockMIDITimeStampsPerTimeInterval(0.001);
     [self startPlaybackAtTimeStamp:timeStamp MIDITimeStamp:midiTimeStamp];
 }
 
@@ -168,6 +208,11 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 }
 
 - (void)startPlaybackAtTimeStamp:(MusicTimeStamp)timeStamp MIDITimeStamp:(MIDITimeStamp)midiTimeStamp adjustForPreRollWhenRecording:(BOOL)adjustForPreRoll
+{
+    [self startPlaybackAtTimeStamp:timeStamp MIDITimeStamp:midiTimeStamp adjustForPreRollWhenRecording:adjustForPreRoll offline:NO];
+}
+
+- (void)startPlaybackAtTimeStamp:(MusicTimeStamp)timeStamp MIDITimeStamp:(MIDITimeStamp)midiTimeStamp adjustForPreRollWhenRecording:(BOOL)adjustForPreRoll offline:(BOOL)offline
 {
     if (self.isPlaying) [self stop];
     if (adjustForPreRoll && self.isRecording) timeStamp -= self.preRoll;
@@ -196,21 +241,38 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
         [self updateClockWithMusicTimeStamp:timeStamp tempo:startingTempo atMIDITimeStamp:midiTimeStamp];
     });
 
+    _offlineMIDITimeStamp = midiTimeStamp;
+    self.renderingOffline = offline;
     self.playing = YES;
 
     dispatch_sync(queue, ^{
-        self.pendingNoteOffs = [NSMutableDictionary dictionary];
+        self.pendingNoteOffs = [[MIKMIDIPendingNoteOffQueue alloc] init];
         self.latestScheduledMIDITimeStamp = midiTimeStamp;
-        dispatch_source_t timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, self.processingQueue);
-        if (!timer) return NSLog(@"Unable to create processing timer for %@.", [self class]);
-        self.processingTimer = timer;
+        if (self.shouldChaseNotes) [self chaseNotesSoundingAtTimeStamp:timeStamp];
+        if (offline) return; // Driven by -renderOfflineToMIDITimeStamp: instead of a timer
+
+        self->_lookAheadInterval = self.maximumLookAheadInterval;
+        self->_wakeUpLatenessEstimate = 0;
+        self->_eventsPerSecondEstimate = 0;
+        self->_processingTimerIsIdle = NO;
+        self->_schedulingStatistics = (MIKMIDISequencerSchedulingStatistics){0};
+        [self scheduleProcessingTimerAtMIDITimeStamp:self.timeSource.currentMIDITimeStamp generation:++self->_processingTimerGeneration];
+    });
+}
 
-        dispatch_source_set_timer(timer, DISPATCH_TIME_NOW, 0.05 * NSEC_PER_SEC, 0.05 * NSEC_PER_SEC);
-        dispatch_source_set_event_handler(timer, ^{
-            [self processSequenceStartingFromMIDITimeStamp:self.latestScheduledMIDITimeStamp];
-        });
+- (void)startOfflineRenderingAtTimeStamp:(MusicTimeStamp)timeStamp MIDITimeStamp:(MIDITimeStamp)midiTimeStamp
+{
+    [self startPlaybackAtTimeStamp:timeStamp MIDITimeStamp:midiTimeStamp adjustForPreRollWhenRecording:NO offline:YES];
+}
+
+- (void)renderOfflineToMIDITimeStamp:(MIDITimeStamp)midiTimeStamp
+{
+    if (!self.isRenderingOffline) return;
 
-        dispatch_resume(timer);
+    dispatch_sync(self.processingQueue, ^{
+        if (midiTimeStamp <= self->_offlineMIDITimeStamp) return;
+        self->_offlineMIDITimeStamp = midiTimeStamp;
+        [self processSequenceStartingFromMIDITimeStamp:self.latestScheduledMIDITimeStamp];
     });
 }
 
@@ -228,24 +290,12 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 {
     [self dispatchSyncToProcessingQueueAsNeeded:^{
         NSMutableArray *commandsToSendNow = [NSMutableArray array];
-        MIDITimeStamp offTimeStamp = MIKMIDIGetCurrentTimeStamp() + MIKMIDIClockMIDITimeStampsPerTimeInterval(self.maximumLookAheadInterval);
-
-        for (MIKMIDIPendingNoteOffsForTimeStamp *pendingNoteOffsForTimeStamp in self.pendingNoteOffs.allValues) {
-            NSMutableArray *noteEvents = pendingNoteOffsForTimeStamp.noteEventsWithEndTimeStamp;
-            NSUInteger count = noteEvents.count;
-            NSMutableIndexSet *indexesToRemove = [NSMutableIndexSet indexSet];
-            for (NSUInteger i = 0; i < count; i++) {
-                MIKMIDIEventWithDestination *event = noteEvents[i];
-                if (event.destination == scheduler) {
-                    [indexesToRemove addIndex:i];
-
-                    MIKMIDINoteEvent *noteEvent = (MIKMIDINoteEvent *)event.event;
-                    MIKMIDINoteOffCommand *command = [MIKMIDINoteOffCommand noteOffCommandWithNote:noteEvent.note velocity:0 channel:noteEvent.channel midiTimeStamp:offTimeStamp];
-                    [commandsToSendNow addObject:command];
-                }
-            }
+        MIDITimeStamp offTimeStamp = [self currentMIDITimeStamp] + MIKMIDIClockMIDITimeStampsPerTimeInterval(self.maximumLookAheadInterval);
 
-            [noteEvents removeObjectsAtIndexes:indexesToRemove];
+        for (MIKMIDIEventWithDestination *event in [self.pendingNoteOffs removeNoteOffsWithDestination:scheduler]) {
+            MIKMIDINoteEvent *noteEvent = (MIKMIDINoteEvent *)event.event;
+            MIKMIDINoteOffCommand *command = [MIKMIDINoteOffCommand noteOffCommandWithNote:noteEvent.note velocity:0 channel:noteEvent.channel midiTimeStamp:offTimeStamp];
+            [commandsToSendNow addObject:command];
         }
 
         if (commandsToSendNow.count) [self scheduleCommands:commandsToSendNow withCommandScheduler:scheduler];
@@ -254,15 +304,16 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 
 - (void)stopWithDispatchToProcessingQueue:(BOOL)dispatchToProcessingQueue
 {
-    MIDITimeStamp stopTimeStamp = MIKMIDIGetCurrentTimeStamp();
+    MIDITimeStamp stopTimeStamp = [self currentMIDITimeStamp];
     if (!self.isPlaying) return;
 
     void (^stopPlayback)(void) = ^{
-        self.processingTimer = NULL;
+        self->_processingTimerGeneration++;
+        self->_processingTimerIsIdle = NO;
 
         MIKMIDIClock *clock = self.clock;
         [self recordAllPendingNoteEventsWithOffTimeStamp:[clock musicTimeStampForMIDITimeStamp:stopTimeStamp]];
-        MusicTimeStamp allPendingNotesOffTimeStamp = MAX(self.latestScheduledMIDITimeStamp + 1, MIKMIDIGetCurrentTimeStamp() + MIKMIDIClockMIDITimeStampsPerTimeInterval(0.001));
+        MusicTimeStamp allPendingNotesOffTimeStamp = MAX(self.latestScheduledMIDITimeStamp + 1, stopTimeStamp + MIKMIDIClockMIDITimeStampsPerTimeInterval(0.001));
         [self sendAllPendingNoteOffsWithMIDITimeStamp:allPendingNotesOffTimeStamp];
         self.pendingRecordedNoteEvents = nil;
         self.looping = NO;
@@ -278,13 +329,31 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     self.processingQueue = NULL;
     self.playing = NO;
     self.recording = NO;
+    self.renderingOffline = NO;
+}
+
+// The time playback has reached. When rendering offline, that's the time stamp rendering has been asked to reach.
+- (MIDITimeStamp)currentMIDITimeStamp
+{
+    return self.isRenderingOffline ? _offlineMIDITimeStamp : self.timeSource.currentMIDITimeStamp;
 }
 
 - (void)processSequenceStartingFromMIDITimeStamp:(MIDITimeStamp)fromMIDITimeStamp
 {
-    MIDITimeStamp toMIDITimeStamp = MIKMIDIGetCurrentTimeStamp() + MIKMIDIClockMIDITimeStampsPerTimeInterval(self.maximumLookAheadInterval);
+    MIDITimeStamp toMIDITimeStamp;
+    if (self.isRenderingOffline) {
+        toMIDITimeStamp = _offlineMIDITimeStamp; // Nothing to look ahead for, everything up to here is due now
+    } else {
+        toMIDITimeStamp = self.timeSource.currentMIDITimeStamp + MIKMIDIClockMIDITimeStampsPerTimeInterval(_lookAheadInterval);
+    }
     if (toMIDITimeStamp < fromMIDITimeStamp) return;
+    [self processSequenceFromMIDITimeStamp:fromMIDITimeStamp toMIDITimeStamp:toMIDITimeStamp];
+}
+
+- (void)processSequenceFromMIDITimeStamp:(MIDITimeStamp)fromMIDITimeStamp toMIDITimeStamp:(MIDITimeStamp)toMIDITimeStamp
+{
     MIKMIDIClock *clock = self.clock;
+    BOOL isRenderingOffline = self.isRenderingOffline;
 
     MIKMIDISequence *sequence = self.sequence;
     MusicTimeStamp loopStartTimeStamp = self.loopStartTimeStamp;
@@ -298,64 +367,37 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     MusicTimeStamp toMusicTimeStamp = MIN(calculatedToMusicTimeStamp, maxToMusicTimeStamp);
     MIDITimeStamp actualToMIDITimeStamp = [clock midiTimeStampForMusicTimeStamp:toMusicTimeStamp];
 
-    // Get relevant tempo events
-    NSMutableDictionary *allEventsByTimeStamp = [NSMutableDictionary dictionary];
-    NSMutableDictionary *tempoEventsByTimeStamp = [NSMutableDictionary dictionary];
+    // Each source of events is in time order, so they're merged as they're scheduled, rather than collected and sorted.
+    // Sources that come first in this array are scheduled first when events have the same time stamp.
+    NSMutableArray *sources = [NSMutableArray array];
+    NSMutableArray *sourceDestinations = [NSMutableArray array];
+
+    // Get relevant tempo events. They go first, so the clock is updated before anything else at their time stamp is scheduled.
+    NSMutableArray *tempoEvents = [NSMutableArray array];
     Float64 overrideTempo = self.tempo;
 
     if (!overrideTempo) {
-        NSArray *sequenceTempoEvents = [sequence.tempoTrack eventsOfClass:[MIKMIDITempoEvent class] fromTimeStamp:MAX(fromMusicTimeStamp, 0) toTimeStamp:toMusicTimeStamp];
-        for (MIKMIDITempoEvent *tempoEvent in sequenceTempoEvents) {
-            NSNumber *timeStampKey = @(tempoEvent.timeStamp);
-            allEventsByTimeStamp[timeStampKey] = [NSMutableArray arrayWithObject:tempoEvent];
-            tempoEventsByTimeStamp[timeStampKey] = tempoEvent;
-        }
+        [tempoEvents addObjectsFromArray:[sequence.tempoTrack eventsOfClass:[MIKMIDITempoEvent class] fromTimeStamp:MAX(fromMusicTimeStamp, 0) toTimeStamp:toMusicTimeStamp]];
     }
 
     if (self.needsCurrentTempoUpdate) {
-        if (!tempoEventsByTimeStamp.count) {
+        if (!tempoEvents.count) {
             if (!overrideTempo) overrideTempo = [sequence tempoAtTimeStamp:fromMusicTimeStamp];
             if (!overrideTempo) overrideTempo = kDefaultTempo;
 
-            MIKMIDITempoEvent *tempoEvent = [MIKMIDITempoEvent tempoEventWithTimeStamp:fromMusicTimeStamp tempo:overrideTempo];
-            NSNumber *timeStampKey = @(fromMusicTimeStamp);
-            allEventsByTimeStamp[timeStampKey] = [NSMutableArray arrayWithObject:tempoEvent];
-            tempoEventsByTimeStamp[timeStampKey] = tempoEvent;
+            [tempoEvents addObject:[MIKMIDITempoEvent tempoEventWithTimeStamp:fromMusicTimeStamp tempo:overrideTempo]];
         }
         self.needsCurrentTempoUpdate = NO;
     }
-
-    // Get pending note off events
-    NSMutableDictionary *pendingNoteOffs = self.pendingNoteOffs;
-    for (NSNumber *timeStampKey in [pendingNoteOffs copy]) {
-        MusicTimeStamp pendingNoteOffsMusicTimeStamp = timeStampKey.doubleValue;
-        if (pendingNoteOffsMusicTimeStamp < fromMusicTimeStamp) continue;
-        if (pendingNoteOffsMusicTimeStamp > toMusicTimeStamp) continue;
-        if (isLooping && (pendingNoteOffsMusicTimeStamp == loopEndTimeStamp)) continue;	// These pending note offs will be handled right before we loop
-
-        NSMutableArray *eventsAtTimeStamp = allEventsByTimeStamp[timeStampKey] ? allEventsByTimeStamp[timeStampKey] : [NSMutableArray array];
-        [eventsAtTimeStamp addObject:pendingNoteOffs[timeStampKey]];
-        allEventsByTimeStamp[timeStampKey] = eventsAtTimeStamp;
-        [pendingNoteOffs removeObjectForKey:timeStampKey];
-    }
+    [sources addObject:tempoEvents];
+    [sourceDestinations addObject:[NSNull null]];
 
     // Get other events
-    NSMutableArray *nonMutedTracks = [[NSMutableArray alloc] init];
-    NSMutableArray *soloTracks = [[NSMutableArray alloc] init];
-    for (MIKMIDITrack *track in sequence.tracks) {
-        if (track.isMuted) continue;
-
-        [nonMutedTracks addObject:track];
-        if (track.solo) { [soloTracks addObject:track]; }
-    }
-
-    // Never play muted tracks. If any non-muted tracks are soloed, only play those. Matches MusicPlayer behavior
-    NSArray *tracksToPlay = soloTracks.count != 0 ? soloTracks : nonMutedTracks;
-
-    for (MIKMIDITrack *track in tracksToPlay) {
+    for (MIKMIDITrack *track in [self tracksToPlay]) {
         MusicTimeStamp startTimeStamp = MAX(fromMusicTimeStamp - track.offset, 0);
         MusicTimeStamp endTimeStamp = toMusicTimeStamp - track.offset;
         NSArray *events = [track eventsFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
+        if (!events.count) continue;	// Skipping empty tracks here means no destination endpoint is created for them below
         if (track.offset != 0) {
             // Shift events by offset
             NSMutableArray *shiftedEvents = [NSMutableArray array];
@@ -367,46 +409,88 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
             events = shiftedEvents;
         }
 
-        id<MIKMIDICommandScheduler> destination = events.count ? [self commandSchedulerForTrack:track] : nil;	// only get the destination if there's events so we don't create a destination endpoint if not needed
-        for (MIKMIDIEvent *event in events) {
-            if ([event isKindOfClass:[MIKMIDINoteEvent class]] && [(MIKMIDINoteEvent *)event duration] <= 0) continue;
-            NSNumber *timeStampKey = @(event.timeStamp);
-            NSMutableArray *eventsAtTimeStamp = allEventsByTimeStamp[timeStampKey] ? allEventsByTimeStamp[timeStampKey] : [NSMutableArray array];
-            [eventsAtTimeStamp addObject:[MIKMIDIEventWithDestination eventWithDestination:destination event:event]];
-            allEventsByTimeStamp[timeStampKey] = eventsAtTimeStamp;
-        }
+        id<MIKMIDICommandScheduler> destination = [self commandSchedulerForTrack:track];
+        [sources addObject:events];
+        [sourceDestinations addObject:destination ?: [NSNull null]];
     }
 
     // Get click track events
-    for (MIKMIDIEventWithDestination *destinationEvent in [self clickTrackEventsFromTimeStamp:fromMusicTimeStamp toTimeStamp:toMusicTimeStamp]) {
-        NSNumber *timeStampKey = @(destinationEvent.event.timeStamp);
-        NSMutableArray *eventsAtTimesStamp = allEventsByTimeStamp[timeStampKey] ? allEventsByTimeStamp[timeStampKey] : [NSMutableArray array];
-        [eventsAtTimesStamp addObject:destinationEvent];
-        allEventsByTimeStamp[timeStampKey] = eventsAtTimesStamp;
-    }
-
-    // Schedule events
-    for (NSNumber *timeStampKey in [allEventsByTimeStamp.allKeys sortedArrayUsingSelector:@selector(compare:)]) {
-        MusicTimeStamp musicTimeStamp = timeStampKey.doubleValue;
-        if (isLooping && (musicTimeStamp < loopStartTimeStamp || musicTimeStamp >= loopEndTimeStamp)) continue;
-        MIDITimeStamp midiTimeStamp = [clock midiTimeStampForMusicTimeStamp:musicTimeStamp];
-        if (midiTimeStamp < MIKMIDIGetCurrentTimeStamp() && midiTimeStamp > fromMIDITimeStamp) continue;	// prevents events that were just recorded from being scheduled
-
-        MIKMIDITempoEvent *tempoEventAtTimeStamp = tempoEventsByTimeStamp[timeStampKey];
-        if (tempoEventAtTimeStamp) [self updateClockWithMusicTimeStamp:musicTimeStamp tempo:tempoEventAtTimeStamp.bpm atMIDITimeStamp:midiTimeStamp];
-
-        NSArray *events = allEventsByTimeStamp[timeStampKey];
-        for (id eventObject in events) {
-            if ([eventObject isKindOfClass:[MIKMIDIEventWithDestination class]]) {
-                [self scheduleEventWithDestination:eventObject];
-            } else if ([eventObject isKindOfClass:[MIKMIDIPendingNoteOffsForTimeStamp class]]) {
-                for (MIKMIDIEventWithDestination *noteOffEvent in [eventObject noteEventsWithEndTimeStamp]) {
-                    [self scheduleEventWithDestination:noteOffEvent];
-                }
-            }
+    NSArray *clickTrackEvents = [self clickTrackEventsFromTimeStamp:fromMusicTimeStamp toTimeStamp:toMusicTimeStamp];
+    if (clickTrackEvents.count) {
+        [sources addObject:clickTrackEvents];
+        [sourceDestinations addObject:[NSNull null]];	// Click track events carry their own destination
+    }
+
+    // Schedule events. A source's place in the heap is keyed by the time stamp of its next event, then its index.
+    NSUInteger sourceCount = sources.count;
+    NSUInteger *cursors = calloc(sourceCount, sizeof(*cursors));
+    MIKMIDISequencerHeapEntry *heap = malloc(sourceCount * sizeof(*heap));
+    NSUInteger heapCount = 0;
+    for (NSUInteger i = 0; i < sourceCount; i++) {
+        NSArray *events = sources[i];
+        if (!events.count) continue;
+        MIKMIDIEvent *firstEvent = events[0];
+        if ([firstEvent isKindOfClass:[MIKMIDIEventWithDestination class]]) firstEvent = [(MIKMIDIEventWithDestination *)firstEvent event];
+        MIKMIDISequencerHeapPush(heap, &heapCount, (MIKMIDISequencerHeapEntry){firstEvent.timeStamp, i, NULL});
+    }
+
+    MIKMIDIPendingNoteOffQueue *pendingNoteOffs = self.pendingNoteOffs;
+    MusicTimeStamp currentMusicTimeStamp = NAN;
+    BOOL skipEventsAtCurrentTimeStamp = NO;
+    MIDITimeStamp currentMIDITimeStamp = 0;
+    while (YES) {
+        // Pending note offs are scheduled after tempo events at the same time stamp, and before everything else.
+        // Those at the end of the loop will be handled right before we loop.
+        MusicTimeStamp noteOffTimeStamp = pendingNoteOffs.nextEndTimeStamp;
+        BOOL noteOffIsDue = (noteOffTimeStamp <= toMusicTimeStamp) && !(isLooping && noteOffTimeStamp >= loopEndTimeStamp);
+        BOOL scheduleNoteOff = noteOffIsDue && (!heapCount || noteOffTimeStamp < heap[0].timeStamp || (noteOffTimeStamp == heap[0].timeStamp && heap[0].order != 0));
+        if (!scheduleNoteOff && !heapCount) break;
+
+        MusicTimeStamp musicTimeStamp = scheduleNoteOff ? noteOffTimeStamp : heap[0].timeStamp;
+        if (musicTimeStamp != currentMusicTimeStamp) {
+            currentMusicTimeStamp = musicTimeStamp;
+            currentMIDITimeStamp = [clock midiTimeStampForMusicTimeStamp:musicTimeStamp];
+            skipEventsAtCurrentTimeStamp = (isLooping && (musicTimeStamp < loopStartTimeStamp || musicTimeStamp >= loopEndTimeStamp));
+            if (!isRenderingOffline && currentMIDITimeStamp < [self currentMIDITimeStamp] && currentMIDITimeStamp > fromMIDITimeStamp) skipEventsAtCurrentTimeStamp = YES;	// prevents events that were just recorded from being scheduled. Offline, nothing is late.
+        }
+
+        if (scheduleNoteOff) {
+            // Always send note offs, even when skipping other events, so no notes are left hanging.
+            [self scheduleEventWithDestination:[pendingNoteOffs removeNextNoteOff]];
+            _numberOfScheduledEvents++;
+            continue;
+        }
+
+        NSUInteger sourceIndex = MIKMIDISequencerHeapPop(heap, &heapCount).order;
+        NSArray *events = sources[sourceIndex];
+        id eventObject = events[cursors[sourceIndex]++];
+        if (cursors[sourceIndex] < events.count) {
+            MIKMIDIEvent *nextEvent = events[cursors[sourceIndex]];
+            if ([nextEvent isKindOfClass:[MIKMIDIEventWithDestination class]]) nextEvent = [(MIKMIDIEventWithDestination *)nextEvent event];
+            MIKMIDISequencerHeapPush(heap, &heapCount, (MIKMIDISequencerHeapEntry){nextEvent.timeStamp, sourceIndex, NULL});
+        }
+        if (skipEventsAtCurrentTimeStamp) continue;
+
+        if (sourceIndex == 0) {
+            MIKMIDITempoEvent *tempoEvent = eventObject;
+            [self updateClockWithMusicTimeStamp:musicTimeStamp tempo:tempoEvent.bpm atMIDITimeStamp:currentMIDITimeStamp];
+        } else if ([eventObject isKindOfClass:[MIKMIDIEventWithDestination class]]) {
+            [self scheduleEventWithDestination:eventObject];
+            _numberOfScheduledEvents++;
+        } else {
+            if ([eventObject isKindOfClass:[MIKMIDINoteEvent class]] && [(MIKMIDINoteEvent *)eventObject duration] <= 0) continue;
+            id destination = sourceDestinations[sourceIndex];
+            if (destination == [NSNull null]) destination = nil;
+            [self scheduleEventWithDestination:[MIKMIDIEventWithDestination eventWithDestination:destination event:eventObject]];
+            _numberOfScheduledEvents++;
         }
     }
+    free(cursors);
+    free(heap);
 
+    // Tempo events in this window re-synced the clock, so the window's end has moved in MIDI time. The next window
+    // has to start where this one's end beat now falls, or events after a tempo change are scheduled twice or skipped.
+    if (tempoEvents.count) actualToMIDITimeStamp = [clock midiTimeStampForMusicTimeStamp:toMusicTimeStamp];
     self.latestScheduledMIDITimeStamp = actualToMIDITimeStamp;
 
     // Handle looping or stopping at the end of the sequence
@@ -426,13 +510,48 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
             [self processSequenceStartingFromMIDITimeStamp:loopStartMIDITimeStamp];
         }
     } else if (!self.isRecording) { // Don't stop automatically during recording
-        MIDITimeStamp systemTimeStamp = MIKMIDIGetCurrentTimeStamp();
+        MIDITimeStamp systemTimeStamp = [self currentMIDITimeStamp];
         if ((systemTimeStamp > actualToMIDITimeStamp) && ([clock musicTimeStampForMIDITimeStamp:systemTimeStamp] >= self.sequenceLength)) {
             [self stopWithDispatchToProcessingQueue:NO];
         }
     }
 }
 
+- (NSArray *)tracksToPlay
+{
+    NSMutableArray *nonMutedTracks = [[NSMutableArray alloc] init];
+    NSMutableArray *soloTracks = [[NSMutableArray alloc] init];
+    for (MIKMIDITrack *track in self.sequence.tracks) {
+        if (track.isMuted) continue;
+
+        [nonMutedTracks addObject:track];
+        if (track.solo) { [soloTracks addObject:track]; }
+    }
+
+    // Never play muted tracks. If any non-muted tracks are soloed, only play those. Matches MusicPlayer behavior
+    return soloTracks.count != 0 ? soloTracks : nonMutedTracks;
+}
+
+// Starts the notes that began before timeStamp and are still held at timeStamp, for the rest of their duration
+- (void)chaseNotesSoundingAtTimeStamp:(MusicTimeStamp)timeStamp
+{
+    for (MIKMIDITrack *track in [self tracksToPlay]) {
+        MusicTimeStamp offset = track.offset;
+        NSArray *notes = [track notesSoundingAtTimeStamp:timeStamp - offset];
+        if (!notes.count) continue;
+
+        id<MIKMIDICommandScheduler> destination = [self commandSchedulerForTrack:track];
+        for (MIKMIDINoteEvent *note in notes) {
+            if (note.timeStamp + offset >= timeStamp) continue;	// Notes starting right at timeStamp are played as usual
+
+            MIKMutableMIDINoteEvent *chasedNote = [note mutableCopy];
+            chasedNote.timeStamp = timeStamp;
+            chasedNote.duration = note.endTimeStamp + offset - timeStamp;
+            [self scheduleEventWithDestination:[MIKMIDIEventWithDestination eventWithDestination:destination event:chasedNote]];
+        }
+    }
+}
+
 - (void)scheduleEventWithDestination:(MIKMIDIEventWithDestination *)destinationEvent
 {
     MIKMIDIEvent *event = destinationEvent.event;
@@ -448,14 +567,7 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
             command = [MIKMIDICommand noteOnCommandFromNoteEvent:noteEvent clock:clock];
 
             // Add note off to pending note offs
-            MusicTimeStamp endTimeStamp = noteEvent.endTimeStamp;
-            NSMutableDictionary *pendingNoteOffs = self.pendingNoteOffs;
-            MIKMIDIPendingNoteOffsForTimeStamp *pendingNoteOffsForEndTimeStamp = pendingNoteOffs[@(endTimeStamp)];
-            if (!pendingNoteOffsForEndTimeStamp) {
-                pendingNoteOffsForEndTimeStamp = [MIKMIDIPendingNoteOffsForTimeStamp pendingNoteOffWithEndTimeStamp:endTimeStamp];
-                pendingNoteOffs[@(endTimeStamp)] = pendingNoteOffsForEndTimeStamp;
-            }
-            [pendingNoteOffsForEndTimeStamp.noteEventsWithEndTimeStamp addObject:[MIKMIDIEventWithDestination eventWithDestination:destination event:event representsNoteOff:YES]];
+            [self.pendingNoteOffs addNoteOff:[MIKMIDIEventWithDestination eventWithDestination:destination event:event representsNoteOff:YES]];
         }
     } else if ([event isKindOfClass:[MIKMIDIChannelEvent class]]) {
         command = [MIKMIDICommand commandFromChannelEvent:(MIKMIDIChannelEvent *)event clock:clock];
@@ -466,31 +578,26 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 
 - (void)sendAllPendingNoteOffsWithMIDITimeStamp:(MIDITimeStamp)offTimeStamp
 {
-    NSMutableDictionary *noteOffs = self.pendingNoteOffs;
+    NSArray *noteOffs = [self.pendingNoteOffs removeAllNoteOffs];
     if (!noteOffs.count) return;
 
     NSMapTable *noteOffDestinationsToCommands = [NSMapTable mapTableWithKeyOptions:NSPointerFunctionsStrongMemory valueOptions:NSPointerFunctionsStrongMemory];
     MIKMIDIClock *clock = self.clock;
 
-    for (NSNumber *musicTimeStampNumber in noteOffs) {
-        MIKMIDIPendingNoteOffsForTimeStamp *pendingNoteOffs = noteOffs[musicTimeStampNumber];
-        for (MIKMIDIEventWithDestination *noteOffEventWithDestination in pendingNoteOffs.noteEventsWithEndTimeStamp) {
-            MIKMIDINoteEvent *event = (MIKMIDINoteEvent *)noteOffEventWithDestination.event;
-            id<MIKMIDICommandScheduler> destination = noteOffEventWithDestination.destination;
-            NSMutableArray *noteOffCommandsForDestination = [noteOffDestinationsToCommands objectForKey:destination] ? [noteOffDestinationsToCommands objectForKey:destination] : [NSMutableArray array];
-
-            MIKMutableMIDICommand *noteOffCommand = [[MIKMIDICommand noteOffCommandFromNoteEvent:event clock:clock] mutableCopy];
-            noteOffCommand.midiTimestamp = offTimeStamp;
-            [noteOffCommandsForDestination addObject:noteOffCommand];
-            [noteOffDestinationsToCommands setObject:noteOffCommandsForDestination forKey:destination];
-        }
+    for (MIKMIDIEventWithDestination *noteOffEventWithDestination in noteOffs) {
+        MIKMIDINoteEvent *event = (MIKMIDINoteEvent *)noteOffEventWithDestination.event;
+        id<MIKMIDICommandScheduler> destination = noteOffEventWithDestination.destination;
+        NSMutableArray *noteOffCommandsForDestination = [noteOffDestinationsToCommands objectForKey:destination] ? [noteOffDestinationsToCommands objectForKey:destination] : [NSMutableArray array];
+
+        MIKMutableMIDICommand *noteOffCommand = [[MIKMIDICommand noteOffCommandFromNoteEvent:event clock:clock] mutableCopy];
+        noteOffCommand.midiTimestamp = offTimeStamp;
+        [noteOffCommandsForDestination addObject:noteOffCommand];
+        [noteOffDestinationsToCommands setObject:noteOffCommandsForDestination forKey:destination];
     }
 
     for (id<MIKMIDICommandScheduler> scheduler in [[noteOffDestinationsToCommands keyEnumerator] allObjects]) {
         [self scheduleCommands:[noteOffDestinationsToCommands objectForKey:scheduler] withCommandScheduler:scheduler];
     }
-
-    [noteOffs removeAllObjects];
 }
 
 - (void)updateClockWithMusicTimeStamp:(MusicTimeStamp)musicTimeStamp tempo:(Float64)tempo atMIDITimeStamp:(MIDITimeStamp)midiTimeStamp
@@ -718,13 +825,121 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
         [self didChangeValueForKey:@"loopStartTimeStamp"];
         [self didChangeValueForKey:@"loopEndTimeStamp"];
     }];
+    [self setNeedsProcessing];
 }
 
 #pragma mark - Timer
 
-- (void)processingTimerFired:(NSTimer *)timer
+// Processes the sequence at midiTimeStamp, then periodically after that until playback stops or restarts,
+// according to the time source. Must be called on the processing queue.
+- (void)scheduleProcessingTimerAtMIDITimeStamp:(MIDITimeStamp)midiTimeStamp generation:(NSUInteger)generation
 {
-    [self processSequenceStartingFromMIDITimeStamp:self.latestScheduledMIDITimeStamp + 1];
+    id<MIKMIDITimeSource> timeSource = self.timeSource;
+    [timeSource dispatchAtMIDITimeStamp:midiTimeStamp queue:self.processingQueue block:^{
+        if (self->_processingTimerGeneration != generation) return;
+        self->_processingTimerIsIdle = NO;
+
+        MIDITimeStamp now = timeSource.currentMIDITimeStamp;
+        NSTimeInterval lateness = (now > midiTimeStamp) ? (now - midiTimeStamp) * MIKMIDIClockSecondsPerMIDITimeStamp() : 0;
+        NSTimeInterval interval = [self updateLookAheadIntervalWithWakeUpLateness:lateness];
+
+        MIDITimeStamp fromMIDITimeStamp = self.latestScheduledMIDITimeStamp;
+        NSUInteger numberOfScheduledEvents = self->_numberOfScheduledEvents;
+        [self processSequenceStartingFromMIDITimeStamp:fromMIDITimeStamp];
+        if (self->_processingTimerGeneration != generation) return;	// Stopped at the end of the sequence
+        numberOfScheduledEvents = self->_numberOfScheduledEvents - numberOfScheduledEvents;
+
+        MIDITimeStamp nextMIDITimeStamp = midiTimeStamp + MIKMIDIClockMIDITimeStampsPerTimeInterval(interval);
+        if (self.isAdaptiveLookAheadEnabled) {
+            MIDITimeStamp toMIDITimeStamp = self.latestScheduledMIDITimeStamp;
+            if (toMIDITimeStamp > fromMIDITimeStamp) {
+                Float64 eventsPerSecond = numberOfScheduledEvents / ((toMIDITimeStamp - fromMIDITimeStamp) * MIKMIDIClockSecondsPerMIDITimeStamp());
+                self->_eventsPerSecondEstimate = MAX(eventsPerSecond, self->_eventsPerSecondEstimate / 2.0);
+            }
+            if (!numberOfScheduledEvents) {
+                MIDITimeStamp idleMIDITimeStamp = [self idleWakeUpMIDITimeStampAfterMIDITimeStamp:now];
+                if (idleMIDITimeStamp > nextMIDITimeStamp) {
+                    nextMIDITimeStamp = idleMIDITimeStamp;
+                    self->_eventsPerSecondEstimate = 0;
+                    self->_processingTimerIsIdle = YES;
+                }
+            }
+        }
+        nextMIDITimeStamp = MAX(nextMIDITimeStamp, timeSource.currentMIDITimeStamp);
+
+        MIKMIDISequencerSchedulingStatistics *statistics = &self->_schedulingStatistics;
+        statistics->sleepInterval = (nextMIDITimeStamp - MIN(now, nextMIDITimeStamp)) * MIKMIDIClockSecondsPerMIDITimeStamp();
+        statistics->numberOfEventsScheduledAtLastWakeUp = numberOfScheduledEvents;
+        statistics->maximumNumberOfEventsScheduledAtOneWakeUp = MAX(statistics->maximumNumberOfEventsScheduledAtOneWakeUp, numberOfScheduledEvents);
+
+        [self scheduleProcessingTimerAtMIDITimeStamp:nextMIDITimeStamp generation:generation];
+    }];
+}
+
+// Chooses the look-ahead interval for a wake-up, and returns how long to wait until the next one. Must be called on the processing queue.
+- (NSTimeInterval)updateLookAheadIntervalWithWakeUpLateness:(NSTimeInterval)lateness
+{
+    NSTimeInterval maximumLookAheadInterval = self.maximumLookAheadInterval;
+    NSTimeInterval interval = kProcessingTimerInterval;
+    if (self.isAdaptiveLookAheadEnabled) {
+        _wakeUpLatenessEstimate = MAX(lateness, _wakeUpLatenessEstimate * kWakeUpLatenessEstimateDecay);
+        NSTimeInterval latenessAllowance = 2.0 * _wakeUpLatenessEstimate + kLookAheadSafetyMargin;
+
+        // Wake up often enough to schedule about kTargetNumberOfEventsPerProcessingPass events at a time,
+        // looking ahead far enough to reach past the next wake-up, even if it's as late as recent ones.
+        if (_eventsPerSecondEstimate > 0) interval = MIN(kTargetNumberOfEventsPerProcessingPass / _eventsPerSecondEstimate, interval);
+        interval = MAX(MIN(interval, maximumLookAheadInterval - latenessAllowance), kMinimumProcessingTimerInterval);
+        _lookAheadInterval = MIN(interval + latenessAllowance, maximumLookAheadInterval);
+    } else {
+        _lookAheadInterval = maximumLookAheadInterval;
+    }
+
+    MIKMIDISequencerSchedulingStatistics *statistics = &_schedulingStatistics;
+    statistics->numberOfWakeUps++;
+    statistics->lookAheadInterval = _lookAheadInterval;
+    statistics->lastWakeUpLateness = lateness;
+    statistics->maximumWakeUpLateness = MAX(statistics->maximumWakeUpLateness, lateness);
+    statistics->averageWakeUpLateness += (lateness - statistics->averageWakeUpLateness) / statistics->numberOfWakeUps;
+
+    return interval;
+}
+
+// Returns when to wake up so that the next thing after what's been scheduled so far is scheduled in time,
+// or 0 if the sequencer shouldn't sleep. Must be called on the processing queue.
+- (MIDITimeStamp)idleWakeUpMIDITimeStampAfterMIDITimeStamp:(MIDITimeStamp)now
+{
+    if (self.isRecording || self.needsCurrentTempoUpdate) return 0;
+
+    MIKMIDIClock *clock = self.clock;
+    MIDITimeStamp latestScheduledMIDITimeStamp = self.latestScheduledMIDITimeStamp;
+    MusicTimeStamp fromTimeStamp = [clock musicTimeStampForMIDITimeStamp:latestScheduledMIDITimeStamp];
+    MusicTimeStamp sequenceLength = self.sequenceLength;
+    if (fromTimeStamp >= sequenceLength) return latestScheduledMIDITimeStamp + 1; // Wake up to stop
+
+    MusicTimeStamp nextTimeStamp = MIN(self.pendingNoteOffs.nextEndTimeStamp, sequenceLength);
+    for (MIKMIDITrack *track in [self tracksToPlay]) {
+        MusicTimeStamp offset = track.offset;
+        MusicTimeStamp timeStamp = [track timeStampOfFirstEventAfterTimeStamp:fromTimeStamp - offset];
+        if (timeStamp != DBL_MAX) nextTimeStamp = MIN(nextTimeStamp, timeStamp + offset);
+    }
+    if (!self.tempo) nextTimeStamp = MIN(nextTimeStamp, [self.sequence.tempoTrack timeStampOfFirstEventAfterTimeStamp:fromTimeStamp]);
+    for (MIKMIDIEventWithDestination *clickEvent in [self clickTrackEventsFromTimeStamp:fromTimeStamp toTimeStamp:fromTimeStamp + 4]) {
+        if (clickEvent.event.timeStamp <= fromTimeStamp) continue;
+        nextTimeStamp = MIN(nextTimeStamp, clickEvent.event.timeStamp);
+        break;
+    }
+    if (self.shouldLoop) {
+        MusicTimeStamp loopStartTimeStamp = self.loopStartTimeStamp, loopEndTimeStamp = self.effectiveLoopEndTimeStamp;
+        if (loopStartTimeStamp > fromTimeStamp) nextTimeStamp = MIN(nextTimeStamp, loopStartTimeStamp);
+        if (loopEndTimeStamp > fromTimeStamp) nextTimeStamp = MIN(nextTimeStamp, loopEndTimeStamp);
+    }
+
+    // Wake up one look-ahead interval early. Waking up from idle, the interval will be at least as long as this.
+    NSTimeInterval lookAheadInterval = MIN(kProcessingTimerInterval + 2.0 * _wakeUpLatenessEstimate + kLookAheadSafetyMargin, self.maximumLookAheadInterval);
+    MIDITimeStamp nextMIDITimeStamp = [clock midiTimeStampForMusicTimeStamp:nextTimeStamp];
+    MIDITimeStamp lookAhead = MIKMIDIClockMIDITimeStampsPerTimeInterval(lookAheadInterval);
+    MIDITimeStamp wakeUpMIDITimeStamp = (nextMIDITimeStamp > lookAhead) ? nextMIDITimeStamp - lookAhead : 0;
+    return MIN(wakeUpMIDITimeStamp, now + MIKMIDIClockMIDITimeStampsPerTimeInterval(kMaximumIdleProcessingTimerInterval));
 }
 
 #pragma mark - KVO
@@ -760,7 +975,7 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 {
     MIKMIDIClock *clock = self.clock;
     if (clock.isReady) {
-        MusicTimeStamp timeStamp = [clock musicTimeStampForMIDITimeStamp:MIKMIDIGetCurrentTimeStamp()];
+        MusicTimeStamp timeStamp = [clock musicTimeStampForMIDITimeStamp:[self currentMIDITimeStamp]];
         _currentTimeStamp = MAX(((timeStamp <= self.sequenceLength) ? timeStamp : self.sequenceLength), self.startingTimeStamp);
     }
     return _currentTimeStamp;
@@ -788,14 +1003,11 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     _preRoll = (preRoll >= 0) ? preRoll : 0;
 }
 
-- (void)setProcessingTimer:(dispatch_source_t)processingTimer
+- (void)setTimeSource:(id<MIKMIDITimeSource>)timeSource
 {
-    if (_processingTimer != processingTimer) {
-        if (_processingTimer) {
-            dispatch_source_cancel(_processingTimer);
-        }
-        _processingTimer = processingTimer;
-    }
+    if (!timeSource) timeSource = [MIKMIDIHostTimeSource hostTimeSource];
+    _timeSource = timeSource;
+    self.clock.timeSource = timeSource;
 }
 
 @synthesize metronome = _metronome;
@@ -815,6 +1027,7 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     if (_tempo != tempo) {
         _tempo = tempo;
         if (self.isPlaying) self.needsCurrentTempoUpdate = YES;
+        [self setNeedsProcessing];
     }
 }
 
@@ -846,6 +1059,15 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     _maximumLookAheadInterval = MIN(MAX(maximumLookAheadInterval, 0.05), 1.0);
 }
 
+- (MIKMIDISequencerSchedulingStatistics)schedulingStatistics
+{
+    __block MIKMIDISequencerSchedulingStatistics statistics;
+    [self dispatchSyncToProcessingQueueAsNeeded:^{
+        statistics = self->_schedulingStatistics;
+    }];
+    return statistics;
+}
+
 #pragma mark - Deprecated
 
 - (void)setDestinationEndpoint:(MIKMIDIDestinationEndpoint *)endpoint forTrack:(MIKMIDITrack *)track
@@ -877,6 +1099,18 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
     }
 }
 
+- (void)setNeedsProcessing
+{
+    dispatch_queue_t processingQueue = self.processingQueue;
+    if (!processingQueue) return;
+
+    dispatch_async(processingQueue, ^{
+        if (!self->_processingTimerIsIdle || !self.isPlaying || self.isRenderingOffline) return;
+        self->_processingTimerIsIdle = NO;
+        [self scheduleProcessingTimerAtMIDITimeStamp:self.timeSource.currentMIDITimeStamp generation:++self->_processingTimerGeneration];
+    });
+}
+
 @end
 
 
@@ -913,19 +1147,102 @@ const MusicTimeStamp MIKMIDISequencerEndOfSequenceLoopEndTimeStamp = -1;
 @end
 
 
-@implementation MIKMIDIPendingNoteOffsForTimeStamp
+@implementation MIKMIDIPendingNoteOffQueue
+{
+    MIKMIDISequencerHeapEntry *_heap;
+    NSUInteger _capacity;
+    NSUInteger _nextOrder;
+}
+
+- (void)dealloc
+{
+    for (NSUInteger i = 0; i < _count; i++) CFRelease(_heap[i].object);
+    free(_heap);
+}
+
+- (void)addNoteOff:(MIKMIDIEventWithDestination *)noteOff
+{
+    if (_count == _capacity) {
+        _capacity = MAX(_capacity * 2, 64);
+        _heap = reallocf(_heap, _capacity * sizeof(*_heap));
+        if (!_heap) [NSException raise:NSMallocException format:@"Unable to allocate storage for %lu note offs.", (unsigned long)_capacity];
+    }
+    MusicTimeStamp endTimeStamp = [(MIKMIDINoteEvent *)noteOff.event endTimeStamp];
+    MIKMIDISequencerHeapPush(_heap, &_count, (MIKMIDISequencerHeapEntry){endTimeStamp, _nextOrder++, (void *)CFBridgingRetain(noteOff)});
+}
+
+- (MIKMIDIEventWithDestination *)removeNextNoteOff
+{
+    if (!_count) return nil;
+    return CFBridgingRelease(MIKMIDISequencerHeapPop(_heap, &_count).object);
+}
+
+- (NSArray *)removeNoteOffsWithDestination:(id<MIKMIDICommandScheduler>)destination
+{
+    NSMutableArray *result = [NSMutableArray array];
+    NSUInteger count = _count;
+    _count = 0;
+    // Rebuild the heap in place from the note offs being kept. It never grows past the entry being read.
+    for (NSUInteger i = 0; i < count; i++) {
+        MIKMIDISequencerHeapEntry entry = _heap[i];
+        MIKMIDIEventWithDestination *noteOff = (__bridge MIKMIDIEventWithDestination *)entry.object;
+        if (noteOff.destination == destination) {
+            [result addObject:CFBridgingRelease(entry.object)];
+        } else {
+            MIKMIDISequencerHeapPush(_heap, &_count, entry);
+        }
+    }
+    return result;
+}
 
-+ (instancetype)pendingNoteOffWithEndTimeStamp:(MusicTimeStamp)endTimeStamp
+- (NSArray *)removeAllNoteOffs
 {
-    MIKMIDIPendingNoteOffsForTimeStamp *noteOff = [[self alloc] init];
-    noteOff->_endTimeStamp = endTimeStamp;
-    return noteOff;
+    NSMutableArray *result = [NSMutableArray arrayWithCapacity:_count];
+    while (_count) [result addObject:[self removeNextNoteOff]];
+    return result;
 }
 
-- (NSMutableArray *)noteEventsWithEndTimeStamp
+- (MusicTimeStamp)nextEndTimeStamp
 {
-    if (!_noteEventsWithEndTimeStamp) _noteEventsWithEndTimeStamp = [NSMutableArray array];
-    return _noteEventsWithEndTimeStamp;
+    return _count ? _heap[0].timeStamp : DBL_MAX;
 }
 
 @end
+
+
+#pragma mark -
+
+static BOOL MIKMIDISequencerHeapEntryPrecedes(MIKMIDISequencerHeapEntry entry1, MIKMIDISequencerHeapEntry entry2)
+{
+    if (entry1.timeStamp != entry2.timeStamp) return entry1.timeStamp < entry2.timeStamp;
+    return entry1.order < entry2.order;
+}
+
+static void MIKMIDISequencerHeapPush(MIKMIDISequencerHeapEntry *heap, NSUInteger *count, MIKMIDISequencerHeapEntry entry)
+{
+    NSUInteger index = (*count)++;
+    while (index > 0) {
+        NSUInteger parent = (index - 1) / 2;
+        if (!MIKMIDISequencerHeapEntryPrecedes(entry, heap[parent])) break;
+        heap[index] = heap[parent];
+        index = parent;
+    }
+    heap[index] = entry;
+}
+
+static MIKMIDISequencerHeapEntry MIKMIDISequencerHeapPop(MIKMIDISequencerHeapEntry *heap, NSUInteger *count)
+{
+    MIKMIDISequencerHeapEntry result = heap[0];
+    MIKMIDISequencerHeapEntry last = heap[--(*count)];
+    NSUInteger index = 0;
+    while (YES) {
+        NSUInteger child = 2 * index + 1;
+        if (child >= *count) break;
+        if (child + 1 < *count && MIKMIDISequencerHeapEntryPrecedes(heap[child + 1], heap[child])) child++;
+        if (!MIKMIDISequencerHeapEntryPrecedes(heap[child], last)) break;
+        heap[index] = heap[child];
+        index = child;
+    }
+    if (*count) heap[index] = last;
+    return result;
+}
@@ -0,0 +1,74 @@
+//
+//  MIKMIDISimulatedTimeSource.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "MIKMIDITimeSource.h"
+#import "MIKMIDICompilerCompatibility.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  MIKMIDISimulatedTimeSource is a time source whose time only changes when it's advanced.
+ *
+ *  Blocks waiting for a time stamp are run as the time source is advanced past it, in time stamp
+ *  order, with the current time set to the time stamp each was waiting for. Blocks dispatched for
+ *  a time that has already been reached wait for the next advance, so nothing runs behind the
+ *  caller's back. This lets code that
+ *  depends on timing, like a playing MIKMIDISequencer or an MIKMIDIInputPort waiting for the end
+ *  of a system exclusive message, be driven through minutes of simulated time in milliseconds,
+ *  with exactly the same results every time.
+ */
+@interface MIKMIDISimulatedTimeSource : NSObject <MIKMIDITimeSource>
+
+/**
+ *  Creates a simulated time source starting at the current host time.
+ *
+ *  @return An initialized simulated time source.
+ */
+- (instancetype)init;
+
+/**
+ *  Creates a simulated time source starting at a particular time.
+ *
+ *  @param midiTimeStamp The time stamp to start at.
+ *
+ *  @return An initialized simulated time source.
+ */
+- (instancetype)initWithMIDITimeStamp:(MIDITimeStamp)midiTimeStamp NS_DESIGNATED_INITIALIZER;
+
+/**
+ *  Moves the time forward to a time stamp, running every block that was waiting for a time
+ *  stamp up to and including it. Blocks are run synchronously on their queues, so when this
+ *  method returns they have all finished. Blocks they submit that are due by midiTimeStamp are
+ *  run too.
+ *
+ *  This must not be called on any of the queues blocks are waiting to be submitted to.
+ *
+ *  @param midiTimeStamp The time stamp to advance to. Does nothing if it's earlier than the current time.
+ */
+- (void)advanceToMIDITimeStamp:(MIDITimeStamp)midiTimeStamp;
+
+/**
+ *  Moves the time forward by a time interval.
+ *
+ *  @param timeInterval The number of seconds to advance by.
+ *
+ *  @see -advanceToMIDITimeStamp:
+ */
+- (void)advanceByTimeInterval:(NSTimeInterval)timeInterval;
+
+/**
+ *  The number of blocks that haven't been run yet. This includes blocks whose time stamp has
+ *  already been reached, such as blocks added for a past time stamp, until the next call to
+ *  -advanceToMIDITimeStamp: or -advanceByTimeInterval: runs them.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfPendingBlocks;
+
+@end
+
+NS_ASSUME_NONNULL_END
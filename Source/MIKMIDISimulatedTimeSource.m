@@ -0,0 +1,114 @@
+//
+//  MIKMIDISimulatedTimeSource.m
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDISimulatedTimeSource.h"
+#import <stdatomic.h>
+#import "MIKMIDIUtilities.h"
+#import "MIKMIDIClock.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDISimulatedTimeSource.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDISimulatedTimeSource.m in the Build Phases for this target
+#endif
+
+@interface MIKMIDISimulatedTimeSourcePendingBlock : NSObject
+@property (nonatomic) MIDITimeStamp midiTimeStamp;
+@property (nonatomic, strong) dispatch_queue_t queue;
+@property (nonatomic, copy) dispatch_block_t block;
+@end
+
+@implementation MIKMIDISimulatedTimeSource
+{
+	atomic_ullong _currentMIDITimeStamp;
+	dispatch_queue_t _stateQueue;
+	NSMutableArray *_pendingBlocks; // In time stamp order, then the order they were added in. Only used on _stateQueue.
+}
+
+- (instancetype)init
+{
+	return [self initWithMIDITimeStamp:MIKMIDIGetCurrentTimeStamp()];
+}
+
+- (instancetype)initWithMIDITimeStamp:(MIDITimeStamp)midiTimeStamp
+{
+	self = [super init];
+	if (self) {
+		atomic_init(&_currentMIDITimeStamp, midiTimeStamp);
+		_stateQueue = dispatch_queue_create("com.mixedinkey.MIKMIDI.MIKMIDISimulatedTimeSource.stateQueue", DISPATCH_QUEUE_SERIAL);
+		_pendingBlocks = [NSMutableArray array];
+	}
+	return self;
+}
+
+#pragma mark - MIKMIDITimeSource
+
+- (MIDITimeStamp)currentMIDITimeStamp
+{
+	return atomic_load_explicit(&_currentMIDITimeStamp, memory_order_acquire);
+}
+
+- (void)dispatchAtMIDITimeStamp:(MIDITimeStamp)midiTimeStamp queue:(dispatch_queue_t)queue block:(dispatch_block_t)block
+{
+	MIKMIDISimulatedTimeSourcePendingBlock *pendingBlock = [[MIKMIDISimulatedTimeSourcePendingBlock alloc] init];
+	pendingBlock.midiTimeStamp = midiTimeStamp;
+	pendingBlock.queue = queue;
+	pendingBlock.block = block;
+	dispatch_sync(_stateQueue, ^{
+		NSUInteger index = [self->_pendingBlocks indexOfObject:pendingBlock
+												 inSortedRange:NSMakeRange(0, self->_pendingBlocks.count)
+													   options:NSBinarySearchingLastEqual | NSBinarySearchingInsertionIndex
+											   usingComparator:^NSComparisonResult(MIKMIDISimulatedTimeSourcePendingBlock *block1, MIKMIDISimulatedTimeSourcePendingBlock *block2) {
+												   if (block1.midiTimeStamp < block2.midiTimeStamp) return NSOrderedAscending;
+												   if (block1.midiTimeStamp > block2.midiTimeStamp) return NSOrderedDescending;
+												   return NSOrderedSame;
+											   }];
+		[self->_pendingBlocks insertObject:pendingBlock atIndex:index];
+	});
+}
+
+#pragma mark - Public
+
+- (void)advanceToMIDITimeStamp:(MIDITimeStamp)midiTimeStamp
+{
+	while (YES) {
+		__block MIKMIDISimulatedTimeSourcePendingBlock *nextBlock = nil;
+		dispatch_sync(_stateQueue, ^{
+			MIKMIDISimulatedTimeSourcePendingBlock *firstBlock = self->_pendingBlocks.firstObject;
+			MIDITimeStamp now = atomic_load_explicit(&self->_currentMIDITimeStamp, memory_order_relaxed);
+			if (firstBlock && firstBlock.midiTimeStamp <= midiTimeStamp) {
+				nextBlock = firstBlock;
+				[self->_pendingBlocks removeObjectAtIndex:0];
+				now = MAX(now, firstBlock.midiTimeStamp);
+			} else {
+				now = MAX(now, midiTimeStamp);
+			}
+			atomic_store_explicit(&self->_currentMIDITimeStamp, now, memory_order_release);
+		});
+		if (!nextBlock) break;
+
+		dispatch_sync(nextBlock.queue, nextBlock.block);
+	}
+}
+
+- (void)advanceByTimeInterval:(NSTimeInterval)timeInterval
+{
+	[self advanceToMIDITimeStamp:self.currentMIDITimeStamp + MIKMIDIClockMIDITimeStampsPerTimeInterval(timeInterval)];
+}
+
+#pragma mark - Properties
+
+- (NSUInteger)numberOfPendingBlocks
+{
+	__block NSUInteger result = 0;
+	dispatch_sync(_stateQueue, ^{ result = self->_pendingBlocks.count; });
+	return result;
+}
+
+@end
+
+@implementation MIKMIDISimulatedTimeSourcePendingBlock
+@end
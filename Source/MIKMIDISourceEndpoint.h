@@ -22,6 +22,37 @@ NS_ASSUME_NONNULL_BEGIN
  */
 typedef void(^MIKMIDIEventHandlerBlock)(MIKMIDISourceEndpoint *source, MIKArrayOf(MIKMIDICommand *) *commands); // commands in an array of MIKMIDICommands
 
+/**
+ *  Where and how an MIKMIDIEventHandlerBlock is called with incoming MIDI messages.
+ *
+ *  In every mode but MIKMIDIEventDeliveryModeBatchedMainQueue, the handler is called once for each
+ *  packet list received from CoreMIDI, with all of the commands in it.
+ */
+typedef NS_ENUM(NSInteger, MIKMIDIEventDeliveryMode) {
+	/** The handler is called on the main queue. This is the default. */
+	MIKMIDIEventDeliveryModeMainQueue = 0,
+	
+	/** The handler is called on the main queue, with all of the commands received since
+	 it was last called. Under heavy input, this calls the handler far less often than
+	 MIKMIDIEventDeliveryModeMainQueue. */
+	MIKMIDIEventDeliveryModeBatchedMainQueue,
+	
+	/** The handler is called on a serial, high priority background queue, so delivery
+	 isn't delayed by work on the main thread. */
+	MIKMIDIEventDeliveryModeHighPriorityQueue,
+	
+	/** The handler is called right away, on the thread the commands were received on.
+	 This is usually CoreMIDI's high priority MIDI read thread, so this has the lowest
+	 latency, but the handler must return quickly, and must not block, to avoid delaying
+	 further input.
+	 
+	 Commands that are delivered late, rather than as a packet list is received, are delivered
+	 on an internal serial queue instead. These are 14-bit control change MSBs whose LSB never
+	 came, and system exclusive messages that timed out. So the handler may be called on that
+	 queue at the same time as it's called on the read thread, and must be thread safe. */
+	MIKMIDIEventDeliveryModeReadThread,
+};
+
 /**
  *  MIKMIDISourceEndpoint represents a source (input) MIDI endpoint.
  *  It is essentially an Objective-C wrapper for instances of CoreMIDI's MIDIEndpoint class
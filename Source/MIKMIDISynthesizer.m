@@ -12,14 +12,44 @@
 #import "MIKMIDIErrors.h"
 #import "MIKMIDIClock.h"
 #import "MIKMIDIPrivate.h"
+#include <stdatomic.h>
+
+// Size of both the ring buffer and the render thread's pending command heap, so up to twice this many commands can be waiting
+#define kMIKMIDISynthesizerScheduledCommandCapacity	2048
+
+// A command waiting to be sent to the instrument unit
+typedef struct {
+	MIDITimeStamp timeStamp;
+	UInt32 order; // Keeps commands with the same time stamp in the order they were scheduled
+	UInt8 statusByte;
+	UInt8 dataByte1;
+	UInt8 dataByte2;
+} MIKMIDISynthesizerScheduledCommand;
+
+static void MIKMIDISynthesizerPushPendingCommand(MIKMIDISynthesizerScheduledCommand *heap, NSUInteger *count, MIKMIDISynthesizerScheduledCommand command);
+static MIKMIDISynthesizerScheduledCommand MIKMIDISynthesizerPopPendingCommand(MIKMIDISynthesizerScheduledCommand *heap, NSUInteger *count);
 
 @interface MIKMIDISynthesizer ()
 {
-	CFMutableDictionaryRef _scheduledCommandsByTimeStamp;
-	CFMutableSetRef _scheduledCommandTimeStampsSet;
-	CFMutableArrayRef _scheduledCommandTimeStampsArray;
-
+	// Scheduled commands are passed to the render thread through a single producer, single consumer ring buffer,
+	// so the render thread never waits for a lock or allocates memory. The indexes only ever increase.
+	// _scheduledCommandQueue serializes producers. The buffers are allocated when something is first scheduled.
+	MIKMIDISynthesizerScheduledCommand *_scheduledCommands;
+	atomic_size_t _scheduledCommandsWriteIndex;
+	atomic_size_t _scheduledCommandsReadIndex;
+	UInt32 _nextScheduledCommandOrder;
 	dispatch_queue_t _scheduledCommandQueue;
+
+	// Commands the render thread has taken from the ring buffer that aren't due yet, in a min-heap
+	// ordered by time stamp. Only used on the render thread.
+	MIKMIDISynthesizerScheduledCommand *_pendingCommands;
+	NSUInteger _numberOfPendingCommands;
+
+	// Worked out again only when the buffer size or sample rate changes. Only used on the render thread.
+	UInt32 _renderNumberOfFrames;
+	Float64 _renderSampleRate;
+	MIDITimeStamp _midiTimeStampsPerRender;
+	UInt64 _sampleFramesPerMIDITimeStamp; // 32.32 fixed point
 }
 
 @end
@@ -47,6 +77,8 @@
 		}
 #endif
 		_scheduledCommandQueue = dispatch_queue_create(queueLabel.UTF8String, attr);
+		atomic_init(&_scheduledCommandsWriteIndex, 0);
+		atomic_init(&_scheduledCommandsReadIndex, 0);
 
 		_componentDescription = componentDescription;
 		if (![self setupAUGraphWithError:error]) { return nil; }
@@ -60,23 +92,12 @@
 
 - (void)dealloc
 {
+	// Removes the render notify, so the render thread is done with the buffers
 	self.instrumentUnit = NULL;
 	self.graph = NULL;
 
-	if (_scheduledCommandsByTimeStamp) {
-		CFRelease(_scheduledCommandsByTimeStamp);
-		_scheduledCommandsByTimeStamp = NULL;
-	}
-
-	if (_scheduledCommandTimeStampsSet) {
-		CFRelease(_scheduledCommandTimeStampsSet);
-		_scheduledCommandTimeStampsSet = NULL;
-	}
-
-	if (_scheduledCommandTimeStampsArray) {
-		CFRelease(_scheduledCommandTimeStampsArray);
-		_scheduledCommandTimeStampsArray = NULL;
-	}
+	free(_scheduledCommands);
+	free(_pendingCommands);
 }
 
 #pragma mark - Public
@@ -381,104 +402,77 @@
 
 - (void)scheduleMIDICommands:(NSArray *)commands
 {
-	for (MIKMIDICommand *command in commands) {
-		dispatch_sync(_scheduledCommandQueue, ^{
-			NSUInteger count = commands.count;
-			if (!self->_scheduledCommandsByTimeStamp) {
-				self->_scheduledCommandsByTimeStamp = CFDictionaryCreateMutable(NULL, count, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
-			}
-			if (!self->_scheduledCommandTimeStampsSet) {
-				self->_scheduledCommandTimeStampsSet = CFSetCreateMutable(NULL, count, &kCFTypeSetCallBacks);
-			}
-			if (!self->_scheduledCommandTimeStampsArray) {
-				self->_scheduledCommandTimeStampsArray = CFArrayCreateMutable(NULL, count, &kCFTypeArrayCallBacks);
-			}
+	dispatch_sync(_scheduledCommandQueue, ^{
+		if (!self->_scheduledCommands) {
+			// Published to the render thread by the first store to the write index
+			self->_scheduledCommands = calloc(kMIKMIDISynthesizerScheduledCommandCapacity, sizeof(MIKMIDISynthesizerScheduledCommand));
+			self->_pendingCommands = calloc(kMIKMIDISynthesizerScheduledCommandCapacity, sizeof(MIKMIDISynthesizerScheduledCommand));
+		}
 
-			MIDITimeStamp timeStamp = command.midiTimestamp;
-			void *timeStampNumber = (__bridge void*)@(timeStamp);
-			CFMutableArrayRef commandsAtTimeStamp = (CFMutableArrayRef)CFDictionaryGetValue(self->_scheduledCommandsByTimeStamp, timeStampNumber);
-			if (!commandsAtTimeStamp) {
-				commandsAtTimeStamp = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);
-				CFDictionarySetValue(self->_scheduledCommandsByTimeStamp, timeStampNumber, (void *)commandsAtTimeStamp);
-				CFRelease(commandsAtTimeStamp);
-
-				if (!CFSetContainsValue(self->_scheduledCommandTimeStampsSet, timeStampNumber)) {
-					CFSetAddValue(self->_scheduledCommandTimeStampsSet, timeStampNumber);
-					CFArrayAppendValue(self->_scheduledCommandTimeStampsArray, timeStampNumber);
-				}
+		size_t writeIndex = atomic_load_explicit(&self->_scheduledCommandsWriteIndex, memory_order_relaxed);
+		for (MIKMIDICommand *command in commands) {
+			size_t readIndex = atomic_load_explicit(&self->_scheduledCommandsReadIndex, memory_order_acquire);
+			if (writeIndex - readIndex >= kMIKMIDISynthesizerScheduledCommandCapacity) {
+				NSLog(@"Dropping %@ scheduled with %@, because too many commands are waiting to be sent.", command, self);
+				continue;
 			}
 
-			CFArrayAppendValue(commandsAtTimeStamp, (__bridge void *)command);
-		});
-	}
+			MIKMIDISynthesizerScheduledCommand *scheduledCommand = &self->_scheduledCommands[writeIndex % kMIKMIDISynthesizerScheduledCommandCapacity];
+			scheduledCommand->timeStamp = command.midiTimestamp;
+			scheduledCommand->order = self->_nextScheduledCommandOrder++;
+			scheduledCommand->statusByte = command.statusByte;
+			scheduledCommand->dataByte1 = command.dataByte1;
+			scheduledCommand->dataByte2 = command.dataByte2;
+			atomic_store_explicit(&self->_scheduledCommandsWriteIndex, ++writeIndex, memory_order_release);
+		}
+	});
 }
 
 #pragma mark - Callbacks
 
 OSStatus MIKMIDISynthesizerScheduleUpcomingMIDICommands(MIKMIDISynthesizer *synth, AudioUnit instrumentUnit, UInt32 inNumberFrames, Float64 sampleRate, const AudioTimeStamp *inTimeStamp)
 {
-	dispatch_queue_t queue = synth->_scheduledCommandQueue;
-	if (!queue) return noErr;	// no commands have been scheduled with this synth
-
-	static NSTimeInterval lastTimeUntilNextCallback = 0;
-	static MIDITimeStamp lastMIDITimeStampsUntilNextCallback = 0;
-	NSTimeInterval timeUntilNextCallback = inNumberFrames / sampleRate;
-	MIDITimeStamp midiTimeStampsUntilNextCallback = lastMIDITimeStampsUntilNextCallback;
-
-	if (lastTimeUntilNextCallback != timeUntilNextCallback) {
-		midiTimeStampsUntilNextCallback = MIKMIDIClockMIDITimeStampsPerTimeInterval(timeUntilNextCallback);
-		lastTimeUntilNextCallback = timeUntilNextCallback;
-		lastMIDITimeStampsUntilNextCallback = midiTimeStampsUntilNextCallback;
+	size_t writeIndex = atomic_load_explicit(&synth->_scheduledCommandsWriteIndex, memory_order_acquire);
+	if (!writeIndex) return noErr;	// no commands have been scheduled with this synth
+	if (!inNumberFrames) return noErr;
+
+	if (inNumberFrames != synth->_renderNumberOfFrames || sampleRate != synth->_renderSampleRate) {
+		synth->_renderNumberOfFrames = inNumberFrames;
+		synth->_renderSampleRate = sampleRate;
+		synth->_midiTimeStampsPerRender = MIKMIDIClockMIDITimeStampsPerTimeInterval(inNumberFrames / sampleRate);
+		synth->_sampleFramesPerMIDITimeStamp = llround(sampleRate * MIKMIDIClockSecondsPerMIDITimeStamp() * 4294967296.0);
 	}
+	MIDITimeStamp hostTime = inTimeStamp->mHostTime;
+	MIDITimeStamp midiTimeStampsPerRender = synth->_midiTimeStampsPerRender;
+	UInt64 sampleFramesPerMIDITimeStamp = synth->_sampleFramesPerMIDITimeStamp;
+	MIDITimeStamp toTimeStamp = hostTime + midiTimeStampsPerRender;
+
+	// Take everything newly scheduled off the ring buffer, as it isn't necessarily in time order
+	MIKMIDISynthesizerScheduledCommand *scheduledCommands = synth->_scheduledCommands;
+	MIKMIDISynthesizerScheduledCommand *pendingCommands = synth->_pendingCommands;
+	size_t readIndex = atomic_load_explicit(&synth->_scheduledCommandsReadIndex, memory_order_relaxed);
+	while (readIndex != writeIndex && synth->_numberOfPendingCommands < kMIKMIDISynthesizerScheduledCommandCapacity) {
+		MIKMIDISynthesizerScheduledCommand command = scheduledCommands[readIndex++ % kMIKMIDISynthesizerScheduledCommandCapacity];
+		MIKMIDISynthesizerPushPendingCommand(pendingCommands, &synth->_numberOfPendingCommands, command);
+	}
+	atomic_store_explicit(&synth->_scheduledCommandsReadIndex, readIndex, memory_order_release);
 
-	MIDITimeStamp toTimeStamp = inTimeStamp->mHostTime + midiTimeStampsUntilNextCallback;
-	CFMutableArrayRef commandsToSend = CFArrayCreateMutable(NULL, 0, &kCFTypeArrayCallBacks);;
-
-	dispatch_sync(queue, ^{
-		CFMutableDictionaryRef commandsByTimeStamp = synth->_scheduledCommandsByTimeStamp;
-		if (!commandsByTimeStamp || !CFDictionaryGetCount(commandsByTimeStamp)) return;
-
-
-		CFMutableSetRef commandTimeStampsSet = synth->_scheduledCommandTimeStampsSet;
-		CFMutableArrayRef commandTimeStampsArray = synth->_scheduledCommandTimeStampsArray;
-		if (!commandTimeStampsSet || !commandTimeStampsArray) return;
-
-		CFArrayRef commandTimeStampsArrayCopy = CFArrayCreateCopy(NULL, commandTimeStampsArray);
-		CFIndex count = CFArrayGetCount(commandTimeStampsArrayCopy);
-		for (CFIndex i = 0; i < count; i++) {
-			NSNumber *timeStampNumber = (__bridge NSNumber *)CFArrayGetValueAtIndex(commandTimeStampsArrayCopy, i);
-			MIDITimeStamp timeStamp = timeStampNumber.unsignedLongLongValue;
-			if (timeStamp >= toTimeStamp) break;
-
-			CFMutableArrayRef commandsAtTimeStamp = (CFMutableArrayRef)CFDictionaryGetValue(commandsByTimeStamp, (__bridge void*)timeStampNumber);
-			CFArrayAppendArray(commandsToSend, commandsAtTimeStamp, CFRangeMake(0, CFArrayGetCount(commandsAtTimeStamp)));
-
-			CFDictionaryRemoveValue(commandsByTimeStamp, (__bridge void *)timeStampNumber);
-			CFSetRemoveValue(commandTimeStampsSet, (__bridge void*)timeStampNumber);
-			CFArrayRemoveValueAtIndex(commandTimeStampsArray, 0);
-		}
-		CFRelease(commandTimeStampsArrayCopy);
-	});
-
-	NSTimeInterval secondsPerMIDITimeStamp = MIKMIDIClockSecondsPerMIDITimeStamp();
-
-	CFIndex commandCount = CFArrayGetCount(commandsToSend);
-	for (CFIndex i = 0; i < commandCount; i++) {
-		MIKMIDICommand *command = (__bridge MIKMIDICommand *)CFArrayGetValueAtIndex(commandsToSend, i);
+	// Commands come off the heap in time order, so they're sent in order within the buffer too
+	while (synth->_numberOfPendingCommands && pendingCommands[0].timeStamp < toTimeStamp) {
+		MIKMIDISynthesizerScheduledCommand command = MIKMIDISynthesizerPopPendingCommand(pendingCommands, &synth->_numberOfPendingCommands);
 
-		MIDITimeStamp sendTimeStamp = command.midiTimestamp;
-		if (sendTimeStamp < inTimeStamp->mHostTime) sendTimeStamp = inTimeStamp->mHostTime;
-		MIDITimeStamp timeStampOffset = sendTimeStamp - inTimeStamp->mHostTime;
-		Float64 sampleOffset = secondsPerMIDITimeStamp * timeStampOffset * sampleRate;
+		// Late commands are sent at the start of the buffer. Clamping the offset also keeps the multiplication from overflowing.
+		MIDITimeStamp timeStampOffset = (command.timeStamp > hostTime) ? MIN(command.timeStamp - hostTime, midiTimeStampsPerRender) : 0;
+		UInt32 sampleOffset = (UInt32)((timeStampOffset * sampleFramesPerMIDITimeStamp + 0x80000000ULL) >> 32);
+		if (sampleOffset >= inNumberFrames) sampleOffset = inNumberFrames - 1;
 
 		OSStatus err = synth->_sendMIDICommand(synth, instrumentUnit, command.statusByte, command.dataByte1, command.dataByte2, sampleOffset);
 		if (err) {
-			NSLog(@"Unable to schedule MIDI command %@ for instrument unit %p: %@", command, instrumentUnit, @(err));
+			NSLog(@"Unable to schedule MIDI command %02x %02x %02x for instrument unit %p: %@", command.statusByte, command.dataByte1, command.dataByte2, instrumentUnit, @(err));
 			return err;
 		}
 	}
 
-	CFRelease(commandsToSend);
 	return noErr;
 }
 
@@ -588,3 +582,40 @@ static OSStatus MIKMIDISynthesizerInstrumentUnitRenderCallback(void *						inRef
 #pragma clang diagnostic pop
 
 @end
+
+#pragma mark - Pending Command Heap
+
+static BOOL MIKMIDISynthesizerScheduledCommandPrecedes(const MIKMIDISynthesizerScheduledCommand *command1, const MIKMIDISynthesizerScheduledCommand *command2)
+{
+	if (command1->timeStamp != command2->timeStamp) return command1->timeStamp < command2->timeStamp;
+	return (SInt32)(command1->order - command2->order) < 0; // Order numbers wrap around
+}
+
+static void MIKMIDISynthesizerPushPendingCommand(MIKMIDISynthesizerScheduledCommand *heap, NSUInteger *count, MIKMIDISynthesizerScheduledCommand command)
+{
+	NSUInteger index = (*count)++;
+	while (index > 0) {
+		NSUInteger parent = (index - 1) / 2;
+		if (!MIKMIDISynthesizerScheduledCommandPrecedes(&command, &heap[parent])) break;
+		heap[index] = heap[parent];
+		index = parent;
+	}
+	heap[index] = command;
+}
+
+static MIKMIDISynthesizerScheduledCommand MIKMIDISynthesizerPopPendingCommand(MIKMIDISynthesizerScheduledCommand *heap, NSUInteger *count)
+{
+	MIKMIDISynthesizerScheduledCommand result = heap[0];
+	MIKMIDISynthesizerScheduledCommand last = heap[--(*count)];
+	NSUInteger index = 0;
+	while (YES) {
+		NSUInteger child = 2 * index + 1;
+		if (child >= *count) break;
+		if (child + 1 < *count && MIKMIDISynthesizerScheduledCommandPrecedes(&heap[child + 1], &heap[child])) child++;
+		if (!MIKMIDISynthesizerScheduledCommandPrecedes(&heap[child], &last)) break;
+		heap[index] = heap[child];
+		index = child;
+	}
+	if (*count) heap[index] = last;
+	return result;
+}
@@ -0,0 +1,149 @@
+//
+//  MIKMIDISystemExclusiveSender.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDIDestinationEndpoint;
+@class MIKMIDIOutputPort;
+@protocol MIKMIDITimeSource;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  A block called as system exclusive data is sent.
+ *
+ *  @param numberOfBytesSent The number of bytes sent so far.
+ *  @param length            The total number of bytes to send, or 0 if it isn't known.
+ */
+typedef void(^MIKMIDISystemExclusiveSenderProgressHandler)(NSUInteger numberOfBytesSent, NSUInteger length);
+
+/**
+ *  A block called when sending system exclusive data finishes.
+ *
+ *  @param error nil if all of the data was sent. If sending was cancelled, an error in NSCocoaErrorDomain
+ *  with the code NSUserCancelledError. Otherwise, an error describing the problem.
+ */
+typedef void(^MIKMIDISystemExclusiveSenderCompletionHandler)(NSError *_Nullable error);
+
+/**
+ *  MIKMIDISystemExclusiveSender sends large amounts of system exclusive data, such as firmware updates,
+ *  sample dumps or patch banks, in chunks paced so that slow destinations, like a 5-pin DIN interface,
+ *  aren't overrun.
+ *
+ *  Data can come from memory, a file, which is memory mapped rather than read in, or an input stream,
+ *  which is read a chunk at a time. It is sent as is, so it can contain several system exclusive
+ *  messages back to back, as .syx files often do, but must start with a system exclusive status
+ *  byte (0xF0).
+ *
+ *  Sending happens in the background. Progress and completion are reported on the main queue.
+ *  If sending is cancelled or fails part way through a message, an end of exclusive byte (0xF7) is
+ *  sent so the destination isn't left waiting for the rest of it.
+ *
+ *  A sender can send its data more than once, but only one send can be in progress at a time.
+ *  A sender created with an input stream can only send once.
+ */
+@interface MIKMIDISystemExclusiveSender : NSObject
+
+/**
+ *  Creates a sender for system exclusive data in memory. The data isn't copied, so it can
+ *  be memory mapped.
+ *
+ *  @param data The data to send.
+ *
+ *  @return An initialized sender.
+ */
+- (instancetype)initWithData:(NSData *)data;
+
+/**
+ *  Creates a sender for the system exclusive data in a file. The file is memory mapped,
+ *  so only the parts that are being sent are read into memory.
+ *
+ *  @param url   The URL of the file to send.
+ *  @param error If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return An initialized sender, or nil if the file couldn't be opened.
+ */
+- (nullable instancetype)initWithContentsOfURL:(NSURL *)url error:(NSError **)error;
+
+/**
+ *  Creates a sender for system exclusive data read from a stream. The stream is read one
+ *  chunk at a time as data is sent. It is opened if it isn't already open, and closed
+ *  when sending finishes if the sender opened it.
+ *
+ *  @param inputStream The stream to read data from.
+ *  @param length      The number of bytes the stream will provide, used for reporting progress, or 0 if it isn't known.
+ *
+ *  @return An initialized sender.
+ */
+- (instancetype)initWithInputStream:(NSInputStream *)inputStream length:(NSUInteger)length;
+
+/**
+ *  Starts sending the data to a destination.
+ *
+ *  @param destination       The destination to send to.
+ *  @param progressHandler   A block called on the main queue after each chunk is sent. May be nil.
+ *  @param completionHandler A block called on the main queue when sending finishes, fails or is cancelled. May be nil.
+ *  @param error             If an error occurs, upon return contains an NSError object that describes the problem. If you are not interested in possible errors, you may pass in NULL.
+ *
+ *  @return YES if sending started, NO if the receiver is already sending, or has already used up its input stream.
+ */
+- (BOOL)sendToDestination:(MIKMIDIDestinationEndpoint *)destination
+		  progressHandler:(nullable MIKMIDISystemExclusiveSenderProgressHandler)progressHandler
+		completionHandler:(nullable MIKMIDISystemExclusiveSenderCompletionHandler)completionHandler
+					error:(NSError **)error;
+
+/**
+ *  Stops sending. The completion handler is called with an NSUserCancelledError
+ *  once the chunk being sent, if any, has gone out.
+ */
+- (void)cancel;
+
+/**
+ *  The rate to send data at, in bytes per second. If this is 0 (the default), the destination's
+ *  kMIDIPropertyMaxSysExSpeed is used, which CoreMIDI defaults to 3125 bytes per second,
+ *  the speed of a MIDI 1.0 DIN connection.
+ */
+@property (nonatomic) NSUInteger bytesPerSecond;
+
+/**
+ *  The largest number of bytes to send at once. If this is 0 (the default), chunks are sized to
+ *  take about 10 ms to send at the sending rate, and are between 32 and 1024 bytes long.
+ *  Values larger than 1024 are treated as 1024.
+ */
+@property (nonatomic) NSUInteger chunkLength;
+
+/**
+ *  The total number of bytes to send, or 0 if the receiver was created with an input stream of
+ *  unknown length.
+ */
+@property (nonatomic, readonly) NSUInteger length;
+
+/**
+ *  The number of bytes sent so far by the current or most recent send.
+ */
+@property (nonatomic, readonly) NSUInteger numberOfBytesSent;
+
+/**
+ *  YES while data is being sent.
+ */
+@property (nonatomic, readonly, getter=isSending) BOOL sending;
+
+/**
+ *  The output port to send through. The default is the shared device manager's output port.
+ */
+@property (nonatomic, strong) MIKMIDIOutputPort *outputPort;
+
+/**
+ *  The time source used to pace chunks. The default is +[MIKMIDIHostTimeSource hostTimeSource].
+ */
+@property (nonatomic, strong) id<MIKMIDITimeSource> timeSource;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,267 @@
+//
+//  MIKMIDISystemExclusiveSender.m
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDISystemExclusiveSender.h"
+#import <CoreMIDI/CoreMIDI.h>
+#import "MIKMIDIDeviceManager.h"
+#import "MIKMIDIOutputPort.h"
+#import "MIKMIDIDestinationEndpoint.h"
+#import "MIKMIDIClock.h"
+#import "MIKMIDIHostTimeSource.h"
+#import "MIKMIDIUtilities.h"
+#import "MIKMIDIErrors.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDISystemExclusiveSender.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDISystemExclusiveSender.m in the Build Phases for this target
+#endif
+
+#define kMIKMIDISystemExclusiveSenderDefaultBytesPerSecond	3125 // MIDI 1.0 DIN: 31250 baud, 10 bits per byte
+#define kMIKMIDISystemExclusiveSenderChunkDuration	0.01
+#define kMIKMIDISystemExclusiveSenderMinimumChunkLength	32
+#define kMIKMIDISystemExclusiveSenderMaximumChunkLength	1024
+
+@implementation MIKMIDISystemExclusiveSender
+{
+	NSData *_data;
+	NSInputStream *_inputStream;
+	dispatch_queue_t _sendQueue;
+
+	// Only accessed on _sendQueue
+	BOOL _sending;
+	BOOL _cancelled;
+	BOOL _openedInputStream;
+	BOOL _usedInputStream;
+	NSUInteger _numberOfBytesSent;
+	UInt8 _lastByteSent;
+	MIKMIDIDestinationEndpoint *_destination;
+	MIKMIDIOutputPort *_sendingOutputPort;
+	id<MIKMIDITimeSource> _sendingTimeSource;
+	NSUInteger _sendingBytesPerSecond;
+	NSUInteger _sendingChunkLength;
+	MIDITimeStamp _nextChunkMIDITimeStamp;
+	MIKMIDISystemExclusiveSenderProgressHandler _progressHandler;
+	MIKMIDISystemExclusiveSenderCompletionHandler _completionHandler;
+}
+
+- (instancetype)initWithData:(NSData *)data length:(NSUInteger)length inputStream:(NSInputStream *)inputStream
+{
+	self = [super init];
+	if (self) {
+		_data = data;
+		_inputStream = inputStream;
+		_length = length;
+		_sendQueue = dispatch_queue_create("com.mixedinkey.MIKMIDI.MIKMIDISystemExclusiveSender.sendQueue", DISPATCH_QUEUE_SERIAL);
+		_outputPort = [MIKMIDIDeviceManager sharedDeviceManager].outputPort;
+		_timeSource = [MIKMIDIHostTimeSource hostTimeSource];
+	}
+	return self;
+}
+
+- (instancetype)initWithData:(NSData *)data
+{
+	return [self initWithData:data length:[data length] inputStream:nil];
+}
+
+- (instancetype)initWithContentsOfURL:(NSURL *)url error:(NSError **)error
+{
+	NSData *data = [NSData dataWithContentsOfURL:url options:NSDataReadingMappedAlways error:error];
+	if (!data) return nil;
+	return [self initWithData:data];
+}
+
+- (instancetype)initWithInputStream:(NSInputStream *)inputStream length:(NSUInteger)length
+{
+	return [self initWithData:nil length:length inputStream:inputStream];
+}
+
+#pragma mark - Public
+
+- (BOOL)sendToDestination:(MIKMIDIDestinationEndpoint *)destination
+		  progressHandler:(MIKMIDISystemExclusiveSenderProgressHandler)progressHandler
+		completionHandler:(MIKMIDISystemExclusiveSenderCompletionHandler)completionHandler
+					error:(NSError **)error
+{
+	error = error ? error : &(NSError *__autoreleasing){ nil };
+
+	if (_data && (![_data length] || ((const UInt8 *)[_data bytes])[0] != 0xF0)) {
+		*error = [NSError MIKMIDIErrorWithCode:MIKMIDIInvalidSystemExclusiveDataErrorCode userInfo:nil];
+		return NO;
+	}
+
+	NSUInteger bytesPerSecond = self.bytesPerSecond;
+	if (!bytesPerSecond) {
+		SInt32 maxSysexSpeed = MIKIntegerPropertyFromMIDIObject(destination.objectRef, kMIDIPropertyMaxSysExSpeed, NULL);
+		bytesPerSecond = (maxSysexSpeed > 0) ? (NSUInteger)maxSysexSpeed : kMIKMIDISystemExclusiveSenderDefaultBytesPerSecond;
+	}
+	NSUInteger chunkLength = self.chunkLength;
+	if (!chunkLength) {
+		chunkLength = (NSUInteger)(bytesPerSecond * kMIKMIDISystemExclusiveSenderChunkDuration);
+		chunkLength = MAX(chunkLength, kMIKMIDISystemExclusiveSenderMinimumChunkLength);
+	}
+	chunkLength = MIN(chunkLength, kMIKMIDISystemExclusiveSenderMaximumChunkLength);
+	MIKMIDIOutputPort *outputPort = self.outputPort;
+	id<MIKMIDITimeSource> timeSource = self.timeSource;
+
+	__block BOOL started = NO;
+	dispatch_sync(_sendQueue, ^{
+		if (self->_sending || self->_usedInputStream) return;
+
+		if (self->_inputStream) {
+			self->_usedInputStream = YES;
+			self->_openedInputStream = ([self->_inputStream streamStatus] == NSStreamStatusNotOpen);
+			if (self->_openedInputStream) [self->_inputStream open];
+		}
+		self->_sending = YES;
+		self->_cancelled = NO;
+		self->_numberOfBytesSent = 0;
+		self->_lastByteSent = 0xF7;
+		self->_destination = destination;
+		self->_sendingOutputPort = outputPort;
+		self->_sendingTimeSource = timeSource;
+		self->_sendingBytesPerSecond = bytesPerSecond;
+		self->_sendingChunkLength = chunkLength;
+		self->_nextChunkMIDITimeStamp = timeSource.currentMIDITimeStamp;
+		self->_progressHandler = progressHandler;
+		self->_completionHandler = completionHandler;
+		started = YES;
+
+		[self sendNextChunk];
+	});
+
+	if (!started) *error = [NSError MIKMIDIErrorWithCode:MIKMIDISystemExclusiveSenderBusyErrorCode userInfo:nil];
+	return started;
+}
+
+- (void)cancel
+{
+	dispatch_async(_sendQueue, ^{
+		self->_cancelled = YES;
+	});
+}
+
+#pragma mark - Private
+
+// Must be called on _sendQueue
+- (void)sendNextChunk
+{
+	if (!_sending) return;
+	if (_cancelled) {
+		[self finishWithError:[NSError errorWithDomain:NSCocoaErrorDomain code:NSUserCancelledError userInfo:nil]];
+		return;
+	}
+
+	// The chunk is read straight into the packet, rather than into a buffer and then copied
+	UInt64 buffer[(sizeof(MIDIPacketList) + kMIKMIDISystemExclusiveSenderMaximumChunkLength) / sizeof(UInt64) + 1]; // UInt64 for alignment
+	MIDIPacketList *packetList = (MIDIPacketList *)buffer;
+	packetList->numPackets = 1;
+	MIDIPacket *packet = &packetList->packet[0];
+	packet->timeStamp = 0;
+
+	NSError *error = nil;
+	NSInteger length = [self readChunkOfMaximumLength:_sendingChunkLength intoBuffer:packet->data error:&error];
+	if (length < 0) {
+		[self finishWithError:error];
+		return;
+	}
+	if (length == 0) {
+		[self finishWithError:nil];
+		return;
+	}
+	if (_numberOfBytesSent == 0 && packet->data[0] != 0xF0) {
+		[self finishWithError:[NSError MIKMIDIErrorWithCode:MIKMIDIInvalidSystemExclusiveDataErrorCode userInfo:nil]];
+		return;
+	}
+
+	packet->length = (UInt16)length;
+	if (![_sendingOutputPort sendPacketList:packetList toDestination:_destination error:&error]) {
+		[self finishWithError:error];
+		return;
+	}
+	_lastByteSent = packet->data[length - 1];
+	_numberOfBytesSent += length;
+
+	MIKMIDISystemExclusiveSenderProgressHandler progressHandler = _progressHandler;
+	if (progressHandler) {
+		NSUInteger numberOfBytesSent = _numberOfBytesSent, totalLength = _length;
+		dispatch_async(dispatch_get_main_queue(), ^{ progressHandler(numberOfBytesSent, totalLength); });
+	}
+
+	// Wait until the chunk has had time to go out. If this wake up was late, wait from now rather
+	// than from when it should have been, so a late wake up never results in sending faster.
+	MIDITimeStamp now = _sendingTimeSource.currentMIDITimeStamp;
+	MIDITimeStamp chunkDuration = MIKMIDIClockMIDITimeStampsPerTimeInterval((NSTimeInterval)length / _sendingBytesPerSecond);
+	_nextChunkMIDITimeStamp = MAX(_nextChunkMIDITimeStamp, now) + chunkDuration;
+	[_sendingTimeSource dispatchAtMIDITimeStamp:_nextChunkMIDITimeStamp queue:_sendQueue block:^{
+		[self sendNextChunk];
+	}];
+}
+
+// Must be called on _sendQueue. Returns the number of bytes read, 0 at the end of the data, or -1 if an error occurred.
+- (NSInteger)readChunkOfMaximumLength:(NSUInteger)maximumLength intoBuffer:(UInt8 *)buffer error:(NSError **)error
+{
+	if (_data) {
+		NSUInteger length = MIN(maximumLength, [_data length] - _numberOfBytesSent);
+		memcpy(buffer, (const UInt8 *)[_data bytes] + _numberOfBytesSent, length);
+		return length;
+	}
+
+	NSInteger length = [_inputStream read:buffer maxLength:maximumLength];
+	if (length < 0) {
+		*error = [_inputStream streamError] ?: [NSError MIKMIDIErrorWithCode:MIKMIDIUnknownErrorCode userInfo:nil];
+	}
+	return length;
+}
+
+// Must be called on _sendQueue
+- (void)finishWithError:(NSError *)error
+{
+	// Don't leave the destination in the middle of a system exclusive message
+	if (_lastByteSent != 0xF7) {
+		MIDIPacketList packetList;
+		MIDIPacket *packet = MIDIPacketListInit(&packetList);
+		UInt8 endOfExclusive = 0xF7;
+		MIDIPacketListAdd(&packetList, sizeof(packetList), packet, 0, 1, &endOfExclusive);
+		NSError *sendError = nil;
+		if (![_sendingOutputPort sendPacketList:&packetList toDestination:_destination error:&sendError]) {
+			NSLog(@"Sending end of exclusive byte failed with error %@ in %s.", sendError, __PRETTY_FUNCTION__);
+		}
+	}
+	if (_openedInputStream) {
+		[_inputStream close];
+		_openedInputStream = NO;
+	}
+
+	MIKMIDISystemExclusiveSenderCompletionHandler completionHandler = _completionHandler;
+	_sending = NO;
+	_destination = nil;
+	_sendingOutputPort = nil;
+	_sendingTimeSource = nil;
+	_progressHandler = nil;
+	_completionHandler = nil;
+	if (completionHandler) {
+		dispatch_async(dispatch_get_main_queue(), ^{ completionHandler(error); });
+	}
+}
+
+#pragma mark - Properties
+
+- (NSUInteger)numberOfBytesSent
+{
+	__block NSUInteger result = 0;
+	dispatch_sync(_sendQueue, ^{ result = self->_numberOfBytesSent; });
+	return result;
+}
+
+- (BOOL)isSending
+{
+	__block BOOL result = NO;
+	dispatch_sync(_sendQueue, ^{ result = self->_sending; });
+	return result;
+}
+
+@end
@@ -0,0 +1,117 @@
+//
+//  MIKMIDITempoMap.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <AudioToolbox/AudioToolbox.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+@class MIKMIDITempoEvent;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  MIKMIDITempoMap converts between MusicTimeStamps (beats) and seconds for a set of tempo events.
+ *
+ *  The elapsed time at each tempo change is computed once, when the map is created, so each conversion
+ *  is a binary search for the tempo in effect followed by a multiply, rather than a walk through every
+ *  earlier tempo event. Before the first tempo event, or if there are none, the tempo is 120 BPM,
+ *  matching MusicSequence.
+ *
+ *  Tempo maps are immutable and safe to use from multiple threads at once. MIKMIDISequence keeps
+ *  one for its tempo track, rebuilding it when the tempo track's events change.
+ *
+ *  @see -[MIKMIDISequence tempoMap]
+ */
+@interface MIKMIDITempoMap : NSObject
+
+/**
+ *  Creates a tempo map.
+ *
+ *  @param tempoEvents An array of MIKMIDITempoEvents, sorted by timestamp. Where several events have the same
+ *  timestamp, the last one wins. Events with a tempo of 0 or less are ignored.
+ *
+ *  @return An initialized tempo map.
+ */
+- (instancetype)initWithTempoEvents:(MIKArrayOf(MIKMIDITempoEvent *) *)tempoEvents;
+
+/**
+ *  Returns a tempo map for a new set of tempo events. The part of the receiver before the first event
+ *  that differs is reused rather than recomputed, so this is cheaper than creating a new map
+ *  from scratch when, for example, a tempo change is added near the end of a long sequence.
+ *
+ *  @param tempoEvents An array of MIKMIDITempoEvents, sorted by timestamp.
+ *
+ *  @return A tempo map for tempoEvents. This is the receiver if tempoEvents is equivalent to its tempoEvents.
+ */
+- (MIKMIDITempoMap *)tempoMapWithTempoEvents:(MIKArrayOf(MIKMIDITempoEvent *) *)tempoEvents;
+
+/**
+ *  Returns the tempo in effect at a timestamp.
+ *
+ *  @param timeStamp The MusicTimeStamp to get the tempo at.
+ *
+ *  @return The tempo in beats per minute.
+ */
+- (Float64)tempoAtTimeStamp:(MusicTimeStamp)timeStamp;
+
+/**
+ *  Returns the last tempo event at or before a timestamp.
+ *
+ *  @param timeStamp The MusicTimeStamp to look for a tempo event at.
+ *
+ *  @return A tempo event, or nil if there isn't one at or before timeStamp.
+ */
+- (nullable MIKMIDITempoEvent *)tempoEventAtTimeStamp:(MusicTimeStamp)timeStamp;
+
+/**
+ *  Converts a MusicTimeStamp to the number of seconds since the start of the sequence.
+ *
+ *  @param timeStamp The MusicTimeStamp to convert.
+ *
+ *  @return The number of seconds from timestamp 0 to timeStamp.
+ */
+- (Float64)secondsForTimeStamp:(MusicTimeStamp)timeStamp;
+
+/**
+ *  Converts a number of seconds since the start of the sequence to a MusicTimeStamp.
+ *
+ *  @param seconds The number of seconds to convert.
+ *
+ *  @return The MusicTimeStamp seconds after timestamp 0.
+ */
+- (MusicTimeStamp)timeStampForSeconds:(Float64)seconds;
+
+/**
+ *  Converts an array of MusicTimeStamps to seconds. This is considerably faster than calling
+ *  -secondsForTimeStamp: for each of them, particularly when they're in ascending order,
+ *  as they are when drawing a ruler or exporting events.
+ *
+ *  @param seconds    A buffer of at least count Float64s, which is filled with the converted values.
+ *  @param timeStamps The MusicTimeStamps to convert.
+ *  @param count      The number of timestamps to convert.
+ */
+- (void)getSeconds:(Float64 *)seconds forTimeStamps:(const MusicTimeStamp *)timeStamps count:(NSUInteger)count;
+
+/**
+ *  Converts an array of times in seconds to MusicTimeStamps. This is considerably faster than calling
+ *  -timeStampForSeconds: for each of them, particularly when they're in ascending order.
+ *
+ *  @param timeStamps A buffer of at least count MusicTimeStamps, which is filled with the converted values.
+ *  @param seconds    The times in seconds to convert.
+ *  @param count      The number of times to convert.
+ */
+- (void)getTimeStamps:(MusicTimeStamp *)timeStamps forSeconds:(const Float64 *)seconds count:(NSUInteger)count;
+
+/**
+ *  The tempo events the map was created with.
+ */
+@property (nonatomic, readonly) MIKArrayOf(MIKMIDITempoEvent *) *tempoEvents;
+
+@end
+
+NS_ASSUME_NONNULL_END
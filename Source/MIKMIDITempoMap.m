@@ -0,0 +1,221 @@
+//
+//  MIKMIDITempoMap.m
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import "MIKMIDITempoMap.h"
+#import "MIKMIDITempoEvent.h"
+
+#if !__has_feature(objc_arc)
+#error MIKMIDITempoMap.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDITempoMap.m in the Build Phases for this target
+#endif
+
+#define kMIKMIDITempoMapDefaultTempo	120
+
+// Returns the index of the last segment starting at or before value, or 0 if value is before all of them.
+static NSUInteger MIKMIDITempoMapSegmentIndex(const Float64 *starts, NSUInteger segmentCount, Float64 value)
+{
+	NSUInteger low = 1, high = segmentCount;
+	while (low < high) {
+		NSUInteger middle = low + (high - low) / 2;
+		if (starts[middle] <= value) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return low - 1;
+}
+
+// Maps values through the piecewise linear function whose segments begin at starts, with the given values there and slopes.
+// Consecutive values in the same segment are converted together, in a loop the compiler can vectorize. results may be values.
+static void MIKMIDITempoMapConvert(const Float64 *starts, const Float64 *destinations, const Float64 *slopes, NSUInteger segmentCount,
+								   const Float64 *values, Float64 *results, NSUInteger count)
+{
+	NSUInteger i = 0;
+	while (i < count) {
+		NSUInteger segment = MIKMIDITempoMapSegmentIndex(starts, segmentCount, values[i]);
+		Float64 low = segment ? starts[segment] : -DBL_MAX;
+		Float64 high = (segment + 1 < segmentCount) ? starts[segment + 1] : DBL_MAX;
+		NSUInteger end = i + 1;
+		while (end < count && values[end] >= low && values[end] < high) end++;
+
+		Float64 start = starts[segment], destination = destinations[segment], slope = slopes[segment];
+		for (NSUInteger j = i; j < end; j++) {
+			results[j] = destination + (values[j] - start) * slope;
+		}
+		i = end;
+	}
+}
+
+static NSComparisonResult MIKMIDITempoMapCompareTimeStamps(MIKMIDITempoEvent *event1, MIKMIDITempoEvent *event2)
+{
+	if (event1.timeStamp < event2.timeStamp) return NSOrderedAscending;
+	if (event1.timeStamp > event2.timeStamp) return NSOrderedDescending;
+	return NSOrderedSame;
+}
+
+@implementation MIKMIDITempoMap
+{
+	// Segment i starts at _beats[i], which is _seconds[i] into the sequence.
+	Float64 *_beats;
+	Float64 *_seconds;
+	Float64 *_secondsPerBeat;
+	Float64 *_beatsPerSecond;
+	NSUInteger _segmentCount;
+}
+
+- (instancetype)initWithTempoEvents:(NSArray *)tempoEvents
+{
+	return [self initWithTempoEvents:tempoEvents reusingTempoMap:nil beforeTimeStamp:-DBL_MAX];
+}
+
+// Copies tempoMap's segments that start before timeStamp, rather than computing them again. They must be the same for tempoEvents.
+- (instancetype)initWithTempoEvents:(NSArray *)tempoEvents reusingTempoMap:(MIKMIDITempoMap *)tempoMap beforeTimeStamp:(MusicTimeStamp)timeStamp
+{
+	self = [super init];
+	if (self) {
+		_tempoEvents = [tempoEvents copy];
+		NSUInteger eventCount = [_tempoEvents count];
+		NSUInteger capacity = eventCount + 1;
+		_beats = malloc(capacity * sizeof(Float64));
+		_seconds = malloc(capacity * sizeof(Float64));
+		_secondsPerBeat = malloc(capacity * sizeof(Float64));
+		_beatsPerSecond = malloc(capacity * sizeof(Float64));
+
+		NSUInteger eventIndex = 0;
+		if (tempoMap && timeStamp > 0) {
+			NSUInteger segment = MIKMIDITempoMapSegmentIndex(tempoMap->_beats, tempoMap->_segmentCount, timeStamp);
+			_segmentCount = (tempoMap->_beats[segment] < timeStamp) ? segment + 1 : segment;
+			memcpy(_beats, tempoMap->_beats, _segmentCount * sizeof(Float64));
+			memcpy(_seconds, tempoMap->_seconds, _segmentCount * sizeof(Float64));
+			memcpy(_secondsPerBeat, tempoMap->_secondsPerBeat, _segmentCount * sizeof(Float64));
+			memcpy(_beatsPerSecond, tempoMap->_beatsPerSecond, _segmentCount * sizeof(Float64));
+
+			MIKMIDITempoEvent *probe = [MIKMIDITempoEvent tempoEventWithTimeStamp:timeStamp tempo:kMIKMIDITempoMapDefaultTempo];
+			eventIndex = [_tempoEvents indexOfObject:probe
+									   inSortedRange:NSMakeRange(0, eventCount)
+											 options:NSBinarySearchingFirstEqual | NSBinarySearchingInsertionIndex
+									 usingComparator:^NSComparisonResult(id event1, id event2) {
+										 return MIKMIDITempoMapCompareTimeStamps(event1, event2);
+									 }];
+		} else {
+			// The first segment starts at 0, with the last tempo at or before it
+			Float64 tempo = kMIKMIDITempoMapDefaultTempo;
+			for (; eventIndex < eventCount; eventIndex++) {
+				MIKMIDITempoEvent *event = _tempoEvents[eventIndex];
+				if (event.timeStamp > 0) break;
+				if (event.bpm > 0) tempo = event.bpm;
+			}
+			_beats[0] = 0;
+			_seconds[0] = 0;
+			_secondsPerBeat[0] = 60.0 / tempo;
+			_beatsPerSecond[0] = tempo / 60.0;
+			_segmentCount = 1;
+		}
+
+		for (; eventIndex < eventCount; eventIndex++) {
+			MIKMIDITempoEvent *event = _tempoEvents[eventIndex];
+			Float64 tempo = event.bpm;
+			if (tempo <= 0) continue;
+
+			NSUInteger segment = _segmentCount - 1;
+			MusicTimeStamp eventTimeStamp = event.timeStamp;
+			if (eventTimeStamp > _beats[segment]) {
+				_seconds[_segmentCount] = _seconds[segment] + (eventTimeStamp - _beats[segment]) * _secondsPerBeat[segment];
+				_beats[_segmentCount] = eventTimeStamp;
+				segment = _segmentCount++;
+			}
+			_secondsPerBeat[segment] = 60.0 / tempo;
+			_beatsPerSecond[segment] = tempo / 60.0;
+		}
+	}
+	return self;
+}
+
+- (void)dealloc
+{
+	free(_beats);
+	free(_seconds);
+	free(_secondsPerBeat);
+	free(_beatsPerSecond);
+}
+
+#pragma mark - Public
+
+- (MIKMIDITempoMap *)tempoMapWithTempoEvents:(NSArray *)tempoEvents
+{
+	MusicTimeStamp firstChange = [self timeStampOfFirstDifferenceFromTempoEvents:tempoEvents];
+	if (firstChange == DBL_MAX) return self;
+	return [[[self class] alloc] initWithTempoEvents:tempoEvents reusingTempoMap:self beforeTimeStamp:firstChange];
+}
+
+- (Float64)tempoAtTimeStamp:(MusicTimeStamp)timeStamp
+{
+	return 60.0 / _secondsPerBeat[MIKMIDITempoMapSegmentIndex(_beats, _segmentCount, timeStamp)];
+}
+
+- (MIKMIDITempoEvent *)tempoEventAtTimeStamp:(MusicTimeStamp)timeStamp
+{
+	NSArray *tempoEvents = self.tempoEvents;
+	MIKMIDITempoEvent *probe = [MIKMIDITempoEvent tempoEventWithTimeStamp:timeStamp tempo:kMIKMIDITempoMapDefaultTempo];
+	NSUInteger index = [tempoEvents indexOfObject:probe
+									inSortedRange:NSMakeRange(0, [tempoEvents count])
+										  options:NSBinarySearchingLastEqual | NSBinarySearchingInsertionIndex
+								  usingComparator:^NSComparisonResult(id event1, id event2) {
+									  return MIKMIDITempoMapCompareTimeStamps(event1, event2);
+								  }];
+	return index ? tempoEvents[index - 1] : nil;
+}
+
+- (Float64)secondsForTimeStamp:(MusicTimeStamp)timeStamp
+{
+	Float64 seconds = 0;
+	MIKMIDITempoMapConvert(_beats, _seconds, _secondsPerBeat, _segmentCount, &timeStamp, &seconds, 1);
+	return seconds;
+}
+
+- (MusicTimeStamp)timeStampForSeconds:(Float64)seconds
+{
+	MusicTimeStamp timeStamp = 0;
+	MIKMIDITempoMapConvert(_seconds, _beats, _beatsPerSecond, _segmentCount, &seconds, &timeStamp, 1);
+	return timeStamp;
+}
+
+- (void)getSeconds:(Float64 *)seconds forTimeStamps:(const MusicTimeStamp *)timeStamps count:(NSUInteger)count
+{
+	MIKMIDITempoMapConvert(_beats, _seconds, _secondsPerBeat, _segmentCount, timeStamps, seconds, count);
+}
+
+- (void)getTimeStamps:(MusicTimeStamp *)timeStamps forSeconds:(const Float64 *)seconds count:(NSUInteger)count
+{
+	MIKMIDITempoMapConvert(_seconds, _beats, _beatsPerSecond, _segmentCount, seconds, timeStamps, count);
+}
+
+#pragma mark - Private
+
+// Returns the timestamp of the first event that differs between tempoEvents and the receiver's, or DBL_MAX if none do.
+- (MusicTimeStamp)timeStampOfFirstDifferenceFromTempoEvents:(NSArray *)tempoEvents
+{
+	NSArray *existingEvents = self.tempoEvents;
+	NSUInteger existingCount = [existingEvents count], count = [tempoEvents count];
+	for (NSUInteger i = 0; i < MIN(existingCount, count); i++) {
+		MIKMIDITempoEvent *existingEvent = existingEvents[i], *event = tempoEvents[i];
+		if (existingEvent.timeStamp != event.timeStamp || existingEvent.bpm != event.bpm) {
+			return MIN(existingEvent.timeStamp, event.timeStamp);
+		}
+	}
+	if (existingCount > count) return [existingEvents[count] timeStamp];
+	if (count > existingCount) return [tempoEvents[existingCount] timeStamp];
+	return DBL_MAX;
+}
+
+- (NSString *)description
+{
+	return [NSString stringWithFormat:@"%@ tempo events: %@", [super description], self.tempoEvents];
+}
+
+@end
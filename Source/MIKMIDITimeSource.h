@@ -0,0 +1,47 @@
+//
+//  MIKMIDITimeSource.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CoreMIDI/CoreMIDI.h>
+#import "MIKMIDICompilerCompatibility.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/**
+ *  Objects that conform to this protocol tell MIKMIDIClock, MIKMIDISequencer and MIKMIDIInputPort
+ *  what time it is, and wake them up when time stamps they're waiting for arrive.
+ *
+ *  Time stamps are in host time units, like every other MIDITimeStamp in MIKMIDI, so they can
+ *  be converted with MIKMIDIClockSecondsPerMIDITimeStamp() and MIKMIDIClockMIDITimeStampsPerTimeInterval().
+ *
+ *  MIKMIDIHostTimeSource, the default, follows the system's host clock. MIKMIDISimulatedTimeSource
+ *  only moves when it's told to, which makes timing dependent code fast and repeatable to test.
+ *
+ *  @see MIKMIDIHostTimeSource
+ *  @see MIKMIDISimulatedTimeSource
+ */
+@protocol MIKMIDITimeSource <NSObject>
+
+/**
+ *  The current time. This must never go backwards, and must be safe to read from any thread,
+ *  including real time threads.
+ */
+@property (nonatomic, readonly) MIDITimeStamp currentMIDITimeStamp;
+
+/**
+ *  Submits a block to a queue once the current time reaches a time stamp.
+ *
+ *  @param midiTimeStamp The time stamp to wait for. If it has already passed, block is submitted as soon as possible.
+ *  @param queue         The queue to submit block to.
+ *  @param block         The block to submit.
+ */
+- (void)dispatchAtMIDITimeStamp:(MIDITimeStamp)midiTimeStamp queue:(dispatch_queue_t)queue block:(dispatch_block_t)block;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -95,6 +95,33 @@ NS_ASSUME_NONNULL_BEGIN
  */
 - (MIKArrayOf(MIKMIDINoteEvent *) *)notesFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
 
+/**
+ *  Gets the MIDI notes in the track that are sounding at timeStamp. That is, the notes that start at or
+ *  before timeStamp and end after it.
+ *
+ *  @param timeStamp The time stamp to get sounding notes at.
+ *
+ *  @return An array of MIKMIDINoteEvent instances, sorted by time stamp.
+ *
+ *  @discussion Unlike notesFromTimeStamp:toTimeStamp:, this includes notes that started before timeStamp
+ *  and are still held. The track keeps an index of its notes' start and end times, so this takes
+ *  O(log n) time plus time proportional to the number of notes returned.
+ */
+- (MIKArrayOf(MIKMIDINoteEvent *) *)notesSoundingAtTimeStamp:(MusicTimeStamp)timeStamp;
+
+/**
+ *  Gets the MIDI notes in the track that sound at any point from startTimeStamp up to, but not including, endTimeStamp.
+ *
+ *  @param startTimeStamp The starting time stamp of the range.
+ *  @param endTimeStamp The ending time stamp of the range, which is excluded.
+ *
+ *  @return An array of MIKMIDINoteEvent instances, sorted by time stamp.
+ *
+ *  @discussion This includes notes that started before startTimeStamp and are still held at startTimeStamp.
+ *  Notes with a duration of 0 are included if they start in the range.
+ */
+- (MIKArrayOf(MIKMIDINoteEvent *) *)notesOverlappingRangeFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp;
+
 #pragma mark - Event Manipulation
 
 /**
@@ -160,12 +187,20 @@ NS_ASSUME_NONNULL_BEGIN
 
 /**
  *  The underlying MusicTrack that backs the instance of MIKMIDITrack.
+ *
+ *  @note For tracks in a sequence loaded with MIKMIDISequenceLoadingOptionLazy,
+ *  accessing this property causes the track's events to be loaded.
  */
 @property (nonatomic, readonly) MusicTrack musicTrack;
 
 /**
  *  An array of MIKMIDIEvent containing all of the MIDI events for the track, sorted by timestamp.
  *
+ *  The track doesn't keep an object for each of its events, so a new array is made each time this
+ *  is accessed, with objects created for events that aren't already in use elsewhere. Events returned
+ *  by separate accesses are equal, and identical while the earlier ones are still in use. To get only
+ *  some of the track's events, -eventsFromTimeStamp:toTimeStamp: is cheaper.
+ *
  *  This property can be observed using Key Value Observing.
  */
 @property (nonatomic, copy) MIKArrayOf(MIKMIDIEvent *) *events;
@@ -177,6 +212,14 @@ NS_ASSUME_NONNULL_BEGIN
  */
 @property (nonatomic, readonly) MIKArrayOf(MIKMIDINoteEvent *) *notes;
 
+/**
+ *  The track's name, taken from its first track name meta event, or nil if it doesn't have one.
+ *
+ *  For tracks in a sequence loaded with MIKMIDISequenceLoadingOptionLazy, this is available
+ *  without loading the track's events.
+ */
+@property (nonatomic, readonly, nullable) NSString *name;
+
 /**
  *  The receiver's index in its containing sequence, or -1 if the track isn't in a sequence.
  */
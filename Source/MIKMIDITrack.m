@@ -12,10 +12,14 @@
 #import "MIKMIDINoteEvent.h"
 #import "MIKMIDITempoEvent.h"
 #import "MIKMIDIEventIterator.h"
+#import "MIKMIDIMetaTrackSequenceNameEvent.h"
+#import "MIKMIDIFileDecoder.h"
+#import "MIKMIDIEventStore.h"
+#import "MIKMIDINoteIntervalIndex.h"
 #import "MIKMIDIDestinationEndpoint.h"
 #import "MIKMIDIErrors.h"
 #import "MIKMIDISequencer+MIKMIDIPrivate.h"
-
+#include <stdatomic.h>
 
 #if !__has_feature(objc_arc)
 #error MIKMIDITrack.m must be compiled with ARC. Either turn on ARC for the project or set the -fobjc-arc flag for MIKMIDITrack.m in the Build Phases for this target
@@ -24,8 +28,13 @@
 @interface MIKMIDITrack ()
 
 @property (weak, nonatomic, nullable) MIKMIDISequence *sequence;
-@property (nonatomic, strong) NSMutableSet *internalEvents;
-@property (nonatomic, strong) NSArray *sortedEventsCache;
+@property (nonatomic, strong) MIKMIDIEventStore *internalEvents;
+@property (nonatomic) NSUInteger eventsChangeCount; // Changed whenever the events change, so observers of events, notes and length are notified
+@property (nonatomic, strong, nullable) MIKMIDINoteIntervalIndex *noteIntervalIndexCache;
+
+@property (nonatomic, strong, nullable) MIKMIDIFileDecoder *pendingFileDecoder;
+@property (nonatomic) NSUInteger pendingFileTrackIndex;
+@property (atomic, strong, nullable) MIKMIDIMetaTrackSequenceNameEvent *pendingNameEvent; // Read without locking by -name
 
 @property (nonatomic) MusicTimeStamp restoredLength;
 @property (nonatomic) MusicTrackLoopInfo restoredLoopInfo;
@@ -35,6 +44,11 @@
 
 
 @implementation MIKMIDITrack
+{
+	// Set while pendingFileDecoder holds events that haven't been loaded. Cleared with release ordering once
+	// they're loaded, so a thread that sees it cleared without locking also sees the loaded events.
+	atomic_bool _hasPendingFileEvents;
+}
 
 #pragma mark - Lifecycle
 
@@ -45,12 +59,12 @@
         OSStatus err = MusicTrackGetSequence(musicTrack, &musicTrackSequence);
         if (err) NSLog(@"MusicTrackGetSequence() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 
-        if (musicTrackSequence != sequence.musicSequence) {
+        if (musicTrackSequence != sequence.underlyingMusicSequence) {
             NSLog(@"ERROR: initWithSequence:musicTrack: requires the musicTrack's associated MusicSequence to be the same as sequence's musicSequence property.");
             return nil;
         }
 
-		_internalEvents = [[NSMutableSet alloc] init];
+		_internalEvents = [[MIKMIDIEventStore alloc] init];
         _musicTrack = musicTrack;
         _sequence = sequence;
 		[self reloadAllEventsFromMusicTrack];
@@ -64,6 +78,52 @@
     return [[self alloc] initWithSequence:sequence musicTrack:musicTrack];
 }
 
+- (instancetype)initWithSequence:(MIKMIDISequence *)sequence musicTrack:(MusicTrack)musicTrack events:(NSArray *)events
+{
+	if (self = [super init]) {
+		_musicTrack = musicTrack;
+		_sequence = sequence;
+		if (![self loadEvents:events]) return nil;
+	}
+	
+	return self;
+}
+
++ (instancetype)trackWithSequence:(MIKMIDISequence *)sequence musicTrack:(MusicTrack)musicTrack events:(NSArray *)events
+{
+	return [[self alloc] initWithSequence:sequence musicTrack:musicTrack events:events];
+}
+
+- (instancetype)initWithSequence:(MIKMIDISequence *)sequence
+					  musicTrack:(MusicTrack)musicTrack
+					 fileDecoder:(MIKMIDIFileDecoder *)decoder
+					  trackIndex:(NSUInteger)trackIndex
+						  length:(MusicTimeStamp)length
+					   nameEvent:(MIKMIDIMetaTrackSequenceNameEvent *)nameEvent
+{
+	if (self = [super init]) {
+		_musicTrack = musicTrack;
+		_sequence = sequence;
+		_pendingFileDecoder = decoder;
+		_pendingFileTrackIndex = trackIndex;
+		atomic_init(&_hasPendingFileEvents, decoder != nil);
+		_pendingNameEvent = nameEvent;
+		_length = length;
+	}
+	
+	return self;
+}
+
++ (instancetype)trackWithSequence:(MIKMIDISequence *)sequence
+					   musicTrack:(MusicTrack)musicTrack
+					  fileDecoder:(MIKMIDIFileDecoder *)decoder
+					   trackIndex:(NSUInteger)trackIndex
+						   length:(MusicTimeStamp)length
+						nameEvent:(MIKMIDIMetaTrackSequenceNameEvent *)nameEvent
+{
+	return [[self alloc] initWithSequence:sequence musicTrack:musicTrack fileDecoder:decoder trackIndex:trackIndex length:length nameEvent:nameEvent];
+}
+
 - (instancetype)init
 {
 #ifdef DEBUG
@@ -72,6 +132,48 @@
     return nil;
 }
 
+#pragma mark - Loading Events
+
+// Adds events to the (empty) MusicTrack, and uses them as the track's contents, without reading them back.
+- (BOOL)loadEvents:(NSArray *)events
+{
+	for (MIKMIDIEvent *event in events) {
+		NSError *error = nil;
+		if (![self insertMIDIEventInMusicTrack:event error:&error]) {
+			NSLog(@"Error adding %@ to %@: %@", event, self, error);
+			return NO;
+		}
+	}
+	
+	// Set ivars directly, as loading a lazily loaded track's events shouldn't look like a change to observers.
+	_internalEvents = [[MIKMIDIEventStore alloc] initWithEvents:events];
+	_noteIntervalIndexCache = nil;
+	_length = -1;
+	return YES;
+}
+
+- (void)loadEventsIfNeeded
+{
+	if (!atomic_load_explicit(&_hasPendingFileEvents, memory_order_acquire)) return;
+	
+	@synchronized(self) {
+		MIKMIDIFileDecoder *decoder = self.pendingFileDecoder;
+		if (!decoder) return;
+		
+		// Tempo and time signature events were already put in the sequence's tempo track when it was loaded.
+		NSError *error = nil;
+		NSArray *events = [decoder eventsForTrackAtIndex:self.pendingFileTrackIndex tempoTrackEvents:[NSMutableArray array] error:&error];
+		if (!events) {
+			NSLog(@"Error loading events for %@: %@", self, error);
+			events = @[];
+		}
+		[self loadEvents:events];
+		self.pendingFileDecoder = nil;
+		self.pendingNameEvent = nil;
+		atomic_store_explicit(&_hasPendingFileEvents, false, memory_order_release);
+	}
+}
+
 #pragma mark - Sequencer Synchronization
 
 - (void)dispatchSyncToSequencerProcessingQueueAsNeeded:(void (^)(void))block
@@ -93,8 +195,9 @@
 - (void)addEvent:(MIKMIDIEvent *)event
 {
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self loadEventsIfNeeded];
 		if (!event) return;
-		if ([self.internalEvents containsObject:event]) return; // Don't allow duplicates
+		if ([self.internalEvents containsEvent:event]) return; // Don't allow duplicates
 
 		NSError *error = nil;
 		if (![self insertMIDIEventInMusicTrack:event error:&error]) {
@@ -110,8 +213,11 @@
 - (void)addEvents:(NSArray *)events
 {
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
-		NSMutableSet *scratch = [NSMutableSet setWithArray:events];
-		[scratch minusSet:self.internalEvents]; // Don't allow duplicates
+		[self loadEventsIfNeeded];
+		NSMutableSet *scratch = [NSMutableSet setWithCapacity:[events count]];
+		for (MIKMIDIEvent *event in events) {
+			if (![self.internalEvents containsEvent:event]) [scratch addObject:event]; // Don't allow duplicates
+		}
 		if (![scratch count]) return;
 
 		NSError *error = nil;
@@ -130,8 +236,9 @@
 - (void)removeEvent:(MIKMIDIEvent *)event
 {
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self loadEventsIfNeeded];
 		if (!event) return;
-		if (![self.internalEvents containsObject:event]) return;
+		if (![self.internalEvents containsEvent:event]) return;
 
 		NSError *error = nil;
 		if (![self removeMIDIEventsFromMusicTrack:[NSSet setWithObject:event] error:&error]) {
@@ -147,9 +254,12 @@
 - (void)removeEvents:(NSArray *)events
 {
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self loadEventsIfNeeded];
 		if (![events count]) return;
-		NSMutableSet *scratch = [NSMutableSet setWithArray:events];
-		[scratch intersectSet:self.internalEvents];
+		NSMutableSet *scratch = [NSMutableSet setWithCapacity:[events count]];
+		for (MIKMIDIEvent *event in events) {
+			if ([self.internalEvents containsEvent:event]) [scratch addObject:event];
+		}
 
 		NSError *error = nil;
 		if (![self removeMIDIEventsFromMusicTrack:scratch error:&error]) {
@@ -174,7 +284,7 @@
 	error = error ? error : &(NSError *__autoreleasing){ nil };
 	
     OSStatus err = noErr;
-    MusicTrack track = self.musicTrack;
+    MusicTrack track = _musicTrack;
     MusicTimeStamp timeStamp = event.timeStamp;
     const void *data = [event.data bytes];
 
@@ -272,11 +382,20 @@
 	if (![events count]) return YES;
 	
 	// MusicTrackClear() doesn't reliably clear events that fall on its boundaries,
-	// so we iterate the track and delete that way instead
+	// so we iterate the track and delete that way instead. Only the part of the track
+	// spanned by events needs to be looked at.
+	MusicTimeStamp firstTimeStamp = DBL_MAX, lastTimeStamp = -DBL_MAX;
+	for (MIKMIDIEvent *event in events) {
+		firstTimeStamp = MIN(firstTimeStamp, event.timeStamp);
+		lastTimeStamp = MAX(lastTimeStamp, event.timeStamp);
+	}
+
 	BOOL success = NO;
 	MIKMIDIEventIterator *iterator = [MIKMIDIEventIterator iteratorForTrack:self];
+	if (firstTimeStamp > 0) [iterator seek:firstTimeStamp];
 	while (iterator.hasCurrentEvent) {
 		MIKMIDIEvent *currentEvent = iterator.currentEvent;
+		if (currentEvent.timeStamp > lastTimeStamp) break;
 		if ([events containsObject:currentEvent]) {
 			if (![iterator deleteCurrentEventWithError:error]) return NO;
 			success = YES;
@@ -297,14 +416,38 @@
 // All public event getters pass through this method
 - (NSArray *)eventsOfClass:(Class)eventClass fromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
 {
-	NSMutableArray *result = [NSMutableArray array];
-	for (MIKMIDIEvent *event in self.events) {
-		if (event.timeStamp < startTimeStamp) { continue; }
-		if (event.timeStamp > endTimeStamp) { break; }
-		if (eventClass && ![event isKindOfClass:eventClass]) { continue; }
-		[result addObject:event];
-	}
-	return [result copy];
+	__block NSArray *result;
+
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self loadEventsIfNeeded];
+		result = [[self.internalEvents eventsOfClass:eventClass fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp] copy];
+	}];
+
+	return result ?: @[];
+}
+
+- (MusicTimeStamp)timeStampOfFirstEventAfterTimeStamp:(MusicTimeStamp)timeStamp
+{
+	__block MusicTimeStamp result = DBL_MAX;
+
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self loadEventsIfNeeded];
+		result = [self.internalEvents timeStampOfFirstEventAfterTimeStamp:timeStamp];
+	}];
+
+	return result;
+}
+
+- (MIKMIDIEventStore *)copyOfEventStore
+{
+	__block MIKMIDIEventStore *result;
+
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self loadEventsIfNeeded];
+		result = [self.internalEvents copy];
+	}];
+
+	return result;
 }
 
 - (NSArray *)eventsFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
@@ -317,24 +460,52 @@
 	return [self eventsOfClass:[MIKMIDINoteEvent class] fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp];
 }
 
+- (NSArray *)notesSoundingAtTimeStamp:(MusicTimeStamp)timeStamp
+{
+	__block NSArray *result;
+
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self loadEventsIfNeeded];
+		result = [self.internalEvents eventsAtIndexes:[self.noteIntervalIndex indexesOfNotesSoundingAtTimeStamp:timeStamp]];
+	}];
+
+	return result ?: @[];
+}
+
+- (NSArray *)notesOverlappingRangeFromTimeStamp:(MusicTimeStamp)startTimeStamp toTimeStamp:(MusicTimeStamp)endTimeStamp
+{
+	__block NSArray *result;
+
+	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self loadEventsIfNeeded];
+		result = [self.internalEvents eventsAtIndexes:[self.noteIntervalIndex indexesOfNotesOverlappingRangeFromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp]];
+	}];
+
+	return result ?: @[];
+}
+
 #pragma mark Private
 
+// Built on first use after the track's events change. Must be called on the sequencer's processing queue, if any.
+- (MIKMIDINoteIntervalIndex *)noteIntervalIndex
+{
+	if (!self.noteIntervalIndexCache) {
+		self.noteIntervalIndexCache = [[MIKMIDINoteIntervalIndex alloc] initWithEventStore:self.internalEvents];
+	}
+	return self.noteIntervalIndexCache;
+}
+
 - (void)reloadAllEventsFromMusicTrack
 {
 	MIKMIDIEventIterator *iterator = [MIKMIDIEventIterator iteratorForTrack:self];
-	NSMutableSet *allEvents = [NSMutableSet set];
+	NSMutableArray *allEvents = [NSMutableArray array];
 	while (iterator.hasCurrentEvent) {
 		MIKMIDIEvent *event = iterator.currentEvent;
 		[allEvents addObject:event];
 		[iterator moveToNextEvent];
 	}
 
-	[self willChangeValueForKey:@"internalEvents"];
-	[self.internalEvents intersectSet:allEvents];
-	[self.internalEvents unionSet:allEvents];
-	[self didChangeValueForKey:@"internalEvents"];
-	
-	self.sortedEventsCache = nil;
+	self.internalEvents = [[MIKMIDIEventStore alloc] initWithEvents:allEvents];
 }
 
 #pragma mark - Editing Events (Public)
@@ -344,6 +515,7 @@
 	__block BOOL success = NO;
 
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self loadEventsIfNeeded];
 		success = [self private_moveEventsFromStartingTimeStamp:startTimeStamp toEndingTimeStamp:endTimeStamp byAmount:timestampOffset];
 	}];
 
@@ -394,6 +566,7 @@
 	__block BOOL success = NO;
 
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self loadEventsIfNeeded];
 		success = [self private_clearEventsFromStartingTimeStamp:startTimeStamp toEndingTimeStamp:endTimeStamp];
 	}];
 
@@ -413,6 +586,7 @@
 	__block BOOL success = NO;
 
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self loadEventsIfNeeded];
 		MusicTimeStamp length = self.length;
 		if (!length || (startTimeStamp > length) || ![self.internalEvents count]) { success = YES; return; }
 
@@ -432,6 +606,7 @@
 	__block BOOL success = NO;
 
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self loadEventsIfNeeded];
 		// Move existing events to make room for new events
 		if (![self private_moveEventsFromStartingTimeStamp:destTimeStamp
 										 toEndingTimeStamp:kMusicTimeStamp_EndOfTrack
@@ -448,6 +623,7 @@
 	__block BOOL success = NO;
 
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+		[self loadEventsIfNeeded];
 		success = [self private_mergeEventsFromMIDITrack:origTrack fromTimeStamp:startTimeStamp toTimeStamp:endTimeStamp atTimeStamp:destTimeStamp];
 	}];
 
@@ -506,7 +682,7 @@
 
 + (NSSet *)keyPathsForValuesAffectingEvents
 {
-	return [NSSet setWithObjects:@"sortedEventsCache", nil];
+	return [NSSet setWithObjects:@"eventsChangeCount", nil];
 }
 
 - (NSArray *)events
@@ -514,11 +690,9 @@
 	__block NSArray *events;
 
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
-		if (!self.sortedEventsCache) {
-			NSSortDescriptor *sortDescriptor = [NSSortDescriptor sortDescriptorWithKey:@"timeStamp" ascending:YES];
-			self->_sortedEventsCache = [self.internalEvents sortedArrayUsingDescriptors:@[sortDescriptor]];
-		}
-		events = self.sortedEventsCache;
+		[self loadEventsIfNeeded];
+		// Not cached, so the track doesn't keep an object for every event once callers are done with them
+		events = [self.internalEvents.allEvents copy];
 	}];
 
 	return events ?: @[];
@@ -526,6 +700,7 @@
 
 - (void)setEvents:(NSArray *)events
 {
+	[self loadEventsIfNeeded];
 	[self clearEventsFromStartingTimeStamp:0 toEndingTimeStamp:self.length];
 	[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
 		for (MIKMIDIEvent *event in events) {
@@ -537,22 +712,22 @@
 			}
 		}
 
-		self.internalEvents = [NSMutableSet setWithArray:events];
+		self.internalEvents = [[MIKMIDIEventStore alloc] initWithEvents:events];
 	}];
 }
 
-- (void)setInternalEvents:(NSMutableSet *)internalEvents
+- (void)setInternalEvents:(MIKMIDIEventStore *)internalEvents
 {
 	if (internalEvents != _internalEvents) {
 		_internalEvents = internalEvents;
-		self.sortedEventsCache = nil;
+		[self eventsDidChange];
 	}
 }
 
 - (void)addInternalEventsObject:(MIKMIDIEvent *)event
 {
-	[self.internalEvents addObject:[event copy]];
-	self.sortedEventsCache = nil;
+	[self.internalEvents addEvent:[event copy]];
+	[self eventsDidChange];
 }
 
 - (void)addInternalEvents:(NSSet *)events
@@ -564,19 +739,21 @@
 
 - (void)removeInternalEventsObject:(MIKMIDIEvent *)event
 {
-	[self.internalEvents removeObject:event];
-	self.sortedEventsCache = nil;
+	[self.internalEvents removeEvent:event];
+	[self eventsDidChange];
 }
 
 - (void)removeInternalEvents:(NSSet *)events
 {
-	[self.internalEvents minusSet:events];
-	self.sortedEventsCache = nil;
+	for (MIKMIDIEvent *event in events) {
+		[self.internalEvents removeEvent:event];
+	}
+	[self eventsDidChange];
 }
 
 + (NSSet *)keyPathsForValuesAffectingNotes
 {
-	return [NSSet setWithObjects:@"sortedEventsCache", nil];
+	return [NSSet setWithObjects:@"eventsChangeCount", nil];
 }
 
 - (NSArray *)notes
@@ -587,12 +764,32 @@
 	return [self.events filteredArrayUsingPredicate:predicate];
 }
 
+- (MusicTrack)musicTrack
+{
+	[self loadEventsIfNeeded];
+	return _musicTrack;
+}
+
+- (MusicTrack)underlyingMusicTrack
+{
+	return _musicTrack;
+}
+
+- (NSString *)name
+{
+	MIKMIDIMetaTrackSequenceNameEvent *nameEvent = self.pendingNameEvent;
+	if (!nameEvent) {
+		nameEvent = [[self eventsOfClass:[MIKMIDIMetaTrackSequenceNameEvent class] fromTimeStamp:0 toTimeStamp:kMusicTimeStamp_EndOfTrack] firstObject];
+	}
+	return nameEvent.name;
+}
+
 - (NSInteger)trackNumber
 {
     __strong MIKMIDISequence *sequence = self.sequence;
 	if (!sequence) return -1;
 	UInt32 trackNumber = 0;
-	OSStatus err = MusicSequenceGetTrackIndex(sequence.musicSequence, self.musicTrack, &trackNumber);
+	OSStatus err = MusicSequenceGetTrackIndex(sequence.underlyingMusicSequence, _musicTrack, &trackNumber);
 	if (err) {
 		NSLog(@"MusicSequenceGetTrackIndex() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 		return -1;
@@ -606,10 +803,10 @@
 {
 	if (_offset != 0) return _offset;
 	
-	if (self.musicTrack) {
+	if (_musicTrack) {
 		MusicTimeStamp offset = 0;
 		UInt32 offsetLength = sizeof(offset);
-		OSStatus err = MusicTrackGetProperty(self.musicTrack, kSequenceTrackProperty_OffsetTime, &offset, &offsetLength);
+		OSStatus err = MusicTrackGetProperty(_musicTrack, kSequenceTrackProperty_OffsetTime, &offset, &offsetLength);
 		if (err) NSLog(@"MusicTrackGetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 		return offset;
 	} else {
@@ -621,10 +818,11 @@
 {
 	_offset = offset;
 	
-	if (self.musicTrack) {
-		OSStatus err = MusicTrackSetProperty(self.musicTrack, kSequenceTrackProperty_OffsetTime, &offset, sizeof(offset));
+	if (_musicTrack) {
+		OSStatus err = MusicTrackSetProperty(_musicTrack, kSequenceTrackProperty_OffsetTime, &offset, sizeof(offset));
 		if (err) NSLog(@"MusicTrackSetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 	}
+	[self.sequence.sequencer setNeedsProcessing];
 }
 
 @synthesize muted = _muted;
@@ -633,10 +831,10 @@
 {
 	if (_muted) return YES;
 	
-	if (self.musicTrack) {
+	if (_musicTrack) {
 		Boolean isMuted = FALSE;
 		UInt32 isMutedLength = sizeof(isMuted);
-		OSStatus err = MusicTrackGetProperty(self.musicTrack, kSequenceTrackProperty_MuteStatus, &isMuted, &isMutedLength);
+		OSStatus err = MusicTrackGetProperty(_musicTrack, kSequenceTrackProperty_MuteStatus, &isMuted, &isMutedLength);
 		if (err) NSLog(@"MusicTrackGetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 		return isMuted ? YES : NO;
 	} else {
@@ -648,11 +846,12 @@
 {
 	_muted = muted;
 	
-	if (self.musicTrack) {
+	if (_musicTrack) {
 		Boolean mutedBoolean = muted ? TRUE : FALSE;
-		OSStatus err = MusicTrackSetProperty(self.musicTrack, kSequenceTrackProperty_MuteStatus, &mutedBoolean, sizeof(mutedBoolean));
+		OSStatus err = MusicTrackSetProperty(_musicTrack, kSequenceTrackProperty_MuteStatus, &mutedBoolean, sizeof(mutedBoolean));
 		if (err) NSLog(@"MusicTrackSetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 	}
+	[self.sequence.sequencer setNeedsProcessing];
 }
 
 @synthesize solo = _solo;
@@ -661,10 +860,10 @@
 {
 	if (_solo) return YES;
 	
-	if (self.musicTrack) {
+	if (_musicTrack) {
 		Boolean isSolo = FALSE;
 		UInt32 isSoloLength = sizeof(isSolo);
-		OSStatus err = MusicTrackGetProperty(self.musicTrack, kSequenceTrackProperty_SoloStatus, &isSolo, &isSoloLength);
+		OSStatus err = MusicTrackGetProperty(_musicTrack, kSequenceTrackProperty_SoloStatus, &isSolo, &isSoloLength);
 		if (err) NSLog(@"MusicTrackGetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 		return isSolo ? YES : NO;
 	} else {
@@ -676,27 +875,29 @@
 {
 	_solo = solo;
 	
-	if (self.musicTrack) {
+	if (_musicTrack) {
 		Boolean soloBoolean = solo ? TRUE : FALSE;
-		OSStatus err = MusicTrackSetProperty(self.musicTrack, kSequenceTrackProperty_SoloStatus, &soloBoolean, sizeof(soloBoolean));
+		OSStatus err = MusicTrackSetProperty(_musicTrack, kSequenceTrackProperty_SoloStatus, &soloBoolean, sizeof(soloBoolean));
 		if (err) NSLog(@"MusicTrackSetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 	}
+	[self.sequence.sequencer setNeedsProcessing];
 }
 
 + (NSSet *)keyPathsForValuesAffectingLength
 {
-	return [NSSet setWithObjects:@"sortedEventsCache", nil];
+	return [NSSet setWithObjects:@"eventsChangeCount", nil];
 }
 
 - (MusicTimeStamp)length
 {
 	if (_length == -1) {
-		MusicTimeStamp lastStamp = 0;
+		__block MusicTimeStamp lastStamp = 0;
 
-		for (MIKMIDIEvent *event in self.events) {
-			MusicTimeStamp endStamp = [event respondsToSelector:@selector(endTimeStamp)] ? [(MIKMIDINoteEvent *)event endTimeStamp] : event.timeStamp;
-			if (endStamp > lastStamp) lastStamp = endStamp;
-		}
+		// Ask the store, rather than going through -events, which would create an object for every event
+		[self dispatchSyncToSequencerProcessingQueueAsNeeded:^{
+			[self loadEventsIfNeeded];
+			lastStamp = MAX(self.internalEvents.endTimeStamp, 0);
+		}];
 
 		_length = lastStamp;
 	}
@@ -704,17 +905,19 @@
 	return _length;
 }
 
-- (void)setSortedEventsCache:(NSArray *)sortedEventsCache
+- (void)eventsDidChange
 {
-	_sortedEventsCache = sortedEventsCache;
+	_noteIntervalIndexCache = nil;
 	_length = -1;
+	self.eventsChangeCount++;
+	[self.sequence.sequencer setNeedsProcessing];
 }
 
 - (SInt16)timeResolution
 {
     SInt16 resolution = 0;
     UInt32 resolutionLength = sizeof(resolution);
-    OSStatus err = MusicTrackGetProperty(self.musicTrack, kSequenceTrackProperty_TimeResolution, &resolution, &resolutionLength);
+    OSStatus err = MusicTrackGetProperty(_musicTrack, kSequenceTrackProperty_TimeResolution, &resolution, &resolutionLength);
     if (err) NSLog(@"MusicTrackGetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
     return resolution;
 }
@@ -775,14 +978,14 @@
 {
 	MusicTrackLoopInfo info;
 	UInt32 infoSize = sizeof(info);
-	OSStatus err = MusicTrackGetProperty(self.musicTrack, kSequenceTrackProperty_LoopInfo, &info, &infoSize);
+	OSStatus err = MusicTrackGetProperty(_musicTrack, kSequenceTrackProperty_LoopInfo, &info, &infoSize);
 	if (err) NSLog(@"MusicTrackGetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 	return info;
 }
 
 - (void)setLoopInfo:(MusicTrackLoopInfo)loopInfo
 {
-	OSStatus err = MusicTrackSetProperty(self.musicTrack, kSequenceTrackProperty_LoopInfo, &loopInfo, sizeof(loopInfo));
+	OSStatus err = MusicTrackSetProperty(_musicTrack, kSequenceTrackProperty_LoopInfo, &loopInfo, sizeof(loopInfo));
 	if (err) NSLog(@"MusicTrackSetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
 }
 
@@ -811,7 +1014,7 @@
 	NSLog(@"%s is deprecated. You should update your code to avoid calling this method. Use MIKMIDISequencer's API instead.", __PRETTY_FUNCTION__);
 
     if (destinationEndpoint != _destinationEndpoint) {
-        OSStatus err = MusicTrackSetDestMIDIEndpoint(self.musicTrack, (MIDIEndpointRef)destinationEndpoint.objectRef);
+        OSStatus err = MusicTrackSetDestMIDIEndpoint(_musicTrack, (MIDIEndpointRef)destinationEndpoint.objectRef);
         if (err) NSLog(@"MusicTrackGetProperty() failed with error %@ in %s.", @(err), __PRETTY_FUNCTION__);
         _destinationEndpoint = destinationEndpoint;
     }
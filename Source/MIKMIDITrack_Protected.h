@@ -9,6 +9,10 @@
 #import "MIKMIDITrack.h"
 #import "MIKMIDICompilerCompatibility.h"
 
+@class MIKMIDIFileDecoder;
+@class MIKMIDIEventStore;
+@class MIKMIDIMetaTrackSequenceNameEvent;
+
 NS_ASSUME_NONNULL_BEGIN
 
 @interface MIKMIDITrack ()
@@ -24,6 +28,73 @@ NS_ASSUME_NONNULL_BEGIN
  */
 + (nullable instancetype)trackWithSequence:(MIKMIDISequence *)sequence musicTrack:(MusicTrack)musicTrack;
 
+/**
+ *  Creates and initializes a new MIKMIDITrack whose contents are already known, for example
+ *  because they were decoded directly from a MIDI file.
+ *
+ *  The events are added to musicTrack, but unlike +trackWithSequence:musicTrack:, they are
+ *  not read back out of it again.
+ *
+ *  @param sequence The MIDI sequence the new track will belong to.
+ *  @param musicTrack An empty MusicTrack to use as the backing for the new MIDI track.
+ *  @param events The events in the track, sorted by timestamp.
+ *
+ *  @note You should not call this method. It is for internal MIKMIDI use only.
+ */
++ (nullable instancetype)trackWithSequence:(MIKMIDISequence *)sequence musicTrack:(MusicTrack)musicTrack events:(MIKArrayOf(MIKMIDIEvent *) *)events;
+
+/**
+ *  Creates and initializes a new MIKMIDITrack whose events are decoded from a MIDI file the
+ *  first time they are needed, rather than up front.
+ *
+ *  Until then, the track reports the length and name it will have once its events are loaded.
+ *  Accessing the track's events, musicTrack, or modifying its contents causes them to be loaded.
+ *
+ *  @param sequence The MIDI sequence the new track will belong to.
+ *  @param musicTrack An empty MusicTrack to use as the backing for the new MIDI track.
+ *  @param decoder The decoder for the file containing the track's events.
+ *  @param trackIndex The index of the track's chunk in the file.
+ *  @param length The length of the track, as determined by -[MIKMIDIFileDecoder scanTrackAtIndex:...].
+ *  @param nameEvent The track's name event, if any.
+ *
+ *  @note You should not call this method. It is for internal MIKMIDI use only.
+ */
++ (nullable instancetype)trackWithSequence:(MIKMIDISequence *)sequence
+								musicTrack:(MusicTrack)musicTrack
+							   fileDecoder:(MIKMIDIFileDecoder *)decoder
+								trackIndex:(NSUInteger)trackIndex
+									length:(MusicTimeStamp)length
+								 nameEvent:(nullable MIKMIDIMetaTrackSequenceNameEvent *)nameEvent;
+
+/**
+ *  Decodes the events of a lazily loaded track, if they haven't been already.
+ *  Does nothing for tracks that weren't loaded lazily.
+ */
+- (void)loadEventsIfNeeded;
+
+/**
+ *  Returns the timestamp of the first event in the track after a timestamp, not including the track's offset.
+ *  Used by MIKMIDISequencer to find out how long it can sleep for.
+ *
+ *  @param timeStamp The timestamp to look after.
+ *
+ *  @return The timestamp of the first event later than timeStamp, or DBL_MAX if there isn't one.
+ */
+- (MusicTimeStamp)timeStampOfFirstEventAfterTimeStamp:(MusicTimeStamp)timeStamp;
+
+/**
+ *  Returns a copy of the store holding the track's events. The copy holds the track's note and
+ *  channel events packed, as the track does, rather than as objects, so it's cheap to make, and
+ *  can be read without holding up the sequencer. Used by MIKMIDIFileEncoder.
+ */
+- (MIKMIDIEventStore *)copyOfEventStore;
+
+/**
+ *  The MusicTrack backing the receiver. Unlike -musicTrack, this does not cause
+ *  the events of a lazily loaded track to be loaded.
+ */
+@property (nonatomic, readonly) MusicTrack underlyingMusicTrack;
+
 /**
  *  Sets a temporary length and loopInfo for the track.
  *
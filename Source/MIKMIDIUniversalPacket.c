@@ -0,0 +1,291 @@
+//
+//  MIKMIDIUniversalPacket.c
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#include "MIKMIDIUniversalPacket.h"
+#include <string.h>
+
+size_t MIKMIDIUniversalMessageWordCountForType(uint8_t type)
+{
+	switch (type & 0x0F) {
+		case 0x0:
+		case 0x1:
+		case 0x2:
+		case 0x6:
+		case 0x7:
+			return 1;
+		case 0x3:
+		case 0x4:
+		case 0x8:
+		case 0x9:
+		case 0xA:
+			return 2;
+		case 0xB:
+		case 0xC:
+			return 3;
+		default: // 0x5 and 0xD-0xF
+			return 4;
+	}
+}
+
+size_t MIKMIDIUniversalPacketParse(const uint32_t *words, size_t wordCount, MIKMIDIUniversalMessage *messages, size_t capacity, size_t *wordsConsumed)
+{
+	size_t count = 0;
+	size_t i = 0;
+	while (i < wordCount && count < capacity) {
+		size_t length = MIKMIDIUniversalMessageWordCountForType((uint8_t)(words[i] >> 28));
+		if (length > wordCount - i) break; // Wait for the rest of the message
+
+		MIKMIDIUniversalMessage *message = &messages[count++];
+		memset(message, 0, sizeof(*message));
+		memcpy(message->words, words + i, length * sizeof(uint32_t));
+		i += length;
+	}
+	if (wordsConsumed) *wordsConsumed = i;
+	return count;
+}
+
+size_t MIKMIDIUniversalPacketWrite(const MIKMIDIUniversalMessage *messages, size_t count, uint32_t *words, size_t capacity)
+{
+	size_t written = 0;
+	for (size_t i = 0; i < count; i++) {
+		size_t length = MIKMIDIUniversalMessageWordCountForType(MIKMIDIUniversalMessageGetType(&messages[i]));
+		if (length > capacity - written) break;
+		memcpy(words + written, messages[i].words, length * sizeof(uint32_t));
+		written += length;
+	}
+	return written;
+}
+
+void MIKMIDIUniversalPacketWordsToBytes(const uint32_t *words, size_t count, uint8_t *bytes)
+{
+	for (size_t i = 0; i < count; i++) {
+		uint32_t word = words[i];
+		bytes[4*i] = (uint8_t)(word >> 24);
+		bytes[4*i+1] = (uint8_t)(word >> 16);
+		bytes[4*i+2] = (uint8_t)(word >> 8);
+		bytes[4*i+3] = (uint8_t)word;
+	}
+}
+
+void MIKMIDIUniversalPacketBytesToWords(const uint8_t *bytes, size_t count, uint32_t *words)
+{
+	for (size_t i = 0; i < count; i++) {
+		const uint8_t *b = bytes + 4*i;
+		words[i] = ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+	}
+}
+
+static inline uint32_t MIKMIDIUniversalMakeFirstWord(uint8_t type, uint8_t group, uint8_t status, uint8_t data1, uint8_t data2)
+{
+	return ((uint32_t)(type & 0x0F) << 28) | ((uint32_t)(group & 0x0F) << 24) | ((uint32_t)status << 16) | ((uint32_t)data1 << 8) | data2;
+}
+
+int MIKMIDIUniversalMessageMakeMIDI1(uint8_t group, uint8_t status, uint8_t data1, uint8_t data2, MIKMIDIUniversalMessage *message)
+{
+	uint8_t type;
+	if (status >= 0x80 && status < 0xF0) {
+		type = MIKMIDIUniversalMessageTypeMIDI1ChannelVoice;
+	} else if (status > 0xF0 && status != 0xF7) {
+		type = MIKMIDIUniversalMessageTypeSystem;
+	} else {
+		return 0;
+	}
+
+	memset(message, 0, sizeof(*message));
+	message->words[0] = MIKMIDIUniversalMakeFirstWord(type, group, status, data1 & 0x7F, data2 & 0x7F);
+	return 1;
+}
+
+MIKMIDIUniversalMessage MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(uint8_t group, uint8_t status, uint8_t data1, uint8_t data2, uint32_t value)
+{
+	MIKMIDIUniversalMessage message = {{0}};
+	message.words[0] = MIKMIDIUniversalMakeFirstWord(MIKMIDIUniversalMessageTypeMIDI2ChannelVoice, group, status, data1, data2);
+	message.words[1] = value;
+	return message;
+}
+
+size_t MIKMIDIUniversalSystemExclusiveMessageCount(size_t length)
+{
+	if (length == 0) return 1;
+	return (length + MIKMIDIUniversalSystemExclusiveBytesPerMessage - 1) / MIKMIDIUniversalSystemExclusiveBytesPerMessage;
+}
+
+size_t MIKMIDIUniversalMessagesMakeSystemExclusive(uint8_t group, const uint8_t *bytes, size_t length, MIKMIDIUniversalMessage *messages, size_t capacity)
+{
+	if (length && bytes[0] == 0xF0) { bytes++; length--; }
+	if (length && bytes[length-1] == 0xF7) length--;
+
+	size_t count = MIKMIDIUniversalSystemExclusiveMessageCount(length);
+	if (count > capacity) return 0;
+
+	for (size_t i = 0; i < count; i++) {
+		uint8_t status = MIKMIDIUniversalSystemExclusiveStatusContinue;
+		if (count == 1) status = MIKMIDIUniversalSystemExclusiveStatusComplete;
+		else if (i == 0) status = MIKMIDIUniversalSystemExclusiveStatusStart;
+		else if (i == count - 1) status = MIKMIDIUniversalSystemExclusiveStatusEnd;
+
+		uint8_t piece[MIKMIDIUniversalSystemExclusiveBytesPerMessage] = {0};
+		size_t offset = i * MIKMIDIUniversalSystemExclusiveBytesPerMessage;
+		size_t pieceLength = length - offset;
+		if (pieceLength > MIKMIDIUniversalSystemExclusiveBytesPerMessage) pieceLength = MIKMIDIUniversalSystemExclusiveBytesPerMessage;
+		for (size_t j = 0; j < pieceLength; j++) piece[j] = bytes[offset + j] & 0x7F;
+
+		MIKMIDIUniversalMessage *message = &messages[i];
+		memset(message, 0, sizeof(*message));
+		message->words[0] = MIKMIDIUniversalMakeFirstWord(MIKMIDIUniversalMessageTypeData64, group, (uint8_t)((status << 4) | pieceLength), piece[0], piece[1]);
+		message->words[1] = ((uint32_t)piece[2] << 24) | ((uint32_t)piece[3] << 16) | ((uint32_t)piece[4] << 8) | piece[5];
+	}
+	return count;
+}
+
+size_t MIKMIDIUniversalMessageGetSystemExclusiveBytes(const MIKMIDIUniversalMessage *message, uint8_t *bytes, uint8_t *status)
+{
+	if (MIKMIDIUniversalMessageGetType(message) != MIKMIDIUniversalMessageTypeData64) return 0;
+
+	uint8_t statusByte = MIKMIDIUniversalMessageGetStatus(message);
+	if (status) *status = statusByte >> 4;
+	size_t length = statusByte & 0x0F;
+	if (length > MIKMIDIUniversalSystemExclusiveBytesPerMessage) length = MIKMIDIUniversalSystemExclusiveBytesPerMessage;
+
+	uint8_t piece[MIKMIDIUniversalSystemExclusiveBytesPerMessage];
+	piece[0] = MIKMIDIUniversalMessageGetData1(message);
+	piece[1] = MIKMIDIUniversalMessageGetData2(message);
+	MIKMIDIUniversalPacketWordsToBytes(&message->words[1], 1, piece + 2);
+	memcpy(bytes, piece, length);
+	return length;
+}
+
+uint32_t MIKMIDIUniversalScaleUp(uint32_t value, unsigned sourceBits, unsigned destinationBits)
+{
+	if (sourceBits == 0 || sourceBits >= destinationBits) return value;
+
+	// Values at or below the center are just shifted. Above it, the bits below the top bit are
+	// repeated to fill the new low bits, so the maximum maps to the maximum.
+	unsigned scaleBits = destinationBits - sourceBits;
+	uint32_t shiftedValue = value << scaleBits;
+	uint32_t sourceCenter = (uint32_t)1 << (sourceBits - 1);
+	if (value <= sourceCenter) return shiftedValue;
+
+	unsigned repeatBits = sourceBits - 1;
+	uint32_t repeatValue = value & (((uint32_t)1 << repeatBits) - 1);
+	if (scaleBits > repeatBits) {
+		repeatValue <<= scaleBits - repeatBits;
+	} else {
+		repeatValue >>= repeatBits - scaleBits;
+	}
+	while (repeatValue) {
+		shiftedValue |= repeatValue;
+		repeatValue >>= repeatBits;
+	}
+	return shiftedValue;
+}
+
+uint32_t MIKMIDIUniversalScaleDown(uint32_t value, unsigned sourceBits, unsigned destinationBits)
+{
+	if (destinationBits >= sourceBits) return value;
+	return value >> (sourceBits - destinationBits);
+}
+
+int MIKMIDIUniversalMessageTranslateToMIDI2(const MIKMIDIUniversalMessage *message, MIKMIDIUniversalMessage *result)
+{
+	if (MIKMIDIUniversalMessageGetType(message) != MIKMIDIUniversalMessageTypeMIDI1ChannelVoice) return 0;
+
+	uint8_t group = MIKMIDIUniversalMessageGetGroup(message);
+	uint8_t status = MIKMIDIUniversalMessageGetStatus(message);
+	uint8_t data1 = MIKMIDIUniversalMessageGetData1(message) & 0x7F;
+	uint8_t data2 = MIKMIDIUniversalMessageGetData2(message) & 0x7F;
+	uint8_t channel = status & 0x0F;
+	switch (status & 0xF0) {
+		case 0x90:
+			if (data2 == 0) {
+				*result = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(group, 0x80 | channel, data1, 0, (uint32_t)0x8000 << 16);
+				return 1;
+			}
+			// Fall through
+		case 0x80:
+			*result = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(group, status, data1, 0, MIKMIDIUniversalScaleUp(data2, 7, 16) << 16);
+			return 1;
+		case 0xA0:
+		case 0xB0:
+			*result = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(group, status, data1, 0, MIKMIDIUniversalScaleUp(data2, 7, 32));
+			return 1;
+		case 0xC0:
+			*result = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(group, status, 0, 0, (uint32_t)data1 << 24);
+			return 1;
+		case 0xD0:
+			*result = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(group, status, 0, 0, MIKMIDIUniversalScaleUp(data1, 7, 32));
+			return 1;
+		case 0xE0:
+			*result = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(group, status, 0, 0, MIKMIDIUniversalScaleUp(((uint32_t)data2 << 7) | data1, 14, 32));
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+size_t MIKMIDIUniversalMessageTranslateToMIDI1(const MIKMIDIUniversalMessage *message, MIKMIDIUniversalMessage *results, size_t capacity)
+{
+	if (MIKMIDIUniversalMessageGetType(message) != MIKMIDIUniversalMessageTypeMIDI2ChannelVoice) return 0;
+
+	uint8_t group = MIKMIDIUniversalMessageGetGroup(message);
+	uint8_t status = MIKMIDIUniversalMessageGetStatus(message);
+	uint8_t opcode = status & 0xF0;
+	uint8_t controlChange = 0xB0 | (status & 0x0F);
+	uint8_t data1 = MIKMIDIUniversalMessageGetData1(message);
+	uint8_t data2 = MIKMIDIUniversalMessageGetData2(message);
+	uint32_t value = MIKMIDIUniversalMessageGetValue(message);
+
+	MIKMIDIUniversalMessage translated[MIKMIDIUniversalMessageMaximumMIDI1TranslationCount];
+	size_t count = 1;
+	switch (opcode) {
+		case 0x80:
+		case 0x90: {
+			uint32_t velocity = MIKMIDIUniversalScaleDown(value >> 16, 16, 7);
+			if (opcode == 0x90 && velocity == 0) velocity = 1; // 0 would make it a note off
+			MIKMIDIUniversalMessageMakeMIDI1(group, status, data1, (uint8_t)velocity, &translated[0]);
+			break;
+		}
+		case 0xA0:
+		case 0xB0:
+			MIKMIDIUniversalMessageMakeMIDI1(group, status, data1, (uint8_t)MIKMIDIUniversalScaleDown(value, 32, 7), &translated[0]);
+			break;
+		case 0xC0:
+			if (data2 & MIKMIDIUniversalProgramChangeFlagBankValid) {
+				MIKMIDIUniversalMessageMakeMIDI1(group, controlChange, 0, (value >> 8) & 0x7F, &translated[0]);
+				MIKMIDIUniversalMessageMakeMIDI1(group, controlChange, 32, value & 0x7F, &translated[1]);
+				count = 3;
+			}
+			MIKMIDIUniversalMessageMakeMIDI1(group, status, (value >> 24) & 0x7F, 0, &translated[count-1]);
+			break;
+		case 0xD0:
+			MIKMIDIUniversalMessageMakeMIDI1(group, status, (uint8_t)MIKMIDIUniversalScaleDown(value, 32, 7), 0, &translated[0]);
+			break;
+		case 0xE0: {
+			uint32_t pitchChange = MIKMIDIUniversalScaleDown(value, 32, 14);
+			MIKMIDIUniversalMessageMakeMIDI1(group, status, pitchChange & 0x7F, (pitchChange >> 7) & 0x7F, &translated[0]);
+			break;
+		}
+		case MIKMIDIUniversalOpcodeRegisteredController:
+		case MIKMIDIUniversalOpcodeAssignableController: {
+			int isRegistered = (opcode == MIKMIDIUniversalOpcodeRegisteredController);
+			uint32_t dataEntry = MIKMIDIUniversalScaleDown(value, 32, 14);
+			MIKMIDIUniversalMessageMakeMIDI1(group, controlChange, isRegistered ? 101 : 99, data1, &translated[0]);
+			MIKMIDIUniversalMessageMakeMIDI1(group, controlChange, isRegistered ? 100 : 98, data2, &translated[1]);
+			MIKMIDIUniversalMessageMakeMIDI1(group, controlChange, 6, (dataEntry >> 7) & 0x7F, &translated[2]);
+			MIKMIDIUniversalMessageMakeMIDI1(group, controlChange, 38, dataEntry & 0x7F, &translated[3]);
+			count = 4;
+			break;
+		}
+		default:
+			return 0;
+	}
+
+	if (count > capacity) return 0;
+	memcpy(results, translated, count * sizeof(MIKMIDIUniversalMessage));
+	return count;
+}
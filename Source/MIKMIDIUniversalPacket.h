@@ -0,0 +1,274 @@
+//
+//  MIKMIDIUniversalPacket.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#ifndef MIKMIDIUniversalPacket_h
+#define MIKMIDIUniversalPacket_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  Portable support for the MIDI 2.0 Universal MIDI Packet (UMP) format.
+ *
+ *  A UMP stream is a sequence of 32-bit words. Each message is one, two, three or four words long,
+ *  and its length is given by the message type in the top four bits of its first word. This file
+ *  splits streams into messages and writes them back, builds and takes apart messages, and
+ *  translates channel voice messages between their MIDI 1.0 and MIDI 2.0 forms, scaling values
+ *  as described in the MIDI 2.0 specification.
+ *
+ *  Words are in host byte order, as in CoreMIDI's MIDIEventPacket. Use
+ *  MIKMIDIUniversalPacketWordsToBytes() and MIKMIDIUniversalPacketBytesToWords() to convert to and
+ *  from the big endian byte order used in files and on the network.
+ *
+ *  Like MIKMIDIMessageParser.h, this file has no dependency on Foundation, CoreMIDI or AudioToolbox,
+ *  never allocates, and can be compiled and tested on any platform with a C99 compiler.
+ */
+
+/**
+ *  UMP message types.
+ */
+typedef enum {
+	/** NOOP and jitter reduction messages. One word. */
+	MIKMIDIUniversalMessageTypeUtility = 0x0,
+	/** MIDI 1.0 system common and system real time messages. One word. */
+	MIKMIDIUniversalMessageTypeSystem = 0x1,
+	/** MIDI 1.0 channel voice messages. One word. */
+	MIKMIDIUniversalMessageTypeMIDI1ChannelVoice = 0x2,
+	/** System exclusive messages, in up to six byte pieces. Two words. */
+	MIKMIDIUniversalMessageTypeData64 = 0x3,
+	/** MIDI 2.0 channel voice messages. Two words. */
+	MIKMIDIUniversalMessageTypeMIDI2ChannelVoice = 0x4,
+	/** 8-bit system exclusive and mixed data set messages. Four words. */
+	MIKMIDIUniversalMessageTypeData128 = 0x5,
+	/** Flex data messages. Four words. */
+	MIKMIDIUniversalMessageTypeFlexData = 0xD,
+	/** UMP stream messages. Four words. */
+	MIKMIDIUniversalMessageTypeStream = 0xF,
+} MIKMIDIUniversalMessageType;
+
+/**
+ *  Opcodes of MIDI 2.0 channel voice messages that don't exist in MIDI 1.0. Like MIDI 1.0
+ *  status bytes, they are in the top four bits of the status byte. The other opcodes,
+ *  0x80 (note off) to 0xE0 (pitch bend), are the same as in MIDI 1.0.
+ */
+enum {
+	MIKMIDIUniversalOpcodeRegisteredPerNoteController = 0x00,
+	MIKMIDIUniversalOpcodeAssignablePerNoteController = 0x10,
+	/** RPN. The bank is in data1, the index in data2, and the 32-bit value in the second word. */
+	MIKMIDIUniversalOpcodeRegisteredController = 0x20,
+	/** NRPN. The bank is in data1, the index in data2, and the 32-bit value in the second word. */
+	MIKMIDIUniversalOpcodeAssignableController = 0x30,
+	/** Relative RPN. The second word is a signed, two's complement increment. */
+	MIKMIDIUniversalOpcodeRelativeRegisteredController = 0x40,
+	/** Relative NRPN. The second word is a signed, two's complement increment. */
+	MIKMIDIUniversalOpcodeRelativeAssignableController = 0x50,
+	MIKMIDIUniversalOpcodePerNotePitchBend = 0x60,
+	MIKMIDIUniversalOpcodePerNoteManagement = 0xF0,
+};
+
+/**
+ *  Set in data2 of a MIDI 2.0 program change when its bank is valid.
+ */
+#define MIKMIDIUniversalProgramChangeFlagBankValid	0x01
+
+/**
+ *  The status of a system exclusive (data 64) message, saying where it falls in a system exclusive message.
+ */
+typedef enum {
+	/** The whole system exclusive message is in one UMP message. */
+	MIKMIDIUniversalSystemExclusiveStatusComplete = 0x0,
+	MIKMIDIUniversalSystemExclusiveStatusStart = 0x1,
+	MIKMIDIUniversalSystemExclusiveStatusContinue = 0x2,
+	MIKMIDIUniversalSystemExclusiveStatusEnd = 0x3,
+} MIKMIDIUniversalSystemExclusiveStatus;
+
+/**
+ *  A single UMP message. Only the words given by the message's type are used. Unused words are 0.
+ */
+typedef struct {
+	uint32_t words[4];
+} MIKMIDIUniversalMessage;
+
+/**
+ *  The most words a UMP message can have.
+ */
+#define MIKMIDIUniversalMessageMaximumWordCount	4
+
+/**
+ *  The most system exclusive bytes a data 64 message can carry.
+ */
+#define MIKMIDIUniversalSystemExclusiveBytesPerMessage	6
+
+/**
+ *  The most MIDI 1.0 messages MIKMIDIUniversalMessageTranslateToMIDI1() writes for one MIDI 2.0 message.
+ */
+#define MIKMIDIUniversalMessageMaximumMIDI1TranslationCount	4
+
+/** The message's MIKMIDIUniversalMessageType. */
+static inline uint8_t MIKMIDIUniversalMessageGetType(const MIKMIDIUniversalMessage *message) { return (uint8_t)(message->words[0] >> 28); }
+/** The message's group, 0-15. */
+static inline uint8_t MIKMIDIUniversalMessageGetGroup(const MIKMIDIUniversalMessage *message) { return (message->words[0] >> 24) & 0x0F; }
+/** The status byte. For channel voice messages, the opcode and channel. For data 64 messages, the system exclusive status and byte count. */
+static inline uint8_t MIKMIDIUniversalMessageGetStatus(const MIKMIDIUniversalMessage *message) { return (message->words[0] >> 16) & 0xFF; }
+/** For MIDI 1.0 messages, the first data byte. For MIDI 2.0 channel voice messages, the note, controller, or bank. */
+static inline uint8_t MIKMIDIUniversalMessageGetData1(const MIKMIDIUniversalMessage *message) { return (message->words[0] >> 8) & 0xFF; }
+/** For MIDI 1.0 messages, the second data byte. For MIDI 2.0 channel voice messages, the attribute type, index, or program change flags. */
+static inline uint8_t MIKMIDIUniversalMessageGetData2(const MIKMIDIUniversalMessage *message) { return message->words[0] & 0xFF; }
+/** For MIDI 2.0 channel voice messages, the second word. For notes, the velocity is in the top 16 bits and attribute data in the bottom 16. */
+static inline uint32_t MIKMIDIUniversalMessageGetValue(const MIKMIDIUniversalMessage *message) { return message->words[1]; }
+
+/**
+ *  Returns the number of words in messages of a type, 1-4.
+ */
+size_t MIKMIDIUniversalMessageWordCountForType(uint8_t type);
+
+/**
+ *  Splits UMP words into messages.
+ *
+ *  Parsing stops early if messages fills up, or if the words end partway through a message.
+ *  Call again, starting at words + *wordsConsumed, to parse the rest.
+ *
+ *  @param words         The words to parse, in host byte order.
+ *  @param wordCount     The number of words in words.
+ *  @param messages      Array to fill in with the parsed messages.
+ *  @param capacity      The number of elements in messages.
+ *  @param wordsConsumed On return, the number of words parsed.
+ *
+ *  @return The number of messages written to messages.
+ */
+size_t MIKMIDIUniversalPacketParse(const uint32_t *words, size_t wordCount, MIKMIDIUniversalMessage *messages, size_t capacity, size_t *wordsConsumed);
+
+/**
+ *  Writes messages out as UMP words.
+ *
+ *  @param messages The messages to write.
+ *  @param count    The number of messages in messages.
+ *  @param words    Buffer to write the words to.
+ *  @param capacity The number of words words can hold. Writing stops at the first message that doesn't fit.
+ *
+ *  @return The number of words written.
+ */
+size_t MIKMIDIUniversalPacketWrite(const MIKMIDIUniversalMessage *messages, size_t count, uint32_t *words, size_t capacity);
+
+/**
+ *  Converts words to big endian bytes. bytes must have room for 4 * count bytes.
+ */
+void MIKMIDIUniversalPacketWordsToBytes(const uint32_t *words, size_t count, uint8_t *bytes);
+
+/**
+ *  Converts big endian bytes to words. bytes must contain 4 * count bytes.
+ */
+void MIKMIDIUniversalPacketBytesToWords(const uint8_t *bytes, size_t count, uint32_t *words);
+
+/**
+ *  Makes a UMP message for a MIDI 1.0 channel voice, system common or system real time message.
+ *
+ *  @param group   The group, 0-15.
+ *  @param status  The status byte. Must not be a system exclusive or end of exclusive status byte.
+ *  @param data1   The first data byte, if any.
+ *  @param data2   The second data byte, if any.
+ *  @param message On return, the message.
+ *
+ *  @return 1 if message was made, 0 if status isn't a valid status byte for a single word message.
+ */
+int MIKMIDIUniversalMessageMakeMIDI1(uint8_t group, uint8_t status, uint8_t data1, uint8_t data2, MIKMIDIUniversalMessage *message);
+
+/**
+ *  Makes a MIDI 2.0 channel voice message.
+ *
+ *  @param group  The group, 0-15.
+ *  @param status The opcode and channel.
+ *  @param data1  The note, controller, or bank.
+ *  @param data2  The attribute type, index, or program change flags.
+ *  @param value  The second word.
+ *
+ *  @return The message.
+ */
+MIKMIDIUniversalMessage MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(uint8_t group, uint8_t status, uint8_t data1, uint8_t data2, uint32_t value);
+
+/**
+ *  Returns the number of data 64 messages needed to carry a system exclusive message.
+ *
+ *  @param length The number of bytes in the message, not counting the 0xF0 and 0xF7 bytes.
+ */
+size_t MIKMIDIUniversalSystemExclusiveMessageCount(size_t length);
+
+/**
+ *  Splits a MIDI 1.0 system exclusive message into data 64 messages.
+ *
+ *  @param group    The group, 0-15.
+ *  @param bytes    The system exclusive message. A leading 0xF0 and trailing 0xF7 are skipped.
+ *  @param length   The number of bytes in bytes.
+ *  @param messages Array to fill in with the messages.
+ *  @param capacity The number of elements in messages.
+ *
+ *  @return The number of messages written, or 0 if messages doesn't have room for all of them.
+ */
+size_t MIKMIDIUniversalMessagesMakeSystemExclusive(uint8_t group, const uint8_t *bytes, size_t length, MIKMIDIUniversalMessage *messages, size_t capacity);
+
+/**
+ *  Gets the system exclusive bytes carried by a data 64 message.
+ *
+ *  @param message A data 64 message.
+ *  @param bytes   Buffer to copy the bytes to. Must have room for MIKMIDIUniversalSystemExclusiveBytesPerMessage bytes.
+ *  @param status  On return, a MIKMIDIUniversalSystemExclusiveStatus value. May be NULL.
+ *
+ *  @return The number of bytes copied, 0-6.
+ */
+size_t MIKMIDIUniversalMessageGetSystemExclusiveBytes(const MIKMIDIUniversalMessage *message, uint8_t *bytes, uint8_t *status);
+
+/**
+ *  Scales a value up to more bits with the MIDI 2.0 specification's min-center-max method, so the
+ *  lowest, center and highest values of the source range map to those of the destination range.
+ */
+uint32_t MIKMIDIUniversalScaleUp(uint32_t value, unsigned sourceBits, unsigned destinationBits);
+
+/**
+ *  Scales a value down to fewer bits, by dropping its low bits.
+ */
+uint32_t MIKMIDIUniversalScaleDown(uint32_t value, unsigned sourceBits, unsigned destinationBits);
+
+/**
+ *  Translates a MIDI 1.0 channel voice message to a MIDI 2.0 channel voice message, scaling its value up.
+ *
+ *  A note on with a velocity of 0 becomes a note off with a velocity of 0x8000. Control changes are
+ *  translated one at a time, so RPN, NRPN and bank select control changes are translated to MIDI 2.0
+ *  control changes, not assembled into MIDI 2.0 RPN, NRPN or program change messages.
+ *
+ *  @param message A MIDI 1.0 channel voice message.
+ *  @param result  On return, the MIDI 2.0 message.
+ *
+ *  @return 1 if message was translated, 0 if it isn't a MIDI 1.0 channel voice message.
+ */
+int MIKMIDIUniversalMessageTranslateToMIDI2(const MIKMIDIUniversalMessage *message, MIKMIDIUniversalMessage *result);
+
+/**
+ *  Translates a MIDI 2.0 channel voice message to MIDI 1.0 channel voice messages, scaling its value down.
+ *
+ *  Most messages become one MIDI 1.0 message. A note on velocity that scales down to 0 becomes 1.
+ *  RPN and NRPN messages become four control changes: parameter number MSB and LSB, and data entry MSB
+ *  and LSB. Program changes with a valid bank become bank select MSB and LSB control changes and a
+ *  program change. Per-note and relative messages have no MIDI 1.0 equivalent, and aren't translated.
+ *
+ *  @param message  A MIDI 2.0 channel voice message.
+ *  @param results  Array to fill in with the MIDI 1.0 messages.
+ *  @param capacity The number of elements in results. MIKMIDIUniversalMessageMaximumMIDI1TranslationCount is always enough.
+ *
+ *  @return The number of messages written to results, or 0 if message couldn't be translated, or results is too small.
+ */
+size_t MIKMIDIUniversalMessageTranslateToMIDI1(const MIKMIDIUniversalMessage *message, MIKMIDIUniversalMessage *results, size_t capacity);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MIKMIDIUniversalPacket_h */
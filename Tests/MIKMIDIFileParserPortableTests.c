@@ -0,0 +1,160 @@
+//
+//  MIKMIDIFileParserPortableTests.c
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#include "MIKMIDIPortableTests.h"
+#include "MIKMIDIFileParser.h"
+
+// Wraps track in a format 0 file with a division of 480 ticks per quarter note. Returns the file's length.
+static size_t MIKFileWithTrackBytes(const uint8_t *track, uint32_t length, uint8_t *file)
+{
+	const uint8_t header[] = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0x01, 0xE0,
+		'M', 'T', 'r', 'k', (length >> 24) & 0xFF, (length >> 16) & 0xFF, (length >> 8) & 0xFF, length & 0xFF};
+	memcpy(file, header, sizeof(header));
+	memcpy(file + sizeof(header), track, length);
+	return sizeof(header) + length;
+}
+
+// Returns the result of reading the first event of the only track in a file containing track
+static MIKMIDIFileResult MIKReadFirstEvent(const uint8_t *track, uint32_t length, MIKMIDIFileEvent *event)
+{
+	uint8_t file[256];
+	size_t fileLength = MIKFileWithTrackBytes(track, length, file);
+	MIKMIDIFileHeader header;
+	MIKMIDIFileTrackChunk chunk;
+	size_t count = 0;
+	MIKMIDIFileResult result = MIKMIDIFileParseHeader(file, fileLength, &header, NULL);
+	if (result == MIKMIDIFileResultOK) result = MIKMIDIFileIndexTrackChunks(file, fileLength, &header, &chunk, 1, &count);
+	if (result != MIKMIDIFileResultOK) return result;
+
+	MIKMIDIFileTrackReader reader;
+	MIKMIDIFileTrackReaderInit(&reader, chunk);
+	return MIKMIDIFileTrackReaderNextEvent(&reader, event);
+}
+
+static void MIKTestVariableLengthQuantities(void)
+{
+	struct { uint8_t bytes[4]; size_t length; uint32_t value; } cases[] = {
+		{{0x00}, 1, 0},
+		{{0x7F}, 1, 0x7F},
+		{{0x81, 0x00}, 2, 0x80},
+		{{0xFF, 0x7F}, 2, 0x3FFF},
+		{{0x81, 0x80, 0x00}, 3, 0x4000},
+		{{0xFF, 0xFF, 0xFF, 0x7F}, 4, 0x0FFFFFFF},
+	};
+	for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		const uint8_t *cursor = cases[i].bytes;
+		uint32_t value = 0;
+		MIKAssertEqual(MIKMIDIFileReadVariableLengthQuantity(&cursor, cases[i].bytes + cases[i].length, &value), MIKMIDIFileResultOK);
+		MIKAssertEqual(value, cases[i].value);
+		MIKAssert(cursor == cases[i].bytes + cases[i].length);
+	}
+
+	const uint8_t truncated[] = {0x81, 0x80};
+	const uint8_t *cursor = truncated;
+	uint32_t value = 0;
+	MIKAssertEqual(MIKMIDIFileReadVariableLengthQuantity(&cursor, truncated + sizeof(truncated), &value), MIKMIDIFileResultTruncated);
+}
+
+static void MIKTestReadingEvents(void)
+{
+	const uint8_t track[] = {
+		0x00, 0xFF, 0x03, 0x04, 'L', 'e', 'a', 'd',		// Track name
+		0x00, 0x90, 0x3C, 0x64,							// Note on C4
+		0x00, 0x40, 0x50,								// Note on E4 (running status)
+		0x83, 0x60, 0x3C, 0x00,							// Note off C4 (running status, velocity 0) at 480
+		0x00, 0xF0, 0x03, 0x7E, 0x01, 0xF7,				// Sysex
+		0x00, 0xC1, 0x05,								// Program change, which has one data byte
+		0x00, 0xFF, 0x2F, 0x00,							// End of track
+	};
+	uint8_t file[256];
+	size_t fileLength = MIKFileWithTrackBytes(track, sizeof(track), file);
+
+	MIKMIDIFileHeader header;
+	size_t firstChunkOffset = 0;
+	MIKAssertEqual(MIKMIDIFileParseHeader(file, fileLength, &header, &firstChunkOffset), MIKMIDIFileResultOK);
+	MIKAssertEqual(header.format, 0);
+	MIKAssertEqual(header.numberOfTracks, 1);
+	MIKAssertEqual(header.division, 480);
+	MIKAssert(MIKMIDIFileHeaderHasMetricalDivision(&header));
+	MIKAssertEqual(firstChunkOffset, 14);
+
+	MIKMIDIFileTrackChunk chunk;
+	size_t count = 0;
+	MIKAssertEqual(MIKMIDIFileIndexTrackChunks(file, fileLength, &header, &chunk, 1, &count), MIKMIDIFileResultOK);
+	MIKAssertEqual(count, 1);
+	MIKAssertEqual(chunk.length, sizeof(track));
+
+	MIKMIDIFileTrackReader reader;
+	MIKMIDIFileTrackReaderInit(&reader, chunk);
+	MIKMIDIFileEvent event;
+
+	MIKAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	MIKAssertEqual(event.kind, MIKMIDIFileEventKindMeta);
+	MIKAssertEqual(event.metaType, MIKMIDIFileMetaTypeTrackName);
+	MIKAssertEqual(event.payloadLength, 4);
+	MIKAssertEqualBytes(event.payload, "Lead", 4);
+
+	MIKAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	MIKAssertEqual(event.kind, MIKMIDIFileEventKindChannel);
+	MIKAssertEqual(event.status, 0x90);
+	MIKAssertEqual(event.data1, 0x3C);
+	MIKAssertEqual(event.data2, 0x64);
+
+	MIKAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	MIKAssertEqual(event.status, 0x90);
+	MIKAssertEqual(event.data1, 0x40);
+	MIKAssertEqual(event.data2, 0x50);
+
+	MIKAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	MIKAssertEqual(event.tick, 480);
+	MIKAssertEqual(event.data1, 0x3C);
+	MIKAssertEqual(event.data2, 0);
+
+	MIKAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	MIKAssertEqual(event.kind, MIKMIDIFileEventKindSystemExclusive);
+	MIKAssertEqual(event.status, 0xF0);
+	MIKAssertEqual(event.payloadLength, 3);
+	MIKAssertEqual(event.payload[2], 0xF7);
+
+	MIKAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultOK);
+	MIKAssertEqual(event.status, 0xC1);
+	MIKAssertEqual(event.data1, 0x05);
+	MIKAssertEqual(event.data2, 0);
+
+	MIKAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultEndOfTrack);
+	MIKAssertEqual(event.tick, 480);
+	MIKAssertEqual(MIKMIDIFileTrackReaderNextEvent(&reader, &event), MIKMIDIFileResultEndOfTrack);
+}
+
+static void MIKTestMalformedFiles(void)
+{
+	MIKMIDIFileHeader header;
+	const uint8_t notAMIDIFile[] = {'R', 'I', 'F', 'F', 0, 0, 0, 6, 0, 0, 0, 1, 0, 96};
+	MIKAssertEqual(MIKMIDIFileParseHeader(notAMIDIFile, sizeof(notAMIDIFile), &header, NULL), MIKMIDIFileResultNotAMIDIFile);
+	const uint8_t truncatedHeader[] = {'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0};
+	MIKAssertEqual(MIKMIDIFileParseHeader(truncatedHeader, sizeof(truncatedHeader), &header, NULL), MIKMIDIFileResultTruncated);
+
+	MIKMIDIFileEvent event;
+	const uint8_t missingStatus[] = {0x00, 0x3C, 0x64};
+	MIKAssertEqual(MIKReadFirstEvent(missingStatus, sizeof(missingStatus), &event), MIKMIDIFileResultMissingRunningStatus);
+	const uint8_t statusByteAsData[] = {0x00, 0x90, 0x3C, 0xE4};
+	MIKAssertEqual(MIKReadFirstEvent(statusByteAsData, sizeof(statusByteAsData), &event), MIKMIDIFileResultMalformedEvent);
+	const uint8_t undefinedStatus[] = {0x00, 0xF4, 0x00};
+	MIKAssertEqual(MIKReadFirstEvent(undefinedStatus, sizeof(undefinedStatus), &event), MIKMIDIFileResultMalformedEvent);
+	const uint8_t truncatedEvent[] = {0x00, 0x90, 0x3C};
+	MIKAssertEqual(MIKReadFirstEvent(truncatedEvent, sizeof(truncatedEvent), &event), MIKMIDIFileResultTruncated);
+	const uint8_t truncatedMeta[] = {0x00, 0xFF, 0x03, 0x04, 'L', 'e'};
+	MIKAssertEqual(MIKReadFirstEvent(truncatedMeta, sizeof(truncatedMeta), &event), MIKMIDIFileResultTruncated);
+}
+
+void MIKMIDIFileParserRunTests(void)
+{
+	MIKTestVariableLengthQuantities();
+	MIKTestReadingEvents();
+	MIKTestMalformedFiles();
+}
@@ -0,0 +1,197 @@
+//
+//  MIKMIDIFileWriterPortableTests.c
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#include "MIKMIDIPortableTests.h"
+#include "MIKMIDIFileWriter.h"
+#include <stdlib.h>
+
+typedef struct {
+	uint8_t *bytes;
+	size_t length;
+	size_t capacity;
+	int failWrites;
+} MIKTestOutput;
+
+static MIKMIDIFileResult MIKTestWrite(void *context, const uint8_t *bytes, size_t length)
+{
+	MIKTestOutput *output = context;
+	if (output->failWrites) return MIKMIDIFileResultOutputFailed;
+	if (output->length + length > output->capacity) {
+		size_t capacity = (output->length + length) * 2;
+		uint8_t *newBytes = realloc(output->bytes, capacity);
+		if (!newBytes) return MIKMIDIFileResultOutputFailed;
+		output->bytes = newBytes;
+		output->capacity = capacity;
+	}
+	memcpy(output->bytes + output->length, bytes, length);
+	output->length += length;
+	return MIKMIDIFileResultOK;
+}
+
+static MIKMIDIFileResult MIKTestPatch(void *context, uint64_t offset, const uint8_t *bytes, size_t length)
+{
+	MIKTestOutput *output = context;
+	if (offset + length > output->length) return MIKMIDIFileResultOutputFailed;
+	memcpy(output->bytes + offset, bytes, length);
+	return MIKMIDIFileResultOK;
+}
+
+static void MIKTestWritingVariableLengthQuantities(void)
+{
+	uint8_t bytes[4];
+	MIKAssertEqual(MIKMIDIFileWriteVariableLengthQuantity(0, bytes), 1);
+	MIKAssertEqual(bytes[0], 0x00);
+	MIKAssertEqual(MIKMIDIFileWriteVariableLengthQuantity(0x7F, bytes), 1);
+	MIKAssertEqual(bytes[0], 0x7F);
+	MIKAssertEqual(MIKMIDIFileWriteVariableLengthQuantity(0x80, bytes), 2);
+	MIKAssertEqualBytes(bytes, ((uint8_t[]){0x81, 0x00}), 2);
+	MIKAssertEqual(MIKMIDIFileWriteVariableLengthQuantity(0x0FFFFFFF, bytes), 4);
+	MIKAssertEqualBytes(bytes, ((uint8_t[]){0xFF, 0xFF, 0xFF, 0x7F}), 4);
+	MIKAssertEqual(MIKMIDIFileWriteVariableLengthQuantity(0x10000000, bytes), 0);
+}
+
+static void MIKTestWriterOutput(void)
+{
+	MIKTestOutput output = {0};
+	MIKMIDIFileWriter writer;
+	MIKMIDIFileWriterInit(&writer, MIKTestWrite, MIKTestPatch, &output);
+	MIKMIDIFileHeader header = {.format = 0, .numberOfTracks = 1, .division = 480};
+	MIKAssertEqual(MIKMIDIFileWriterWriteHeader(&writer, &header), MIKMIDIFileResultOK);
+	MIKAssertEqual(MIKMIDIFileWriterBeginTrack(&writer, MIKMIDIFileWriterUnknownTrackLength), MIKMIDIFileResultOK);
+	MIKAssertEqual(MIKMIDIFileWriterWriteMetaEvent(&writer, 0, MIKMIDIFileMetaTypeTrackName, (const uint8_t *)"Lead", 4), MIKMIDIFileResultOK);
+	MIKAssertEqual(MIKMIDIFileWriterWriteNote(&writer, 0, 480, 0, 60, 100, 0), MIKMIDIFileResultOK);
+	MIKAssertEqual(MIKMIDIFileWriterWriteNote(&writer, 0, 480, 0, 64, 80, 32), MIKMIDIFileResultOK);
+	const uint8_t sysex[] = {0x7E, 0x01, 0xF7};
+	MIKAssertEqual(MIKMIDIFileWriterWriteSystemExclusiveEvent(&writer, 480, 0xF0, sysex, sizeof(sysex)), MIKMIDIFileResultOK);
+	uint32_t length = 0;
+	MIKAssertEqual(MIKMIDIFileWriterEndTrack(&writer, &length), MIKMIDIFileResultOK);
+	MIKAssertEqual(MIKMIDIFileWriterFlush(&writer), MIKMIDIFileResultOK);
+	MIKMIDIFileWriterDestroy(&writer);
+
+	const uint8_t expected[] = {
+		'M', 'T', 'h', 'd', 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x01, 0x01, 0xE0,
+		'M', 'T', 'r', 'k', 0x00, 0x00, 0x00, 0x21,	// Length filled in after the fact
+		0x00, 0xFF, 0x03, 0x04, 'L', 'e', 'a', 'd',
+		0x00, 0x90, 0x3C, 0x64,
+		0x00, 0x40, 0x50,				// Running status
+		0x83, 0x60, 0x3C, 0x00,			// Note off as a note on with velocity 0, at 480
+		0x00, 0x80, 0x40, 0x20,			// Real note off, to keep the release velocity
+		0x00, 0xF0, 0x03, 0x7E, 0x01, 0xF7,
+		0x00, 0xFF, 0x2F, 0x00,
+	};
+	MIKAssertEqual(length, 0x21);
+	MIKAssertEqual(output.length, sizeof(expected));
+	if (output.length == sizeof(expected)) MIKAssertEqualBytes(output.bytes, expected, sizeof(expected));
+	free(output.bytes);
+}
+
+static void MIKTestNotesWithoutVelocityAreWrittenAsNoteOffs(void)
+{
+	MIKTestOutput output = {0};
+	MIKMIDIFileWriter writer;
+	MIKMIDIFileWriterInit(&writer, MIKTestWrite, MIKTestPatch, &output);
+	MIKMIDIFileHeader header = {.format = 0, .numberOfTracks = 1, .division = 480};
+	MIKMIDIFileWriterWriteHeader(&writer, &header);
+	MIKMIDIFileWriterBeginTrack(&writer, MIKMIDIFileWriterUnknownTrackLength);
+	MIKAssertEqual(MIKMIDIFileWriterWriteNote(&writer, 0, 10, 1, 60, 0, 0), MIKMIDIFileResultOK);
+	MIKAssertEqual(MIKMIDIFileWriterWriteNote(&writer, 5, 10, 1, 62, 1, 0), MIKMIDIFileResultOK);
+	MIKAssertEqual(MIKMIDIFileWriterEndTrack(&writer, NULL), MIKMIDIFileResultOK);
+	MIKAssertEqual(MIKMIDIFileWriterFlush(&writer), MIKMIDIFileResultOK);
+	MIKMIDIFileWriterDestroy(&writer);
+
+	// Only the audible note gets a note on, and its velocity is kept
+	const uint8_t expected[] = {0x00, 0x81, 0x3C, 0x00, 0x05, 0x91, 0x3E, 0x01, 0x05, 0x3E, 0x00, 0x00, 0xFF, 0x2F, 0x00};
+	MIKAssertEqual(output.length, 22 + sizeof(expected));
+	if (output.length == 22 + sizeof(expected)) MIKAssertEqualBytes(output.bytes + 22, expected, sizeof(expected));
+	free(output.bytes);
+}
+
+static void MIKTestWriterRequiresLengthOfLongTracksWithoutPatching(void)
+{
+	MIKTestOutput output = {0};
+	MIKMIDIFileWriter writer;
+	MIKMIDIFileWriterInit(&writer, MIKTestWrite, NULL, &output);
+	MIKMIDIFileHeader header = {.format = 0, .numberOfTracks = 1, .division = 480};
+	MIKMIDIFileWriterWriteHeader(&writer, &header);
+	MIKMIDIFileWriterBeginTrack(&writer, MIKMIDIFileWriterUnknownTrackLength);
+	for (uint64_t i = 0; i < MIKMIDIFileWriterBufferSize; i++) {
+		MIKMIDIFileWriterWriteNote(&writer, i * 10, i * 10 + 5, 0, i % 128, 100, 0);
+	}
+	MIKAssertEqual(MIKMIDIFileWriterEndTrack(&writer, NULL), MIKMIDIFileResultInvalidArgument);
+	MIKMIDIFileWriterDestroy(&writer);
+	free(output.bytes);
+}
+
+static void MIKTestWriterReportsOutputFailures(void)
+{
+	MIKTestOutput output = {.failWrites = 1};
+	MIKMIDIFileWriter writer;
+	MIKMIDIFileWriterInit(&writer, MIKTestWrite, MIKTestPatch, &output);
+	MIKMIDIFileHeader header = {.format = 0, .numberOfTracks = 1, .division = 480};
+	MIKMIDIFileWriterWriteHeader(&writer, &header);
+	MIKMIDIFileWriterBeginTrack(&writer, MIKMIDIFileWriterUnknownTrackLength);
+	MIKMIDIFileWriterEndTrack(&writer, NULL);
+	MIKAssertEqual(MIKMIDIFileWriterFlush(&writer), MIKMIDIFileResultOutputFailed);
+	MIKAssertEqual(MIKMIDIFileWriterWriteChannelEvent(&writer, 0, 0xB0, 7, 100), MIKMIDIFileResultOutputFailed);
+	MIKMIDIFileWriterDestroy(&writer);
+}
+
+static void MIKTestWrittenFilesCanBeRead(void)
+{
+	MIKTestOutput output = {0};
+	MIKMIDIFileWriter writer;
+	MIKMIDIFileWriterInit(&writer, MIKTestWrite, MIKTestPatch, &output);
+	MIKMIDIFileHeader header = {.format = 1, .numberOfTracks = 1, .division = 96};
+	MIKMIDIFileWriterWriteHeader(&writer, &header);
+	MIKMIDIFileWriterBeginTrack(&writer, MIKMIDIFileWriterUnknownTrackLength);
+	for (uint64_t i = 0; i < 1000; i++) {
+		MIKMIDIFileWriterWriteNote(&writer, i * 24, i * 24 + 48, i % 16, i % 128, 1 + i % 127, 0);
+	}
+	MIKAssertEqual(MIKMIDIFileWriterEndTrack(&writer, NULL), MIKMIDIFileResultOK);
+	MIKAssertEqual(MIKMIDIFileWriterFlush(&writer), MIKMIDIFileResultOK);
+	MIKMIDIFileWriterDestroy(&writer);
+
+	MIKMIDIFileHeader readHeader;
+	MIKMIDIFileTrackChunk chunk;
+	size_t count = 0;
+	MIKAssertEqual(MIKMIDIFileParseHeader(output.bytes, output.length, &readHeader, NULL), MIKMIDIFileResultOK);
+	MIKAssertEqual(readHeader.format, 1);
+	MIKAssertEqual(readHeader.division, 96);
+	MIKAssertEqual(MIKMIDIFileIndexTrackChunks(output.bytes, output.length, &readHeader, &chunk, 1, &count), MIKMIDIFileResultOK);
+
+	MIKMIDIFileTrackReader reader;
+	MIKMIDIFileTrackReaderInit(&reader, chunk);
+	MIKMIDIFileEvent event;
+	size_t noteOnCount = 0, noteOffCount = 0;
+	MIKMIDIFileResult result;
+	while ((result = MIKMIDIFileTrackReaderNextEvent(&reader, &event)) == MIKMIDIFileResultOK) {
+		if ((event.status & 0xF0) == 0x90 && event.data2 != 0) {
+			MIKAssertEqual(event.tick, noteOnCount * 24);
+			MIKAssertEqual(event.data1, noteOnCount % 128);
+			MIKAssertEqual(event.data2, 1 + noteOnCount % 127);
+			noteOnCount++;
+		} else {
+			noteOffCount++;
+		}
+	}
+	MIKAssertEqual(result, MIKMIDIFileResultEndOfTrack);
+	MIKAssertEqual(noteOnCount, 1000);
+	MIKAssertEqual(noteOffCount, 1000);
+	MIKAssertEqual(event.tick, 999 * 24 + 48);
+	free(output.bytes);
+}
+
+void MIKMIDIFileWriterRunTests(void)
+{
+	MIKTestWritingVariableLengthQuantities();
+	MIKTestWriterOutput();
+	MIKTestNotesWithoutVelocityAreWrittenAsNoteOffs();
+	MIKTestWriterRequiresLengthOfLongTracksWithoutPatching();
+	MIKTestWriterReportsOutputFailures();
+	MIKTestWrittenFilesCanBeRead();
+}
@@ -0,0 +1,135 @@
+//
+//  MIKMIDIMessageParserPortableTests.c
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#include "MIKMIDIPortableTests.h"
+#include "MIKMIDIMessageParser.h"
+
+static void MIKTestRunningStatusAcrossBuffers(void)
+{
+	MIKMIDIMessageParser parser;
+	MIKMIDIMessageParserInit(&parser);
+	MIKMIDIParsedMessage messages[8];
+	size_t consumed = 0;
+
+	const uint8_t first[] = {0x90, 0x3C};
+	MIKAssertEqual(MIKMIDIMessageParserParse(&parser, first, sizeof(first), 100, messages, 8, &consumed), 0);
+	MIKAssertEqual(consumed, sizeof(first));
+
+	const uint8_t second[] = {0x64, 0x40, 0x50, 0xC2, 0x05, 0x06};
+	MIKAssertEqual(MIKMIDIMessageParserParse(&parser, second, sizeof(second), 200, messages, 8, &consumed), 4);
+	MIKAssertEqual(messages[0].kind, MIKMIDIParsedMessageKindShort);
+	MIKAssertEqual(messages[0].timeStamp, 100); // Messages take the time stamp of the buffer they start in
+	MIKAssertEqual(messages[0].status, 0x90);
+	MIKAssertEqual(messages[0].data1, 0x3C);
+	MIKAssertEqual(messages[0].data2, 0x64);
+	MIKAssertEqual(messages[0].length, 3);
+	MIKAssertEqual(messages[1].timeStamp, 200);
+	MIKAssertEqual(messages[1].status, 0x90);
+	MIKAssertEqual(messages[1].data1, 0x40);
+	MIKAssertEqual(messages[2].status, 0xC2);
+	MIKAssertEqual(messages[2].data1, 0x05);
+	MIKAssertEqual(messages[2].length, 2);
+	MIKAssertEqual(messages[3].status, 0xC2);
+	MIKAssertEqual(messages[3].data1, 0x06);
+
+	// System common messages cancel running status, so the following data bytes are dropped
+	const uint8_t third[] = {0xF3, 0x01, 0x07};
+	MIKAssertEqual(MIKMIDIMessageParserParse(&parser, third, sizeof(third), 300, messages, 8, &consumed), 1);
+	MIKAssertEqual(messages[0].status, 0xF3);
+	MIKAssertEqual(messages[0].data1, 0x01);
+}
+
+static void MIKTestRealTimeMessagesInsideOtherMessages(void)
+{
+	MIKMIDIMessageParser parser;
+	MIKMIDIMessageParserInit(&parser);
+	MIKMIDIParsedMessage messages[8];
+	size_t consumed = 0;
+
+	const uint8_t bytes[] = {0xB0, 0x07, 0xF8, 0x64, 0xFE};
+	MIKAssertEqual(MIKMIDIMessageParserParse(&parser, bytes, sizeof(bytes), 0, messages, 8, &consumed), 3);
+	MIKAssertEqual(messages[0].status, 0xF8);
+	MIKAssertEqual(messages[0].length, 1);
+	MIKAssertEqual(messages[1].status, 0xB0);
+	MIKAssertEqual(messages[1].data1, 0x07);
+	MIKAssertEqual(messages[1].data2, 0x64);
+	MIKAssertEqual(messages[2].status, 0xFE);
+}
+
+static void MIKTestSystemExclusiveFragments(void)
+{
+	MIKMIDIMessageParser parser;
+	MIKMIDIMessageParserInit(&parser);
+	MIKMIDIParsedMessage messages[8];
+	size_t consumed = 0;
+
+	const uint8_t first[] = {0xF0, 0x7E, 0x01, 0xF8, 0x02};
+	MIKAssertEqual(MIKMIDIMessageParserParse(&parser, first, sizeof(first), 0, messages, 8, &consumed), 3);
+	MIKAssertEqual(messages[0].kind, MIKMIDIParsedMessageKindSystemExclusiveFragment);
+	MIKAssertEqual(messages[0].flags, MIKMIDIParsedMessageFlagSystemExclusiveStart);
+	MIKAssertEqual(messages[0].length, 3);
+	MIKAssert(messages[0].bytes == first);
+	MIKAssertEqual(messages[1].kind, MIKMIDIParsedMessageKindShort);
+	MIKAssertEqual(messages[1].status, 0xF8);
+	MIKAssertEqual(messages[2].kind, MIKMIDIParsedMessageKindSystemExclusiveFragment);
+	MIKAssertEqual(messages[2].flags, 0);
+	MIKAssertEqual(messages[2].length, 1);
+	MIKAssertEqual(messages[2].bytes[0], 0x02);
+
+	const uint8_t second[] = {0x03, 0xF7, 0xF0, 0x04, 0x90, 0x3C, 0x64};
+	MIKAssertEqual(MIKMIDIMessageParserParse(&parser, second, sizeof(second), 0, messages, 8, &consumed), 3);
+	MIKAssertEqual(messages[0].flags, MIKMIDIParsedMessageFlagSystemExclusiveEnd);
+	MIKAssertEqual(messages[0].length, 2);
+	MIKAssertEqualBytes(messages[0].bytes, ((uint8_t[]){0x03, 0xF7}), 2);
+	// A status byte cuts off a message that never ended
+	MIKAssertEqual(messages[1].flags, MIKMIDIParsedMessageFlagSystemExclusiveStart | MIKMIDIParsedMessageFlagSystemExclusiveEnd);
+	MIKAssertEqual(messages[1].length, 2);
+	MIKAssertEqual(messages[2].status, 0x90);
+}
+
+static void MIKTestParsingStopsWhenMessagesAreFull(void)
+{
+	MIKMIDIMessageParser parser;
+	MIKMIDIMessageParserInit(&parser);
+	MIKMIDIParsedMessage messages[MIKMIDIMessageParserMinimumCapacity];
+	size_t consumed = 0;
+
+	const uint8_t bytes[] = {0xF8, 0xF8, 0xF8, 0xF8, 0xF8};
+	size_t total = 0, offset = 0;
+	while (offset < sizeof(bytes)) {
+		size_t count = MIKMIDIMessageParserParse(&parser, bytes + offset, sizeof(bytes) - offset, 0, messages, MIKMIDIMessageParserMinimumCapacity, &consumed);
+		MIKAssert(count > 0);
+		if (count == 0) break;
+		total += count;
+		offset += consumed;
+	}
+	MIKAssertEqual(total, sizeof(bytes));
+}
+
+static void MIKTestDataLengths(void)
+{
+	MIKAssertEqual(MIKMIDIMessageParserDataLengthForStatus(0x80), 2);
+	MIKAssertEqual(MIKMIDIMessageParserDataLengthForStatus(0xC5), 1);
+	MIKAssertEqual(MIKMIDIMessageParserDataLengthForStatus(0xD0), 1);
+	MIKAssertEqual(MIKMIDIMessageParserDataLengthForStatus(0xE0), 2);
+	MIKAssertEqual(MIKMIDIMessageParserDataLengthForStatus(0xF1), 1);
+	MIKAssertEqual(MIKMIDIMessageParserDataLengthForStatus(0xF2), 2);
+	MIKAssertEqual(MIKMIDIMessageParserDataLengthForStatus(0xF6), 0);
+	MIKAssertEqual(MIKMIDIMessageParserDataLengthForStatus(0xF0), -1);
+	MIKAssertEqual(MIKMIDIMessageParserDataLengthForStatus(0xF7), -1);
+	MIKAssertEqual(MIKMIDIMessageParserDataLengthForStatus(0x40), -1);
+}
+
+void MIKMIDIMessageParserRunTests(void)
+{
+	MIKTestRunningStatusAcrossBuffers();
+	MIKTestRealTimeMessagesInsideOtherMessages();
+	MIKTestSystemExclusiveFragments();
+	MIKTestParsingStopsWhenMessagesAreFull();
+	MIKTestDataLengths();
+}
@@ -0,0 +1,26 @@
+//
+//  MIKMIDIPortableTests.c
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#include "MIKMIDIPortableTests.h"
+
+unsigned long MIKMIDIPortableTestsFailureCount = 0;
+
+int main(void)
+{
+	MIKMIDIFileParserRunTests();
+	MIKMIDIFileWriterRunTests();
+	MIKMIDIMessageParserRunTests();
+	MIKMIDIUniversalPacketRunTests();
+
+	if (MIKMIDIPortableTestsFailureCount) {
+		fprintf(stderr, "%lu assertion(s) failed\n", MIKMIDIPortableTestsFailureCount);
+		return 1;
+	}
+	printf("All tests passed\n");
+	return 0;
+}
@@ -0,0 +1,37 @@
+//
+//  MIKMIDIPortableTests.h
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#ifndef MIKMIDIPortableTests_h
+#define MIKMIDIPortableTests_h
+
+#include <stdio.h>
+#include <string.h>
+
+/**
+ *  Minimal test harness for the parts of MIKMIDI written in portable C. These run with
+ *  nothing but a C99 compiler, so they can be run on any platform. See Tests/Makefile.
+ */
+
+extern unsigned long MIKMIDIPortableTestsFailureCount;
+
+#define MIKAssert(condition) do { \
+	if (!(condition)) { \
+		MIKMIDIPortableTestsFailureCount++; \
+		fprintf(stderr, "%s:%d: %s: assertion failed: %s\n", __FILE__, __LINE__, __func__, #condition); \
+	} \
+} while (0)
+
+#define MIKAssertEqual(a, b) MIKAssert((a) == (b))
+#define MIKAssertEqualBytes(a, b, length) MIKAssert(memcmp((a), (b), (length)) == 0)
+
+void MIKMIDIFileParserRunTests(void);
+void MIKMIDIFileWriterRunTests(void);
+void MIKMIDIMessageParserRunTests(void);
+void MIKMIDIUniversalPacketRunTests(void);
+
+#endif /* MIKMIDIPortableTests_h */
@@ -0,0 +1,142 @@
+//
+//  MIKMIDIUniversalPacketPortableTests.c
+//  MIKMIDI
+//
+//  Created by the MIKMIDI contributors on 10/16/26.
+//  Copyright (c) 2026 Mixed In Key. All rights reserved.
+//
+
+#include "MIKMIDIPortableTests.h"
+#include "MIKMIDIUniversalPacket.h"
+
+static void MIKTestScaling(void)
+{
+	MIKAssertEqual(MIKMIDIUniversalScaleUp(0, 7, 32), 0);
+	MIKAssertEqual(MIKMIDIUniversalScaleUp(64, 7, 32), 0x80000000u);
+	MIKAssertEqual(MIKMIDIUniversalScaleUp(127, 7, 32), 0xFFFFFFFFu);
+	MIKAssertEqual(MIKMIDIUniversalScaleUp(127, 7, 16), 0xFFFF);
+	MIKAssertEqual(MIKMIDIUniversalScaleUp(0x2000, 14, 32), 0x80000000u);
+	MIKAssertEqual(MIKMIDIUniversalScaleUp(0x3FFF, 14, 32), 0xFFFFFFFFu);
+
+	// Scaling up and back down again must give back the original value
+	for (uint32_t value = 0; value < 128; value++) {
+		MIKAssertEqual(MIKMIDIUniversalScaleDown(MIKMIDIUniversalScaleUp(value, 7, 32), 32, 7), value);
+		MIKAssertEqual(MIKMIDIUniversalScaleDown(MIKMIDIUniversalScaleUp(value, 7, 16), 16, 7), value);
+	}
+	for (uint32_t value = 0; value < 0x4000; value++) {
+		MIKAssertEqual(MIKMIDIUniversalScaleDown(MIKMIDIUniversalScaleUp(value, 14, 32), 32, 14), value);
+	}
+}
+
+static void MIKTestParsingAndWritingPackets(void)
+{
+	const uint32_t words[] = {
+		0x20903C64,					// MIDI 1.0 note on
+		0x40903C00, 0xFFFF0000,		// MIDI 2.0 note on
+		0x10F80000,					// Timing clock
+		0x50000000, 1, 2, 3,		// Data 128
+		0x40B00700,					// MIDI 2.0 control change, missing its second word
+	};
+	size_t wordCount = sizeof(words) / sizeof(words[0]);
+	MIKMIDIUniversalMessage messages[8];
+	size_t consumed = 0;
+	size_t count = MIKMIDIUniversalPacketParse(words, wordCount, messages, 8, &consumed);
+	MIKAssertEqual(count, 4);
+	MIKAssertEqual(consumed, 8);
+	MIKAssertEqual(MIKMIDIUniversalMessageGetType(&messages[1]), MIKMIDIUniversalMessageTypeMIDI2ChannelVoice);
+	MIKAssertEqual(MIKMIDIUniversalMessageGetStatus(&messages[1]), 0x90);
+	MIKAssertEqual(MIKMIDIUniversalMessageGetData1(&messages[1]), 0x3C);
+	MIKAssertEqual(MIKMIDIUniversalMessageGetValue(&messages[1]), 0xFFFF0000);
+	MIKAssertEqual(MIKMIDIUniversalMessageWordCountForType(MIKMIDIUniversalMessageTypeData128), 4);
+
+	uint32_t written[16];
+	MIKAssertEqual(MIKMIDIUniversalPacketWrite(messages, count, written, 16), 8);
+	MIKAssertEqualBytes(written, words, 8 * sizeof(uint32_t));
+	MIKAssertEqual(MIKMIDIUniversalPacketWrite(messages, count, written, 7), 4); // Only whole messages are written
+
+	uint8_t bytes[sizeof(words)];
+	uint32_t wordsFromBytes[sizeof(words) / sizeof(words[0])];
+	MIKMIDIUniversalPacketWordsToBytes(words, wordCount, bytes);
+	MIKAssertEqualBytes(bytes, ((uint8_t[]){0x20, 0x90, 0x3C, 0x64}), 4);
+	MIKMIDIUniversalPacketBytesToWords(bytes, wordCount, wordsFromBytes);
+	MIKAssertEqualBytes(wordsFromBytes, words, sizeof(words));
+}
+
+static void MIKTestTranslation(void)
+{
+	MIKMIDIUniversalMessage midi1, midi2, results[MIKMIDIUniversalMessageMaximumMIDI1TranslationCount];
+	MIKAssert(MIKMIDIUniversalMessageMakeMIDI1(0, 0x90, 0x3C, 0x64, &midi1));
+	MIKAssertEqual(midi1.words[0], 0x20903C64);
+	MIKAssert(MIKMIDIUniversalMessageTranslateToMIDI2(&midi1, &midi2));
+	MIKAssertEqual(midi2.words[0], 0x40903C00);
+	MIKAssertEqual(midi2.words[1], MIKMIDIUniversalScaleUp(0x64, 7, 16) << 16);
+	MIKAssertEqual(MIKMIDIUniversalMessageTranslateToMIDI1(&midi2, results, 4), 1);
+	MIKAssertEqual(results[0].words[0], 0x20903C64);
+
+	// A MIDI 2.0 note on whose velocity scales down to 0 must not become a note off
+	MIKMIDIUniversalMessage quietNote = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(0, 0x90, 0x3C, 0, 0x00100000);
+	MIKAssertEqual(MIKMIDIUniversalMessageTranslateToMIDI1(&quietNote, results, 4), 1);
+	MIKAssertEqual(MIKMIDIUniversalMessageGetData2(&results[0]), 1);
+
+	MIKAssert(MIKMIDIUniversalMessageMakeMIDI1(0, 0xE0, 0x7F, 0x7F, &midi1));
+	MIKAssert(MIKMIDIUniversalMessageTranslateToMIDI2(&midi1, &midi2));
+	MIKAssertEqual(midi2.words[1], 0xFFFFFFFFu);
+
+	// RPNs become four control changes, and aren't translated at all if they don't fit
+	MIKMIDIUniversalMessage rpn = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(2, MIKMIDIUniversalOpcodeRegisteredController, 0, 1, 0x80000000u);
+	MIKAssertEqual(MIKMIDIUniversalMessageTranslateToMIDI1(&rpn, results, 3), 0);
+	MIKAssertEqual(MIKMIDIUniversalMessageTranslateToMIDI1(&rpn, results, 4), 4);
+	for (size_t i = 0; i < 4; i++) {
+		MIKAssertEqual(MIKMIDIUniversalMessageGetGroup(&results[i]), 2);
+		MIKAssertEqual(MIKMIDIUniversalMessageGetStatus(&results[i]), 0xB0);
+	}
+	MIKAssertEqual(MIKMIDIUniversalMessageGetData1(&results[0]), 101);
+	MIKAssertEqual(MIKMIDIUniversalMessageGetData1(&results[1]), 100);
+	MIKAssertEqual(MIKMIDIUniversalMessageGetData2(&results[1]), 1);
+	MIKAssertEqual(MIKMIDIUniversalMessageGetData1(&results[2]), 6);
+
+	// Program changes with a valid bank become bank select MSB, LSB, then the program change
+	MIKMIDIUniversalMessage programChange = MIKMIDIUniversalMessageMakeMIDI2ChannelVoice(0, 0xC5, 0, MIKMIDIUniversalProgramChangeFlagBankValid, (5u << 24) | (1 << 8) | 2);
+	MIKAssertEqual(MIKMIDIUniversalMessageTranslateToMIDI1(&programChange, results, 4), 3);
+	MIKAssertEqual(results[0].words[0], 0x20B50001);
+	MIKAssertEqual(results[1].words[0], 0x20B52002);
+	MIKAssertEqual(results[2].words[0], 0x20C50500);
+
+	MIKAssert(!MIKMIDIUniversalMessageMakeMIDI1(0, 0xF0, 0, 0, &midi1));
+	MIKAssert(!MIKMIDIUniversalMessageMakeMIDI1(0, 0x40, 0, 0, &midi1));
+	MIKAssert(MIKMIDIUniversalMessageMakeMIDI1(3, 0xF2, 1, 2, &midi1));
+	MIKAssertEqual(midi1.words[0], 0x13F20102);
+}
+
+static void MIKTestSystemExclusive(void)
+{
+	const uint8_t sysex[] = {0xF0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 0xF7};
+	MIKMIDIUniversalMessage messages[4];
+	MIKAssertEqual(MIKMIDIUniversalSystemExclusiveMessageCount(13), 3);
+	MIKAssertEqual(MIKMIDIUniversalMessagesMakeSystemExclusive(0, sysex, sizeof(sysex), messages, 2), 0);
+	MIKAssertEqual(MIKMIDIUniversalMessagesMakeSystemExclusive(0, sysex, sizeof(sysex), messages, 4), 3);
+
+	uint8_t bytes[20];
+	size_t length = 0;
+	uint8_t statuses[3];
+	for (size_t i = 0; i < 3; i++) {
+		length += MIKMIDIUniversalMessageGetSystemExclusiveBytes(&messages[i], bytes + length, &statuses[i]);
+	}
+	MIKAssertEqual(length, 13);
+	MIKAssertEqualBytes(bytes, sysex + 1, 13);
+	MIKAssertEqual(statuses[0], MIKMIDIUniversalSystemExclusiveStatusStart);
+	MIKAssertEqual(statuses[1], MIKMIDIUniversalSystemExclusiveStatusContinue);
+	MIKAssertEqual(statuses[2], MIKMIDIUniversalSystemExclusiveStatusEnd);
+
+	const uint8_t empty[] = {0xF0, 0xF7};
+	MIKAssertEqual(MIKMIDIUniversalMessagesMakeSystemExclusive(0, empty, sizeof(empty), messages, 4), 1);
+	MIKAssertEqual(messages[0].words[0], 0x30000000);
+}
+
+void MIKMIDIUniversalPacketRunTests(void)
+{
+	MIKTestScaling();
+	MIKTestParsingAndWritingPackets();
+	MIKTestTranslation();
+	MIKTestSystemExclusive();
+}